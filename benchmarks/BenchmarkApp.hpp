@@ -36,6 +36,7 @@ public:
         ("length,l", po::value<size_t>(&_length)->default_value(512), "Length of vector")
         ("iterations,it", po::value<size_t>(&_iterations)->default_value(5000000), "Number of iterations")
         ("fma", po::value<bool>(&_useFma)->default_value(false), "Use the FMA instruction")
+        ("double", po::value<bool>(&_useDouble)->default_value(false), "Use double-precision instead of single-precision arrays")
         ("acceleration,a", po::value<std::string>(&acceleration)->default_value("best"), "Acceleration type to use, AVX, AVX2, Serial etc.");
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -86,13 +87,14 @@ public:
   /// \brief Produces a concise report of the execution of both benchmarks
   /// \return std::string containing the report
   ///
-  std::string Report()
+  virtual std::string Report()
   {
     std::ostringstream reportStream;
     reportStream << "Benchmarks report for " << _name << std::endl;
     reportStream << "Vector size: " << _length << std::endl;
     reportStream << "Iterations: " << _iterations << std::endl;
     reportStream << "FMA: " << _useFma << std::endl;
+    reportStream << "Double-precision: " << _useDouble << std::endl;
     reportStream << "Acceleration type: " << StringFromAcceleration(_acceleration) << std::endl;
     reportStream << "Serial ticks: " << _serialDuration.count() << std::endl;
     reportStream << "Simd ticks:   " << _simdDuration.count() << std::endl;
@@ -121,6 +123,11 @@ protected:
   ///
   bool _useFma;
 
+  ///
+  /// \brief Whether to benchmark double-precision arrays instead of single-precision, modifiable by the -double cmdline param, defaults to false
+  ///
+  bool _useDouble;
+
   std::chrono::high_resolution_clock::duration _serialDuration;
   std::chrono::high_resolution_clock::duration _simdDuration;
   std::string _name;
@@ -33,6 +33,10 @@ public:
     _simdSrc.resize(_length);
     _dst.resize(_length);
     _src.resize(_length);
+    _simdDoubleDst.resize(_length);
+    _simdDoubleSrc.resize(_length);
+    _doubleDst.resize(_length);
+    _doubleSrc.resize(_length);
 
     std::cout << "Length = " << _length << std::endl;
 
@@ -41,14 +45,22 @@ public:
 
   virtual bool RunSimd()
   {
-    _simdDst.Add(_simdSrc);
+    if ( _useDouble ) {
+      _simdDoubleDst.Add(_simdDoubleSrc);
+    } else {
+      _simdDst.Add(_simdSrc);
+    }
 
     return true;
   }
 
   virtual bool RunSerial()
   {
-    RunSerialImpl(_dst, _src);
+    if ( _useDouble ) {
+      RunSerialImpl(_doubleDst, _doubleSrc);
+    } else {
+      RunSerialImpl(_dst, _src);
+    }
     return true;
   }
 
@@ -58,6 +70,12 @@ private:
 
   std::vector<float> _src;
   std::vector<float> _dst;
+
+  DoublePrecisionArray _simdDoubleSrc;
+  DoublePrecisionArray _simdDoubleDst;
+
+  std::vector<double> _doubleSrc;
+  std::vector<double> _doubleDst;
 };
 
 BasicArithmeticBenchmarks theApp;
@@ -8,3 +8,10 @@ void RunSerialImpl(vector<float>& dst, const vector<float>& src)
     dst[i] += src[i];
   }
 }
+
+void RunSerialImpl(vector<double>& dst, const vector<double>& src)
+{
+  for ( auto i = 0; i < dst.size(); ++i ) {
+    dst[i] += src[i];
+  }
+}
@@ -3,3 +3,4 @@
 #include <vector>
 
 void RunSerialImpl(std::vector<float>& dst, const std::vector<float>& src);
+void RunSerialImpl(std::vector<double>& dst, const std::vector<double>& src);
@@ -0,0 +1,63 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../BenchmarkApp.hpp"
+#include "Array.hpp"
+
+using namespace khyber;
+
+///
+/// \brief Compares a fused expression against the same pipeline written as chained Array<T> calls. The "Simd" ticks are for the
+/// fused expression and the "Serial" ticks for the chained calls, which allocate a temporary and make a memory pass per step.
+///
+class ExpressionBenchmarks : public BenchmarkApp
+{
+public:
+  virtual bool InitApplication(int argc, char* argv[])
+  {
+    if ( !BenchmarkApp::InitApplication(argc, argv) ) {
+      return false;
+    }
+
+    _a.resize(_length, 1.0f);
+    _b.resize(_length, 2.0f);
+    _c.resize(_length, 3.0f);
+    _dst.resize(_length);
+
+    return true;
+  }
+
+  virtual bool RunSimd()
+  {
+    _dst = sqrt((_a + _b) * _c - _a / _b);
+
+    return true;
+  }
+
+  virtual bool RunSerial()
+  {
+    _dst = _a.Add(_b).Mul(_c).Sub(_a.Div(_b)).Sqrt();
+
+    return true;
+  }
+
+private:
+  SinglePrecisionArray _a;
+  SinglePrecisionArray _b;
+  SinglePrecisionArray _c;
+  SinglePrecisionArray _dst;
+};
+
+ExpressionBenchmarks theApp;
+BenchmarkApp* app = (BenchmarkApp*)&theApp;
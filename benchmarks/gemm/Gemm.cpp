@@ -0,0 +1,105 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../BenchmarkApp.hpp"
+#include "Matrix.hpp"
+#include "ProcessorCaps.hpp"
+
+using namespace khyber;
+
+///
+/// \brief Measures the product of two length x length single-precision matrices. The "Simd" ticks are Matrix<float>::Mul( ), the
+/// "Serial" ticks the straightforward i-k-j loop the compiler vectorizes by itself, so the difference is what the packing, the cache
+/// blocking and the register tile bring.
+///
+class GemmBenchmarks : public BenchmarkApp
+{
+public:
+  virtual bool InitApplication(int argc, char* argv[])
+  {
+    if ( !BenchmarkApp::InitApplication(argc, argv) ) {
+      return false;
+    }
+
+    ProcessorCaps caps = ProcessorCaps::Host();
+    if ( _acceleration == AVX ) {
+      caps.ClearFlags(BM_AVX2);
+    } else if ( _acceleration == Serial ) {
+      caps.ClearFlags(BM_SSE4_1 | BM_AVX | BM_AVX2 | BM_FMA);
+    }
+    SinglePrecisionArray::OverrideProcessorCaps(caps);
+
+    _lhs.resize(_length, _length);
+    _rhs.resize(_length, _length);
+    _product.resize(_length, _length);
+    for ( size_t r = 0; r < _length; ++r ) {
+      for ( size_t c = 0; c < _length; ++c ) {
+        _lhs(r, c) = (float)((r + c) % 7) - 3.0f;
+        _rhs(r, c) = (float)((r * c) % 5) - 2.0f;
+      }
+    }
+
+    return true;
+  }
+
+  virtual bool RunSimd()
+  {
+    _product.Mul(_lhs, _rhs);
+
+    return true;
+  }
+
+  virtual bool RunSerial()
+  {
+    for ( size_t r = 0; r < _length; ++r ) {
+      float* row = &_product(r, 0);
+      std::fill(row, row + _length, 0.0f);
+      for ( size_t k = 0; k < _length; ++k ) {
+        float lhs = _lhs(r, k);
+        const float* rhs = &_rhs(k, 0);
+        for ( size_t c = 0; c < _length; ++c ) {
+          row[c] += lhs * rhs[c];
+        }
+      }
+    }
+
+    return true;
+  }
+
+  virtual std::string Report()
+  {
+    GemmBlocking blocking = DefaultGemmBlocking(ArchBinding<float>::Active());
+    std::ostringstream reportStream;
+    reportStream << BenchmarkApp::Report();
+    reportStream << "Threads: " << ThreadPool::Instance().GetThreadCount() << std::endl;
+    reportStream << "Blocking (depth, rows, columns): " << blocking.depth << ", " << blocking.rows << ", " << blocking.columns << std::endl;
+    reportStream << "Loop GFLOP/s:   " << GigaFlops(_serialDuration) << std::endl;
+    reportStream << "Blocked GFLOP/s: " << GigaFlops(_simdDuration) << std::endl;
+    return reportStream.str();
+  }
+
+private:
+  SinglePrecisionMatrix _lhs;
+  SinglePrecisionMatrix _rhs;
+  SinglePrecisionMatrix _product;
+
+  double GigaFlops(std::chrono::high_resolution_clock::duration duration)
+  {
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    return (2.0 * (double)_length * (double)_length * (double)_length * (double)_iterations) / seconds / 1e9;
+  }
+};
+
+GemmBenchmarks theApp;
+BenchmarkApp* app = (BenchmarkApp*)&theApp;
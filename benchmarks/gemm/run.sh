@@ -0,0 +1,6 @@
+#!/bin/sh
+# Multiplies square matrices of 256, 512, 1024 and 2048 rows, extra arguments such as --acceleration avx are forwarded to every run
+./gemm --length 256 --iterations 50 "$@"
+./gemm --length 512 --iterations 10 "$@"
+./gemm --length 1024 --iterations 3 "$@"
+./gemm --length 2048 --iterations 1 "$@"
@@ -0,0 +1,100 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../BenchmarkApp.hpp"
+#include "Matrix.hpp"
+#include "ProcessorCaps.hpp"
+
+using namespace khyber;
+
+///
+/// \brief Measures the product of a length x length single-precision matrix with a vector. The "Simd" ticks are
+/// Matrix<float>::MulVec( ), the "Serial" ticks one Array<float>::DotProduct( ) per row, each with its own pass over the
+/// vector and its own horizontal reduction. The transposed product is timed separately and reported alongside.
+///
+class GemvBenchmarks : public BenchmarkApp
+{
+public:
+  virtual bool InitApplication(int argc, char* argv[])
+  {
+    if ( !BenchmarkApp::InitApplication(argc, argv) ) {
+      return false;
+    }
+
+    ProcessorCaps caps = ProcessorCaps::Host();
+    if ( _acceleration == AVX ) {
+      caps.ClearFlags(BM_AVX2);
+    } else if ( _acceleration == Serial ) {
+      caps.ClearFlags(BM_SSE4_1 | BM_AVX | BM_AVX2 | BM_FMA);
+    }
+    SinglePrecisionArray::OverrideProcessorCaps(caps);
+
+    _matrix.resize(_length, _length);
+    _vector.resize(_length);
+    _product.resize(_length);
+    for ( size_t r = 0; r < _length; ++r ) {
+      _vector[r] = (float)(r % 9) - 4.0f;
+      for ( size_t c = 0; c < _length; ++c ) {
+        _matrix(r, c) = (float)((r + c) % 7) - 3.0f;
+      }
+    }
+
+    return true;
+  }
+
+  virtual bool RunSimd()
+  {
+    _product = _matrix.MulVec(_vector);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    _product = _matrix.TransposedMulVec(_vector);
+    _transposedDuration += std::chrono::high_resolution_clock::now() - start;
+
+    return true;
+  }
+
+  virtual bool RunSerial()
+  {
+    for ( size_t r = 0; r < _length; ++r ) {
+      _product[r] = _matrix.Row(r).DotProduct(_vector);
+    }
+
+    return true;
+  }
+
+  virtual std::string Report()
+  {
+    std::ostringstream reportStream;
+    reportStream << BenchmarkApp::Report();
+    reportStream << "Per-row DotProduct GFLOP/s: " << GigaFlops(_serialDuration) << std::endl;
+    reportStream << "MulVec GFLOP/s:             " << GigaFlops(_simdDuration - _transposedDuration) << std::endl;
+    reportStream << "TransposedMulVec GFLOP/s:   " << GigaFlops(_transposedDuration) << std::endl;
+    return reportStream.str();
+  }
+
+private:
+  SinglePrecisionMatrix _matrix;
+  SinglePrecisionArray _vector;
+  SinglePrecisionArray _product;
+  std::chrono::high_resolution_clock::duration _transposedDuration = std::chrono::high_resolution_clock::duration::zero();
+
+  double GigaFlops(std::chrono::high_resolution_clock::duration duration)
+  {
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    return (2.0 * (double)_length * (double)_length * (double)_iterations) / seconds / 1e9;
+  }
+};
+
+GemvBenchmarks theApp;
+BenchmarkApp* app = (BenchmarkApp*)&theApp;
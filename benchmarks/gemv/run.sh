@@ -0,0 +1,5 @@
+#!/bin/sh
+# Scores a vector against square matrices of 256, 1024 and 4096 rows, extra arguments such as --acceleration avx are forwarded to every run
+./gemv --length 256 --iterations 20000 "$@"
+./gemv --length 1024 --iterations 1000 "$@"
+./gemv --length 4096 --iterations 50 "$@"
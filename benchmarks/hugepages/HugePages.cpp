@@ -0,0 +1,116 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+
+#include "../BenchmarkApp.hpp"
+#include "Array.hpp"
+#include "HugePages.hpp"
+#include "ProcessorCaps.hpp"
+
+using namespace khyber;
+
+///
+/// \brief Measures the memory bandwidth of Add, a scalar multiplication expression and DotProduct. The "Simd" ticks run on arrays
+/// backed by huge pages (explicit ones if the kernel has some reserved, transparent ones otherwise), the "Serial" ticks on the same
+/// arrays with regular pages, so the difference is the cost of the TLB misses.
+///
+class HugePagesBenchmarks : public BenchmarkApp
+{
+public:
+  virtual bool InitApplication(int argc, char* argv[])
+  {
+    if ( !BenchmarkApp::InitApplication(argc, argv) ) {
+      return false;
+    }
+
+    ProcessorCaps caps = ProcessorCaps::Host();
+    if ( _acceleration == AVX ) {
+      caps.ClearFlags(BM_AVX2);
+    } else if ( _acceleration == Serial ) {
+      caps.ClearFlags(BM_SSE4_1 | BM_AVX | BM_AVX2 | BM_FMA);
+    }
+    SinglePrecisionArray::OverrideProcessorCaps(caps);
+
+    _smallLhs = SinglePrecisionArray(_length, SmallPages);
+    _smallRhs = SinglePrecisionArray(_length, SmallPages);
+    _smallDst = SinglePrecisionArray(_length, SmallPages);
+    _hugeLhs = SinglePrecisionArray(_length, ExplicitHugePages);
+    _hugeRhs = SinglePrecisionArray(_length, ExplicitHugePages);
+    _hugeDst = SinglePrecisionArray(_length, ExplicitHugePages);
+    for ( size_t i = 0; i < _length; ++i ) {
+      _smallLhs[i] = _hugeLhs[i] = 1.0f;
+      _smallRhs[i] = _hugeRhs[i] = 2.0f;
+    }
+    _sink = 0.0f;
+
+    return true;
+  }
+
+  virtual bool RunSimd()
+  {
+    RunOperations(_hugeLhs, _hugeRhs, _hugeDst);
+
+    return true;
+  }
+
+  virtual bool RunSerial()
+  {
+    RunOperations(_smallLhs, _smallRhs, _smallDst);
+
+    return true;
+  }
+
+  virtual std::string Report()
+  {
+    HugePageStatistics statistics = HugePages::Statistics();
+    std::ostringstream reportStream;
+    reportStream << BenchmarkApp::Report();
+    reportStream << "Array (bytes): " << _length * sizeof(float) << std::endl;
+    reportStream << "Explicit huge page arrays: " << statistics.explicitAllocations << std::endl;
+    reportStream << "Transparent huge page arrays: " << statistics.transparentAllocations << std::endl;
+    reportStream << "Regular pages GB/s: " << GigaBytes(_serialDuration) << std::endl;
+    reportStream << "Huge pages GB/s:    " << GigaBytes(_simdDuration) << std::endl;
+    return reportStream.str();
+  }
+
+private:
+  SinglePrecisionArray _smallLhs;
+  SinglePrecisionArray _smallRhs;
+  SinglePrecisionArray _smallDst;
+  SinglePrecisionArray _hugeLhs;
+  SinglePrecisionArray _hugeRhs;
+  SinglePrecisionArray _hugeDst;
+  float _sink;
+
+  void RunOperations(SinglePrecisionArray& lhs, SinglePrecisionArray& rhs, SinglePrecisionArray& dst)
+  {
+    dst.Add(lhs, rhs);
+    dst = lhs * 3.0f;
+    _sink += dst.DotProduct(rhs);
+  }
+
+  ///
+  /// \brief Bytes the program asks for per iteration: Add reads two arrays and writes one, the multiplication reads one and writes
+  /// one and DotProduct reads two
+  ///
+  double GigaBytes(std::chrono::high_resolution_clock::duration duration)
+  {
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    return (7.0 * sizeof(float) * (double)_length * (double)_iterations) / seconds / 1e9;
+  }
+};
+
+HugePagesBenchmarks theApp;
+BenchmarkApp* app = (BenchmarkApp*)&theApp;
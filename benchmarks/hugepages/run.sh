@@ -0,0 +1,6 @@
+#!/bin/sh
+# Runs Add, a scalar multiplication expression and DotProduct on arrays of 64MB, 256MB and 1GB, with regular and with huge
+# pages, extra arguments such as --acceleration avx are forwarded to every run
+./hugepages --length 16777216 --iterations 100 "$@"
+./hugepages --length 67108864 --iterations 25 "$@"
+./hugepages --length 268435456 --iterations 6 "$@"
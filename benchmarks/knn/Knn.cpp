@@ -0,0 +1,118 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "../BenchmarkApp.hpp"
+#include "ProcessorCaps.hpp"
+#include "VectorIndex.hpp"
+
+// Dimension of the vectors and size of the query batch, typical of embedding search
+#define KNN_DIMENSION 128
+#define KNN_QUERIES 64
+#define KNN_NEIGHBORS 10
+
+using namespace khyber;
+
+///
+/// \brief Measures the search of length vectors of KNN_DIMENSION elements for the KNN_NEIGHBORS nearest, by L2 distance, of each of
+/// KNN_QUERIES queries. The "Simd" ticks are one batched VectorIndex::Search( ), the "Serial" ticks one Array<float>::Distance( ) per
+/// query and vector followed by a partial sort.
+///
+class KnnBenchmarks : public BenchmarkApp
+{
+public:
+  KnnBenchmarks() : _index(KNN_DIMENSION)
+  {
+  }
+
+  virtual bool InitApplication(int argc, char* argv[])
+  {
+    if ( !BenchmarkApp::InitApplication(argc, argv) ) {
+      return false;
+    }
+
+    ProcessorCaps caps = ProcessorCaps::Host();
+    if ( _acceleration == AVX ) {
+      caps.ClearFlags(BM_AVX2);
+    } else if ( _acceleration == Serial ) {
+      caps.ClearFlags(BM_SSE4_1 | BM_AVX | BM_AVX2 | BM_FMA);
+    }
+    SinglePrecisionArray::OverrideProcessorCaps(caps);
+
+    SinglePrecisionMatrix vectors(_length, KNN_DIMENSION);
+    for ( size_t r = 0; r < _length; ++r ) {
+      for ( size_t c = 0; c < KNN_DIMENSION; ++c ) {
+        vectors(r, c) = (float)((r * 7 + c * 13 + r * c) % 101) / 50.0f - 1.0f;
+      }
+    }
+    _index.Add(vectors);
+
+    _queries.resize(KNN_QUERIES, KNN_DIMENSION);
+    for ( size_t r = 0; r < KNN_QUERIES; ++r ) {
+      for ( size_t c = 0; c < KNN_DIMENSION; ++c ) {
+        _queries(r, c) = (float)((r * 3 + c * 29) % 97) / 48.0f - 1.0f;
+      }
+    }
+
+    return true;
+  }
+
+  virtual bool RunSimd()
+  {
+    std::vector<std::vector<Neighbor> > results = _index.Search(_queries, KNN_NEIGHBORS);
+    _sink += results[0][0].id;
+
+    return true;
+  }
+
+  virtual bool RunSerial()
+  {
+    std::vector<std::pair<float, size_t> > distances(_length);
+    for ( size_t q = 0; q < KNN_QUERIES; ++q ) {
+      for ( size_t v = 0; v < _length; ++v ) {
+        distances[v] = std::make_pair(_index.Vector(v).Distance(_queries.Row(q)), v);
+      }
+      std::partial_sort(distances.begin(), distances.begin() + KNN_NEIGHBORS, distances.end());
+      _sink += distances[0].second;
+    }
+
+    return true;
+  }
+
+  virtual std::string Report()
+  {
+    std::ostringstream reportStream;
+    reportStream << BenchmarkApp::Report();
+    reportStream << "Threads: " << ThreadPool::Instance().GetThreadCount() << std::endl;
+    reportStream << "Distance( ) queries/s:      " << QueriesPerSecond(_serialDuration) << std::endl;
+    reportStream << "VectorIndex queries/s:      " << QueriesPerSecond(_simdDuration) << std::endl;
+    return reportStream.str();
+  }
+
+private:
+  VectorIndex _index;
+  SinglePrecisionMatrix _queries;
+  size_t _sink = 0;
+
+  double QueriesPerSecond(std::chrono::high_resolution_clock::duration duration)
+  {
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    return (double)KNN_QUERIES * (double)_iterations / seconds;
+  }
+};
+
+KnnBenchmarks theApp;
+BenchmarkApp* app = (BenchmarkApp*)&theApp;
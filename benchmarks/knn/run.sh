@@ -0,0 +1,6 @@
+#!/bin/sh
+# Searches 10000, 100000 and 1000000 vectors of 128 elements for the 10 nearest neighbors of 64 queries, extra arguments such as
+# --acceleration avx are forwarded to every run
+./knn --length 10000 --iterations 20 "$@"
+./knn --length 100000 --iterations 3 "$@"
+./knn --length 1000000 --iterations 1 "$@"
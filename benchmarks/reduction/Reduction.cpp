@@ -0,0 +1,138 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "../BenchmarkApp.hpp"
+#include "Array.hpp"
+#include "ProcessorCaps.hpp"
+
+using namespace khyber;
+
+///
+/// \brief Measures the throughput of the DotProduct reduction in GFLOP/s, run it with lengths whose
+/// working set fits in L1, in L2 and only in DRAM (see run.sh) to see where the kernel stops being
+/// latency-bound and starts being bandwidth-bound
+///
+class ReductionBenchmarks : public BenchmarkApp
+{
+public:
+  virtual bool InitApplication(int argc, char* argv[])
+  {
+    if ( !BenchmarkApp::InitApplication(argc, argv) ) {
+      return false;
+    }
+
+    ProcessorCaps caps = ProcessorCaps::Host();
+    if ( !_useFma ) {
+      caps.ClearFlags(BM_FMA);
+    }
+    if ( _acceleration == AVX ) {
+      caps.ClearFlags(BM_AVX2);
+    } else if ( _acceleration == Serial ) {
+      caps.ClearFlags(BM_SSE4_1 | BM_AVX | BM_AVX2 | BM_FMA);
+    }
+    SinglePrecisionArray::OverrideProcessorCaps(caps);
+    DoublePrecisionArray::OverrideProcessorCaps(caps);
+
+    _simdMultiplier.resize(_length);
+    _simdMultiplicand.resize(_length);
+    _multiplier.resize(_length);
+    _multiplicand.resize(_length);
+    _simdDoubleMultiplier.resize(_length);
+    _simdDoubleMultiplicand.resize(_length);
+    _doubleMultiplier.resize(_length);
+    _doubleMultiplicand.resize(_length);
+
+    for ( size_t i = 0; i < _length; ++i ) {
+      _simdMultiplier[i] = _multiplier[i] = 1.0f / (float)(i % 64 + 1);
+      _simdMultiplicand[i] = _multiplicand[i] = (float)(i % 7);
+      _simdDoubleMultiplier[i] = _doubleMultiplier[i] = 1.0 / (double)(i % 64 + 1);
+      _simdDoubleMultiplicand[i] = _doubleMultiplicand[i] = (double)(i % 7);
+    }
+
+    return true;
+  }
+
+  virtual bool RunSimd()
+  {
+    if ( _useDouble ) {
+      _checksum += _simdDoubleMultiplier.DotProduct(_simdDoubleMultiplicand);
+    } else {
+      _checksum += _simdMultiplier.DotProduct(_simdMultiplicand);
+    }
+
+    return true;
+  }
+
+  virtual bool RunSerial()
+  {
+    if ( _useDouble ) {
+      double product = 0;
+      for ( size_t i = 0; i < _length; ++i ) {
+        product += _doubleMultiplier[i] * _doubleMultiplicand[i];
+      }
+      _checksum += product;
+    } else {
+      float product = 0;
+      for ( size_t i = 0; i < _length; ++i ) {
+        product += _multiplier[i] * _multiplicand[i];
+      }
+      _checksum += product;
+    }
+
+    return true;
+  }
+
+  virtual std::string Report()
+  {
+    std::ostringstream reportStream;
+    reportStream << BenchmarkApp::Report();
+    reportStream << "Working set (bytes): " << 2 * _length * (_useDouble ? sizeof(double) : sizeof(float)) << std::endl;
+    reportStream << "Serial GFLOP/s: " << GigaFlops(_serialDuration) << std::endl;
+    reportStream << "Simd GFLOP/s:   " << GigaFlops(_simdDuration) << std::endl;
+    reportStream << "Checksum: " << _checksum << std::endl;
+    return reportStream.str();
+  }
+
+private:
+  SinglePrecisionArray _simdMultiplier;
+  SinglePrecisionArray _simdMultiplicand;
+
+  std::vector<float> _multiplier;
+  std::vector<float> _multiplicand;
+
+  DoublePrecisionArray _simdDoubleMultiplier;
+  DoublePrecisionArray _simdDoubleMultiplicand;
+
+  std::vector<double> _doubleMultiplier;
+  std::vector<double> _doubleMultiplicand;
+
+  ///
+  /// \brief Sum of every result, reported so the compiler can't discard the reductions
+  ///
+  double _checksum = 0;
+
+  ///
+  /// \brief One multiply and one add per element and iteration
+  ///
+  double GigaFlops(std::chrono::high_resolution_clock::duration duration)
+  {
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    return (2.0 * (double)_length * (double)_iterations) / seconds / 1e9;
+  }
+};
+
+ReductionBenchmarks theApp;
+BenchmarkApp* app = (BenchmarkApp*)&theApp;
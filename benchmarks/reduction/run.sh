@@ -0,0 +1,7 @@
+#!/bin/sh
+# Sweeps the dot product over L1-, L2- and DRAM-resident working sets (two operands of
+# 8KB, 64KB and 64MB in single-precision), extra arguments such as --fma 1 or --double 1
+# are forwarded to every run
+./reduction --length 2048 --iterations 1000000 "$@"
+./reduction --length 16384 --iterations 100000 "$@"
+./reduction --length 16777216 --iterations 50 "$@"
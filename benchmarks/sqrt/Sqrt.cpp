@@ -33,21 +33,35 @@ public:
     _simdSrc.resize(_length);
     _dst.resize(_length);
     _src.resize(_length);
+    _simdDoubleDst.resize(_length);
+    _simdDoubleSrc.resize(_length);
+    _doubleDst.resize(_length);
+    _doubleSrc.resize(_length);
 
     return true;
   }
 
   virtual bool RunSimd()
   {
-    _simdDst.Sqrt(_simdSrc);
+    if ( _useDouble ) {
+      _simdDoubleDst.Sqrt(_simdDoubleSrc);
+    } else {
+      _simdDst.Sqrt(_simdSrc);
+    }
 
     return true;
   }
 
   virtual bool RunSerial()
   {
-    for ( auto i = 0; i < _length; ++i ) {
-      _dst[i] = sqrt(_src[i]);
+    if ( _useDouble ) {
+      for ( auto i = 0; i < _length; ++i ) {
+        _doubleDst[i] = sqrt(_doubleSrc[i]);
+      }
+    } else {
+      for ( auto i = 0; i < _length; ++i ) {
+        _dst[i] = sqrt(_src[i]);
+      }
     }
 
     return true;
@@ -59,6 +73,12 @@ private:
 
   std::vector<float> _src;
   std::vector<float> _dst;
+
+  DoublePrecisionArray _simdDoubleSrc;
+  DoublePrecisionArray _simdDoubleDst;
+
+  std::vector<double> _doubleSrc;
+  std::vector<double> _doubleDst;
 };
 
 SqrtBenchmarks theApp;
@@ -0,0 +1,102 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+
+#include "../BenchmarkApp.hpp"
+#include "Array.hpp"
+#include "ProcessorCaps.hpp"
+
+using namespace khyber;
+
+///
+/// \brief Measures the memory bandwidth of Add, a scalar multiplication expression and Sqrt into an existing array. The "Simd" ticks are with the
+/// default streaming threshold, the "Serial" ticks with non-temporal stores disabled, so on arrays larger than the last-level
+/// cache (see run.sh) the difference is the read-for-ownership traffic the streaming stores save.
+///
+class StreamingBenchmarks : public BenchmarkApp
+{
+public:
+  virtual bool InitApplication(int argc, char* argv[])
+  {
+    if ( !BenchmarkApp::InitApplication(argc, argv) ) {
+      return false;
+    }
+
+    ProcessorCaps caps = ProcessorCaps::Host();
+    if ( _acceleration == AVX ) {
+      caps.ClearFlags(BM_AVX2);
+    } else if ( _acceleration == Serial ) {
+      caps.ClearFlags(BM_SSE4_1 | BM_AVX | BM_AVX2 | BM_FMA);
+    }
+    SinglePrecisionArray::OverrideProcessorCaps(caps);
+
+    _lhs.resize(_length, 1.0f);
+    _rhs.resize(_length, 2.0f);
+    _dst.resize(_length);
+
+    return true;
+  }
+
+  virtual bool RunSimd()
+  {
+    SetStreamingThreshold(0);
+    RunOperations();
+
+    return true;
+  }
+
+  virtual bool RunSerial()
+  {
+    SetStreamingThreshold(SIZE_MAX);
+    RunOperations();
+
+    return true;
+  }
+
+  virtual std::string Report()
+  {
+    std::ostringstream reportStream;
+    reportStream << BenchmarkApp::Report();
+    reportStream << "Output (bytes): " << _length * sizeof(float) << std::endl;
+    reportStream << "Streaming threshold (bytes): " << (SetStreamingThreshold(0), GetStreamingThreshold()) << std::endl;
+    reportStream << "Cached stores GB/s:    " << GigaBytes(_serialDuration) << std::endl;
+    reportStream << "Streaming stores GB/s: " << GigaBytes(_simdDuration) << std::endl;
+    return reportStream.str();
+  }
+
+private:
+  SinglePrecisionArray _lhs;
+  SinglePrecisionArray _rhs;
+  SinglePrecisionArray _dst;
+
+  void RunOperations()
+  {
+    _dst.Add(_lhs, _rhs);
+    _dst = _lhs * 3.0f;
+    _dst.Sqrt(_rhs);
+  }
+
+  ///
+  /// \brief Bytes the program asks for per iteration: Add reads two arrays and writes one, the multiplication and Sqrt read one and write one
+  ///
+  double GigaBytes(std::chrono::high_resolution_clock::duration duration)
+  {
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    return (7.0 * sizeof(float) * (double)_length * (double)_iterations) / seconds / 1e9;
+  }
+};
+
+StreamingBenchmarks theApp;
+BenchmarkApp* app = (BenchmarkApp*)&theApp;
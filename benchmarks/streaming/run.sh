@@ -0,0 +1,6 @@
+#!/bin/sh
+# Runs Add, a scalar multiplication and Sqrt on arrays of 4MB (cache-resident), 64MB and 256MB (larger than
+# the last-level cache), extra arguments such as --acceleration avx are forwarded to every run
+./streaming --length 1048576 --iterations 2000 "$@"
+./streaming --length 16777216 --iterations 100 "$@"
+./streaming --length 67108864 --iterations 25 "$@"
@@ -0,0 +1,157 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include "ProcessorCaps.hpp"
+#include "Types.hpp"
+
+namespace khyber
+{
+  ///
+  /// \brief Hand-written vtable of compute kernels for element type T, one instance per instruction set.
+  /// \details Every ArchBinding<T> is built once, filled in with the kernels of a single arch package (fallback, sse, avx, avx2) and
+  /// never modified afterwards. \link Array<T>\endlink does not hold any of these pointers itself, it asks \link Active( )\endlink
+  /// for the table matching the host processor, which is selected the first time it is needed and shared by the whole process.
+  /// The kernels follow the C-style signatures of the arch packages, i.e., the size followed by the output and then the inputs.
+  ///
+  template<typename T>
+  struct ArchBinding
+  {
+    void (*Add) (size_t size, T* sum, const T* augend, const T* addend);
+    void (*ScalarAdd) (size_t size, T addend, T* sum, const T* src);
+    void (*Sub) (size_t size, T* difference, const T* minuend, const T* subtrahend);
+    void (*Mul) (size_t size, T* product, const T* multiplier, const T* multiplicand);
+    void (*Div) (size_t size, T* quotient, const T* dividend, const T* divisor);
+    void (*ScalarMul) (size_t size, T multiplier, T* product, const T* src);
+    void (*ScalarDiv) (size_t size, T divisor, T* quotient, const T* src);
+    void (*Sqrt) (size_t size, T* dst, const T* src);
+    void (*Square) (size_t size, T* dst, const T* src);
+    void (*Cube) (size_t size, T* dst, const T* src);
+    void (*Negate) (size_t size, T* dst, const T* src);
+    void (*Reciprocate) (size_t size, T* dst, const T* src);
+    void (*ApproximateReciprocate) (size_t size, T* dst, const T* src);
+    void (*RefinedReciprocate) (size_t size, T* dst, const T* src);
+    void (*DotProduct) (size_t size, T* product, const T* multiplier, const T* multiplicand);
+    void (*Summation) (size_t size, T* sum, const T* src);
+    void (*CompensatedSummation) (size_t size, T* lanes, const T* src);
+    void (*CompensatedDotProduct) (size_t size, T* lanes, const T* multiplier, const T* multiplicand);
+    void (*PrefixSum) (size_t size, T carry, T* dst, const T* src);
+    void (*ExclusivePrefixSum) (size_t size, T carry, T* dst, const T* src);
+    void (*Distance) (size_t size, T* distance, const T* v1, const T* v2);
+    void (*Minimum) (size_t size, T* minimum, const T* src);
+    void (*Maximum) (size_t size, T* maximum, const T* src);
+    void (*MinMaximum) (size_t size, Extrema<T>* extrema, const T* src);
+    void (*ArgMinimum) (size_t size, size_t* index, const T* src);
+    void (*ArgMaximum) (size_t size, size_t* index, const T* src);
+
+    // Copies with non-temporal stores for outputs larger than the caches, see ParallelMap( ). Null in the serial tables, which never stream.
+    void (*StreamingCopy) (size_t bytes, void* dst, const void* src);
+
+    // Floating point element types only, these are left null in the integral tables
+    void (*Exp) (size_t size, T* dst, const T* src);
+    void (*Log) (size_t size, T* dst, const T* src);
+    void (*Log2) (size_t size, T* dst, const T* src);
+    void (*Sin) (size_t size, T* dst, const T* src);
+    void (*Cos) (size_t size, T* dst, const T* src);
+    void (*Tanh) (size_t size, T* dst, const T* src);
+    void (*Sigmoid) (size_t size, T* dst, const T* src);
+    void (*Pow) (size_t size, T* dst, const T* base, const T* exponent);
+    void (*Rsqrt) (size_t size, T* dst, const T* src);
+    void (*ApproximateRsqrt) (size_t size, T* dst, const T* src);
+    void (*RefinedRsqrt) (size_t size, T* dst, const T* src);
+
+    // Matrix product micro-kernel and its register tile of GemmRows x GemmColumns elements, see Gemm( ). Floating point only.
+    void (*GemmKernel) (size_t depth, const T* packedLhs, const T* packedRhs, T* product, size_t stride, size_t rows, size_t columns);
+    size_t GemmRows;
+    size_t GemmColumns;
+
+    // Matrix-vector products: the dot products of count rows with one vector, and the sum of count rows scaled by one scalar each
+    void (*BatchDotProduct) (size_t size, size_t count, T* products, const T* rows, size_t stride, const T* vector);
+    void (*BatchMulAdd) (size_t size, size_t count, T* dst, const T* rows, size_t stride, const T* scalars);
+
+    // Nearest neighbor search: the dot products of many queries with many vectors, and the indices of the elements below a threshold
+    void (*DotProductTile) (size_t size, size_t queryCount, size_t vectorCount, T* scores, size_t scoreStride,
+                            const T* queries, size_t queryStride, const T* vectors, size_t vectorStride);
+    void (*SelectBelow) (size_t size, T threshold, size_t* count, uint32_t* indices, const T* src);
+
+    // Integral element types only, these are left null in the floating point tables
+    void (*Min) (size_t size, T* dst, const T* lhs, const T* rhs);
+    void (*Max) (size_t size, T* dst, const T* lhs, const T* rhs);
+    void (*And) (size_t size, T* dst, const T* lhs, const T* rhs);
+    void (*Or) (size_t size, T* dst, const T* lhs, const T* rhs);
+    void (*Xor) (size_t size, T* dst, const T* lhs, const T* rhs);
+    void (*AndNot) (size_t size, T* dst, const T* lhs, const T* rhs);
+    void (*ShiftLeft) (size_t size, uint32_t count, T* dst, const T* src);
+    void (*ShiftRight) (size_t size, uint32_t count, T* dst, const T* src);
+    void (*WideSummation) (size_t size, typename WideType<T>::type* sum, const T* src);
+
+    ArchBinding() : StreamingCopy(0), Exp(0), Log(0), Log2(0), Sin(0), Cos(0), Tanh(0), Sigmoid(0), Pow(0),
+                    Rsqrt(0), ApproximateRsqrt(0), RefinedRsqrt(0), GemmKernel(0), GemmRows(0), GemmColumns(0),
+                    BatchDotProduct(0), BatchMulAdd(0), DotProductTile(0), SelectBelow(0),
+                    Min(0), Max(0), And(0), Or(0), Xor(0), AndNot(0), ShiftLeft(0), ShiftRight(0),
+                    WideSummation(0)
+    {
+    }
+
+    ///
+    /// \brief Returns the immutable binding for the most capable instruction set described by caps
+    /// \param caps the processor capabilities to select for
+    /// \return reference to a binding with static storage duration
+    ///
+    static const ArchBinding<T>& Select(const ProcessorCaps& caps);
+
+    ///
+    /// \brief Returns the binding used by all Array<T> objects in this process. It is selected on the first call from
+    /// \link ProcessorCaps::Host( )\endlink unless overridden with \link Override( )\endlink.
+    ///
+    static const ArchBinding<T>& Active()
+    {
+      return *ActiveSlot();
+    }
+
+    ///
+    /// \brief <em>Not for end-use</em>, rebinds every Array<T> in the process to the kernels selected by caps.
+    ///
+    /// This is only provided for diagnostic purposes, e.g., to run the fallback kernels on an AVX2 processor in tests and
+    /// benchmarks. It is not thread-safe with respect to computations running concurrently on other threads.
+    ///
+    /// \param caps the capabilities to select the kernels for
+    ///
+    static void Override(const ProcessorCaps& caps)
+    {
+      ActiveSlot() = &Select(caps);
+    }
+
+  private:
+    static const ArchBinding<T>*& ActiveSlot()
+    {
+      static const ArchBinding<T>* active = &Select(ProcessorCaps::Host());
+      return active;
+    }
+  };
+
+  template<>
+  const ArchBinding<float>& ArchBinding<float>::Select(const ProcessorCaps& caps);
+
+  template<>
+  const ArchBinding<double>& ArchBinding<double>::Select(const ProcessorCaps& caps);
+
+  template<>
+  const ArchBinding<uint32_t>& ArchBinding<uint32_t>::Select(const ProcessorCaps& caps);
+
+  template<>
+  const ArchBinding<int32_t>& ArchBinding<int32_t>::Select(const ProcessorCaps& caps);
+}
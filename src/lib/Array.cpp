@@ -13,524 +13,436 @@
 // limitations under the License.
 
 #include "Array.hpp"
+#include "FallbackInternals.hpp"
+#include "SseInternals.hpp"
 #include "AvxInternals.hpp"
 #include "Avx2Internals.hpp"
 
 namespace khyber
 {
-  /////////////////////////// Programmer API //////////////////////////////////
-
-  template<>
-  Array<float> Array<float>::Add(const Array<float>& addend)
-  {
-    // This ugliness (and the one in AddAcc( ) is for pointer-to-member-function
-    // I know we could use boost::function, and I did, but that is much slower
-    return (this->*AddImpl)(addend);
-  }
-
-  template<>
-  Array<float>& Array<float>::Add(Array<float>& augend,
-                                  const Array<float>& addend)
-  {
-    return (this->*Add2Impl)(augend, addend);
-  }
-
-  template<>
-  Array<float> Array<float>::Sub(const Array<float>& subtrahend)
-  {
-    return (this->*SubImpl)(subtrahend);
-  }
-
-  template<>
-  Array<float>& Array<float>::Sub(Array<float>& minuend,
-                                  const Array<float>& subtrahend)
-  {
-    return (this->*Sub2Impl)(minuend, subtrahend);
-  }
-
-  template<>
-  Array<float> Array<float>::Mul(const Array<float> &multiplier)
-  {
-    return (this->*MulImpl)(multiplier);
-  }
-
-  template<>
-  Array<float>& Array<float>::Mul(Array<float>& multiplier,
-                                  const Array<float>& multiplicand)
-  {
-    return (this->*Mul2Impl)(multiplier, multiplicand);
-  }
-
-  template<>
-  Array<float> Array<float>::ScalarMul(float multiplier)
-  {
-    return (this->*ScalarMulImpl)(multiplier);
-  }
-
-  template<>
-  Array<float>& Array<float>::TransformScalarMul(float multiplier)
-  {
-    return (this->*TransformScalarMulImpl)(multiplier);
-  }
-
-  template<>
-  Array<float> Array<float>::Div(const Array<float> &divisor)
-  {
-    return (this->*DivImpl)(divisor);
-  }
-
-  template<>
-  Array<float>& Array<float>::Div(Array<float>& dividend,
-                                  const Array<float>& divisor)
-  {
-    return (this->*Div2Impl)(dividend, divisor);
-  }
-
-  template<>
-  Array<float> Array<float>::ScalarDiv(float divisor)
-  {
-    return (this->*ScalarDivImpl)(divisor);
-  }
-
-  template<>
-  Array<float>& Array<float>::TransformScalarDiv(float divisor)
-  {
-    return (this->*TransformScalarDivImpl)(divisor);
-  }
-
-  template<>
-  Array<float> Array<float>::Sqrt()
-  {
-    return (this->*SqrtImpl)();
-  }
-
-  template<>
-  Array<float>& Array<float>::Sqrt(Array<float>& src)
-  {
-    return (this->*Sqrt2Impl)(src);
-  }
-
-  template<>
-  Array<float> Array<float>::Square()
-  {
-    return (this->*SquareImpl)();
-  }
-
-  template<>
-  Array<float>& Array<float>::Square(Array<float>& src)
-  {
-    return (this->*Square2Impl)(src);
-  }
-
-  template<>
-  Array<float> Array<float>::Cube()
-  {
-    return (this->*CubeImpl)();
-  }
-
-  template<>
-  Array<float>& Array<float>::Cube(Array<float>& src)
-  {
-    return (this->*Cube2Impl)(src);
-  }
-
-  template<>
-  float Array<float>::DotProduct(const Array<float>& multiplicand) const
-  {
-    return (this->*DotProductImpl)(multiplicand);
-  }
-
-  template<>
-  float Array<float>::Summation() const
-  {
-    return (this->*SummationImpl)();
-  }
-
-  template<>
-  float Array<float>::Distance(const Array<float>& v2) const
-  {
-    return (this->*DistanceImpl)(v2);
-  }
-
-  template<>
-  Array<float> Array<float>::Reciprocate()
-  {
-    return (this->*ReciprocateImpl)();
-  }
-
-  template<>
-  Array<float>& Array<float>::TransformReciprocate()
-  {
-    return (this->*TransformReciprocateImpl)();
+  // Each Build*ArchBinding( ) below fills in a table once, at the first call to ArchBinding<T>::Select( ) for
+  // that element type and instruction set. The arch packages overload their kernels on the element type, the
+  // assignments pick the overload matching the function pointers of ArchBinding<T>. The tables are never
+  // modified afterwards so every Array<T> in the process can share them.
+
+  ////////////////////////// Fallback (serial) binding ////////////////////////
+
+  template<typename T>
+  static ArchBinding<T> BuildFallbackArchBinding()
+  {
+    ArchBinding<T> binding;
+    binding.Add = fallback::InternalAdd<T>;
+    binding.ScalarAdd = fallback::InternalScalarAdd<T>;
+    binding.Sub = fallback::InternalSub<T>;
+    binding.Mul = fallback::InternalMul<T>;
+    binding.Div = fallback::InternalDiv<T>;
+    binding.ScalarMul = fallback::InternalScalarMul<T>;
+    binding.ScalarDiv = fallback::InternalScalarDiv<T>;
+    binding.Sqrt = fallback::InternalSqrt<T>;
+    binding.Square = fallback::InternalSquare<T>;
+    binding.Cube = fallback::InternalCube<T>;
+    binding.Negate = fallback::InternalNegate<T>;
+    binding.Reciprocate = fallback::InternalReciprocate<T>;
+    binding.ApproximateReciprocate = fallback::InternalReciprocate<T>;
+    binding.RefinedReciprocate = fallback::InternalReciprocate<T>;
+    binding.DotProduct = fallback::InternalDotProduct<T>;
+    binding.Summation = fallback::InternalSummation<T>;
+    binding.CompensatedSummation = fallback::InternalCompensatedSummation<T>;
+    binding.CompensatedDotProduct = fallback::InternalCompensatedDotProduct<T>;
+    binding.PrefixSum = fallback::InternalPrefixSum<T>;
+    binding.ExclusivePrefixSum = fallback::InternalExclusivePrefixSum<T>;
+    binding.Distance = fallback::InternalDistance<T>;
+    binding.Minimum = fallback::InternalMinimum<T>;
+    binding.Maximum = fallback::InternalMaximum<T>;
+    binding.MinMaximum = fallback::InternalMinMaximum<T>;
+    binding.ArgMinimum = fallback::InternalArgMinimum<T>;
+    binding.ArgMaximum = fallback::InternalArgMaximum<T>;
+    return binding;
+  }
+
+  template<typename T>
+  static ArchBinding<T> BuildFallbackIntegerArchBinding()
+  {
+    ArchBinding<T> binding = BuildFallbackArchBinding<T>();
+    binding.Min = fallback::InternalMin<T>;
+    binding.Max = fallback::InternalMax<T>;
+    binding.And = fallback::InternalAnd<T>;
+    binding.Or = fallback::InternalOr<T>;
+    binding.Xor = fallback::InternalXor<T>;
+    binding.AndNot = fallback::InternalAndNot<T>;
+    binding.ShiftLeft = fallback::InternalShiftLeft<T>;
+    binding.ShiftRight = fallback::InternalShiftRight<T>;
+    binding.WideSummation = fallback::InternalWideSummation<T, typename WideType<T>::type>;
+    return binding;
+  }
+
+  template<typename T>
+  static ArchBinding<T> BuildFallbackFloatingArchBinding()
+  {
+    ArchBinding<T> binding = BuildFallbackArchBinding<T>();
+    binding.Exp = fallback::InternalExp<T>;
+    binding.Log = fallback::InternalLog<T>;
+    binding.Log2 = fallback::InternalLog2<T>;
+    binding.Sin = fallback::InternalSin<T>;
+    binding.Cos = fallback::InternalCos<T>;
+    binding.Tanh = fallback::InternalTanh<T>;
+    binding.Sigmoid = fallback::InternalSigmoid<T>;
+    binding.Pow = fallback::InternalPow<T>;
+    binding.Rsqrt = fallback::InternalRsqrt<T>;
+    binding.ApproximateRsqrt = fallback::InternalRsqrt<T>;
+    binding.RefinedRsqrt = fallback::InternalRsqrt<T>;
+    binding.GemmKernel = fallback::InternalGemmKernel<T, FALLBACK_GEMM_ROWS, FALLBACK_GEMM_COLUMNS>;
+    binding.GemmRows = FALLBACK_GEMM_ROWS;
+    binding.GemmColumns = FALLBACK_GEMM_COLUMNS;
+    binding.BatchDotProduct = fallback::InternalBatchDotProduct<T>;
+    binding.BatchMulAdd = fallback::InternalBatchMulAdd<T>;
+    binding.DotProductTile = fallback::InternalDotProductTile<T>;
+    binding.SelectBelow = fallback::InternalSelectBelow<T>;
+    return binding;
   }
 
   /////////////////////////////////////////////////////////////////////////////
-  
-
-
-  /////////////////////// AVX implementation dispatchers //////////////////////
-
-  template<>
-  Array<float> Array<float>::AvxAddImpl(const Array<float>& addend)
-  {
-    Array<float> sum(this->_buffer.size());
-    avx::InternalAdd(this->_buffer.size(),
-                     sum._buffer.data(),
-                     this->_buffer.data(),
-                     addend._buffer.data());
-    return std::move(sum);
-  }
-
-  template<>
-  Array<float>& Array<float>::AvxAdd2Impl(Array<float> &augend,
-					  const Array<float> &addend)
-  {
-    avx::InternalAdd(this->_buffer.size(),
-                     this->_buffer.data(),
-                     augend._buffer.data(),
-                     addend._buffer.data());
-    return *this;
-  }
-
-  template<>
-  Array<float> Array<float>::AvxSubImpl(const Array<float> &subtrahend)
-  {
-    Array<float> difference(this->_buffer.size());
-    avx::InternalSub(this->_buffer.size(),
-                     difference._buffer.data(),
-                     this->_buffer.data(),
-                     subtrahend._buffer.data());
-    return std::move(difference);
-  }
-
-  template<>
-  Array<float>& Array<float>::AvxSub2Impl(Array<float>& minuend,
-					  const Array<float>& subtrahend)
-  {
-    avx::InternalSub(this->size(),
-                     this->data(),
-                     minuend.data(),
-                     subtrahend.data());
-    return *this;
-  }
-
-  template<>
-  Array<float> Array<float>::AvxMulImpl(const Array<float> &multiplier)
-  {
-    Array<float> product(this->size());
-    avx::InternalMul(this->size(),
-                     product.data(),
-                     this->data(),
-                     multiplier.data());
-    return std::move(product);
-  }
 
-  template<>
-  Array<float>& Array<float>::AvxMul2Impl(Array<float> &multiplier,
-					  const Array<float> &multiplicand)
-  {
-    avx::InternalMul(this->size(),
-                     this->data(),
-                     multiplier.data(),
-                     multiplicand.data());
-    return *this;
-  }
 
-  template<>
-  Array<float>& Array<float>::AvxTransformScalarMulImpl(float multiplier)
-  {
-    avx::InternalScalarMul(this->size(),
-                           multiplier,
-                           this->data(),
-                           this->data());
-    return *this;
-  }
-
-  template<>
-  Array<float> Array<float>::AvxScalarMulImpl(float multiplier)
-  {
-    Array<float> product(this->size());
-    return std::move(AvxTransformScalarMulImpl(multiplier));
-  }
-
-  template<>
-  Array<float> Array<float>::AvxDivImpl(const Array<float> &divisor)
-  {
-    Array<float> quotient(divisor.size());
-    avx::InternalDiv(this->size(),
-                     quotient.data(),
-                     this->data(),
-                     divisor.data());
-    return std::move(quotient);
-  }
-
-  template<>
-  Array<float>& Array<float>::AvxDiv2Impl(Array<float> &dividend,
-					  const Array<float> &divisor)
-  {
-    avx::InternalDiv(this->size(),
-                     this->data(),
-                     dividend.data(),
-                     divisor.data());
-    return *this;
-  }
-
-  template<>
-  Array<float>& Array<float>::AvxTransformScalarDivImpl(float divisor)
-  {
-    avx::InternalScalarDiv(this->size(),
-                           divisor,
-                           this->data(),
-                           this->data());
-    return *this;
-  }
-
-  template<>
-  Array<float> Array<float>::AvxScalarDivImpl(float divisor)
-  {
-    Array<float> quotient(this->size());
-    return std::move(AvxTransformScalarDivImpl(divisor));
-  }
-
-  template<>
-  Array<float> Array<float>::AvxSqrtImpl()
-  {
-    Array<float> result(this->_buffer.size());
-    avx::InternalSqrt(this->_buffer.size(),
-                      result._buffer.data(),
-                      this->_buffer.data());
-    return std::move(result);
-  }
 
-  template<>
-  Array<float>& Array<float>::AvxSqrt2Impl(Array<float>& src)
-  {
-    avx::InternalSqrt(this->size(),
-                      this->data(),
-                      src.data());
-    return *this;
+  ////////////////////////////////// SSE binding //////////////////////////////
+
+  static ArchBinding<float> BuildSseArchBinding()
+  {
+    ArchBinding<float> binding;
+    binding.Add = sse::InternalAdd;
+    binding.ScalarAdd = sse::InternalScalarAdd;
+    binding.Sub = sse::InternalSub;
+    binding.Mul = sse::InternalMul;
+    binding.Div = sse::InternalDiv;
+    binding.ScalarMul = sse::InternalScalarMul;
+    binding.ScalarDiv = sse::InternalScalarDiv;
+    binding.Sqrt = sse::InternalSqrt;
+    binding.Square = sse::InternalSquare;
+    binding.Cube = sse::InternalCube;
+    binding.Negate = sse::InternalNegate;
+    binding.Reciprocate = sse::InternalReciprocate;
+    binding.ApproximateReciprocate = sse::InternalApproximateReciprocate;
+    binding.RefinedReciprocate = sse::InternalRefinedReciprocate;
+    binding.DotProduct = sse::InternalDotProduct;
+    binding.Summation = sse::InternalSummation;
+    binding.CompensatedSummation = sse::InternalCompensatedSummation;
+    binding.CompensatedDotProduct = sse::InternalCompensatedDotProduct;
+    binding.PrefixSum = sse::InternalPrefixSum;
+    binding.ExclusivePrefixSum = sse::InternalExclusivePrefixSum;
+    binding.Distance = sse::InternalDistance;
+    binding.Minimum = sse::InternalMinimum;
+    binding.Maximum = sse::InternalMaximum;
+    binding.MinMaximum = sse::InternalMinMaximum;
+    binding.ArgMinimum = sse::InternalArgMinimum;
+    binding.ArgMaximum = sse::InternalArgMaximum;
+    binding.Exp = sse::InternalExp;
+    binding.Log = sse::InternalLog;
+    binding.Log2 = sse::InternalLog2;
+    binding.Sin = sse::InternalSin;
+    binding.Cos = sse::InternalCos;
+    binding.Tanh = sse::InternalTanh;
+    binding.Sigmoid = sse::InternalSigmoid;
+    binding.Pow = sse::InternalPow;
+    binding.Rsqrt = sse::InternalRsqrt;
+    binding.ApproximateRsqrt = sse::InternalApproximateRsqrt;
+    binding.RefinedRsqrt = sse::InternalRefinedRsqrt;
+    binding.StreamingCopy = sse::InternalStreamingCopy;
+    binding.GemmKernel = fallback::InternalGemmKernel<float, FALLBACK_GEMM_ROWS, FALLBACK_GEMM_COLUMNS>;
+    binding.GemmRows = FALLBACK_GEMM_ROWS;
+    binding.GemmColumns = FALLBACK_GEMM_COLUMNS;
+    binding.BatchDotProduct = fallback::InternalBatchDotProduct<float>;
+    binding.BatchMulAdd = fallback::InternalBatchMulAdd<float>;
+    binding.DotProductTile = fallback::InternalDotProductTile<float>;
+    binding.SelectBelow = fallback::InternalSelectBelow<float>;
+    return binding;
   }
 
-  template<>
-  Array<float> Array<float>::AvxSquareImpl()
-  {
-    Array<float> result(this->size());
-    avx::InternalSquare(this->size(),
-                        result.data(),
-                        this->data());
-    return std::move(result);
-  }
+  /////////////////////////////////////////////////////////////////////////////
 
-  template<>
-  Array<float>& Array<float>::AvxSquare2Impl(Array<float>& src)
-  {
-    avx::InternalSquare(this->size(),
-                        this->data(),
-                        this->data());
-    return *this;
-  }
 
-  template<>
-  Array<float> Array<float>::AvxCubeImpl()
-  {
-    Array<float> result(this->size());
-    avx::InternalCube(this->size(),
-                      result.data(),
-                      this->data());
-    return std::move(result);
-  }
 
-  template<>
-  Array<float>& Array<float>::AvxCube2Impl(Array<float>& src)
-  {
-    avx::InternalCube(this->size(),
-                      this->data(),
-                      this->data());
-    return *this;
-  }
+  ////////////////////////////////// AVX binding //////////////////////////////
 
-  template<>
-  float Array<float>::AvxDotProductImpl(const Array<float> &multiplicand) const
+  // The AVX transcendental kernels are single-precision only, the double-precision tables keep the serial ones
+  static void BindAvxTranscendentals(ArchBinding<float>& binding)
   {
-    float dotProduct = 0;
-    avx::InternalDotProduct(this->size(),
-                            &dotProduct,
-                            this->data(),
-                            multiplicand.data());
-    return dotProduct;
+    binding.Exp = avx::InternalExp;
+    binding.Log = avx::InternalLog;
+    binding.Log2 = avx::InternalLog2;
+    binding.Sin = avx::InternalSin;
+    binding.Cos = avx::InternalCos;
+    binding.Tanh = avx::InternalTanh;
+    binding.Sigmoid = avx::InternalSigmoid;
+    binding.Pow = avx::InternalPow;
   }
 
-  template<>
-  float Array<float>::AvxSummationImpl() const
+  static void BindAvxTranscendentals(ArchBinding<double>&)
   {
-    float sigma = 0;
-    avx::InternalSummation(this->size(),
-                           &sigma,
-                           this->data());
-    return sigma;
   }
 
-  template<>
-  Array<float> Array<float>::AvxNegateImpl()
+  // Only single-precision has SIMD matrix product and search kernels, the double-precision tables keep the serial ones. AVX2 adds nothing
+  // to the floating point multiply-adds, the AVX2 tables use these kernels as well.
+  static void BindAvxMatrixKernels(ArchBinding<float>& binding, bool fma)
   {
-    Array<float> negated(this->size());
-    avx::InternalNegate(this->size(),
-                        negated.data(),
-                        this->data());
-    return std::move(negated);
+    binding.GemmKernel = fma ? avx::InternalGemmKernelFma : avx::InternalGemmKernel;
+    binding.GemmRows = AVX_GEMM_ROWS;
+    binding.GemmColumns = AVX_GEMM_COLUMNS;
+    binding.BatchDotProduct = fma ? avx::InternalBatchDotProductFma : avx::InternalBatchDotProduct;
+    binding.BatchMulAdd = fma ? avx::InternalBatchMulAddFma : avx::InternalBatchMulAdd;
+    binding.DotProductTile = fma ? avx::InternalDotProductTileFma : avx::InternalDotProductTile;
+    binding.SelectBelow = avx::InternalSelectBelow;
   }
 
-  template<>
-  Array<float>& Array<float>::AvxNegate2Impl(Array<float>& src)
+  static void BindAvxMatrixKernels(ArchBinding<double>&, bool)
   {
-    avx::InternalNegate(this->size(),
-                        this->data(),
-                        src.data());
-    return *this;
   }
 
-  template<>
-  float Array<float>::AvxDistanceImpl(const Array<float>& v2) const
+  // Double-precision has no reciprocal estimates before AVX-512, every precision mode of the double-precision tables divides exactly
+  static void BindAvxReciprocals(ArchBinding<float>& binding)
   {
-    float distance = 0.0;
-    avx::InternalDistance(this->size(),
-                          &distance,
-                          this->data(),
-                          v2.data());
-    return distance;
+    binding.ApproximateReciprocate = avx::InternalApproximateReciprocate;
+    binding.RefinedReciprocate = avx::InternalRefinedReciprocate;
+    binding.ApproximateRsqrt = avx::InternalApproximateRsqrt;
+    binding.RefinedRsqrt = avx::InternalRefinedRsqrt;
   }
 
-  template<>
-  Array<float> Array<float>::AvxReciprocateImpl()
+  static void BindAvxReciprocals(ArchBinding<double>& binding)
   {
-    Array<float> reciprocal(this->size());
-    return std::move(reciprocal.TransformReciprocate());
+    binding.ApproximateReciprocate = avx::InternalReciprocate;
+    binding.RefinedReciprocate = avx::InternalReciprocate;
+    binding.ApproximateRsqrt = avx::InternalRsqrt;
+    binding.RefinedRsqrt = avx::InternalRsqrt;
   }
 
-  template<>
-  Array<float>& Array<float>::AvxTransformReciprocateImpl()
+  template<typename T>
+  static ArchBinding<T> BuildAvxArchBinding(bool fma)
   {
-    avx::InternalReciprocate(this->size(),
-                             this->data(),
-                             this->data());
-    return *this;
+    ArchBinding<T> binding = BuildFallbackFloatingArchBinding<T>();
+    binding.Add = avx::InternalAdd;
+    binding.ScalarAdd = avx::InternalScalarAdd;
+    binding.Sub = avx::InternalSub;
+    binding.Mul = avx::InternalMul;
+    binding.Div = avx::InternalDiv;
+    binding.ScalarMul = avx::InternalScalarMul;
+    binding.ScalarDiv = avx::InternalScalarDiv;
+    binding.Sqrt = avx::InternalSqrt;
+    binding.Square = avx::InternalSquare;
+    binding.Cube = avx::InternalCube;
+    binding.Negate = avx::InternalNegate;
+    binding.Reciprocate = avx::InternalReciprocate;
+    binding.Rsqrt = avx::InternalRsqrt;
+    binding.DotProduct = avx::InternalDotProduct;
+    binding.Summation = avx::InternalSummation;
+    binding.CompensatedSummation = avx::InternalCompensatedSummation;
+    binding.CompensatedDotProduct = avx::InternalCompensatedDotProduct;
+    binding.PrefixSum = avx::InternalPrefixSum;
+    binding.ExclusivePrefixSum = avx::InternalExclusivePrefixSum;
+    binding.Distance = avx::InternalDistance;
+    binding.Minimum = avx::InternalMinimum;
+    binding.Maximum = avx::InternalMaximum;
+    binding.MinMaximum = avx::InternalMinMaximum;
+    binding.ArgMinimum = avx::InternalArgMinimum;
+    binding.ArgMaximum = avx::InternalArgMaximum;
+    binding.StreamingCopy = avx::InternalStreamingCopy;
+    BindAvxTranscendentals(binding);
+    BindAvxReciprocals(binding);
+    BindAvxMatrixKernels(binding, fma);
+    if ( fma ) {
+      binding.DotProduct = avx::InternalDotProductFma;
+      binding.Distance = avx::InternalDistanceFma;
+    }
+    return binding;
   }
 
   /////////////////////////////////////////////////////////////////////////////
 
 
 
-  ////////////////////// AVX2 implementation dispatchers //////////////////////
-
-  template<>
-  Array<float> Array<float>::Avx2AddImpl(const Array<float>& addend)
-  {
-    Array<float> sum(this->_buffer.size());
-    avx2::InternalAdd(this->_buffer.size(),
-		      sum._buffer.data(),
-		      this->_buffer.data(),
-		      addend._buffer.data());
-    return std::move(sum);
-  }
-
-  template<>
-  Array<float>& Array<float>::Avx2Add2Impl(Array<float> &augend,
-					   const Array<float> &addend)
-  {
-    avx2::InternalAdd(this->_buffer.size(),
-		      this->_buffer.data(),
-		      augend._buffer.data(),
-		      addend._buffer.data());
-    return *this;
-  }
-  
-  template<>
-  Array<float> Array<float>::Avx2NegateImpl()
-  {
-    Array<float> negated(this->size());
-    avx2::InternalNegate(this->size(),
-                         negated.data(),
-                         this->data());
-    return std::move(negated);
-  }
-
-  template<>
-  Array<float>& Array<float>::Avx2Negate2Impl(Array<float>& src)
-  {
-    avx2::InternalNegate(this->size(),
-                         this->data(),
-                         src.data());
-    return *this;
+  ///////////////////////////////// AVX2 binding //////////////////////////////
+
+  // The AVX2 transcendental kernels are single-precision only, the double-precision tables keep the serial ones
+  static void BindAvx2Transcendentals(ArchBinding<float>& binding)
+  {
+    binding.Exp = avx2::InternalExp;
+    binding.Log = avx2::InternalLog;
+    binding.Log2 = avx2::InternalLog2;
+    binding.Sin = avx2::InternalSin;
+    binding.Cos = avx2::InternalCos;
+    binding.Tanh = avx2::InternalTanh;
+    binding.Sigmoid = avx2::InternalSigmoid;
+    binding.Pow = avx2::InternalPow;
+  }
+
+  static void BindAvx2Transcendentals(ArchBinding<double>&)
+  {
+  }
+
+  // Double-precision has no reciprocal estimates before AVX-512, every precision mode of the double-precision tables divides exactly
+  static void BindAvx2Reciprocals(ArchBinding<float>& binding)
+  {
+    binding.ApproximateReciprocate = avx2::InternalApproximateReciprocate;
+    binding.RefinedReciprocate = avx2::InternalRefinedReciprocate;
+    binding.ApproximateRsqrt = avx2::InternalApproximateRsqrt;
+    binding.RefinedRsqrt = avx2::InternalRefinedRsqrt;
+  }
+
+  static void BindAvx2Reciprocals(ArchBinding<double>& binding)
+  {
+    binding.ApproximateReciprocate = avx2::InternalReciprocate;
+    binding.RefinedReciprocate = avx2::InternalReciprocate;
+    binding.ApproximateRsqrt = avx2::InternalRsqrt;
+    binding.RefinedRsqrt = avx2::InternalRsqrt;
+  }
+
+  template<typename T>
+  static ArchBinding<T> BuildAvx2ArchBinding(bool fma)
+  {
+    ArchBinding<T> binding = BuildFallbackFloatingArchBinding<T>();
+    binding.Add = avx2::InternalAdd;
+    binding.ScalarAdd = avx2::InternalScalarAdd;
+    binding.Sub = avx2::InternalSub;
+    binding.Mul = avx2::InternalMul;
+    binding.Div = avx2::InternalDiv;
+    binding.ScalarMul = avx2::InternalScalarMul;
+    binding.ScalarDiv = avx2::InternalScalarDiv;
+    binding.Sqrt = avx2::InternalSqrt;
+    binding.Square = avx2::InternalSquare;
+    binding.Cube = avx2::InternalCube;
+    binding.Negate = avx2::InternalNegate;
+    binding.Reciprocate = avx2::InternalReciprocate;
+    binding.Rsqrt = avx2::InternalRsqrt;
+    binding.DotProduct = avx2::InternalDotProduct;
+    binding.Summation = avx2::InternalSummation;
+    binding.CompensatedSummation = avx2::InternalCompensatedSummation;
+    binding.CompensatedDotProduct = avx2::InternalCompensatedDotProduct;
+    binding.PrefixSum = avx2::InternalPrefixSum;
+    binding.ExclusivePrefixSum = avx2::InternalExclusivePrefixSum;
+    binding.Distance = avx2::InternalDistance;
+    binding.Minimum = avx2::InternalMinimum;
+    binding.Maximum = avx2::InternalMaximum;
+    binding.MinMaximum = avx2::InternalMinMaximum;
+    binding.ArgMinimum = avx2::InternalArgMinimum;
+    binding.ArgMaximum = avx2::InternalArgMaximum;
+    binding.StreamingCopy = avx::InternalStreamingCopy;
+    BindAvx2Transcendentals(binding);
+    BindAvx2Reciprocals(binding);
+    BindAvxMatrixKernels(binding, fma);
+    if ( fma ) {
+      binding.DotProduct = avx2::InternalDotProductFma;
+      binding.Distance = avx2::InternalDistanceFma;
+    }
+    return binding;
+  }
+
+  template<typename T>
+  static ArchBinding<T> BuildAvx2IntegerArchBinding()
+  {
+    // AVX2 has no integer division or square root, those stay on the serial kernels
+    ArchBinding<T> binding = BuildFallbackIntegerArchBinding<T>();
+    binding.Add = avx2::InternalAdd;
+    binding.ScalarAdd = avx2::InternalScalarAdd;
+    binding.Sub = avx2::InternalSub;
+    binding.Mul = avx2::InternalMul;
+    binding.ScalarMul = avx2::InternalScalarMul;
+    binding.Square = avx2::InternalSquare;
+    binding.Cube = avx2::InternalCube;
+    binding.Negate = avx2::InternalNegate;
+    binding.DotProduct = avx2::InternalDotProduct;
+    binding.Summation = avx2::InternalSummation;
+    binding.PrefixSum = avx2::InternalPrefixSum;
+    binding.ExclusivePrefixSum = avx2::InternalExclusivePrefixSum;
+    binding.Min = avx2::InternalMin;
+    binding.Max = avx2::InternalMax;
+    binding.And = avx2::InternalAnd;
+    binding.Or = avx2::InternalOr;
+    binding.Xor = avx2::InternalXor;
+    binding.AndNot = avx2::InternalAndNot;
+    binding.ShiftLeft = avx2::InternalShiftLeft;
+    binding.ShiftRight = avx2::InternalShiftRight;
+    binding.WideSummation = avx2::InternalWideSummation;
+    binding.Minimum = avx2::InternalMinimum;
+    binding.Maximum = avx2::InternalMaximum;
+    binding.MinMaximum = avx2::InternalMinMaximum;
+    binding.ArgMinimum = avx2::InternalArgMinimum;
+    binding.ArgMaximum = avx2::InternalArgMaximum;
+    binding.StreamingCopy = avx::InternalStreamingCopy;
+    return binding;
   }
 
   /////////////////////////////////////////////////////////////////////////////
 
   template<>
-  void Array<float>::BuildFallbackArchBinding()
-  {
-    AddImpl = &Array<float>::FallbackAddImpl;
-    Add2Impl = &Array<float>::FallbackAdd2Impl;
-    SubImpl = &Array<float>::FallbackSubImpl;
-    Sub2Impl = &Array<float>::FallbackSub2Impl;
-    MulImpl = &Array<float>::FallbackMulImpl;
-    Mul2Impl = &Array<float>::FallbackMul2Impl;
-    DivImpl = &Array<float>::FallbackDivImpl;
-    Div2Impl = &Array<float>::FallbackDiv2Impl;
-    SqrtImpl = &Array<float>::FallbackSqrtImpl;
-    Sqrt2Impl = &Array<float>::FallbackSqrt2Impl;
-    SquareImpl = &Array<float>::FallbackSquareImpl;
-    Square2Impl = &Array<float>::FallbackSquare2Impl;
-    CubeImpl = &Array<float>::FallbackCubeImpl;
-    Cube2Impl = &Array<float>::FallbackCube2Impl;
-    DotProductImpl = &Array<float>::FallbackDotProductImpl;
-    SummationImpl = &Array<float>::FallbackSummationImpl;
-    NegateImpl = &Array<float>::FallbackNegateImpl;
-    Negate2Impl = &Array<float>::FallbackNegate2Impl;
-    DistanceImpl = &Array<float>::FallbackDistanceImpl;
+  const ArchBinding<float>& ArchBinding<float>::Select(const ProcessorCaps& caps)
+  {
+    // AVX2 processors also report AVX, so the most capable instruction set has to be checked first. FMA is
+    // a separate CPUID flag, each instruction set has a table with and one without the FMA kernels.
+    if ( caps.IsAvx2() && caps.IsFma() ) {
+      static const ArchBinding<float> avx2FmaBinding = BuildAvx2ArchBinding<float>(true);
+      return avx2FmaBinding;
+    } else if ( caps.IsAvx2() ) {
+      static const ArchBinding<float> avx2Binding = BuildAvx2ArchBinding<float>(false);
+      return avx2Binding;
+    } else if ( caps.IsAvx() && caps.IsFma() ) {
+      static const ArchBinding<float> avxFmaBinding = BuildAvxArchBinding<float>(true);
+      return avxFmaBinding;
+    } else if ( caps.IsAvx() ) {
+      static const ArchBinding<float> avxBinding = BuildAvxArchBinding<float>(false);
+      return avxBinding;
+    } else if ( caps.IsSse2() && caps.IsSse4_1() ) {
+      // arch/sse is compiled with -msse4.1, SSE2-only processors stay on the fallback kernels
+      static const ArchBinding<float> sseBinding = BuildSseArchBinding();
+      return sseBinding;
+    } else {
+      static const ArchBinding<float> fallbackBinding = BuildFallbackFloatingArchBinding<float>();
+      return fallbackBinding;
+    }
   }
 
   template<>
-  void Array<float>::BuildAvxArchBinding()
+  const ArchBinding<double>& ArchBinding<double>::Select(const ProcessorCaps& caps)
   {
-    AddImpl = &Array<float>::AvxAddImpl;
-    Add2Impl = &Array<float>::AvxAdd2Impl;
-    SubImpl = &Array<float>::AvxSubImpl;
-    Sub2Impl = &Array<float>::AvxSub2Impl;
-    MulImpl = &Array<float>::AvxMulImpl;
-    Mul2Impl = &Array<float>::AvxMul2Impl;
-    DivImpl = &Array<float>::AvxDivImpl;
-    Div2Impl = &Array<float>::AvxDiv2Impl;
-    SqrtImpl = &Array<float>::AvxSqrtImpl;
-    Sqrt2Impl = &Array<float>::AvxSqrt2Impl;
-    SquareImpl = &Array<float>::AvxSquareImpl;
-    Square2Impl = &Array<float>::AvxSquare2Impl;
-    CubeImpl = &Array<float>::AvxCubeImpl;
-    Cube2Impl = &Array<float>::AvxCube2Impl;
-    DotProductImpl = &Array<float>::AvxDotProductImpl;
-    SummationImpl = &Array<float>::AvxSummationImpl;
-    NegateImpl = &Array<float>::AvxNegateImpl;
-    Negate2Impl = &Array<float>::AvxNegate2Impl;
-    DistanceImpl = &Array<float>::AvxDistanceImpl;
+    // There are no SSE kernels for double-precision, processors without AVX use the fallback kernels
+    if ( caps.IsAvx2() && caps.IsFma() ) {
+      static const ArchBinding<double> avx2FmaBinding = BuildAvx2ArchBinding<double>(true);
+      return avx2FmaBinding;
+    } else if ( caps.IsAvx2() ) {
+      static const ArchBinding<double> avx2Binding = BuildAvx2ArchBinding<double>(false);
+      return avx2Binding;
+    } else if ( caps.IsAvx() && caps.IsFma() ) {
+      static const ArchBinding<double> avxFmaBinding = BuildAvxArchBinding<double>(true);
+      return avxFmaBinding;
+    } else if ( caps.IsAvx() ) {
+      static const ArchBinding<double> avxBinding = BuildAvxArchBinding<double>(false);
+      return avxBinding;
+    } else {
+      static const ArchBinding<double> fallbackBinding = BuildFallbackFloatingArchBinding<double>();
+      return fallbackBinding;
+    }
   }
 
   template<>
-  void Array<float>::BuildAvx2ArchBinding()
+  const ArchBinding<uint32_t>& ArchBinding<uint32_t>::Select(const ProcessorCaps& caps)
   {
-    AddImpl = &Array<float>::Avx2AddImpl;
-    Add2Impl = &Array<float>::Avx2Add2Impl;
-    NegateImpl = &Array<float>::Avx2NegateImpl;
-    Negate2Impl = &Array<float>::Avx2Negate2Impl;
+    // AVX only has 256-bit floating point instructions, the integer kernels need AVX2
+    if ( caps.IsAvx2() ) {
+      static const ArchBinding<uint32_t> avx2Binding = BuildAvx2IntegerArchBinding<uint32_t>();
+      return avx2Binding;
+    } else {
+      static const ArchBinding<uint32_t> fallbackBinding = BuildFallbackIntegerArchBinding<uint32_t>();
+      return fallbackBinding;
+    }
   }
 
   template<>
-  void Array<float>::BuildArchBinding()
+  const ArchBinding<int32_t>& ArchBinding<int32_t>::Select(const ProcessorCaps& caps)
   {
-    if ( _procCaps.IsAvx() ) {
-      BuildAvxArchBinding();
-    } else if ( _procCaps.IsAvx2() ) {
-      BuildAvx2ArchBinding();
+    if ( caps.IsAvx2() ) {
+      static const ArchBinding<int32_t> avx2Binding = BuildAvx2IntegerArchBinding<int32_t>();
+      return avx2Binding;
     } else {
-      BuildFallbackArchBinding();
+      static const ArchBinding<int32_t> fallbackBinding = BuildFallbackIntegerArchBinding<int32_t>();
+      return fallbackBinding;
     }
   }
 }
@@ -0,0 +1,239 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ArrayFile.hpp"
+
+namespace khyber
+{
+  static const char ARRAY_FILE_MAGIC[8] = { 'K', 'H', 'Y', 'B', 'E', 'R', 'A', '\0' };
+
+  static const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+  static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+  static const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+
+  // write( ) transfers at most about 2GB per call on Linux
+  static const size_t MAX_WRITE_BYTES = 1 << 30;
+
+  static inline uint64_t Rotl(uint64_t x, int bits)
+  {
+    return (x << bits) | (x >> (64 - bits));
+  }
+
+  static inline uint64_t Round(uint64_t lane, uint64_t word)
+  {
+    return Rotl(lane + word * PRIME2, 31) * PRIME1;
+  }
+
+  static inline uint64_t LoadWord(const uint8_t* bytes)
+  {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+    return word;
+  }
+
+  uint64_t ArrayFileChecksum(const void* data, size_t bytes)
+  {
+    const uint8_t* src = (const uint8_t*)data;
+    uint64_t lane0 = PRIME1 + PRIME2;
+    uint64_t lane1 = PRIME2;
+    uint64_t lane2 = 0;
+    uint64_t lane3 = 0 - PRIME1;
+    size_t i = 0;
+    for ( ; i + 32 <= bytes; i += 32 ) {
+      lane0 = Round(lane0, LoadWord(src + i));
+      lane1 = Round(lane1, LoadWord(src + i + 8));
+      lane2 = Round(lane2, LoadWord(src + i + 16));
+      lane3 = Round(lane3, LoadWord(src + i + 24));
+    }
+    uint64_t hash = Rotl(lane0, 1) + Rotl(lane1, 7) + Rotl(lane2, 12) + Rotl(lane3, 18) + bytes;
+    for ( ; i + 8 <= bytes; i += 8 ) {
+      hash = Rotl(hash ^ Round(0, LoadWord(src + i)), 27) * PRIME1 + PRIME3;
+    }
+    for ( ; i < bytes; ++i ) {
+      hash = Rotl(hash ^ (src[i] * PRIME3), 11) * PRIME1;
+    }
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    return hash ^ (hash >> 32);
+  }
+
+  static std::system_error SystemError(const char* what, const std::string& path)
+  {
+    return std::system_error(errno, std::generic_category(), std::string("khyber: ") + what + " " + path);
+  }
+
+  static void WriteAll(int fd, const void* data, size_t bytes, const std::string& path)
+  {
+    const char* src = (const char*)data;
+    while ( bytes > 0 ) {
+      ssize_t written = write(fd, src, bytes < MAX_WRITE_BYTES ? bytes : MAX_WRITE_BYTES);
+      if ( written < 0 ) {
+        if ( errno == EINTR ) {
+          continue;
+        }
+        throw SystemError("cannot write", path);
+      }
+      src += written;
+      bytes -= written;
+    }
+  }
+
+  ///
+  /// \brief Flushes the directory entry of path to disk, so the rename that created it survives a crash. Best effort, some file
+  /// systems cannot sync a directory and the file itself is already on disk.
+  ///
+  static void SyncDirectory(const std::string& path)
+  {
+    size_t slash = path.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if ( fd >= 0 ) {
+      fsync(fd);
+      close(fd);
+    }
+  }
+
+  void SaveArrayFile(const std::string& path, uint32_t elementType, uint32_t elementBytes, const void* data, size_t length)
+  {
+    ArrayFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARRAY_FILE_MAGIC, sizeof(header.magic));
+    header.version = ARRAY_FILE_VERSION;
+    header.elementType = elementType;
+    header.elementBytes = elementBytes;
+    header.alignment = ARRAY_FILE_ALIGNMENT;
+    header.length = length;
+    header.payloadOffset = sizeof(ArrayFileHeader);
+    header.checksum = ArrayFileChecksum(data, length * elementBytes);
+
+    // A unique temporary name, so concurrent saves to the same path never write into each other's file
+    std::string temporaryPath = path + ".XXXXXX";
+    int fd = mkstemp(&temporaryPath[0]);
+    if ( fd < 0 ) {
+      throw SystemError("cannot create", temporaryPath);
+    }
+    try {
+      if ( fchmod(fd, 0644) != 0 ) {
+        throw SystemError("cannot set the permissions of", temporaryPath);
+      }
+      WriteAll(fd, &header, sizeof(header), temporaryPath);
+      WriteAll(fd, data, length * elementBytes, temporaryPath);
+      // The contents must be on disk before the rename makes them the file at path, or a crash could leave it empty
+      if ( fsync(fd) != 0 ) {
+        throw SystemError("cannot write", temporaryPath);
+      }
+    } catch ( ... ) {
+      close(fd);
+      unlink(temporaryPath.c_str());
+      throw;
+    }
+    if ( close(fd) != 0 ) {
+      std::system_error error = SystemError("cannot write", temporaryPath);
+      unlink(temporaryPath.c_str());
+      throw error;
+    }
+    if ( rename(temporaryPath.c_str(), path.c_str()) != 0 ) {
+      std::system_error error = SystemError("cannot rename to", path);
+      unlink(temporaryPath.c_str());
+      throw error;
+    }
+    SyncDirectory(path);
+  }
+
+  static void CheckHeader(const ArrayFileHeader& header, size_t fileBytes, uint32_t elementType, uint32_t elementBytes,
+                          const std::string& path)
+  {
+    const char* problem = 0;
+    if ( memcmp(header.magic, ARRAY_FILE_MAGIC, sizeof(header.magic)) != 0 ) {
+      problem = "is not an array file";
+    } else if ( header.version != ARRAY_FILE_VERSION ) {
+      problem = "has an unsupported version";
+    } else if ( header.elementType != elementType || header.elementBytes != elementBytes ) {
+      problem = "holds a different element type";
+    } else if ( header.alignment == 0 || (header.alignment & (header.alignment - 1)) != 0 ||
+                header.payloadOffset < sizeof(ArrayFileHeader) || header.payloadOffset % header.alignment != 0 ) {
+      problem = "has a misaligned payload";
+    } else if ( header.payloadOffset > fileBytes || header.length > (fileBytes - header.payloadOffset) / elementBytes ) {
+      problem = "is truncated";
+    }
+    if ( problem != 0 ) {
+      throw std::runtime_error("khyber: " + path + " " + problem);
+    }
+  }
+
+  ArrayFileMapping MapArrayFile(const std::string& path, uint32_t elementType, uint32_t elementBytes, bool copyOnWrite, bool verifyChecksum)
+  {
+    int fd = open(path.c_str(), O_RDONLY);
+    if ( fd < 0 ) {
+      throw SystemError("cannot open", path);
+    }
+    struct stat status;
+    if ( fstat(fd, &status) != 0 ) {
+      std::system_error error = SystemError("cannot stat", path);
+      close(fd);
+      throw error;
+    }
+    size_t fileBytes = status.st_size;
+    if ( fileBytes < sizeof(ArrayFileHeader) ) {
+      close(fd);
+      throw std::runtime_error("khyber: " + path + " is not an array file");
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    int protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* address = mmap(0, fileBytes, protection, MAP_PRIVATE, fd, 0);
+    if ( address == MAP_FAILED ) {
+      std::system_error error = SystemError("cannot map", path);
+      close(fd);
+      throw error;
+    }
+    close(fd);
+
+    ArrayFileMapping mapping;
+    mapping.address = address;
+    mapping.bytes = fileBytes;
+    try {
+      const ArrayFileHeader& header = *(const ArrayFileHeader*)address;
+      CheckHeader(header, fileBytes, elementType, elementBytes, path);
+      mapping.payload = (char*)address + header.payloadOffset;
+      mapping.length = header.length;
+      if ( verifyChecksum && ArrayFileChecksum(mapping.payload, mapping.length * elementBytes) != header.checksum ) {
+        throw std::runtime_error("khyber: " + path + " fails its checksum");
+      }
+    } catch ( ... ) {
+      munmap(address, fileBytes);
+      throw;
+    }
+    return mapping;
+  }
+
+  void UnmapArrayFile(const ArrayFileMapping& mapping)
+  {
+    if ( mapping.address != 0 ) {
+      munmap(mapping.address, mapping.bytes);
+    }
+  }
+}
@@ -0,0 +1,133 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Version written by SaveArrayFile( ), files of any other version are rejected
+#define ARRAY_FILE_VERSION 1
+
+// Alignment of the payload within the file, and therefore in memory once the file is mapped at a page boundary
+#define ARRAY_FILE_ALIGNMENT 64
+
+namespace khyber
+{
+  ///
+  /// \brief Element type codes of the array file format
+  ///
+  enum ArrayFileElementType
+  {
+    AFT_FLOAT32 = 1,
+    AFT_FLOAT64 = 2,
+    AFT_UINT32 = 3,
+    AFT_INT32 = 4
+  };
+
+  ///
+  /// \brief Maps an element type to its \link ArrayFileElementType\endlink code
+  ///
+  template<typename T>
+  struct ArrayFileElement
+  {
+  };
+
+  template<>
+  struct ArrayFileElement<float>
+  {
+    static const uint32_t type = AFT_FLOAT32;
+  };
+
+  template<>
+  struct ArrayFileElement<double>
+  {
+    static const uint32_t type = AFT_FLOAT64;
+  };
+
+  template<>
+  struct ArrayFileElement<uint32_t>
+  {
+    static const uint32_t type = AFT_UINT32;
+  };
+
+  template<>
+  struct ArrayFileElement<int32_t>
+  {
+    static const uint32_t type = AFT_INT32;
+  };
+
+  ///
+  /// \brief The 64 byte header at the start of an array file, followed by the payload of length elements at payloadOffset
+  /// \details Every field is little-endian, as is the payload, which holds the elements exactly as they are in memory. The payload
+  /// starts at a multiple of alignment, so a file mapped at a page boundary can be handed to the kernels without a copy. checksum
+  /// is \link ArrayFileChecksum( )\endlink of the payload.
+  ///
+  struct ArrayFileHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t elementType;
+    uint32_t elementBytes;
+    uint32_t alignment;
+    uint64_t length;
+    uint64_t payloadOffset;
+    uint64_t checksum;
+    uint8_t reserved[16];
+  };
+
+  static_assert(sizeof(ArrayFileHeader) == 64, "ArrayFileHeader must be 64 bytes");
+
+  ///
+  /// \brief A mapped array file, as returned by \link MapArrayFile( )\endlink
+  ///
+  struct ArrayFileMapping
+  {
+    void* address;
+    size_t bytes;
+    void* payload;
+    size_t length;
+  };
+
+  ///
+  /// \brief Returns the 64-bit checksum of bytes bytes at data
+  /// \details Four independent lanes of 64-bit multiply-rotate rounds over the 8-byte words, so the checksum runs at memory
+  /// bandwidth rather than at the latency of a single dependency chain. It detects truncation and corruption, it is not cryptographic.
+  ///
+  uint64_t ArrayFileChecksum(const void* data, size_t bytes);
+
+  ///
+  /// \brief Writes length elements at data to the array file at path, replacing it
+  /// \details The file is written under a unique temporary name next to path, flushed to disk and renamed over it, so a reader
+  /// never maps a partially written file, even when several threads save to the same path or the machine crashes. Throws
+  /// std::system_error if the file cannot be written.
+  ///
+  void SaveArrayFile(const std::string& path, uint32_t elementType, uint32_t elementBytes, const void* data, size_t length);
+
+  ///
+  /// \brief Maps the array file at path into memory
+  /// \details The mapping is read-only, or private and writable when copyOnWrite is true: writes then go to private copies of the
+  /// touched pages and never reach the file. Verifying the checksum reads the whole payload, without it the pages are only read
+  /// when they are first accessed. Throws std::system_error if the file cannot be opened or mapped, and std::runtime_error if it
+  /// is not an array file of elementType, is truncated or fails the checksum.
+  /// \return the mapping, to be released with \link UnmapArrayFile( )\endlink
+  ///
+  ArrayFileMapping MapArrayFile(const std::string& path, uint32_t elementType, uint32_t elementBytes, bool copyOnWrite, bool verifyChecksum);
+
+  ///
+  /// \brief Releases a mapping returned by \link MapArrayFile( )\endlink
+  ///
+  void UnmapArrayFile(const ArrayFileMapping& mapping);
+}
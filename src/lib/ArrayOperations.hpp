@@ -0,0 +1,1017 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include "ArchBinding.hpp"
+#include "ArrayFile.hpp"
+#include "Parallel.hpp"
+
+namespace khyber
+{
+  template<typename T>
+  class Array;
+
+  template<typename E>
+  class ArrayView;
+
+  ///
+  /// \brief The compute operations shared by \link Array<T>\endlink and \link ArrayView<E>\endlink
+  /// \details Derived provides size( ) and data( ), E is its element type, const for read-only views. Operations returning a new
+  /// array allocate an Array<T>, the others work in the memory of Derived and are rejected at compile time when E is const. Every
+  /// array operand is taken as an ArrayView<const T>, to which an Array<T> and any ArrayView of the same element type convert, so
+  /// arrays and views can be mixed freely. The kernels accept any alignment of the operands.
+  ///
+  template<typename Derived, typename E>
+  class ArrayOperations
+  {
+  public:
+    typedef typename std::remove_const<E>::type T;
+
+    ///
+    /// \brief Add contents of 'this' and addend arrays into a new array and return it
+    /// \param addend
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Add(ArrayView<const T> addend) const
+    {
+      Array<T> sum = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Add, Self().size(), sum.data(), Self().data(), addend.data());
+      return sum;
+    }
+
+    ///
+    /// \brief Add contents of augend and addend arrays into 'this' and return it. The object whose Add( ) is called can
+    /// also be passed as augend for a cumulative addition, i.e., a.Add(a, b) to express a = a + b
+    /// \param augend first component for addition, it can also be 'this'
+    /// \param addend second component for addition
+    /// \return 'this'
+    ///
+    Derived& Add(ArrayView<const T> augend,
+                 ArrayView<const T> addend)
+    {
+      ParallelMap(Binding().Add, Self().size(), MutableData(), augend.data(), addend.data());
+      return Self();
+    }
+    
+    ///
+    /// \brief Sub subtract the contents of subtrahend from 'this' into a new array and return it
+    /// \param subtrahend
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Sub(ArrayView<const T> subtrahend) const
+    {
+      Array<T> difference = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Sub, Self().size(), difference.data(), Self().data(), subtrahend.data());
+      return difference;
+    }
+
+    ///
+    /// \brief Sub subtract subtrahend from minuend into 'this' and return it. The object whose Sub( ) is called can also be
+    /// passed as minuend for a cumulative subtraction, i.e., a.Sub(a, b) to express a = a - b
+    /// \param minuend first component for subtraction, it can also be 'this'
+    /// \param subtrahend second component for subtraction
+    /// \return 'this'
+    ///
+    Derived& Sub(ArrayView<const T> minuend,
+                 ArrayView<const T> subtrahend)
+    {
+      ParallelMap(Binding().Sub, Self().size(), MutableData(), minuend.data(), subtrahend.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Mul multiply contents of multiplier with 'this' into a new array and return it
+    /// \param multiplier
+    /// \return
+    ///
+    Array<T> Mul(ArrayView<const T> multiplier) const
+    {
+      Array<T> product = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Mul, Self().size(), product.data(), Self().data(), multiplier.data());
+      return product;
+    }
+
+    ///
+    /// \brief Mul multiply the contents of multiplier and multiplicand into 'this' and return it. The object whose Mul( ) is
+    /// called can also be passed as multiplier, i.e., a.Mul(a, b) to express a = a * b
+    /// \param multiplier first component for multiplication, it can also be 'this'
+    /// \param multiplicand second component for multiplication
+    /// \return 'this'
+    ///
+    Derived& Mul(ArrayView<const T> multiplier,
+                 ArrayView<const T> multiplicand)
+    {
+      ParallelMap(Binding().Mul, Self().size(), MutableData(), multiplier.data(), multiplicand.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Multiply every element of 'this' by multiplier and return the result in a new array of the same size
+    /// \param multiplier the scalar by which to multiply
+    /// \return move-returned Array<T>
+    ///
+    Array<T> ScalarMul(T multiplier) const
+    {
+      Array<T> product = Array<T>::Uninitialized(Self().size());
+      ParallelScalarMap(Binding().ScalarMul, Self().size(), multiplier, product.data(), Self().data());
+      return product;
+    }
+
+    ///
+    /// \brief Scalar multiplication of 'this' by multiplier, result stored in 'this'
+    /// \param multiplier the scalar value to multiply with each element of 'this'
+    /// \return 'this'
+    ///
+    Derived& TransformScalarMul(T multiplier)
+    {
+      ParallelScalarMap(Binding().ScalarMul, Self().size(), multiplier, MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Div divide the contents of 'this' by divisor into a new array and return it
+    /// \param divisor
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Div(ArrayView<const T> divisor) const
+    {
+      Array<T> quotient = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Div, Self().size(), quotient.data(), Self().data(), divisor.data());
+      return quotient;
+    }
+
+    ///
+    /// \brief Div divide the contents of dividend by divisor into 'this' and return it. The object whose Div( ) is called can
+    /// also be passed as dividend, i.e., a.Div(a, b) to express a = a / b
+    /// \param dividend first component for division, it can also be 'this'
+    /// \param divisor second component for division
+    /// \return 'this'
+    ///
+    Derived& Div(ArrayView<const T> dividend,
+                 ArrayView<const T> divisor)
+    {
+      ParallelMap(Binding().Div, Self().size(), MutableData(), dividend.data(), divisor.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Divide 'this' by scalar and return result in a new array of same size
+    /// \param divisor the scalar value to divide by
+    /// \return move-returned Array<T>
+    ///
+    Array<T> ScalarDiv(T divisor) const
+    {
+      Array<T> quotient = Array<T>::Uninitialized(Self().size());
+      ParallelScalarMap(Binding().ScalarDiv, Self().size(), divisor, quotient.data(), Self().data());
+      return quotient;
+    }
+
+    ///
+    /// \brief Divide each element of 'this' by the scalar divisor and store in 'this'
+    /// \param divisor the scalar value to divide by
+    /// \return 'this'
+    ///
+    Derived& TransformScalarDiv(T divisor)
+    {
+      ParallelScalarMap(Binding().ScalarDiv, Self().size(), divisor, MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Sqrt computes the square root of each element in this array and returns it in a new array of the same dimension
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Sqrt() const
+    {
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Sqrt, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief SqrtAcc computes the square root of each element in the param array and assigns it to 'this'. The object whose
+    /// Sqrt( ) is called can also be passed as src, i.e., a.Sqrt(a) to express a = sqrt(a)
+    /// \param src the Array<T> whose square root is to be computed, can also be 'this'
+    /// \return 'this'
+    ///
+    Derived& Sqrt(ArrayView<const T> src)
+    {
+      ParallelMap(Binding().Sqrt, Self().size(), MutableData(), src.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Square computes the square of each element in this array and returns it in a new array of the same dimension
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Square() const
+    {
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Square, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Square computes the square of each element in the src array and assigns it to 'this'. The object whose Square( ) is
+    /// called can also be passed as src, i.e., a.Square(a) to express a = a * a
+    /// \param src the Array<T> whose square is to be computed, can also be 'this'
+    /// \return 'this'
+    ///
+    Derived& Square(ArrayView<const T> src)
+    {
+      ParallelMap(Binding().Square, Self().size(), MutableData(), src.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Cube computes the cube of each element in 'this' and returns it in a new array of the same dimension
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Cube() const
+    {
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Cube, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Cube computes the cube of each element in the param src and assigns it to 'this'. The object whose Cube( ) is called
+    /// can also be passed as src, i.e., a.Cube(a) to express a = a * a * a
+    /// \param src the Array<T> whose cube is to be computed, can also be 'this'
+    /// \return 'this'
+    ///
+    Derived& Cube(ArrayView<const T> src)
+    {
+      ParallelMap(Binding().Cube, Self().size(), MutableData(), src.data());
+      return Self();
+    }
+
+    ///
+    /// \brief CrossProduct computes the dot product between multiplicand and 'this' vectors, size of multiplicand must be the same as size of 'this'.
+    /// You can also pass 'this' as multiplicand, in which case this will compute the magnitude^2 of the 'this' vector.
+    /// \param multiplicand
+    /// \return double-precision scalar dot product
+    ///
+    T DotProduct(ArrayView<const T> multiplicand) const
+    {
+      T product = 0;
+      ParallelReduce(Binding().DotProduct, std::plus<T>(), Self().size(), &product, Self().data(), multiplicand.data());
+      return product;
+    }
+
+    ///
+    /// \brief Compute the dot product between 'this' and multiplicand like \link CompensatedSummation( )\endlink sums, i.e., the products are
+    /// rounded but their sum is compensated, and the result is bitwise identical whatever the instruction set or the number of threads.
+    /// Floating point element types only.
+    /// \param multiplicand of the same size as 'this'
+    /// \return the scalar dot product
+    ///
+    T CompensatedDotProduct(ArrayView<const T> multiplicand) const
+    {
+      static_assert(std::is_floating_point<T>::value, "CompensatedDotProduct is only defined for floating point element types");
+      return ParallelCompensatedReduce(Binding().CompensatedDotProduct, Self().size(), Self().data(), multiplicand.data());
+    }
+
+    ///
+    /// \brief Compute the sum of all elements in this Array<T>
+    /// \return the scalar sum of all elements
+    ///
+    T Summation() const
+    {
+      T sigma = 0;
+      ParallelReduce(Binding().Summation, std::plus<T>(), Self().size(), &sigma, Self().data());
+      return sigma;
+    }
+
+    ///
+    /// \brief Compute the sum of all elements in this Array<T> with Neumaier's compensated summation, over fixed blocks and lanes, see
+    /// \link ParallelCompensatedReduce( )\endlink. It is slower than \link Summation( )\endlink but much more accurate, and the result
+    /// is bitwise identical whatever the instruction set or the number of threads. Floating point element types only.
+    /// \return the scalar sum of all elements
+    ///
+    T CompensatedSummation() const
+    {
+      static_assert(std::is_floating_point<T>::value, "CompensatedSummation is only defined for floating point element types");
+      return ParallelCompensatedReduce(Binding().CompensatedSummation, Self().size(), Self().data());
+    }
+
+    ///
+    /// \brief Compute the inclusive prefix sum of 'this', i.e., result[i] = this[0] + ... + this[i], and return it in a new array of the same size.
+    /// Large arrays are scanned in two passes across the \link ThreadPool\endlink, floating point results can then differ from the serial
+    /// scan in the last bits.
+    /// \return move-returned Array<T>
+    ///
+    Array<T> PrefixSum() const
+    {
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelScan(Binding().PrefixSum, Binding().Summation, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Replace each element of 'this' with the inclusive prefix sum up to it
+    /// \return 'this'
+    ///
+    Derived& TransformPrefixSum()
+    {
+      ParallelScan(Binding().PrefixSum, Binding().Summation, Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the exclusive prefix sum of 'this', i.e., result[0] = 0 and result[i] = this[0] + ... + this[i - 1], and return it in a new
+    /// array of the same size, e.g., the offsets of consecutive blocks of the sizes in 'this'
+    /// \return move-returned Array<T>
+    ///
+    Array<T> ExclusivePrefixSum() const
+    {
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelScan(Binding().ExclusivePrefixSum, Binding().Summation, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Replace each element of 'this' with the exclusive prefix sum before it
+    /// \return 'this'
+    ///
+    Derived& TransformExclusivePrefixSum()
+    {
+      ParallelScan(Binding().ExclusivePrefixSum, Binding().Summation, Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Negates each element of 'this' and returns it in a new array of the same dimension
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Negate() const
+    {
+      Array<T> negated = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Negate, Self().size(), negated.data(), Self().data());
+      return negated;
+    }
+
+    ///
+    /// \brief Negates each element of the Array<T> src and assigns it to 'this'. The object whose Negate( ) is called can also be passed as src, i.e.,
+    /// a.Negate(a) for a = -a;
+    /// \param src the Array<T> to negate, can also be 'this'
+    /// \return  'this'
+    ///
+    Derived& Negate(ArrayView<const T> src)
+    {
+      ParallelMap(Binding().Negate, Self().size(), MutableData(), src.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Allocate a new Array<T> of the same size as 'this', assign reciprocals of 'this' to each element of the new array and return it.
+    /// Every element is computed the same way whatever its position, the tail of the array included.
+    /// \param precision Exact divides, Refined and Approximate use the single-precision hardware estimate, see \link PrecisionMode\endlink
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Reciprocate(PrecisionMode precision = Exact) const
+    {
+      Array<T> reciprocal = Array<T>::Uninitialized(Self().size());
+      ParallelMap(ForPrecision(precision, Binding().ApproximateReciprocate, Binding().RefinedReciprocate, Binding().Reciprocate),
+                  Self().size(), reciprocal.data(), Self().data());
+      return reciprocal;
+    }
+
+    ///
+    /// \brief Replace each element in 'this' with its reciprocal value, i.e., 1/x, see \link Reciprocate( )\endlink for the precision modes
+    /// \return 'this'
+    ///
+    Derived& TransformReciprocate(PrecisionMode precision = Exact)
+    {
+      ParallelMap(ForPrecision(precision, Binding().ApproximateReciprocate, Binding().RefinedReciprocate, Binding().Reciprocate),
+                  Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the reciprocal square root 1 / sqrt(x) of each element of 'this' and return it in a new array of the same size. Floating point
+    /// element types only.
+    /// \param precision Exact uses the IEEE square root and division, Refined and Approximate use the single-precision hardware estimate, see \link PrecisionMode\endlink
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Rsqrt(PrecisionMode precision = Exact) const
+    {
+      static_assert(std::is_floating_point<T>::value, "Rsqrt is only defined for floating point element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(ForPrecision(precision, Binding().ApproximateRsqrt, Binding().RefinedRsqrt, Binding().Rsqrt),
+                  Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Replace each element of 'this' with its reciprocal square root, see \link Rsqrt( )\endlink for the precision modes
+    /// \return 'this'
+    ///
+    Derived& TransformRsqrt(PrecisionMode precision = Exact)
+    {
+      static_assert(std::is_floating_point<T>::value, "Rsqrt is only defined for floating point element types");
+      ParallelMap(ForPrecision(precision, Binding().ApproximateRsqrt, Binding().RefinedRsqrt, Binding().Rsqrt),
+                  Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Return a copy of 'this' scaled to unit Euclidean norm. Floating point element types only. The scale is the reciprocal square root of
+    /// \link DotProduct( )\endlink of 'this' with itself, computed with the given precision, so every element carries the same relative error from it.
+    /// An array of zeros is returned unchanged, and the sum of squares has to be finite.
+    /// \param precision see \link Rsqrt( )\endlink
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Normalize(PrecisionMode precision = Exact) const
+    {
+      static_assert(std::is_floating_point<T>::value, "Normalize is only defined for floating point element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelScalarMap(Binding().ScalarMul, Self().size(), NormalizationScale(precision), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Scale 'this' to unit Euclidean norm, see \link Normalize( )\endlink
+    /// \return 'this'
+    ///
+    Derived& TransformNormalize(PrecisionMode precision = Exact)
+    {
+      static_assert(std::is_floating_point<T>::value, "Normalize is only defined for floating point element types");
+      ParallelScalarMap(Binding().ScalarMul, Self().size(), NormalizationScale(precision), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the exponential e^x of each element of 'this' and return it in a new array of the same size. Floating point element types only,
+    /// the single-precision SIMD kernels are within 1 ulp, results below -87.33 are denormal and lose precision gradually. Double-precision arrays use the serial std:: functions.
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Exp() const
+    {
+      static_assert(std::is_floating_point<T>::value, "Exp is only defined for floating point element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Exp, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Replace each element of 'this' with its exponential, see \link Exp( )\endlink for the accuracy
+    /// \return 'this'
+    ///
+    Derived& TransformExp()
+    {
+      static_assert(std::is_floating_point<T>::value, "Exp is only defined for floating point element types");
+      ParallelMap(Binding().Exp, Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the natural logarithm log(x) of each element of 'this' and return it in a new array of the same size. Floating point element types only,
+    /// the single-precision SIMD kernels are within 1 ulp, log(0) is -infinity and the logarithm of a negative number NaN. Double-precision arrays use the serial std:: functions.
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Log() const
+    {
+      static_assert(std::is_floating_point<T>::value, "Log is only defined for floating point element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Log, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Replace each element of 'this' with its natural logarithm, see \link Log( )\endlink for the accuracy
+    /// \return 'this'
+    ///
+    Derived& TransformLog()
+    {
+      static_assert(std::is_floating_point<T>::value, "Log is only defined for floating point element types");
+      ParallelMap(Binding().Log, Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the base-2 logarithm log2(x) of each element of 'this' and return it in a new array of the same size. Floating point element types only,
+    /// the single-precision SIMD kernels are within 1.5 ulp, the special values are those of Log( ). Double-precision arrays use the serial std:: functions.
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Log2() const
+    {
+      static_assert(std::is_floating_point<T>::value, "Log2 is only defined for floating point element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Log2, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Replace each element of 'this' with its base-2 logarithm, see \link Log2( )\endlink for the accuracy
+    /// \return 'this'
+    ///
+    Derived& TransformLog2()
+    {
+      static_assert(std::is_floating_point<T>::value, "Log2 is only defined for floating point element types");
+      ParallelMap(Binding().Log2, Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the sine sin(x) of each element of 'this' and return it in a new array of the same size. Floating point element types only,
+    /// the single-precision SIMD kernels are within 1.6 ulp over [-pi, pi], beyond that the absolute error stays below 2^-23 up to |x| = 8192. Double-precision arrays use the serial std:: functions.
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Sin() const
+    {
+      static_assert(std::is_floating_point<T>::value, "Sin is only defined for floating point element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Sin, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Replace each element of 'this' with its sine, see \link Sin( )\endlink for the accuracy
+    /// \return 'this'
+    ///
+    Derived& TransformSin()
+    {
+      static_assert(std::is_floating_point<T>::value, "Sin is only defined for floating point element types");
+      ParallelMap(Binding().Sin, Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the cosine cos(x) of each element of 'this' and return it in a new array of the same size. Floating point element types only,
+    /// the single-precision SIMD kernels are within 1.6 ulp over [-pi, pi], beyond that the absolute error stays below 2^-23 up to |x| = 8192. Double-precision arrays use the serial std:: functions.
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Cos() const
+    {
+      static_assert(std::is_floating_point<T>::value, "Cos is only defined for floating point element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Cos, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Replace each element of 'this' with its cosine, see \link Cos( )\endlink for the accuracy
+    /// \return 'this'
+    ///
+    Derived& TransformCos()
+    {
+      static_assert(std::is_floating_point<T>::value, "Cos is only defined for floating point element types");
+      ParallelMap(Binding().Cos, Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the hyperbolic tangent tanh(x) of each element of 'this' and return it in a new array of the same size. Floating point element types only,
+    /// the single-precision SIMD kernels are within 1.4 ulp. Double-precision arrays use the serial std:: functions.
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Tanh() const
+    {
+      static_assert(std::is_floating_point<T>::value, "Tanh is only defined for floating point element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Tanh, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Replace each element of 'this' with its hyperbolic tangent, see \link Tanh( )\endlink for the accuracy
+    /// \return 'this'
+    ///
+    Derived& TransformTanh()
+    {
+      static_assert(std::is_floating_point<T>::value, "Tanh is only defined for floating point element types");
+      ParallelMap(Binding().Tanh, Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the logistic function 1 / (1 + e^-x) of each element of 'this' and return it in a new array of the same size. Floating point element types only,
+    /// the single-precision SIMD kernels are within 2.5 ulp. Double-precision arrays use the serial std:: functions.
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Sigmoid() const
+    {
+      static_assert(std::is_floating_point<T>::value, "Sigmoid is only defined for floating point element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Sigmoid, Self().size(), result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Replace each element of 'this' with its logistic function, see \link Sigmoid( )\endlink for the accuracy
+    /// \return 'this'
+    ///
+    Derived& TransformSigmoid()
+    {
+      static_assert(std::is_floating_point<T>::value, "Sigmoid is only defined for floating point element types");
+      ParallelMap(Binding().Sigmoid, Self().size(), MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Raise each element of 'this' to the power of the matching element of exponent and return the result in a new array of the same size.
+    /// Floating point element types only. The single-precision SIMD kernels compute 2^(exponent * log2(this)), their error grows with the magnitude
+    /// of the result's binary exponent: about 1 + 1.2 * |exponent * log2(this)| ulp, e.g. 7 ulp for results between 2^-5 and 2^5. The special values
+    /// are those of std::pow, which the double-precision arrays use.
+    /// \param exponent of the same size as 'this'
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Pow(ArrayView<const T> exponent) const
+    {
+      static_assert(std::is_floating_point<T>::value, "Pow is only defined for floating point element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Pow, Self().size(), result.data(), Self().data(), exponent.data());
+      return result;
+    }
+
+    ///
+    /// \brief Raise each element of 'this' to the power of the matching element of exponent in place, see \link Pow( )\endlink for the accuracy
+    /// \param exponent of the same size as 'this'
+    /// \return 'this'
+    ///
+    Derived& TransformPow(ArrayView<const T> exponent)
+    {
+      static_assert(std::is_floating_point<T>::value, "Pow is only defined for floating point element types");
+      ParallelMap(Binding().Pow, Self().size(), MutableData(), Self().data(), exponent.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the distance between 'this' and v2 in vector space. Distance is defined as, with v1 = this, sqrt((v1[0]-v2[0])^2 + ... v1[n-1]*v2[n-1]^2)
+    /// \param v2
+    /// \return double-precision linear distance between 'this' and v2
+    ///
+    T Distance(ArrayView<const T> v2) const
+    {
+      T distance = 0;
+      // The partial distances of the chunks are combined like the sides of a right triangle
+      auto hypotenuse = [](T a, T b) { return (T)std::sqrt(a * a + b * b); };
+      ParallelReduce(Binding().Distance, hypotenuse, Self().size(), &distance, Self().data(), v2.data());
+      return distance;
+    }
+
+    ///
+    /// \brief Min computes the element-wise minimum of 'this' and operand into a new array and returns it. Integral element types only.
+    /// \param operand the second operand, of the same size as 'this'
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Min(ArrayView<const T> operand) const
+    {
+      static_assert(std::is_integral<T>::value, "Min is only defined for integral element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Min, Self().size(), result.data(), Self().data(), operand.data());
+      return result;
+    }
+
+    ///
+    /// \brief Min computes the element-wise minimum of lhs and rhs into 'this' and returns it. The object whose Min( ) is called can
+    /// also be passed as lhs, i.e., a.Min(a, b)
+    /// \param lhs first operand, it can also be 'this'
+    /// \param rhs second operand
+    /// \return 'this'
+    ///
+    Derived& Min(ArrayView<const T> lhs,
+                 ArrayView<const T> rhs)
+    {
+      static_assert(std::is_integral<T>::value, "Min is only defined for integral element types");
+      ParallelMap(Binding().Min, Self().size(), MutableData(), lhs.data(), rhs.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Max computes the element-wise maximum of 'this' and operand into a new array and returns it. Integral element types only.
+    /// \param operand the second operand, of the same size as 'this'
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Max(ArrayView<const T> operand) const
+    {
+      static_assert(std::is_integral<T>::value, "Max is only defined for integral element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Max, Self().size(), result.data(), Self().data(), operand.data());
+      return result;
+    }
+
+    ///
+    /// \brief Max computes the element-wise maximum of lhs and rhs into 'this' and returns it. The object whose Max( ) is called can
+    /// also be passed as lhs, i.e., a.Max(a, b)
+    /// \param lhs first operand, it can also be 'this'
+    /// \param rhs second operand
+    /// \return 'this'
+    ///
+    Derived& Max(ArrayView<const T> lhs,
+                 ArrayView<const T> rhs)
+    {
+      static_assert(std::is_integral<T>::value, "Max is only defined for integral element types");
+      ParallelMap(Binding().Max, Self().size(), MutableData(), lhs.data(), rhs.data());
+      return Self();
+    }
+
+    ///
+    /// \brief And computes the element-wise bitwise AND of 'this' and operand into a new array and returns it. Integral element types only.
+    /// \param operand the second operand, of the same size as 'this'
+    /// \return move-returned Array<T>
+    ///
+    Array<T> And(ArrayView<const T> operand) const
+    {
+      static_assert(std::is_integral<T>::value, "And is only defined for integral element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().And, Self().size(), result.data(), Self().data(), operand.data());
+      return result;
+    }
+
+    ///
+    /// \brief And computes the element-wise bitwise AND of lhs and rhs into 'this' and returns it. The object whose And( ) is called can
+    /// also be passed as lhs, i.e., a.And(a, b)
+    /// \param lhs first operand, it can also be 'this'
+    /// \param rhs second operand
+    /// \return 'this'
+    ///
+    Derived& And(ArrayView<const T> lhs,
+                 ArrayView<const T> rhs)
+    {
+      static_assert(std::is_integral<T>::value, "And is only defined for integral element types");
+      ParallelMap(Binding().And, Self().size(), MutableData(), lhs.data(), rhs.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Or computes the element-wise bitwise OR of 'this' and operand into a new array and returns it. Integral element types only.
+    /// \param operand the second operand, of the same size as 'this'
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Or(ArrayView<const T> operand) const
+    {
+      static_assert(std::is_integral<T>::value, "Or is only defined for integral element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Or, Self().size(), result.data(), Self().data(), operand.data());
+      return result;
+    }
+
+    ///
+    /// \brief Or computes the element-wise bitwise OR of lhs and rhs into 'this' and returns it. The object whose Or( ) is called can
+    /// also be passed as lhs, i.e., a.Or(a, b)
+    /// \param lhs first operand, it can also be 'this'
+    /// \param rhs second operand
+    /// \return 'this'
+    ///
+    Derived& Or(ArrayView<const T> lhs,
+                ArrayView<const T> rhs)
+    {
+      static_assert(std::is_integral<T>::value, "Or is only defined for integral element types");
+      ParallelMap(Binding().Or, Self().size(), MutableData(), lhs.data(), rhs.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Xor computes the element-wise bitwise XOR of 'this' and operand into a new array and returns it. Integral element types only.
+    /// \param operand the second operand, of the same size as 'this'
+    /// \return move-returned Array<T>
+    ///
+    Array<T> Xor(ArrayView<const T> operand) const
+    {
+      static_assert(std::is_integral<T>::value, "Xor is only defined for integral element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().Xor, Self().size(), result.data(), Self().data(), operand.data());
+      return result;
+    }
+
+    ///
+    /// \brief Xor computes the element-wise bitwise XOR of lhs and rhs into 'this' and returns it. The object whose Xor( ) is called can
+    /// also be passed as lhs, i.e., a.Xor(a, b)
+    /// \param lhs first operand, it can also be 'this'
+    /// \param rhs second operand
+    /// \return 'this'
+    ///
+    Derived& Xor(ArrayView<const T> lhs,
+                 ArrayView<const T> rhs)
+    {
+      static_assert(std::is_integral<T>::value, "Xor is only defined for integral element types");
+      ParallelMap(Binding().Xor, Self().size(), MutableData(), lhs.data(), rhs.data());
+      return Self();
+    }
+
+    ///
+    /// \brief AndNot computes the element-wise this[i] & ~operand[i] into a new array and returns it. Integral element types only.
+    /// \param operand the second operand, of the same size as 'this'
+    /// \return move-returned Array<T>
+    ///
+    Array<T> AndNot(ArrayView<const T> operand) const
+    {
+      static_assert(std::is_integral<T>::value, "AndNot is only defined for integral element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelMap(Binding().AndNot, Self().size(), result.data(), Self().data(), operand.data());
+      return result;
+    }
+
+    ///
+    /// \brief AndNot computes the element-wise lhs[i] & ~rhs[i] into 'this' and returns it. The object whose AndNot( ) is called can
+    /// also be passed as lhs, i.e., a.AndNot(a, b)
+    /// \param lhs first operand, it can also be 'this'
+    /// \param rhs second operand
+    /// \return 'this'
+    ///
+    Derived& AndNot(ArrayView<const T> lhs,
+                    ArrayView<const T> rhs)
+    {
+      static_assert(std::is_integral<T>::value, "AndNot is only defined for integral element types");
+      ParallelMap(Binding().AndNot, Self().size(), MutableData(), lhs.data(), rhs.data());
+      return Self();
+    }
+
+    ///
+    /// \brief Shift every element of 'this' left by count bits and return the result in a new array of the same size. Integral element types only.
+    /// \param count the number of bits to shift by
+    /// \return move-returned Array<T>
+    ///
+    Array<T> ShiftLeft(uint32_t count) const
+    {
+      static_assert(std::is_integral<T>::value, "ShiftLeft is only defined for integral element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelScalarMap(Binding().ShiftLeft, Self().size(), count, result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Shift every element of 'this' left by count bits, result stored in 'this'
+    /// \param count the number of bits to shift by
+    /// \return 'this'
+    ///
+    Derived& TransformShiftLeft(uint32_t count)
+    {
+      static_assert(std::is_integral<T>::value, "ShiftLeft is only defined for integral element types");
+      ParallelScalarMap(Binding().ShiftLeft, Self().size(), count, MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Shift every element of 'this' right by count bits and return the result in a new array of the same size. The shift is logical for unsigned and arithmetic for signed element types. Integral element types only.
+    /// \param count the number of bits to shift by
+    /// \return move-returned Array<T>
+    ///
+    Array<T> ShiftRight(uint32_t count) const
+    {
+      static_assert(std::is_integral<T>::value, "ShiftRight is only defined for integral element types");
+      Array<T> result = Array<T>::Uninitialized(Self().size());
+      ParallelScalarMap(Binding().ShiftRight, Self().size(), count, result.data(), Self().data());
+      return result;
+    }
+
+    ///
+    /// \brief Shift every element of 'this' right by count bits, result stored in 'this'
+    /// \param count the number of bits to shift by
+    /// \return 'this'
+    ///
+    Derived& TransformShiftRight(uint32_t count)
+    {
+      static_assert(std::is_integral<T>::value, "ShiftRight is only defined for integral element types");
+      ParallelScalarMap(Binding().ShiftRight, Self().size(), count, MutableData(), Self().data());
+      return Self();
+    }
+
+    ///
+    /// \brief Compute the sum of all elements in this Array<T> in the wider type \link WideType<T>\endlink, e.g., 64 bits for 32-bit
+    /// integers, so that the sum does not wrap around like \link Summation( )\endlink does. Integral element types only.
+    /// \return the scalar sum of all elements
+    ///
+    typename WideType<T>::type WideSummation() const
+    {
+      static_assert(std::is_integral<T>::value, "WideSummation is only defined for integral element types");
+      typename WideType<T>::type sigma = 0;
+      ParallelReduce(Binding().WideSummation, std::plus<typename WideType<T>::type>(), Self().size(), &sigma, Self().data());
+      return sigma;
+    }
+
+    ///
+    /// \brief Returns the smallest element of 'this', or the largest finite value of T if 'this' is empty. NaN is returned if 'this' contains any NaN.
+    ///
+    T Min() const
+    {
+      T minimum;
+      ParallelReduce(Binding().Minimum, [](T a, T b) { return IsSmaller(b, a) ? b : a; }, Self().size(), &minimum, Self().data());
+      return minimum;
+    }
+
+    ///
+    /// \brief Returns the largest element of 'this', or the lowest finite value of T if 'this' is empty. NaN is returned if 'this' contains any NaN.
+    ///
+    T Max() const
+    {
+      T maximum;
+      ParallelReduce(Binding().Maximum, [](T a, T b) { return IsLarger(b, a) ? b : a; }, Self().size(), &maximum, Self().data());
+      return maximum;
+    }
+
+    ///
+    /// \brief Finds both the smallest and the largest element of 'this' in a single pass, see \link Min( )\endlink and \link Max( )\endlink
+    /// \return the extrema of 'this'
+    ///
+    Extrema<T> MinMax() const
+    {
+      Extrema<T> extrema;
+      auto combine = [](Extrema<T> a, Extrema<T> b) {
+        return Extrema<T> { IsSmaller(b.minimum, a.minimum) ? b.minimum : a.minimum,
+                            IsLarger(b.maximum, a.maximum) ? b.maximum : a.maximum };
+      };
+      ParallelReduce(Binding().MinMaximum, combine, Self().size(), &extrema, Self().data());
+      return extrema;
+    }
+
+    ///
+    /// \brief Returns the index of the smallest element of 'this', the first one if it occurs more than once. If 'this' contains any NaN the
+    /// index of the first NaN is returned instead, and 0 if 'this' is empty.
+    ///
+    size_t ArgMin() const
+    {
+      return ParallelArgReduce(Binding().ArgMinimum, IsSmaller, Self().size(), Self().data());
+    }
+
+    ///
+    /// \brief Returns the index of the largest element of 'this', the first one if it occurs more than once. If 'this' contains any NaN the
+    /// index of the first NaN is returned instead, and 0 if 'this' is empty.
+    ///
+    size_t ArgMax() const
+    {
+      return ParallelArgReduce(Binding().ArgMaximum, IsLarger, Self().size(), Self().data());
+    }
+
+    ///
+    /// \brief Writes the elements of 'this' to an array file at path, replacing it. The file can be mapped back without a copy by
+    /// \link Array<T>::MapFile( )\endlink. See \link SaveArrayFile( )\endlink for the format and the exceptions thrown.
+    ///
+    void Save(const std::string& path) const
+    {
+      SaveArrayFile(path, ArrayFileElement<T>::type, sizeof(T), Self().data(), Self().size());
+    }
+
+  protected:
+    Derived& Self()
+    {
+      return static_cast<Derived&>(*this);
+    }
+
+    const Derived& Self() const
+    {
+      return static_cast<const Derived&>(*this);
+    }
+
+    T* MutableData()
+    {
+      static_assert(!std::is_const<E>::value, "A read-only ArrayView cannot be modified");
+      return const_cast<T*>(Self().data());
+    }
+
+  private:
+    static const ArchBinding<T>& Binding()
+    {
+      return ArchBinding<T>::Active();
+    }
+
+    typedef void (*UnaryKernel) (size_t size, T* dst, const T* src);
+
+    static UnaryKernel ForPrecision(PrecisionMode precision, UnaryKernel approximate, UnaryKernel refined, UnaryKernel exact)
+    {
+      return precision == Approximate ? approximate : (precision == Refined ? refined : exact);
+    }
+
+    // The scale goes through the Rsqrt kernel of the requested precision like any other element
+    T NormalizationScale(PrecisionMode precision) const
+    {
+      T sumOfSquares = DotProduct(Self());
+      if ( sumOfSquares == 0 ) {
+        return 1;
+      }
+      T scale;
+      ForPrecision(precision, Binding().ApproximateRsqrt, Binding().RefinedRsqrt, Binding().Rsqrt)(1, &scale, &sumOfSquares);
+      return scale;
+    }
+
+    // Orderings used to fold the extrema of the chunks: a NaN beats any number and the earlier operand wins ties, i.e.,
+    // candidate only replaces incumbent when it is strictly better. x != x only holds when x is NaN.
+    static bool IsSmaller(T candidate, T incumbent)
+    {
+      return incumbent == incumbent && (candidate < incumbent || candidate != candidate);
+    }
+
+    static bool IsLarger(T candidate, T incumbent)
+    {
+      return incumbent == incumbent && (candidate > incumbent || candidate != candidate);
+    }
+  };
+}
@@ -0,0 +1,164 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include "Array.hpp"
+#include "ArrayOperations.hpp"
+#include "Expression.hpp"
+#include "SimdContainer.hpp"
+
+namespace khyber
+{
+  ///
+  /// \brief Non-owning view of size( ) consecutive elements at any address, with the compute operations of \link Array<T>\endlink
+  /// \details ArrayView<T> runs the kernels directly on memory khyber did not allocate, e.g., network buffers, memory shared with another
+  /// runtime or a memory-mapped file, instead of copying it into an Array<T> first. The memory does not have to be aligned.
+  /// ArrayView<const T> is the read-only variant: its operations return new arrays or scalars, and the in-place ones, such as
+  /// TransformExp( ) or a.Add(b, c), do not compile. A mutable view writes through to the memory it refers to, the operands of its
+  /// in-place operations can be the view itself but must not otherwise overlap it.
+  ///
+  /// A view is as cheap to copy as a pointer and a size, and copying or assigning one never copies the elements. It does not keep the
+  /// memory alive, which has to outlive the view and every expression built from it.
+  ///
+  template<typename E>
+  class ArrayView : public ArrayOperations<ArrayView<E>, E>
+  {
+  public:
+    typedef typename std::remove_const<E>::type T;
+
+    ///
+    /// \brief Construct an empty view
+    ///
+    ArrayView() : _data(0), _size(0)
+    {
+    }
+
+    ///
+    /// \brief Construct a view of size elements starting at data, which can have any alignment
+    ///
+    ArrayView(E* data, size_t size) : _data(data), _size(size)
+    {
+    }
+
+    ///
+    /// \brief Construct a view of the whole buffer of an Array<T>, it is invalidated when the array is resized or destroyed
+    ///
+    ArrayView(typename std::conditional<std::is_const<E>::value, const SimdContainer<T>, SimdContainer<T> >::type& container)
+      : _data(container.data()), _size(container.size())
+    {
+    }
+
+    ///
+    /// \brief Construct a read-only view of the same memory as a mutable view
+    ///
+    template<typename F>
+    ArrayView(const ArrayView<F>& view,
+              typename std::enable_if<std::is_same<const F, E>::value && !std::is_same<F, E>::value>::type* = 0)
+      : _data(view.data()), _size(view.size())
+    {
+    }
+
+    ///
+    /// \brief Evaluate an element-wise expression into the memory of this view, see \link Expression\endlink. Unlike an Array<T>
+    /// a view cannot be resized, the expression must have size( ) elements and its operands must not overlap the view unless they start
+    /// at the same address.
+    /// \return 'this'
+    ///
+    template<typename X>
+    ArrayView<E>& operator = (const Expression<X>& expression)
+    {
+      EvaluateExpression(this->MutableData(), expression);
+      return *this;
+    }
+
+    ///
+    /// \brief Returns a view of count elements of this view starting at offset
+    ///
+    ArrayView<E> Slice(size_t offset, size_t count) const
+    {
+      return ArrayView<E>(_data + offset, count);
+    }
+
+    ///
+    /// \brief Checks if the view has no elements
+    ///
+    bool empty() const
+    {
+      return _size == 0;
+    }
+
+    ///
+    /// \brief Returns the number of elements in the view
+    ///
+    size_t size() const
+    {
+      return _size;
+    }
+
+    ///
+    /// \brief Returns the pointer to the first element of the view
+    ///
+    E* data() const
+    {
+      return _data;
+    }
+
+    E* begin() const
+    {
+      return _data;
+    }
+
+    E* end() const
+    {
+      return _data + _size;
+    }
+
+    ///
+    /// \brief Returns a reference to the element at index, which is not checked against size( )
+    ///
+    E& operator [] (size_t index) const
+    {
+      return _data[index];
+    }
+
+  private:
+    E* _data;
+    size_t _size;
+  };
+
+  // Views are expression operands like arrays, wrapped in the same terminal node
+  template<typename E>
+  struct OperandTraits<ArrayView<E>, void>
+  {
+    static const bool IsOperand = true;
+    typedef ArrayTerminal<typename std::remove_const<E>::type> node_type;
+
+    static node_type Wrap(const ArrayView<E>& operand)
+    {
+      return node_type(operand.data(), operand.size());
+    }
+  };
+
+  typedef ArrayView<float> SinglePrecisionArrayView;
+  typedef ArrayView<double> DoublePrecisionArrayView;
+  typedef ArrayView<uint32_t> UInt32ArrayView;
+  typedef ArrayView<int32_t> Int32ArrayView;
+  typedef ArrayView<const float> ConstSinglePrecisionArrayView;
+  typedef ArrayView<const double> ConstDoublePrecisionArrayView;
+  typedef ArrayView<const uint32_t> ConstUInt32ArrayView;
+  typedef ArrayView<const int32_t> ConstInt32ArrayView;
+}
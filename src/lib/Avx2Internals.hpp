@@ -14,7 +14,7 @@
 
 #pragma once
 
-#include <cstdint>
+#include "Types.hpp"
 
 namespace khyber
 {
@@ -31,7 +31,7 @@ namespace khyber
   namespace avx2
   {
     ///
-    /// \brief InternalAdd add the two float arrays augend and addend together and store the result in sum
+    /// \brief InternalAdd add the two single-precision floating point arrays augend and addend into sum
     /// \param size the number of elements in all three array parameters
     /// \param sum
     /// \param augend
@@ -39,8 +39,194 @@ namespace khyber
     ///
     void InternalAdd(size_t size,
                      float* sum,
-                     float* augend,
+                     const float* augend,
                      const float* addend);
+
+    ///
+    /// \brief Add a scalar to every element of a single-precision array
+    /// \param size the number of elements in the array sum and src
+    /// \param addend the scalar value to add to each element of the src array
+    /// \param sum the resulting array, can be the same address as src
+    /// \param src the array to add to
+    ///
+    void InternalScalarAdd(size_t size,
+                           float addend,
+                           float* sum,
+                           const float* src);
+
+    ///
+    /// \brief InternalSub subtract the single-precision array subtrahend from minuend and store the result in difference
+    /// \param size the number of elements in all three array parameters
+    /// \param difference
+    /// \param minuend
+    /// \param subtrahend
+    ///
+    void InternalSub(size_t size,
+                     float* difference,
+                     const float* minuend,
+                     const float* subtrahend);
+
+    ///
+    /// \brief InternalMul multiply the single-precision arrays multiplicand and multiplier and store the result in product. This can be considered
+    /// the classical cross product of two vectors
+    /// \param size the number of elements in all three array parameters
+    /// \param product
+    /// \param multiplicand
+    /// \param multiplier
+    ///
+    void InternalMul(size_t size,
+                     float* product,
+                     const float* multiplier,
+                     const float* multiplicand);
+
+    ///
+    /// \brief Multiply a single-precision array by a scalar
+    /// \param size the number of elements in the array product and src
+    /// \param multiplier the scalar value by which to multiply the src array
+    /// \param product the resulting array, can be the same address as src
+    /// \param src the array to multiply
+    ///
+    void InternalScalarMul(size_t size,
+                           float multiplier,
+                           float* product,
+                           const float* src);
+
+    ///
+    /// \brief InternalDiv divide the single-precision array dividend by divisor and store the results in quotient
+    /// \param size the number of elements in all three array parameters
+    /// \param quotient
+    /// \param dividend
+    /// \param divisor
+    ///
+    void InternalDiv(size_t size,
+                     float* quotient,
+                     const float* dividend,
+                     const float* divisor);
+
+    ///
+    /// \brief Divide a single-precision array by a scalar
+    /// \param size the number of elements in the array quotient and src
+    /// \param divisor the scalar value by which to divide the src array
+    /// \param quotient the output array, can be the same address as src
+    /// \param src the array to divide
+    ///
+    void InternalScalarDiv(size_t size,
+                           float divisor,
+                           float* quotient,
+                           const float* src);
+
+    ///
+    /// \brief InternalSqrt compute the square root of every element in the single-precision array src and store the results in dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalSqrt(size_t size,
+                      float* dst,
+                      const float* src);
+
+    ///
+    /// \brief InternalSquare compute the square of every element in the array src and store it in the array dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalSquare(size_t size,
+                        float* dst,
+                        const float* src);
+
+    ///
+    /// \brief Compute the cube of every element in the array src and store it in the array dst.
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalCube(size_t size,
+                      float* dst,
+                      const float* src);
+
+    ///
+    /// \brief Compute the sum of all elements in the single-precision array src, the output is a scalar. Note this is not the prefix sum,
+    /// the src array remains unchanged.
+    /// \param size the number of elements in both array parameters
+    /// \param sum
+    /// \param src
+    ///
+    void InternalSummation(size_t size,
+                           float* sum,
+                           const float* src);
+
+    ///
+    /// \brief InternalCompensatedSummation spread the single-precision array src over COMPENSATED_LANES running sums, element i going to lane i % COMPENSATED_LANES,
+    /// and add each element with Neumaier's compensated addition. The result is bitwise identical to that of the other instruction sets.
+    /// \param size the number of elements in the array parameter
+    /// \param lanes the COMPENSATED_LANES sums followed by their COMPENSATED_LANES compensations, see \link ParallelCompensatedReduce( )\endlink
+    /// \param src the array to sum
+    ///
+    void InternalCompensatedSummation(size_t size,
+                                      float* lanes,
+                                      const float* src);
+
+    ///
+    /// \brief InternalCompensatedDotProduct like InternalCompensatedSummation, over the products multiplier[i] * multiplicand[i] of the single-precision arrays
+    /// \param size the number of elements in both array parameters
+    /// \param lanes the COMPENSATED_LANES sums followed by their COMPENSATED_LANES compensations
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalCompensatedDotProduct(size_t size,
+                                       float* lanes,
+                                       const float* multiplier,
+                                       const float* multiplicand);
+
+    ///
+    /// \brief InternalPrefixSum compute the inclusive prefix sum of src into dst, i.e., dst[i] = carry + src[0] + ... + src[i], for single-precision arrays
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalPrefixSum(size_t size,
+                           float carry,
+                           float* dst,
+                           const float* src);
+
+    ///
+    /// \brief InternalExclusivePrefixSum compute the exclusive prefix sum of src into dst, i.e., dst[0] = carry and dst[i] = carry + src[0] + ... + src[i - 1], for single-precision arrays
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalExclusivePrefixSum(size_t size,
+                                    float carry,
+                                    float* dst,
+                                    const float* src);
+
+    ///
+    /// \brief InternalDotProduct compute the dot product of the single-precision arrays multiplicand and multiplier, store in product
+    /// \param size the number of elements in both array parameters
+    /// \param product pointer to a scalar single-precision float into which the dot product will be output
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalDotProduct(size_t size,
+                            float* product,
+                            const float* multiplier,
+                            const float* multiplicand);
+
+    ///
+    /// \brief InternalDotProductFma compute the dot product of the single-precision arrays multiplicand and multiplier using the FMA intrinsic, store in product
+    /// \param size the number of elements in both array parameters
+    /// \param product pointer to a scalar single-precision float into which the dot product will be output
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalDotProductFma(size_t size,
+                               float* product,
+                               const float* multiplier,
+                               const float* multiplicand);
+
     ///
     /// \brief Change the sign of every element in src and store the result in dst
     /// \param size the number of elements in both array parameters
@@ -49,6 +235,864 @@ namespace khyber
     ///
     void InternalNegate(size_t size,
                         float* dst,
-                        float* src);
+                        const float* src);
+
+    ///
+    /// \brief Compute the linear (geometric) distance between the two vectors, store in distance
+    /// \param size the number of elements in both array parameters
+    /// \param distance pointer to a scalar single-precision floating point into which the distance will be output
+    /// \param v1 array representing 1st point in size()-dimensional space
+    /// \param v2 array representing 2nd point in size()-dimensional space
+    ///
+    void InternalDistance(size_t size,
+                          float* distance,
+                          const float* v1,
+                          const float* v2);
+
+    ///
+    /// \brief Compute the linear (geometric) distance between the two vectors using the FMA intrinsic, store in distance
+    /// \param size the number of elements in both array parameters
+    /// \param distance pointer to a scalar single-precision floating point into which the distance will be output
+    /// \param v1 array representing 1st point in size()-dimensional space
+    /// \param v2 array representing 2nd point in size()-dimensional space
+    ///
+    void InternalDistanceFma(size_t size,
+                             float* distance,
+                             const float* v1,
+                             const float* v2);
+
+    ///
+    /// \brief Compute the reciprocal of every element in the src array by exact division and store it in the dst array
+    /// \param size the number of elements in both array parameters
+    /// \param dst destination array
+    /// \param src source array
+    ///
+    void InternalReciprocate(size_t size,
+                             float* dst,
+                             const float* src);
+
+    ///
+    /// \brief InternalMinimum find the smallest element of the single-precision array src, or NaN if src contains any NaN
+    /// \param size the number of elements in the array parameter
+    /// \param minimum pointer to the scalar into which the minimum is output, the largest finite value if size is 0
+    /// \param src the array to search
+    ///
+    void InternalMinimum(size_t size,
+                         float* minimum,
+                         const float* src);
+
+    ///
+    /// \brief InternalMaximum find the largest element of the single-precision array src, or NaN if src contains any NaN
+    /// \param size the number of elements in the array parameter
+    /// \param maximum pointer to the scalar into which the maximum is output, the lowest finite value if size is 0
+    /// \param src the array to search
+    ///
+    void InternalMaximum(size_t size,
+                         float* maximum,
+                         const float* src);
+
+    ///
+    /// \brief InternalMinMaximum find both the smallest and the largest element of the single-precision array src in a single pass, see InternalMinimum and InternalMaximum
+    /// \param size the number of elements in the array parameter
+    /// \param extrema pointer to the pair into which the minimum and maximum are output
+    /// \param src the array to search
+    ///
+    void InternalMinMaximum(size_t size,
+                            Extrema<float>* extrema,
+                            const float* src);
+
+    ///
+    /// \brief InternalArgMinimum find the index of the first smallest element of the single-precision array src, or of its first NaN if it contains any
+    /// \param size the number of elements in the array parameter
+    /// \param index pointer to the scalar into which the index is output, 0 if size is 0
+    /// \param src the array to search
+    ///
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const float* src);
+
+    ///
+    /// \brief InternalArgMaximum find the index of the first largest element of the single-precision array src, or of its first NaN if it contains any
+    /// \param size the number of elements in the array parameter
+    /// \param index pointer to the scalar into which the index is output, 0 if size is 0
+    /// \param src the array to search
+    ///
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const float* src);
+
+    ///
+    /// \brief InternalExp compute e^x of every element in the single-precision array src and store it in dst. The error is at most 1 ulp, results
+    /// overflow to infinity above 88.72 and are denormal below -87.33 where they lose precision gradually.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalExp(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalLog compute the natural logarithm of every element in the single-precision array src and store it in dst. The error is at most 1 ulp,
+    /// log(0) is -infinity and the logarithm of a negative number is NaN.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalLog(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalLog2 compute the base-2 logarithm of every element in the single-precision array src and store it in dst. The error is at most 1.5 ulp,
+    /// the special values are those of \link InternalLog( )\endlink.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalLog2(size_t size,
+                      float* dst,
+                      const float* src);
+
+    ///
+    /// \brief InternalSin compute the sine of every element in the single-precision array src and store it in dst. The error is at most 1.6 ulp over [-pi, pi],
+    /// beyond that the absolute error stays below 2^-23 up to |x| = 8192 and grows slowly for larger arguments.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalSin(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalCos compute the cosine of every element in the single-precision array src and store it in dst, with the same error bounds as
+    /// \link InternalSin( )\endlink
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalCos(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalTanh compute the hyperbolic tangent of every element in the single-precision array src and store it in dst. The error is at most 1.4 ulp.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalTanh(size_t size,
+                      float* dst,
+                      const float* src);
+
+    ///
+    /// \brief InternalSigmoid compute the logistic function 1 / (1 + e^-x) of every element in the single-precision array src and store it in dst.
+    /// The error is at most 2.5 ulp.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalSigmoid(size_t size,
+                         float* dst,
+                         const float* src);
+
+    ///
+    /// \brief InternalPow raise every element of the single-precision array base to the power of the matching element of exponent and store it in dst.
+    /// It is computed as 2^(exponent * log2(base)), so the error grows with the magnitude of the result's binary exponent: about 1 + 1.2 * |exponent * log2(base)| ulp,
+    /// e.g. 7 ulp for results between 2^-5 and 2^5. The special values are those of std::pow.
+    /// \param size the number of elements in all three array parameters
+    /// \param dst the resulting array, can be the same address as base or exponent
+    /// \param base
+    /// \param exponent
+    ///
+    void InternalPow(size_t size,
+                     float* dst,
+                     const float* base,
+                     const float* exponent);
+
+    ///
+    /// \brief InternalApproximateReciprocate compute the reciprocal of every element in the single-precision array src with rcpps and store it in dst.
+    /// The relative error is at most 1.5*2^-12. Inputs whose reciprocal leaves the normal range, denormals included, give +/-infinity or 0.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalApproximateReciprocate(size_t size,
+                                        float* dst,
+                                        const float* src);
+
+    ///
+    /// \brief InternalRefinedReciprocate compute the reciprocal of every element in the single-precision array src with rcpps followed by one
+    /// Newton-Raphson step and store it in dst. The relative error is at most 1.7*2^-23, the special values are those of \link InternalApproximateReciprocate( )\endlink.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalRefinedReciprocate(size_t size,
+                                    float* dst,
+                                    const float* src);
+
+    ///
+    /// \brief InternalRsqrt compute the reciprocal square root 1 / sqrt(x) of every element in the single-precision array src by exact square root
+    /// and division and store it in dst. The relative error is at most 0.75*2^-23.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalRsqrt(size_t size,
+                       float* dst,
+                       const float* src);
+
+    ///
+    /// \brief InternalApproximateRsqrt compute the reciprocal square root of every element in the single-precision array src with rsqrtps and store it in dst.
+    /// The relative error is at most 1.5*2^-12. Denormal inputs give +infinity.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalApproximateRsqrt(size_t size,
+                                  float* dst,
+                                  const float* src);
+
+    ///
+    /// \brief InternalRefinedRsqrt compute the reciprocal square root of every element in the single-precision array src with rsqrtps followed by one
+    /// Newton-Raphson step and store it in dst. The relative error is at most 2.3*2^-23, the special values are those of \link InternalApproximateRsqrt( )\endlink.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalRefinedRsqrt(size_t size,
+                              float* dst,
+                              const float* src);
+
+    ///////////////////////////// Double-precision ////////////////////////////
+
+    ///
+    /// \brief InternalAdd add the two double-precision floating point arrays augend and addend into sum
+    /// \param size the number of elements in all three array parameters
+    /// \param sum
+    /// \param augend
+    /// \param addend
+    ///
+    void InternalAdd(size_t size,
+                     double* sum,
+                     const double* augend,
+                     const double* addend);
+
+    ///
+    /// \brief Add a scalar to every element of a double-precision array
+    /// \param size the number of elements in the array sum and src
+    /// \param addend the scalar value to add to each element of the src array
+    /// \param sum the resulting array, can be the same address as src
+    /// \param src the array to add to
+    ///
+    void InternalScalarAdd(size_t size,
+                           double addend,
+                           double* sum,
+                           const double* src);
+
+    ///
+    /// \brief InternalSub subtract the double-precision array subtrahend from minuend and store the result in difference
+    /// \param size the number of elements in all three array parameters
+    /// \param difference
+    /// \param minuend
+    /// \param subtrahend
+    ///
+    void InternalSub(size_t size,
+                     double* difference,
+                     const double* minuend,
+                     const double* subtrahend);
+
+    ///
+    /// \brief InternalMul multiply the double-precision arrays multiplicand and multiplier and store the result in product. This can be considered
+    /// the classical cross product of two vectors
+    /// \param size the number of elements in all three array parameters
+    /// \param product
+    /// \param multiplicand
+    /// \param multiplier
+    ///
+    void InternalMul(size_t size,
+                     double* product,
+                     const double* multiplier,
+                     const double* multiplicand);
+
+    ///
+    /// \brief Multiply a double-precision array by a scalar
+    /// \param size the number of elements in the array product and src
+    /// \param multiplier the scalar value by which to multiply the src array
+    /// \param product the resulting array, can be the same address as src
+    /// \param src the array to multiply
+    ///
+    void InternalScalarMul(size_t size,
+                           double multiplier,
+                           double* product,
+                           const double* src);
+
+    ///
+    /// \brief InternalDiv divide the double-precision array dividend by divisor and store the results in quotient
+    /// \param size the number of elements in all three array parameters
+    /// \param quotient
+    /// \param dividend
+    /// \param divisor
+    ///
+    void InternalDiv(size_t size,
+                     double* quotient,
+                     const double* dividend,
+                     const double* divisor);
+
+    ///
+    /// \brief Divide a double-precision array by a scalar
+    /// \param size the number of elements in the array quotient and src
+    /// \param divisor the scalar value by which to divide the src array
+    /// \param quotient the output array, can be the same address as src
+    /// \param src the array to divide
+    ///
+    void InternalScalarDiv(size_t size,
+                           double divisor,
+                           double* quotient,
+                           const double* src);
+
+    ///
+    /// \brief InternalSqrt compute the square root of every element in the double-precision array src and store the results in dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalSqrt(size_t size,
+                      double* dst,
+                      const double* src);
+
+    ///
+    /// \brief InternalSquare compute the square of every element in the array src and store it in the array dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalSquare(size_t size,
+                        double* dst,
+                        const double* src);
+
+    ///
+    /// \brief Compute the cube of every element in the array src and store it in the array dst.
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalCube(size_t size,
+                      double* dst,
+                      const double* src);
+
+    ///
+    /// \brief Compute the sum of all elements in the double-precision array src, the output is a scalar. Note this is not the prefix sum,
+    /// the src array remains unchanged.
+    /// \param size the number of elements in both array parameters
+    /// \param sum
+    /// \param src
+    ///
+    void InternalSummation(size_t size,
+                           double* sum,
+                           const double* src);
+
+    ///
+    /// \brief InternalCompensatedSummation spread the double-precision array src over COMPENSATED_LANES running sums, element i going to lane i % COMPENSATED_LANES,
+    /// and add each element with Neumaier's compensated addition. The result is bitwise identical to that of the other instruction sets.
+    /// \param size the number of elements in the array parameter
+    /// \param lanes the COMPENSATED_LANES sums followed by their COMPENSATED_LANES compensations, see \link ParallelCompensatedReduce( )\endlink
+    /// \param src the array to sum
+    ///
+    void InternalCompensatedSummation(size_t size,
+                                      double* lanes,
+                                      const double* src);
+
+    ///
+    /// \brief InternalCompensatedDotProduct like InternalCompensatedSummation, over the products multiplier[i] * multiplicand[i] of the double-precision arrays
+    /// \param size the number of elements in both array parameters
+    /// \param lanes the COMPENSATED_LANES sums followed by their COMPENSATED_LANES compensations
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalCompensatedDotProduct(size_t size,
+                                       double* lanes,
+                                       const double* multiplier,
+                                       const double* multiplicand);
+
+    ///
+    /// \brief InternalPrefixSum compute the inclusive prefix sum of src into dst, i.e., dst[i] = carry + src[0] + ... + src[i], for double-precision arrays
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalPrefixSum(size_t size,
+                           double carry,
+                           double* dst,
+                           const double* src);
+
+    ///
+    /// \brief InternalExclusivePrefixSum compute the exclusive prefix sum of src into dst, i.e., dst[0] = carry and dst[i] = carry + src[0] + ... + src[i - 1], for double-precision arrays
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalExclusivePrefixSum(size_t size,
+                                    double carry,
+                                    double* dst,
+                                    const double* src);
+
+    ///
+    /// \brief InternalDotProduct compute the dot product of the double-precision arrays multiplicand and multiplier, store in product
+    /// \param size the number of elements in both array parameters
+    /// \param product pointer to a scalar double-precision double into which the dot product will be output
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalDotProduct(size_t size,
+                            double* product,
+                            const double* multiplier,
+                            const double* multiplicand);
+
+    ///
+    /// \brief InternalDotProductFma compute the dot product of the double-precision arrays multiplicand and multiplier using the FMA intrinsic, store in product
+    /// \param size the number of elements in both array parameters
+    /// \param product pointer to a scalar double-precision double into which the dot product will be output
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalDotProductFma(size_t size,
+                               double* product,
+                               const double* multiplier,
+                               const double* multiplicand);
+
+    ///
+    /// \brief Change the sign of every element in src and store the result in dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalNegate(size_t size,
+                        double* dst,
+                        const double* src);
+
+    ///
+    /// \brief Compute the linear (geometric) distance between the two vectors, store in distance
+    /// \param size the number of elements in both array parameters
+    /// \param distance pointer to a scalar double-precision floating point into which the distance will be output
+    /// \param v1 array representing 1st point in size()-dimensional space
+    /// \param v2 array representing 2nd point in size()-dimensional space
+    ///
+    void InternalDistance(size_t size,
+                          double* distance,
+                          const double* v1,
+                          const double* v2);
+
+    ///
+    /// \brief Compute the linear (geometric) distance between the two vectors using the FMA intrinsic, store in distance
+    /// \param size the number of elements in both array parameters
+    /// \param distance pointer to a scalar double-precision floating point into which the distance will be output
+    /// \param v1 array representing 1st point in size()-dimensional space
+    /// \param v2 array representing 2nd point in size()-dimensional space
+    ///
+    void InternalDistanceFma(size_t size,
+                             double* distance,
+                             const double* v1,
+                             const double* v2);
+
+    ///
+    /// \brief Compute the reciprocal of every element in the src array and store it in the dst array
+    /// \param size the number of elements in both array parameters
+    /// \param dst destination array
+    /// \param src source array
+    ///
+    void InternalReciprocate(size_t size,
+                             double* dst,
+                             const double* src);
+
+    ///
+    /// \brief Compute the reciprocal square root 1 / sqrt(x) of every element in the src array and store it in the dst array
+    /// \param size the number of elements in both array parameters
+    /// \param dst destination array
+    /// \param src source array
+    ///
+    void InternalRsqrt(size_t size,
+                       double* dst,
+                       const double* src);
+
+    ///
+    /// \brief InternalMinimum find the smallest element of the double-precision array src, or NaN if src contains any NaN
+    /// \param size the number of elements in the array parameter
+    /// \param minimum pointer to the scalar into which the minimum is output, the largest finite value if size is 0
+    /// \param src the array to search
+    ///
+    void InternalMinimum(size_t size,
+                         double* minimum,
+                         const double* src);
+
+    ///
+    /// \brief InternalMaximum find the largest element of the double-precision array src, or NaN if src contains any NaN
+    /// \param size the number of elements in the array parameter
+    /// \param maximum pointer to the scalar into which the maximum is output, the lowest finite value if size is 0
+    /// \param src the array to search
+    ///
+    void InternalMaximum(size_t size,
+                         double* maximum,
+                         const double* src);
+
+    ///
+    /// \brief InternalMinMaximum find both the smallest and the largest element of the double-precision array src in a single pass, see InternalMinimum and InternalMaximum
+    /// \param size the number of elements in the array parameter
+    /// \param extrema pointer to the pair into which the minimum and maximum are output
+    /// \param src the array to search
+    ///
+    void InternalMinMaximum(size_t size,
+                            Extrema<double>* extrema,
+                            const double* src);
+
+    ///
+    /// \brief InternalArgMinimum find the index of the first smallest element of the double-precision array src, or of its first NaN if it contains any
+    /// \param size the number of elements in the array parameter
+    /// \param index pointer to the scalar into which the index is output, 0 if size is 0
+    /// \param src the array to search
+    ///
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const double* src);
+
+    ///
+    /// \brief InternalArgMaximum find the index of the first largest element of the double-precision array src, or of its first NaN if it contains any
+    /// \param size the number of elements in the array parameter
+    /// \param index pointer to the scalar into which the index is output, 0 if size is 0
+    /// \param src the array to search
+    ///
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const double* src);
+
+    ///////////////////////////// 32-bit integers /////////////////////////////
+
+    ///
+    /// \brief add the two 32-bit integer arrays augend and addend into sum, wrapping around on overflow
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalAdd(size_t size,
+                     uint32_t* sum,
+                     const uint32_t* augend,
+                     const uint32_t* addend);
+    void InternalAdd(size_t size,
+                     int32_t* sum,
+                     const int32_t* augend,
+                     const int32_t* addend);
+
+    ///
+    /// \brief Add a scalar to every element of a 32-bit integer array, wrapping around on overflow
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalScalarAdd(size_t size,
+                           uint32_t addend,
+                           uint32_t* sum,
+                           const uint32_t* src);
+    void InternalScalarAdd(size_t size,
+                           int32_t addend,
+                           int32_t* sum,
+                           const int32_t* src);
+
+    ///
+    /// \brief subtract the 32-bit integer array subtrahend from minuend and store the result in difference
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalSub(size_t size,
+                     uint32_t* difference,
+                     const uint32_t* minuend,
+                     const uint32_t* subtrahend);
+    void InternalSub(size_t size,
+                     int32_t* difference,
+                     const int32_t* minuend,
+                     const int32_t* subtrahend);
+
+    ///
+    /// \brief multiply the 32-bit integer arrays, keeping the low 32 bits of each product
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalMul(size_t size,
+                     uint32_t* product,
+                     const uint32_t* multiplier,
+                     const uint32_t* multiplicand);
+    void InternalMul(size_t size,
+                     int32_t* product,
+                     const int32_t* multiplier,
+                     const int32_t* multiplicand);
+
+    ///
+    /// \brief Multiply every element of a 32-bit integer array by a scalar, keeping the low 32 bits of each product
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalScalarMul(size_t size,
+                           uint32_t multiplier,
+                           uint32_t* product,
+                           const uint32_t* src);
+    void InternalScalarMul(size_t size,
+                           int32_t multiplier,
+                           int32_t* product,
+                           const int32_t* src);
+
+    ///
+    /// \brief Square every element of a 32-bit integer array, keeping the low 32 bits
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalSquare(size_t size,
+                        uint32_t* dst,
+                        const uint32_t* src);
+    void InternalSquare(size_t size,
+                        int32_t* dst,
+                        const int32_t* src);
+
+    ///
+    /// \brief Cube every element of a 32-bit integer array, keeping the low 32 bits
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalCube(size_t size,
+                      uint32_t* dst,
+                      const uint32_t* src);
+    void InternalCube(size_t size,
+                      int32_t* dst,
+                      const int32_t* src);
+
+    ///
+    /// \brief Two's complement negation of every element of a 32-bit integer array
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalNegate(size_t size,
+                        uint32_t* dst,
+                        const uint32_t* src);
+    void InternalNegate(size_t size,
+                        int32_t* dst,
+                        const int32_t* src);
+
+    ///
+    /// \brief Element-wise minimum of the 32-bit integer arrays lhs and rhs
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalMin(size_t size,
+                     uint32_t* dst,
+                     const uint32_t* lhs,
+                     const uint32_t* rhs);
+    void InternalMin(size_t size,
+                     int32_t* dst,
+                     const int32_t* lhs,
+                     const int32_t* rhs);
+
+    ///
+    /// \brief Element-wise maximum of the 32-bit integer arrays lhs and rhs
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalMax(size_t size,
+                     uint32_t* dst,
+                     const uint32_t* lhs,
+                     const uint32_t* rhs);
+    void InternalMax(size_t size,
+                     int32_t* dst,
+                     const int32_t* lhs,
+                     const int32_t* rhs);
+
+    ///
+    /// \brief Element-wise bitwise AND of the 32-bit integer arrays lhs and rhs
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalAnd(size_t size,
+                     uint32_t* dst,
+                     const uint32_t* lhs,
+                     const uint32_t* rhs);
+    void InternalAnd(size_t size,
+                     int32_t* dst,
+                     const int32_t* lhs,
+                     const int32_t* rhs);
+
+    ///
+    /// \brief Element-wise bitwise OR of the 32-bit integer arrays lhs and rhs
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalOr(size_t size,
+                    uint32_t* dst,
+                    const uint32_t* lhs,
+                    const uint32_t* rhs);
+    void InternalOr(size_t size,
+                    int32_t* dst,
+                    const int32_t* lhs,
+                    const int32_t* rhs);
+
+    ///
+    /// \brief Element-wise bitwise XOR of the 32-bit integer arrays lhs and rhs
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalXor(size_t size,
+                     uint32_t* dst,
+                     const uint32_t* lhs,
+                     const uint32_t* rhs);
+    void InternalXor(size_t size,
+                     int32_t* dst,
+                     const int32_t* lhs,
+                     const int32_t* rhs);
+
+    ///
+    /// \brief Element-wise lhs & ~rhs of the 32-bit integer arrays lhs and rhs, note that the operands are in the opposite order of vpandn
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalAndNot(size_t size,
+                        uint32_t* dst,
+                        const uint32_t* lhs,
+                        const uint32_t* rhs);
+    void InternalAndNot(size_t size,
+                        int32_t* dst,
+                        const int32_t* lhs,
+                        const int32_t* rhs);
+
+    ///
+    /// \brief Shift every element of a 32-bit integer array left by count bits, counts above 31 produce 0
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalShiftLeft(size_t size,
+                           uint32_t count,
+                           uint32_t* dst,
+                           const uint32_t* src);
+    void InternalShiftLeft(size_t size,
+                           uint32_t count,
+                           int32_t* dst,
+                           const int32_t* src);
+
+    ///
+    /// \brief Shift every element of a 32-bit integer array right by count bits. The shift is logical for uint32_t, counts above 31 produce 0, and arithmetic for int32_t, counts above 31 replicate the sign bit
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalShiftRight(size_t size,
+                            uint32_t count,
+                            uint32_t* dst,
+                            const uint32_t* src);
+    void InternalShiftRight(size_t size,
+                            uint32_t count,
+                            int32_t* dst,
+                            const int32_t* src);
+
+    ///
+    /// \brief Sum of the elements of a 32-bit integer array, wrapping around on overflow
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalSummation(size_t size,
+                           uint32_t* sum,
+                           const uint32_t* src);
+    void InternalSummation(size_t size,
+                           int32_t* sum,
+                           const int32_t* src);
+
+    ///
+    /// \brief InternalPrefixSum compute the inclusive prefix sum of src into dst, i.e., dst[i] = carry + src[0] + ... + src[i], for 32-bit integer arrays, wrapping around on overflow
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalPrefixSum(size_t size,
+                           uint32_t carry,
+                           uint32_t* dst,
+                           const uint32_t* src);
+    void InternalPrefixSum(size_t size,
+                           int32_t carry,
+                           int32_t* dst,
+                           const int32_t* src);
+
+    ///
+    /// \brief InternalExclusivePrefixSum compute the exclusive prefix sum of src into dst, i.e., dst[0] = carry and dst[i] = carry + src[0] + ... + src[i - 1], for 32-bit integer arrays, wrapping around on overflow
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalExclusivePrefixSum(size_t size,
+                                    uint32_t carry,
+                                    uint32_t* dst,
+                                    const uint32_t* src);
+    void InternalExclusivePrefixSum(size_t size,
+                                    int32_t carry,
+                                    int32_t* dst,
+                                    const int32_t* src);
+
+    ///
+    /// \brief Dot product of two 32-bit integer arrays, wrapping around on overflow
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalDotProduct(size_t size,
+                            uint32_t* product,
+                            const uint32_t* multiplier,
+                            const uint32_t* multiplicand);
+    void InternalDotProduct(size_t size,
+                            int32_t* product,
+                            const int32_t* multiplier,
+                            const int32_t* multiplicand);
+
+    ///
+    /// \brief Sum of the elements of a 32-bit integer array accumulated in 64 bits, it cannot overflow for fewer than 2^32 elements
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalWideSummation(size_t size,
+                               uint64_t* sum,
+                               const uint32_t* src);
+    void InternalWideSummation(size_t size,
+                               int64_t* sum,
+                               const int32_t* src);
+
+    ///
+    /// \brief Smallest element of a 32-bit integer array, the largest value of the type if size is 0
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalMinimum(size_t size,
+                         uint32_t* minimum,
+                         const uint32_t* src);
+    void InternalMinimum(size_t size,
+                         int32_t* minimum,
+                         const int32_t* src);
+
+    ///
+    /// \brief Largest element of a 32-bit integer array, the lowest value of the type if size is 0
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalMaximum(size_t size,
+                         uint32_t* maximum,
+                         const uint32_t* src);
+    void InternalMaximum(size_t size,
+                         int32_t* maximum,
+                         const int32_t* src);
+
+    ///
+    /// \brief Smallest and largest element of a 32-bit integer array, found in a single pass
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalMinMaximum(size_t size,
+                            Extrema<uint32_t>* extrema,
+                            const uint32_t* src);
+    void InternalMinMaximum(size_t size,
+                            Extrema<int32_t>* extrema,
+                            const int32_t* src);
+
+    ///
+    /// \brief Index of the first smallest element of a 32-bit integer array, 0 if size is 0
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const uint32_t* src);
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const int32_t* src);
+
+    ///
+    /// \brief Index of the first largest element of a 32-bit integer array, 0 if size is 0
+    /// \param size the number of elements in the array parameters
+    ///
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const uint32_t* src);
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const int32_t* src);
   }
 }
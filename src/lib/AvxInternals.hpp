@@ -14,7 +14,20 @@
 
 #pragma once
 
-#include <cstdint>
+#include "Types.hpp"
+
+// Register tile of the single-precision matrix product kernels: 6 rows of two 8-float vectors keep 12 accumulators, the two
+// vectors of the right operand and the broadcast element of the left one in the 16 YMM registers
+#define AVX_GEMM_ROWS 6
+#define AVX_GEMM_COLUMNS 16
+
+// Rows of a matrix-vector product processed per pass over the vector: four rows of two-register strides keep 8 accumulators
+#define AVX_GEMV_ROWS 4
+
+// Tile of the many-to-many dot product kernel: 4 queries x 3 vectors keep 12 accumulators and the 3 vector registers in YMM
+// registers, the queries are read straight from memory by the multiply-adds
+#define AVX_TILE_QUERIES 4
+#define AVX_TILE_VECTORS 3
 
 namespace khyber
 {
@@ -39,9 +52,21 @@ namespace khyber
     ///
     void InternalAdd(size_t size,
                      float* sum,
-                     float* augend,
+                     const float* augend,
                      const float* addend);
 
+    ///
+    /// \brief Add a scalar to every element of a single-precision array
+    /// \param size the number of elements in the array sum and src
+    /// \param addend the scalar value to add to each element of the src array
+    /// \param sum the resulting array, can be the same address as src
+    /// \param src the array to add to
+    ///
+    void InternalScalarAdd(size_t size,
+                           float addend,
+                           float* sum,
+                           const float* src);
+
     ///
     /// \brief InternalSub subtract the single-precision array subtrahend from minuend and store the result in difference
     /// \param size the number of elements in all three array parameters
@@ -51,7 +76,7 @@ namespace khyber
     ///
     void InternalSub(size_t size,
                      float* difference,
-                     float* minuend,
+                     const float* minuend,
                      const float* subtrahend);
 
     ///
@@ -64,7 +89,7 @@ namespace khyber
     ///
     void InternalMul(size_t size,
                      float* product,
-                     float* multiplier,
+                     const float* multiplier,
                      const float* multiplicand);
 
     ///
@@ -77,7 +102,7 @@ namespace khyber
     void InternalScalarMul(size_t size,
                            float multiplier,
                            float* product,
-                           float* src);
+                           const float* src);
 
     ///
     /// \brief InternalDiv divide the single-precision array dividend by divisor and store the results in quotient
@@ -88,7 +113,7 @@ namespace khyber
     ///
     void InternalDiv(size_t size,
                      float* quotient,
-                     float* dividend,
+                     const float* dividend,
                      const float* divisor);
 
     ///
@@ -101,7 +126,7 @@ namespace khyber
     void InternalScalarDiv(size_t size,
                            float divisor,
                            float* quotient,
-                           float* src);
+                           const float* src);
 
     ///
     /// \brief InternalSqrt compute the square root of every element in the single-precision array src and store the results in dst
@@ -111,7 +136,7 @@ namespace khyber
     ///
     void InternalSqrt(size_t size,
                       float* dst,
-                      float* src);
+                      const float* src);
 
     ///
     /// \brief InternalSquare compute the square of every element in the array src and store it in the array dst
@@ -121,7 +146,7 @@ namespace khyber
     ///
     void InternalSquare(size_t size,
                         float* dst,
-                        float* src);
+                        const float* src);
 
     ///
     /// \brief Compute the cube of every element in the array src and store it in the array dst.
@@ -131,7 +156,7 @@ namespace khyber
     ///
     void InternalCube(size_t size,
                       float* dst,
-                      float* src);
+                      const float* src);
 
     ///
     /// \brief Compute the sum of all elements in the single-precision array src, the output is a scalar. Note this is not the prefix sum,
@@ -145,14 +170,51 @@ namespace khyber
                            const float* src);
 
     ///
-    /// \brief InternalPrefixSum compute the prefix sum (each element is the cumulative sum of all elements up to and including it) of the src array and store it in dst
-    /// \param size
-    /// \param dst
-    /// \param src
+    /// \brief InternalCompensatedSummation spread the single-precision array src over COMPENSATED_LANES running sums, element i going to lane i % COMPENSATED_LANES,
+    /// and add each element with Neumaier's compensated addition. The result is bitwise identical to that of the other instruction sets.
+    /// \param size the number of elements in the array parameter
+    /// \param lanes the COMPENSATED_LANES sums followed by their COMPENSATED_LANES compensations, see \link ParallelCompensatedReduce( )\endlink
+    /// \param src the array to sum
+    ///
+    void InternalCompensatedSummation(size_t size,
+                                      float* lanes,
+                                      const float* src);
+
+    ///
+    /// \brief InternalCompensatedDotProduct like InternalCompensatedSummation, over the products multiplier[i] * multiplicand[i] of the single-precision arrays
+    /// \param size the number of elements in both array parameters
+    /// \param lanes the COMPENSATED_LANES sums followed by their COMPENSATED_LANES compensations
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalCompensatedDotProduct(size_t size,
+                                       float* lanes,
+                                       const float* multiplier,
+                                       const float* multiplicand);
+
+    ///
+    /// \brief InternalPrefixSum compute the inclusive prefix sum of src into dst, i.e., dst[i] = carry + src[0] + ... + src[i], for single-precision arrays
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
     ///
     void InternalPrefixSum(size_t size,
+                           float carry,
                            float* dst,
-                           float* src);
+                           const float* src);
+
+    ///
+    /// \brief InternalExclusivePrefixSum compute the exclusive prefix sum of src into dst, i.e., dst[0] = carry and dst[i] = carry + src[0] + ... + src[i - 1], for single-precision arrays
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalExclusivePrefixSum(size_t size,
+                                    float carry,
+                                    float* dst,
+                                    const float* src);
 
     ///
     /// \brief InternalDotProduct compute the dot product of the single-precision arrays multiplicand and multiplier, store in product
@@ -178,6 +240,142 @@ namespace khyber
                                const float* multiplier,
                                const float* multiplicand);
 
+    ///
+    /// \brief InternalGemmKernel add the product of a packed AVX_GEMM_ROWS x depth panel of a left operand and a packed depth x
+    /// AVX_GEMM_COLUMNS panel of a right operand to a block of a row-major single-precision matrix, see \link Gemm( )\endlink
+    /// \param depth the number of columns of the left panel, and of rows of the right panel
+    /// \param packedLhs the AVX_GEMM_ROWS elements of each column in turn, zero padded
+    /// \param packedRhs the AVX_GEMM_COLUMNS elements of each row in turn, zero padded, 32 byte aligned
+    /// \param product the first element of the block
+    /// \param stride the number of elements between the rows of product
+    /// \param rows the number of rows of the block, at most AVX_GEMM_ROWS
+    /// \param columns the number of columns of the block, at most AVX_GEMM_COLUMNS
+    ///
+    void InternalGemmKernel(size_t depth,
+                            const float* packedLhs,
+                            const float* packedRhs,
+                            float* product,
+                            size_t stride,
+                            size_t rows,
+                            size_t columns);
+
+    ///
+    /// \brief InternalGemmKernelFma same as \link InternalGemmKernel( )\endlink, using the FMA intrinsic
+    ///
+    void InternalGemmKernelFma(size_t depth,
+                               const float* packedLhs,
+                               const float* packedRhs,
+                               float* product,
+                               size_t stride,
+                               size_t rows,
+                               size_t columns);
+
+    ///
+    /// \brief InternalBatchDotProduct compute the dot products of count rows of a single-precision matrix with the same vector, store
+    /// in products. The rows are multiplied AVX_GEMV_ROWS at a time, so every load of vector is shared by that many rows.
+    /// \param size the number of elements in each row and in vector
+    /// \param count the number of rows, and of elements in products
+    /// \param products
+    /// \param rows the first element of the first row
+    /// \param stride the number of elements between the starts of consecutive rows
+    /// \param vector
+    ///
+    void InternalBatchDotProduct(size_t size,
+                                 size_t count,
+                                 float* products,
+                                 const float* rows,
+                                 size_t stride,
+                                 const float* vector);
+
+    ///
+    /// \brief InternalBatchDotProductFma same as \link InternalBatchDotProduct( )\endlink, using the FMA intrinsic
+    ///
+    void InternalBatchDotProductFma(size_t size,
+                                    size_t count,
+                                    float* products,
+                                    const float* rows,
+                                    size_t stride,
+                                    const float* vector);
+
+    ///
+    /// \brief InternalBatchMulAdd add scalars[r] times row r, for the count rows of a single-precision matrix, to dst. The rows are
+    /// added AVX_GEMV_ROWS at a time, so every element of dst is loaded and stored once per that many rows.
+    /// \param size the number of elements in each row and in dst
+    /// \param count the number of rows, and of elements in scalars
+    /// \param dst
+    /// \param rows the first element of the first row
+    /// \param stride the number of elements between the starts of consecutive rows
+    /// \param scalars
+    ///
+    void InternalBatchMulAdd(size_t size,
+                             size_t count,
+                             float* dst,
+                             const float* rows,
+                             size_t stride,
+                             const float* scalars);
+
+    ///
+    /// \brief InternalBatchMulAddFma same as \link InternalBatchMulAdd( )\endlink, using the FMA intrinsic
+    ///
+    void InternalBatchMulAddFma(size_t size,
+                                size_t count,
+                                float* dst,
+                                const float* rows,
+                                size_t stride,
+                                const float* scalars);
+
+    ///
+    /// \brief InternalDotProductTile compute the dot product of every one of queryCount single-precision queries with every one of
+    /// vectorCount vectors, store the dot product of query q and vector v in scores[q * scoreStride + v]. AVX_TILE_QUERIES queries
+    /// are multiplied by AVX_TILE_VECTORS vectors at a time, so every load is shared by three or four dot products.
+    /// \param size the number of elements in each query and each vector
+    /// \param queryCount
+    /// \param vectorCount
+    /// \param scores
+    /// \param scoreStride the number of elements between the scores of consecutive queries
+    /// \param queries the first element of the first query
+    /// \param queryStride the number of elements between the starts of consecutive queries
+    /// \param vectors the first element of the first vector
+    /// \param vectorStride the number of elements between the starts of consecutive vectors
+    ///
+    void InternalDotProductTile(size_t size,
+                                size_t queryCount,
+                                size_t vectorCount,
+                                float* scores,
+                                size_t scoreStride,
+                                const float* queries,
+                                size_t queryStride,
+                                const float* vectors,
+                                size_t vectorStride);
+
+    ///
+    /// \brief InternalDotProductTileFma same as \link InternalDotProductTile( )\endlink, using the FMA intrinsic
+    ///
+    void InternalDotProductTileFma(size_t size,
+                                   size_t queryCount,
+                                   size_t vectorCount,
+                                   float* scores,
+                                   size_t scoreStride,
+                                   const float* queries,
+                                   size_t queryStride,
+                                   const float* vectors,
+                                   size_t vectorStride);
+
+    ///
+    /// \brief InternalSelectBelow store the indices of the elements of src smaller than threshold in indices, in increasing order.
+    /// Eight elements are compared at a time and only the ones that pass are looked at individually. NaN elements are never selected.
+    /// \param size the number of elements in src
+    /// \param threshold
+    /// \param count pointer to the number of indices stored
+    /// \param indices at least size elements
+    /// \param src
+    ///
+    void InternalSelectBelow(size_t size,
+                             float threshold,
+                             size_t* count,
+                             uint32_t* indices,
+                             const float* src);
+
     ///
     /// \brief Change the sign of every element in src and store the result in dst
     /// \param size the number of elements in both array parameters
@@ -186,7 +384,7 @@ namespace khyber
     ///
     void InternalNegate(size_t size,
                         float* dst,
-                        float* src);
+                        const float* src);
 
     ///
     /// \brief Compute the linear (geometric) distance between the two vectors, store in distance
@@ -201,13 +399,534 @@ namespace khyber
                           const float* v2);
 
     ///
-    /// \brief Compute the reciprocal of every element in the src array and store it in the dst array
+    /// \brief Compute the linear (geometric) distance between the two vectors using the FMA intrinsic, store in distance
+    /// \param size the number of elements in both array parameters
+    /// \param distance pointer to a scalar single-precision floating point into which the distance will be output
+    /// \param v1 array representing 1st point in size()-dimensional space
+    /// \param v2 array representing 2nd point in size()-dimensional space
+    ///
+    void InternalDistanceFma(size_t size,
+                             float* distance,
+                             const float* v1,
+                             const float* v2);
+
+    ///
+    /// \brief Compute the reciprocal of every element in the src array by exact division and store it in the dst array
     /// \param size the number of elements in both array parameters
     /// \param dst destination array
     /// \param src source array
     ///
     void InternalReciprocate(size_t size,
                              float* dst,
-                             float* src);
+                             const float* src);
+
+    ///
+    /// \brief InternalMinimum find the smallest element of the single-precision array src, or NaN if src contains any NaN
+    /// \param size the number of elements in the array parameter
+    /// \param minimum pointer to the scalar into which the minimum is output, the largest finite value if size is 0
+    /// \param src the array to search
+    ///
+    void InternalMinimum(size_t size,
+                         float* minimum,
+                         const float* src);
+
+    ///
+    /// \brief InternalMaximum find the largest element of the single-precision array src, or NaN if src contains any NaN
+    /// \param size the number of elements in the array parameter
+    /// \param maximum pointer to the scalar into which the maximum is output, the lowest finite value if size is 0
+    /// \param src the array to search
+    ///
+    void InternalMaximum(size_t size,
+                         float* maximum,
+                         const float* src);
+
+    ///
+    /// \brief InternalMinMaximum find both the smallest and the largest element of the single-precision array src in a single pass, see InternalMinimum and InternalMaximum
+    /// \param size the number of elements in the array parameter
+    /// \param extrema pointer to the pair into which the minimum and maximum are output
+    /// \param src the array to search
+    ///
+    void InternalMinMaximum(size_t size,
+                            Extrema<float>* extrema,
+                            const float* src);
+
+    ///
+    /// \brief InternalArgMinimum find the index of the first smallest element of the single-precision array src, or of its first NaN if it contains any
+    /// \param size the number of elements in the array parameter
+    /// \param index pointer to the scalar into which the index is output, 0 if size is 0
+    /// \param src the array to search
+    ///
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const float* src);
+
+    ///
+    /// \brief InternalArgMaximum find the index of the first largest element of the single-precision array src, or of its first NaN if it contains any
+    /// \param size the number of elements in the array parameter
+    /// \param index pointer to the scalar into which the index is output, 0 if size is 0
+    /// \param src the array to search
+    ///
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const float* src);
+
+    ///
+    /// \brief InternalExp compute e^x of every element in the single-precision array src and store it in dst. The error is at most 1 ulp, results
+    /// overflow to infinity above 88.72 and are denormal below -87.33 where they lose precision gradually.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalExp(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalLog compute the natural logarithm of every element in the single-precision array src and store it in dst. The error is at most 1 ulp,
+    /// log(0) is -infinity and the logarithm of a negative number is NaN.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalLog(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalLog2 compute the base-2 logarithm of every element in the single-precision array src and store it in dst. The error is at most 1.5 ulp,
+    /// the special values are those of \link InternalLog( )\endlink.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalLog2(size_t size,
+                      float* dst,
+                      const float* src);
+
+    ///
+    /// \brief InternalSin compute the sine of every element in the single-precision array src and store it in dst. The error is at most 1.6 ulp over [-pi, pi],
+    /// beyond that the absolute error stays below 2^-23 up to |x| = 8192 and grows slowly for larger arguments.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalSin(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalCos compute the cosine of every element in the single-precision array src and store it in dst, with the same error bounds as
+    /// \link InternalSin( )\endlink
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalCos(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalTanh compute the hyperbolic tangent of every element in the single-precision array src and store it in dst. The error is at most 1.4 ulp.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalTanh(size_t size,
+                      float* dst,
+                      const float* src);
+
+    ///
+    /// \brief InternalSigmoid compute the logistic function 1 / (1 + e^-x) of every element in the single-precision array src and store it in dst.
+    /// The error is at most 2.5 ulp.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalSigmoid(size_t size,
+                         float* dst,
+                         const float* src);
+
+    ///
+    /// \brief InternalPow raise every element of the single-precision array base to the power of the matching element of exponent and store it in dst.
+    /// It is computed as 2^(exponent * log2(base)), so the error grows with the magnitude of the result's binary exponent: about 1 + 1.2 * |exponent * log2(base)| ulp,
+    /// e.g. 7 ulp for results between 2^-5 and 2^5. The special values are those of std::pow.
+    /// \param size the number of elements in all three array parameters
+    /// \param dst the resulting array, can be the same address as base or exponent
+    /// \param base
+    /// \param exponent
+    ///
+    void InternalPow(size_t size,
+                     float* dst,
+                     const float* base,
+                     const float* exponent);
+
+    ///
+    /// \brief InternalApproximateReciprocate compute the reciprocal of every element in the single-precision array src with rcpps and store it in dst.
+    /// The relative error is at most 1.5*2^-12. Inputs whose reciprocal leaves the normal range, denormals included, give +/-infinity or 0.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalApproximateReciprocate(size_t size,
+                                        float* dst,
+                                        const float* src);
+
+    ///
+    /// \brief InternalRefinedReciprocate compute the reciprocal of every element in the single-precision array src with rcpps followed by one
+    /// Newton-Raphson step and store it in dst. The relative error is at most 1.7*2^-23, the special values are those of \link InternalApproximateReciprocate( )\endlink.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalRefinedReciprocate(size_t size,
+                                    float* dst,
+                                    const float* src);
+
+    ///
+    /// \brief InternalRsqrt compute the reciprocal square root 1 / sqrt(x) of every element in the single-precision array src by exact square root
+    /// and division and store it in dst. The relative error is at most 0.75*2^-23.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalRsqrt(size_t size,
+                       float* dst,
+                       const float* src);
+
+    ///
+    /// \brief InternalApproximateRsqrt compute the reciprocal square root of every element in the single-precision array src with rsqrtps and store it in dst.
+    /// The relative error is at most 1.5*2^-12. Denormal inputs give +infinity.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalApproximateRsqrt(size_t size,
+                                  float* dst,
+                                  const float* src);
+
+    ///
+    /// \brief InternalRefinedRsqrt compute the reciprocal square root of every element in the single-precision array src with rsqrtps followed by one
+    /// Newton-Raphson step and store it in dst. The relative error is at most 2.3*2^-23, the special values are those of \link InternalApproximateRsqrt( )\endlink.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalRefinedRsqrt(size_t size,
+                              float* dst,
+                              const float* src);
+
+    ///////////////////////////// Double-precision ////////////////////////////
+
+    ///
+    /// \brief InternalAdd add the two double-precision floating point arrays augend and addend into sum
+    /// \param size the number of elements in all three array parameters
+    /// \param sum
+    /// \param augend
+    /// \param addend
+    ///
+    void InternalAdd(size_t size,
+                     double* sum,
+                     const double* augend,
+                     const double* addend);
+
+    ///
+    /// \brief Add a scalar to every element of a double-precision array
+    /// \param size the number of elements in the array sum and src
+    /// \param addend the scalar value to add to each element of the src array
+    /// \param sum the resulting array, can be the same address as src
+    /// \param src the array to add to
+    ///
+    void InternalScalarAdd(size_t size,
+                           double addend,
+                           double* sum,
+                           const double* src);
+
+    ///
+    /// \brief InternalSub subtract the double-precision array subtrahend from minuend and store the result in difference
+    /// \param size the number of elements in all three array parameters
+    /// \param difference
+    /// \param minuend
+    /// \param subtrahend
+    ///
+    void InternalSub(size_t size,
+                     double* difference,
+                     const double* minuend,
+                     const double* subtrahend);
+
+    ///
+    /// \brief InternalMul multiply the double-precision arrays multiplicand and multiplier and store the result in product. This can be considered
+    /// the classical cross product of two vectors
+    /// \param size the number of elements in all three array parameters
+    /// \param product
+    /// \param multiplicand
+    /// \param multiplier
+    ///
+    void InternalMul(size_t size,
+                     double* product,
+                     const double* multiplier,
+                     const double* multiplicand);
+
+    ///
+    /// \brief Multiply a double-precision array by a scalar
+    /// \param size the number of elements in the array product and src
+    /// \param multiplier the scalar value by which to multiply the src array
+    /// \param product the resulting array, can be the same address as src
+    /// \param src the array to multiply
+    ///
+    void InternalScalarMul(size_t size,
+                           double multiplier,
+                           double* product,
+                           const double* src);
+
+    ///
+    /// \brief InternalDiv divide the double-precision array dividend by divisor and store the results in quotient
+    /// \param size the number of elements in all three array parameters
+    /// \param quotient
+    /// \param dividend
+    /// \param divisor
+    ///
+    void InternalDiv(size_t size,
+                     double* quotient,
+                     const double* dividend,
+                     const double* divisor);
+
+    ///
+    /// \brief Divide a double-precision array by a scalar
+    /// \param size the number of elements in the array quotient and src
+    /// \param divisor the scalar value by which to divide the src array
+    /// \param quotient the output array, can be the same address as src
+    /// \param src the array to divide
+    ///
+    void InternalScalarDiv(size_t size,
+                           double divisor,
+                           double* quotient,
+                           const double* src);
+
+    ///
+    /// \brief InternalSqrt compute the square root of every element in the double-precision array src and store the results in dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalSqrt(size_t size,
+                      double* dst,
+                      const double* src);
+
+    ///
+    /// \brief InternalSquare compute the square of every element in the array src and store it in the array dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalSquare(size_t size,
+                        double* dst,
+                        const double* src);
+
+    ///
+    /// \brief Compute the cube of every element in the array src and store it in the array dst.
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalCube(size_t size,
+                      double* dst,
+                      const double* src);
+
+    ///
+    /// \brief Compute the sum of all elements in the double-precision array src, the output is a scalar. Note this is not the prefix sum,
+    /// the src array remains unchanged.
+    /// \param size the number of elements in both array parameters
+    /// \param sum
+    /// \param src
+    ///
+    void InternalSummation(size_t size,
+                           double* sum,
+                           const double* src);
+
+    ///
+    /// \brief InternalCompensatedSummation spread the double-precision array src over COMPENSATED_LANES running sums, element i going to lane i % COMPENSATED_LANES,
+    /// and add each element with Neumaier's compensated addition. The result is bitwise identical to that of the other instruction sets.
+    /// \param size the number of elements in the array parameter
+    /// \param lanes the COMPENSATED_LANES sums followed by their COMPENSATED_LANES compensations, see \link ParallelCompensatedReduce( )\endlink
+    /// \param src the array to sum
+    ///
+    void InternalCompensatedSummation(size_t size,
+                                      double* lanes,
+                                      const double* src);
+
+    ///
+    /// \brief InternalCompensatedDotProduct like InternalCompensatedSummation, over the products multiplier[i] * multiplicand[i] of the double-precision arrays
+    /// \param size the number of elements in both array parameters
+    /// \param lanes the COMPENSATED_LANES sums followed by their COMPENSATED_LANES compensations
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalCompensatedDotProduct(size_t size,
+                                       double* lanes,
+                                       const double* multiplier,
+                                       const double* multiplicand);
+
+    ///
+    /// \brief InternalPrefixSum compute the inclusive prefix sum of src into dst, i.e., dst[i] = carry + src[0] + ... + src[i], for double-precision arrays
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalPrefixSum(size_t size,
+                           double carry,
+                           double* dst,
+                           const double* src);
+
+    ///
+    /// \brief InternalExclusivePrefixSum compute the exclusive prefix sum of src into dst, i.e., dst[0] = carry and dst[i] = carry + src[0] + ... + src[i - 1], for double-precision arrays
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalExclusivePrefixSum(size_t size,
+                                    double carry,
+                                    double* dst,
+                                    const double* src);
+
+    ///
+    /// \brief InternalDotProduct compute the dot product of the double-precision arrays multiplicand and multiplier, store in product
+    /// \param size the number of elements in both array parameters
+    /// \param product pointer to a scalar double-precision double into which the dot product will be output
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalDotProduct(size_t size,
+                            double* product,
+                            const double* multiplier,
+                            const double* multiplicand);
+
+    ///
+    /// \brief InternalDotProductFma compute the dot product of the double-precision arrays multiplicand and multiplier using the FMA intrinsic, store in product
+    /// \param size the number of elements in both array parameters
+    /// \param product pointer to a scalar double-precision double into which the dot product will be output
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalDotProductFma(size_t size,
+                               double* product,
+                               const double* multiplier,
+                               const double* multiplicand);
+
+    ///
+    /// \brief Change the sign of every element in src and store the result in dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalNegate(size_t size,
+                        double* dst,
+                        const double* src);
+
+    ///
+    /// \brief Compute the linear (geometric) distance between the two vectors, store in distance
+    /// \param size the number of elements in both array parameters
+    /// \param distance pointer to a scalar double-precision floating point into which the distance will be output
+    /// \param v1 array representing 1st point in size()-dimensional space
+    /// \param v2 array representing 2nd point in size()-dimensional space
+    ///
+    void InternalDistance(size_t size,
+                          double* distance,
+                          const double* v1,
+                          const double* v2);
+
+    ///
+    /// \brief Compute the linear (geometric) distance between the two vectors using the FMA intrinsic, store in distance
+    /// \param size the number of elements in both array parameters
+    /// \param distance pointer to a scalar double-precision floating point into which the distance will be output
+    /// \param v1 array representing 1st point in size()-dimensional space
+    /// \param v2 array representing 2nd point in size()-dimensional space
+    ///
+    void InternalDistanceFma(size_t size,
+                             double* distance,
+                             const double* v1,
+                             const double* v2);
+
+    ///
+    /// \brief Compute the reciprocal of every element in the src array and store it in the dst array
+    /// \param size the number of elements in both array parameters
+    /// \param dst destination array
+    /// \param src source array
+    ///
+    void InternalReciprocate(size_t size,
+                             double* dst,
+                             const double* src);
+
+    ///
+    /// \brief Compute the reciprocal square root 1 / sqrt(x) of every element in the src array and store it in the dst array
+    /// \param size the number of elements in both array parameters
+    /// \param dst destination array
+    /// \param src source array
+    ///
+    void InternalRsqrt(size_t size,
+                       double* dst,
+                       const double* src);
+
+    ///
+    /// \brief InternalMinimum find the smallest element of the double-precision array src, or NaN if src contains any NaN
+    /// \param size the number of elements in the array parameter
+    /// \param minimum pointer to the scalar into which the minimum is output, the largest finite value if size is 0
+    /// \param src the array to search
+    ///
+    void InternalMinimum(size_t size,
+                         double* minimum,
+                         const double* src);
+
+    ///
+    /// \brief InternalMaximum find the largest element of the double-precision array src, or NaN if src contains any NaN
+    /// \param size the number of elements in the array parameter
+    /// \param maximum pointer to the scalar into which the maximum is output, the lowest finite value if size is 0
+    /// \param src the array to search
+    ///
+    void InternalMaximum(size_t size,
+                         double* maximum,
+                         const double* src);
+
+    ///
+    /// \brief InternalMinMaximum find both the smallest and the largest element of the double-precision array src in a single pass, see InternalMinimum and InternalMaximum
+    /// \param size the number of elements in the array parameter
+    /// \param extrema pointer to the pair into which the minimum and maximum are output
+    /// \param src the array to search
+    ///
+    void InternalMinMaximum(size_t size,
+                            Extrema<double>* extrema,
+                            const double* src);
+
+    ///
+    /// \brief InternalArgMinimum find the index of the first smallest element of the double-precision array src, or of its first NaN if it contains any
+    /// \param size the number of elements in the array parameter
+    /// \param index pointer to the scalar into which the index is output, 0 if size is 0
+    /// \param src the array to search
+    ///
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const double* src);
+
+    ///
+    /// \brief InternalArgMaximum find the index of the first largest element of the double-precision array src, or of its first NaN if it contains any
+    /// \param size the number of elements in the array parameter
+    /// \param index pointer to the scalar into which the index is output, 0 if size is 0
+    /// \param src the array to search
+    ///
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const double* src);
+
+    ///
+    /// \brief InternalStreamingCopy copy bytes bytes from src to dst with non-temporal stores, which write around the caches instead of
+    /// evicting their contents. The stores are weakly ordered: the caller must issue an sfence before another thread reads dst.
+    /// \param bytes the number of bytes to copy
+    /// \param dst the destination, any alignment, the bytes before its first 32 byte boundary are stored normally
+    /// \param src the source, any alignment, must not overlap dst
+    ///
+    void InternalStreamingCopy(size_t bytes,
+                               void* dst,
+                               const void* src);
   }
 }
@@ -0,0 +1,196 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <cstring>
+#include <xmmintrin.h>
+#include "BufferPool.hpp"
+
+// The smallest size class, classes below it would waste more on bookkeeping than they save
+#define POOL_MIN_BLOCK_BYTES 64
+
+// Four classes for each power of two from POOL_MIN_BLOCK_BYTES to POOL_MAX_BLOCK_BYTES
+#define POOL_CLASS_COUNT (4 * 22 + 1)
+
+namespace khyber
+{
+  static std::atomic<size_t> s_cacheLimit(DEFAULT_POOL_CACHE_BYTES);
+
+  static size_t HighestBit(size_t value)
+  {
+    return 63 - __builtin_clzll(value);
+  }
+
+  ///
+  /// \brief Rounds bytes up to its size class: 64, 80, 96, 112, 128, 160, ... and returns the index of that class
+  ///
+  static size_t SizeClass(size_t bytes, size_t& classBytes)
+  {
+    if ( bytes <= POOL_MIN_BLOCK_BYTES ) {
+      classBytes = POOL_MIN_BLOCK_BYTES;
+      return 0;
+    }
+    size_t highest = HighestBit(bytes - 1);
+    size_t step = (size_t)1 << (highest - 2);
+    classBytes = (bytes + step - 1) & ~(step - 1);
+    return (highest - HighestBit(POOL_MIN_BLOCK_BYTES)) * 4 + (classBytes >> (highest - 2)) - 4;
+  }
+
+  static bool Poolable(size_t bytes, size_t alignment)
+  {
+    return bytes > 0 && bytes <= POOL_MAX_BLOCK_BYTES && alignment <= POOL_BLOCK_ALIGNMENT;
+  }
+
+  static thread_local bool t_cacheDestroyed = false;
+
+  ///
+  /// \brief The free lists of one thread, linked through the first bytes of each free block
+  ///
+  struct ThreadCache
+  {
+    void* freeLists[POOL_CLASS_COUNT];
+    BufferPoolStatistics statistics;
+
+    ThreadCache()
+    {
+      memset(freeLists, 0, sizeof(freeLists));
+      memset(&statistics, 0, sizeof(statistics));
+    }
+
+    ~ThreadCache()
+    {
+      Trim();
+      t_cacheDestroyed = true;
+    }
+
+    void Trim()
+    {
+      for ( size_t i = 0; i < POOL_CLASS_COUNT; ++i ) {
+        while ( freeLists[i] != nullptr ) {
+          void* block = freeLists[i];
+          freeLists[i] = *(void**)block;
+          _mm_free(block);
+        }
+      }
+      statistics.cachedBytes = 0;
+    }
+  };
+
+  ///
+  /// \brief Returns the cache of the calling thread, or nullptr once it has been destroyed at thread exit, e.g., for static
+  /// arrays destroyed after the thread-local objects of the main thread
+  ///
+  static ThreadCache* LocalCache()
+  {
+    if ( t_cacheDestroyed ) {
+      return nullptr;
+    }
+    static thread_local ThreadCache cache;
+    return &cache;
+  }
+
+  void* BufferPool::Allocate(size_t bytes, size_t alignment)
+  {
+    if ( !Poolable(bytes, alignment) ) {
+      return _mm_malloc(bytes, alignment);
+    }
+    // A poolable block is always a whole size class, even without a cache, as another thread may put it on a free list
+    size_t classBytes;
+    size_t index = SizeClass(bytes, classBytes);
+    ThreadCache* cache = LocalCache();
+    if ( cache == nullptr ) {
+      return _mm_malloc(classBytes, POOL_BLOCK_ALIGNMENT);
+    }
+    ++cache->statistics.allocations;
+    void* block = cache->freeLists[index];
+    if ( block != nullptr ) {
+      cache->freeLists[index] = *(void**)block;
+      cache->statistics.cachedBytes -= classBytes;
+      ++cache->statistics.hits;
+      return block;
+    }
+    return _mm_malloc(classBytes, POOL_BLOCK_ALIGNMENT);
+  }
+
+  void BufferPool::Release(void* block, size_t bytes, size_t alignment)
+  {
+    if ( block == nullptr ) {
+      return;
+    }
+    ThreadCache* cache = LocalCache();
+    if ( cache == nullptr || !Poolable(bytes, alignment) ) {
+      if ( cache != nullptr ) {
+        ++cache->statistics.releases;
+        ++cache->statistics.systemReleases;
+      }
+      _mm_free(block);
+      return;
+    }
+    BufferPoolStatistics& statistics = cache->statistics;
+    ++statistics.releases;
+    size_t classBytes;
+    size_t index = SizeClass(bytes, classBytes);
+    if ( statistics.cachedBytes + classBytes > s_cacheLimit.load(std::memory_order_relaxed) ) {
+      ++statistics.systemReleases;
+      _mm_free(block);
+      return;
+    }
+    *(void**)block = cache->freeLists[index];
+    cache->freeLists[index] = block;
+    statistics.cachedBytes += classBytes;
+    if ( statistics.cachedBytes > statistics.peakCachedBytes ) {
+      statistics.peakCachedBytes = statistics.cachedBytes;
+    }
+  }
+
+  size_t BufferPool::GetCacheLimit()
+  {
+    return s_cacheLimit.load(std::memory_order_relaxed);
+  }
+
+  void BufferPool::SetCacheLimit(size_t bytes)
+  {
+    s_cacheLimit.store(bytes, std::memory_order_relaxed);
+  }
+
+  void BufferPool::Trim()
+  {
+    ThreadCache* cache = LocalCache();
+    if ( cache != nullptr ) {
+      cache->Trim();
+    }
+  }
+
+  BufferPoolStatistics BufferPool::Statistics()
+  {
+    ThreadCache* cache = LocalCache();
+    if ( cache == nullptr ) {
+      BufferPoolStatistics none;
+      memset(&none, 0, sizeof(none));
+      return none;
+    }
+    return cache->statistics;
+  }
+
+  void BufferPool::ResetStatistics()
+  {
+    ThreadCache* cache = LocalCache();
+    if ( cache != nullptr ) {
+      size_t cachedBytes = cache->statistics.cachedBytes;
+      memset(&cache->statistics, 0, sizeof(cache->statistics));
+      cache->statistics.cachedBytes = cachedBytes;
+      cache->statistics.peakCachedBytes = cachedBytes;
+    }
+  }
+}
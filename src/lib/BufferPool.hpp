@@ -0,0 +1,92 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Every pooled block is aligned to a cache line, which covers the alignment of all SIMD types
+#define POOL_BLOCK_ALIGNMENT 64
+
+// Blocks larger than this bypass the pool, the cost of their page faults dwarfs the allocation
+#define POOL_MAX_BLOCK_BYTES (256 << 20)
+
+// Default number of free bytes each thread keeps for reuse
+#define DEFAULT_POOL_CACHE_BYTES (64 << 20)
+
+namespace khyber
+{
+  ///
+  /// \brief Allocation counters of the calling thread, see \link BufferPool::Statistics( )\endlink
+  ///
+  struct BufferPoolStatistics
+  {
+    uint64_t allocations;    // blocks handed out, from the cache or not
+    uint64_t hits;           // allocations served from the cache
+    uint64_t releases;       // blocks given back
+    uint64_t systemReleases; // released blocks freed because the cache was full, or too large to pool
+    size_t cachedBytes;      // free bytes the cache holds now
+    size_t peakCachedBytes;  // the most free bytes the cache has held
+  };
+
+  ///
+  /// \brief Thread-local cache of free aligned blocks, the default allocation policy of \link SimdAllocator\endlink.
+  /// \details Requests are rounded up to a size class, four classes for each power of two so at most a quarter of a block is
+  /// wasted, and a released block goes onto the free list of its class on the releasing thread instead of back to the
+  /// system. A loop that creates and destroys temporaries of the same size therefore allocates memory only once. Each thread
+  /// caches at most the cache limit in free bytes, blocks released beyond it, or larger than POOL_MAX_BLOCK_BYTES, are freed
+  /// at once. A thread's cache is freed when the thread exits.
+  ///
+  class BufferPool
+  {
+  public:
+    ///
+    /// \brief Allocates bytes aligned to alignment
+    /// \return the block, or nullptr if the system is out of memory
+    ///
+    static void* Allocate(size_t bytes, size_t alignment);
+
+    ///
+    /// \brief Gives back a block returned by \link Allocate( )\endlink, with the same bytes and alignment. Any thread may release it.
+    ///
+    static void Release(void* block, size_t bytes, size_t alignment);
+
+    ///
+    /// \brief Returns the number of free bytes each thread may cache
+    ///
+    static size_t GetCacheLimit();
+
+    ///
+    /// \brief Sets the number of free bytes each thread may cache, 0 disables pooling. A thread already holding more
+    /// frees the excess as it releases blocks, or at once through \link Trim( )\endlink.
+    ///
+    static void SetCacheLimit(size_t bytes);
+
+    ///
+    /// \brief Frees every block cached by the calling thread
+    ///
+    static void Trim();
+
+    ///
+    /// \brief Returns the counters of the calling thread
+    ///
+    static BufferPoolStatistics Statistics();
+
+    ///
+    /// \brief Zeroes the counters of the calling thread, except cachedBytes
+    ///
+    static void ResetStatistics();
+  };
+}
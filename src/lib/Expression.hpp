@@ -0,0 +1,478 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include "ArchBinding.hpp"
+#include "Parallel.hpp"
+
+#define EXPRESSION_TILE_SIZE 512
+
+namespace khyber
+{
+  template<typename T>
+  class Array;
+
+  ///
+  /// \brief Base class of all lazily evaluated element-wise expressions over \link Array<T>\endlink objects
+  /// \details Expressions are built by the arithmetic operators (+, -, *, /), unary minus and sqrt( ) when one of the operands is an
+  /// Array<T> or another expression, the other operand can also be a scalar. Nothing is computed until the expression is assigned to an
+  /// Array<T>; the whole tree is then evaluated in a single pass over memory, EXPRESSION_TILE_SIZE elements at a time. Each node of the
+  /// tree runs the kernel of the process-wide \link ArchBinding<T>\endlink on its tile, so the intermediate results stay in the L1 cache
+  /// and no temporary Array<T> is allocated, i.e., d = sqrt((a + b) * c - 1) reads a, b and c once and writes d once.
+  ///
+  /// An expression refers to the buffers of its Array<T> operands, it must not outlive them.
+  ///
+  template<typename E>
+  struct Expression
+  {
+    const E& Self() const
+    {
+      return static_cast<const E&>(*this);
+    }
+  };
+
+  ///
+  /// \brief Leaf of an expression tree, refers to the buffer of an Array<T>
+  ///
+  template<typename T>
+  class ArrayTerminal : public Expression<ArrayTerminal<T> >
+  {
+  public:
+    typedef T value_type;
+
+    ArrayTerminal(const T* data, size_t size) : _data(data), _size(size)
+    {
+    }
+
+    size_t size() const
+    {
+      return _size;
+    }
+
+    bool Aliases(const T* dst) const
+    {
+      return _data == dst;
+    }
+
+    const T* Evaluate(const ArchBinding<T>&, size_t offset, size_t, T*) const
+    {
+      return _data + offset;
+    }
+
+  private:
+    const T* _data;
+    size_t _size;
+  };
+
+  ///
+  /// \brief Node applying the element-wise operation Op to the results of the expressions L and R
+  ///
+  template<typename Op, typename L, typename R>
+  class BinaryExpression : public Expression<BinaryExpression<Op, L, R> >
+  {
+  public:
+    typedef typename L::value_type value_type;
+
+    BinaryExpression(const L& lhs, const R& rhs) : _lhs(lhs), _rhs(rhs)
+    {
+    }
+
+    size_t size() const
+    {
+      return _lhs.size();
+    }
+
+    bool Aliases(const value_type* dst) const
+    {
+      return _lhs.Aliases(dst) || _rhs.Aliases(dst);
+    }
+
+    const value_type* Evaluate(const ArchBinding<value_type>& binding,
+                               size_t offset,
+                               size_t count,
+                               value_type* out) const
+    {
+      // The right operand gets its own tile, the left one is computed in place in out
+      alignas(32) value_type rhsTile[EXPRESSION_TILE_SIZE];
+      const value_type* rhs = _rhs.Evaluate(binding, offset, count, rhsTile);
+      const value_type* lhs = _lhs.Evaluate(binding, offset, count, out);
+      Op::Apply(binding, count, out, lhs, rhs);
+      return out;
+    }
+
+  private:
+    L _lhs;
+    R _rhs;
+  };
+
+  ///
+  /// \brief Node applying the element-wise operation Op between the result of the expression E and a scalar. If ScalarFirst is true the
+  /// scalar is the left operand, e.g., 1 / a, otherwise it is the right one, e.g., a / 2.
+  ///
+  template<typename Op, typename E, bool ScalarFirst>
+  class ScalarExpression : public Expression<ScalarExpression<Op, E, ScalarFirst> >
+  {
+  public:
+    typedef typename E::value_type value_type;
+
+    ScalarExpression(const E& expression, value_type scalar) : _expression(expression), _scalar(scalar)
+    {
+    }
+
+    size_t size() const
+    {
+      return _expression.size();
+    }
+
+    bool Aliases(const value_type* dst) const
+    {
+      return _expression.Aliases(dst);
+    }
+
+    const value_type* Evaluate(const ArchBinding<value_type>& binding,
+                               size_t offset,
+                               size_t count,
+                               value_type* out) const
+    {
+      const value_type* src = _expression.Evaluate(binding, offset, count, out);
+      if ( ScalarFirst ) {
+        Op::ApplyScalarFirst(binding, count, out, _scalar, src);
+      } else {
+        Op::ApplyScalar(binding, count, out, src, _scalar);
+      }
+      return out;
+    }
+
+  private:
+    E _expression;
+    value_type _scalar;
+  };
+
+  ///
+  /// \brief Node applying the element-wise function Op to the result of the expression E
+  ///
+  template<typename Op, typename E>
+  class UnaryExpression : public Expression<UnaryExpression<Op, E> >
+  {
+  public:
+    typedef typename E::value_type value_type;
+
+    UnaryExpression(const E& expression) : _expression(expression)
+    {
+    }
+
+    size_t size() const
+    {
+      return _expression.size();
+    }
+
+    bool Aliases(const value_type* dst) const
+    {
+      return _expression.Aliases(dst);
+    }
+
+    const value_type* Evaluate(const ArchBinding<value_type>& binding,
+                               size_t offset,
+                               size_t count,
+                               value_type* out) const
+    {
+      const value_type* src = _expression.Evaluate(binding, offset, count, out);
+      Op::Apply(binding, count, out, src);
+      return out;
+    }
+
+  private:
+    E _expression;
+  };
+
+  ////////////////////////////// Element-wise operations //////////////////////
+
+  struct AddOp
+  {
+    template<typename T>
+    static void Apply(const ArchBinding<T>& binding, size_t count, T* out, const T* lhs, const T* rhs)
+    {
+      binding.Add(count, out, lhs, rhs);
+    }
+
+    template<typename T>
+    static void ApplyScalar(const ArchBinding<T>& binding, size_t count, T* out, const T* lhs, T rhs)
+    {
+      binding.ScalarAdd(count, rhs, out, lhs);
+    }
+
+    template<typename T>
+    static void ApplyScalarFirst(const ArchBinding<T>& binding, size_t count, T* out, T lhs, const T* rhs)
+    {
+      binding.ScalarAdd(count, lhs, out, rhs);
+    }
+  };
+
+  struct SubOp
+  {
+    template<typename T>
+    static void Apply(const ArchBinding<T>& binding, size_t count, T* out, const T* lhs, const T* rhs)
+    {
+      binding.Sub(count, out, lhs, rhs);
+    }
+
+    // x - s and s - x are computed as x + (-s) and (-x) + s, which IEEE-754 defines to be exactly the same results
+    template<typename T>
+    static void ApplyScalar(const ArchBinding<T>& binding, size_t count, T* out, const T* lhs, T rhs)
+    {
+      binding.ScalarAdd(count, -rhs, out, lhs);
+    }
+
+    template<typename T>
+    static void ApplyScalarFirst(const ArchBinding<T>& binding, size_t count, T* out, T lhs, const T* rhs)
+    {
+      binding.Negate(count, out, rhs);
+      binding.ScalarAdd(count, lhs, out, out);
+    }
+  };
+
+  struct MulOp
+  {
+    template<typename T>
+    static void Apply(const ArchBinding<T>& binding, size_t count, T* out, const T* lhs, const T* rhs)
+    {
+      binding.Mul(count, out, lhs, rhs);
+    }
+
+    template<typename T>
+    static void ApplyScalar(const ArchBinding<T>& binding, size_t count, T* out, const T* lhs, T rhs)
+    {
+      binding.ScalarMul(count, rhs, out, lhs);
+    }
+
+    template<typename T>
+    static void ApplyScalarFirst(const ArchBinding<T>& binding, size_t count, T* out, T lhs, const T* rhs)
+    {
+      binding.ScalarMul(count, lhs, out, rhs);
+    }
+  };
+
+  struct DivOp
+  {
+    template<typename T>
+    static void Apply(const ArchBinding<T>& binding, size_t count, T* out, const T* lhs, const T* rhs)
+    {
+      binding.Div(count, out, lhs, rhs);
+    }
+
+    template<typename T>
+    static void ApplyScalar(const ArchBinding<T>& binding, size_t count, T* out, const T* lhs, T rhs)
+    {
+      binding.ScalarDiv(count, rhs, out, lhs);
+    }
+
+    template<typename T>
+    static void ApplyScalarFirst(const ArchBinding<T>& binding, size_t count, T* out, T lhs, const T* rhs)
+    {
+      alignas(32) T dividend[EXPRESSION_TILE_SIZE];
+      std::fill(dividend, dividend + count, lhs);
+      binding.Div(count, out, dividend, rhs);
+    }
+  };
+
+  struct SqrtOp
+  {
+    template<typename T>
+    static void Apply(const ArchBinding<T>& binding, size_t count, T* out, const T* src)
+    {
+      binding.Sqrt(count, out, src);
+    }
+  };
+
+  struct NegateOp
+  {
+    template<typename T>
+    static void Apply(const ArchBinding<T>& binding, size_t count, T* out, const T* src)
+    {
+      binding.Negate(count, out, src);
+    }
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+
+
+
+  /////////////////////////////// Operand mapping /////////////////////////////
+
+  // Maps the type of an operator's argument to the node stored in the expression tree: an Array<T> becomes an ArrayTerminal<T>,
+  // expressions are stored as they are, anything else is not an operand and is either a scalar or rejected by SFINAE.
+  template<typename X, typename Enable = void>
+  struct OperandTraits
+  {
+    static const bool IsOperand = false;
+  };
+
+  template<typename T>
+  struct OperandTraits<Array<T>, void>
+  {
+    static const bool IsOperand = true;
+    typedef ArrayTerminal<T> node_type;
+
+    static node_type Wrap(const Array<T>& operand)
+    {
+      return node_type(operand.data(), operand.size());
+    }
+  };
+
+  template<typename E>
+  struct OperandTraits<E, typename std::enable_if<std::is_base_of<Expression<E>, E>::value>::type>
+  {
+    static const bool IsOperand = true;
+    typedef E node_type;
+
+    static const node_type& Wrap(const E& operand)
+    {
+      return operand;
+    }
+  };
+
+  template<typename Op, typename L, typename R,
+           bool LOperand = OperandTraits<L>::IsOperand,
+           bool ROperand = OperandTraits<R>::IsOperand>
+  struct BinaryResult
+  {
+  };
+
+  template<typename Op, typename L, typename R>
+  struct BinaryResult<Op, L, R, true, true>
+  {
+    typedef BinaryExpression<Op, typename OperandTraits<L>::node_type, typename OperandTraits<R>::node_type> type;
+
+    static type Make(const L& lhs, const R& rhs)
+    {
+      return type(OperandTraits<L>::Wrap(lhs), OperandTraits<R>::Wrap(rhs));
+    }
+  };
+
+  template<typename Op, typename L, typename R>
+  struct BinaryResult<Op, L, R, true, false>
+  {
+    typedef typename OperandTraits<L>::node_type node_type;
+    typedef typename std::enable_if<std::is_arithmetic<R>::value,
+                                    ScalarExpression<Op, node_type, false> >::type type;
+
+    static type Make(const L& lhs, const R& rhs)
+    {
+      return type(OperandTraits<L>::Wrap(lhs), (typename node_type::value_type)rhs);
+    }
+  };
+
+  template<typename Op, typename L, typename R>
+  struct BinaryResult<Op, L, R, false, true>
+  {
+    typedef typename OperandTraits<R>::node_type node_type;
+    typedef typename std::enable_if<std::is_arithmetic<L>::value,
+                                    ScalarExpression<Op, node_type, true> >::type type;
+
+    static type Make(const L& lhs, const R& rhs)
+    {
+      return type(OperandTraits<R>::Wrap(rhs), (typename node_type::value_type)lhs);
+    }
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+
+
+
+  ////////////////////////////////// Operators ////////////////////////////////
+
+  template<typename L, typename R>
+  typename BinaryResult<AddOp, L, R>::type operator + (const L& lhs, const R& rhs)
+  {
+    return BinaryResult<AddOp, L, R>::Make(lhs, rhs);
+  }
+
+  template<typename L, typename R>
+  typename BinaryResult<SubOp, L, R>::type operator - (const L& lhs, const R& rhs)
+  {
+    return BinaryResult<SubOp, L, R>::Make(lhs, rhs);
+  }
+
+  template<typename L, typename R>
+  typename BinaryResult<MulOp, L, R>::type operator * (const L& lhs, const R& rhs)
+  {
+    return BinaryResult<MulOp, L, R>::Make(lhs, rhs);
+  }
+
+  template<typename L, typename R>
+  typename BinaryResult<DivOp, L, R>::type operator / (const L& lhs, const R& rhs)
+  {
+    return BinaryResult<DivOp, L, R>::Make(lhs, rhs);
+  }
+
+  template<typename X>
+  typename std::enable_if<OperandTraits<X>::IsOperand,
+                          UnaryExpression<NegateOp, typename OperandTraits<X>::node_type> >::type operator - (const X& src)
+  {
+    return UnaryExpression<NegateOp, typename OperandTraits<X>::node_type>(OperandTraits<X>::Wrap(src));
+  }
+
+  ///
+  /// \brief Lazy element-wise square root of an Array<T> or an expression
+  ///
+  template<typename X>
+  typename std::enable_if<OperandTraits<X>::IsOperand,
+                          UnaryExpression<SqrtOp, typename OperandTraits<X>::node_type> >::type sqrt(const X& src)
+  {
+    return UnaryExpression<SqrtOp, typename OperandTraits<X>::node_type>(OperandTraits<X>::Wrap(src));
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+
+  ///
+  /// \brief Evaluates expression into dst, which must hold expression.size( ) elements
+  /// \param dst the destination buffer, it can also be the buffer of one of the operands, e.g., for a = a * b + c
+  /// \param expression the expression tree to evaluate
+  ///
+  template<typename T, typename E>
+  void EvaluateExpression(T* dst, const Expression<E>& expression)
+  {
+    const E& root = expression.Self();
+    const ArchBinding<T>& binding = ArchBinding<T>::Active();
+    const size_t size = root.size();
+
+    // Nodes compute in place in the tile they are handed, which may only be dst when no operand reads from it
+    const bool aliased = root.Aliases(dst);
+
+    // Large results are computed in the tile and copied out with non-temporal stores, see ParallelMap( )
+    StreamingCopyKernel streamingCopy = StreamingCopyFor<T>(size);
+
+    // Large expressions are split across the ThreadPool in whole tiles, each thread uses its own scratch tile
+    ParallelFor(size, EXPRESSION_TILE_SIZE, [&](size_t begin, size_t length) {
+      alignas(32) T tile[EXPRESSION_TILE_SIZE];
+      for ( size_t offset = begin; offset < begin + length; offset += EXPRESSION_TILE_SIZE ) {
+        size_t count = std::min<size_t>(EXPRESSION_TILE_SIZE, begin + length - offset);
+        T* out = aliased || streamingCopy ? tile : dst + offset;
+        const T* result = root.Evaluate(binding, offset, count, out);
+        if ( result != dst + offset && streamingCopy ) {
+          streamingCopy(count * sizeof(T), dst + offset, result);
+        } else if ( result != dst + offset ) {
+          memcpy(dst + offset, result, count * sizeof(T));
+        }
+      }
+      if ( streamingCopy ) {
+        _mm_sfence();
+      }
+    });
+  }
+}
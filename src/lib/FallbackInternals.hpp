@@ -0,0 +1,645 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "Types.hpp"
+
+// Register tile of the serial matrix product kernel, 4 x 8 accumulators map onto the 16 SSE registers of x86-64
+#define FALLBACK_GEMM_ROWS 4
+#define FALLBACK_GEMM_COLUMNS 8
+
+namespace khyber
+{
+  ///
+  /// \brief Serial implementations of the vector operations, used when the processor has none of the supported SIMD instruction sets.
+  ///
+  /// The functions in this namespace have the same signatures as their counterparts in the arch packages, e.g., \link avx::InternalAdd( )\endlink,
+  /// so that they can be bound into an \link ArchBinding<T>\endlink. Unlike the arch packages they are templates and safe to run on any processor.
+  ///
+  namespace fallback
+  {
+    template<typename T>
+    void InternalAdd(size_t size,
+                     T* sum,
+                     const T* augend,
+                     const T* addend)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        sum[i] = augend[i] + addend[i];
+      }
+    }
+
+    template<typename T>
+    void InternalScalarAdd(size_t size,
+                           T addend,
+                           T* sum,
+                           const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        sum[i] = src[i] + addend;
+      }
+    }
+
+    template<typename T>
+    void InternalSub(size_t size,
+                     T* difference,
+                     const T* minuend,
+                     const T* subtrahend)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        difference[i] = minuend[i] - subtrahend[i];
+      }
+    }
+
+    template<typename T>
+    void InternalMul(size_t size,
+                     T* product,
+                     const T* multiplier,
+                     const T* multiplicand)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        product[i] = multiplier[i] * multiplicand[i];
+      }
+    }
+
+    template<typename T>
+    void InternalDiv(size_t size,
+                     T* quotient,
+                     const T* dividend,
+                     const T* divisor)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        quotient[i] = dividend[i] / divisor[i];
+      }
+    }
+
+    template<typename T>
+    void InternalScalarMul(size_t size,
+                           T multiplier,
+                           T* product,
+                           const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        product[i] = src[i] * multiplier;
+      }
+    }
+
+    template<typename T>
+    void InternalScalarDiv(size_t size,
+                           T divisor,
+                           T* quotient,
+                           const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        quotient[i] = src[i] / divisor;
+      }
+    }
+
+    template<typename T>
+    void InternalSqrt(size_t size,
+                      T* dst,
+                      const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = (T)std::sqrt(src[i]);
+      }
+    }
+
+    template<typename T>
+    void InternalSquare(size_t size,
+                        T* dst,
+                        const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = src[i] * src[i];
+      }
+    }
+
+    template<typename T>
+    void InternalCube(size_t size,
+                      T* dst,
+                      const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = src[i] * src[i] * src[i];
+      }
+    }
+
+    template<typename T>
+    void InternalNegate(size_t size,
+                        T* dst,
+                        const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = -src[i];
+      }
+    }
+
+    template<typename T>
+    void InternalReciprocate(size_t size,
+                             T* dst,
+                             const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = (T)1 / src[i];
+      }
+    }
+
+    template<typename T>
+    void InternalDotProduct(size_t size,
+                            T* product,
+                            const T* multiplier,
+                            const T* multiplicand)
+    {
+      *product = 0;
+      for ( size_t i = 0; i < size; ++i ) {
+        *product += multiplier[i] * multiplicand[i];
+      }
+    }
+
+    template<typename T>
+    void InternalSummation(size_t size,
+                           T* sum,
+                           const T* src)
+    {
+      *sum = 0;
+      for ( size_t i = 0; i < size; ++i ) {
+        *sum += src[i];
+      }
+    }
+
+    // Neumaier's compensated addition, lane by lane in the same order as the SIMD kernels: element i goes to lane
+    // i % COMPENSATED_LANES and the last group is padded with zeros.
+    template<typename T>
+    void InternalCompensatedSummation(size_t size,
+                                      T* lanes,
+                                      const T* src)
+    {
+      T* compensations = lanes + COMPENSATED_LANES;
+      for ( size_t lane = 0; lane < COMPENSATED_LANES; ++lane ) {
+        lanes[lane] = compensations[lane] = 0;
+      }
+      for ( size_t i = 0; i < size; i += COMPENSATED_LANES ) {
+        for ( size_t lane = 0; lane < COMPENSATED_LANES; ++lane ) {
+          T x = i + lane < size ? src[i + lane] : 0;
+          T t = lanes[lane] + x;
+          T absSum = lanes[lane] < 0 ? -lanes[lane] : lanes[lane];
+          T absX = x < 0 ? -x : x;
+          compensations[lane] += absSum >= absX ? (lanes[lane] - t) + x : (x - t) + lanes[lane];
+          lanes[lane] = t;
+        }
+      }
+    }
+
+    template<typename T>
+    void InternalCompensatedDotProduct(size_t size,
+                                       T* lanes,
+                                       const T* multiplier,
+                                       const T* multiplicand)
+    {
+      T* compensations = lanes + COMPENSATED_LANES;
+      for ( size_t lane = 0; lane < COMPENSATED_LANES; ++lane ) {
+        lanes[lane] = compensations[lane] = 0;
+      }
+      for ( size_t i = 0; i < size; i += COMPENSATED_LANES ) {
+        for ( size_t lane = 0; lane < COMPENSATED_LANES; ++lane ) {
+          T x = i + lane < size ? multiplier[i + lane] * multiplicand[i + lane] : 0;
+          T t = lanes[lane] + x;
+          T absSum = lanes[lane] < 0 ? -lanes[lane] : lanes[lane];
+          T absX = x < 0 ? -x : x;
+          compensations[lane] += absSum >= absX ? (lanes[lane] - t) + x : (x - t) + lanes[lane];
+          lanes[lane] = t;
+        }
+      }
+    }
+
+    template<typename T>
+    void InternalPrefixSum(size_t size,
+                           T carry,
+                           T* dst,
+                           const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        carry += src[i];
+        dst[i] = carry;
+      }
+    }
+
+    template<typename T>
+    void InternalExclusivePrefixSum(size_t size,
+                                    T carry,
+                                    T* dst,
+                                    const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        T value = src[i];
+        dst[i] = carry;
+        carry += value;
+      }
+    }
+
+    template<typename T>
+    void InternalDistance(size_t size,
+                          T* distance,
+                          const T* v1,
+                          const T* v2)
+    {
+      *distance = 0;
+      for ( size_t i = 0; i < size; ++i ) {
+        *distance += (v1[i] - v2[i]) * (v1[i] - v2[i]);
+      }
+      *distance = (T)std::sqrt(*distance);
+    }
+
+    template<typename T>
+    void InternalMin(size_t size,
+                     T* dst,
+                     const T* lhs,
+                     const T* rhs)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = lhs[i] < rhs[i] ? lhs[i] : rhs[i];
+      }
+    }
+
+    template<typename T>
+    void InternalMax(size_t size,
+                     T* dst,
+                     const T* lhs,
+                     const T* rhs)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = lhs[i] > rhs[i] ? lhs[i] : rhs[i];
+      }
+    }
+
+    template<typename T>
+    void InternalAnd(size_t size,
+                     T* dst,
+                     const T* lhs,
+                     const T* rhs)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = lhs[i] & rhs[i];
+      }
+    }
+
+    template<typename T>
+    void InternalOr(size_t size,
+                    T* dst,
+                    const T* lhs,
+                    const T* rhs)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = lhs[i] | rhs[i];
+      }
+    }
+
+    template<typename T>
+    void InternalXor(size_t size,
+                     T* dst,
+                     const T* lhs,
+                     const T* rhs)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = lhs[i] ^ rhs[i];
+      }
+    }
+
+    template<typename T>
+    void InternalAndNot(size_t size,
+                        T* dst,
+                        const T* lhs,
+                        const T* rhs)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = lhs[i] & ~rhs[i];
+      }
+    }
+
+    template<typename T>
+    void InternalShiftLeft(size_t size,
+                           uint32_t count,
+                           T* dst,
+                           const T* src)
+    {
+      // Shifting by the width of the type is undefined in C++, the SIMD kernels define it as 0
+      typedef typename std::make_unsigned<T>::type U;
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = count < sizeof(T) * 8 ? (T)((U)src[i] << count) : 0;
+      }
+    }
+
+    template<typename T>
+    void InternalShiftRight(size_t size,
+                            uint32_t count,
+                            T* dst,
+                            const T* src)
+    {
+      // Logical for unsigned and arithmetic for signed types, like the SIMD kernels
+      const uint32_t bits = sizeof(T) * 8;
+      for ( size_t i = 0; i < size; ++i ) {
+        if ( count < bits ) {
+          dst[i] = src[i] >> count;
+        } else {
+          dst[i] = std::is_signed<T>::value ? src[i] >> (bits - 1) : 0;
+        }
+      }
+    }
+
+    template<typename T, typename W>
+    void InternalWideSummation(size_t size,
+                               W* sum,
+                               const T* src)
+    {
+      *sum = 0;
+      for ( size_t i = 0; i < size; ++i ) {
+        *sum += src[i];
+      }
+    }
+
+    // The extrema kernels propagate NaN: once the running extremum is NaN no comparison can replace it, and a NaN element
+    // always replaces a number. x != x only holds when x is NaN.
+    template<typename T>
+    void InternalMinimum(size_t size,
+                         T* minimum,
+                         const T* src)
+    {
+      *minimum = std::numeric_limits<T>::max();
+      for ( size_t i = 0; i < size; ++i ) {
+        *minimum = src[i] < *minimum || src[i] != src[i] ? src[i] : *minimum;
+      }
+    }
+
+    template<typename T>
+    void InternalMaximum(size_t size,
+                         T* maximum,
+                         const T* src)
+    {
+      *maximum = std::numeric_limits<T>::lowest();
+      for ( size_t i = 0; i < size; ++i ) {
+        *maximum = src[i] > *maximum || src[i] != src[i] ? src[i] : *maximum;
+      }
+    }
+
+    template<typename T>
+    void InternalMinMaximum(size_t size,
+                            Extrema<T>* extrema,
+                            const T* src)
+    {
+      extrema->minimum = std::numeric_limits<T>::max();
+      extrema->maximum = std::numeric_limits<T>::lowest();
+      for ( size_t i = 0; i < size; ++i ) {
+        extrema->minimum = src[i] < extrema->minimum || src[i] != src[i] ? src[i] : extrema->minimum;
+        extrema->maximum = src[i] > extrema->maximum || src[i] != src[i] ? src[i] : extrema->maximum;
+      }
+    }
+
+    template<typename T>
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const T* src)
+    {
+      *index = 0;
+      for ( size_t i = 0; i < size; ++i ) {
+        if ( src[i] != src[i] ) {
+          *index = i;
+          return;
+        }
+        *index = src[i] < src[*index] ? i : *index;
+      }
+    }
+
+    template<typename T>
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const T* src)
+    {
+      *index = 0;
+      for ( size_t i = 0; i < size; ++i ) {
+        if ( src[i] != src[i] ) {
+          *index = i;
+          return;
+        }
+        *index = src[i] > src[*index] ? i : *index;
+      }
+    }
+
+    // Floating point element types only, bound in place of the SIMD transcendental kernels which are single-precision only
+    template<typename T>
+    void InternalExp(size_t size,
+                     T* dst,
+                     const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = std::exp(src[i]);
+      }
+    }
+
+    template<typename T>
+    void InternalLog(size_t size,
+                     T* dst,
+                     const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = std::log(src[i]);
+      }
+    }
+
+    template<typename T>
+    void InternalLog2(size_t size,
+                      T* dst,
+                      const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = std::log2(src[i]);
+      }
+    }
+
+    template<typename T>
+    void InternalSin(size_t size,
+                     T* dst,
+                     const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = std::sin(src[i]);
+      }
+    }
+
+    template<typename T>
+    void InternalCos(size_t size,
+                     T* dst,
+                     const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = std::cos(src[i]);
+      }
+    }
+
+    template<typename T>
+    void InternalTanh(size_t size,
+                      T* dst,
+                      const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = std::tanh(src[i]);
+      }
+    }
+
+    template<typename T>
+    void InternalSigmoid(size_t size,
+                         T* dst,
+                         const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = (T)1 / ((T)1 + std::exp(-src[i]));
+      }
+    }
+
+    template<typename T>
+    void InternalPow(size_t size,
+                     T* dst,
+                     const T* base,
+                     const T* exponent)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = std::pow(base[i], exponent[i]);
+      }
+    }
+
+    template<typename T>
+    void InternalRsqrt(size_t size,
+                       T* dst,
+                       const T* src)
+    {
+      for ( size_t i = 0; i < size; ++i ) {
+        dst[i] = (T)1 / std::sqrt(src[i]);
+      }
+    }
+
+    ///
+    /// \brief Adds the product of a packed ROWS x depth panel and a packed depth x COLUMNS panel to the rows x columns block at
+    /// product, see \link avx::InternalGemmKernel( )\endlink for the layout
+    ///
+    template<typename T, size_t ROWS, size_t COLUMNS>
+    void InternalGemmKernel(size_t depth,
+                            const T* packedLhs,
+                            const T* packedRhs,
+                            T* product,
+                            size_t stride,
+                            size_t rows,
+                            size_t columns)
+    {
+      T tile[ROWS][COLUMNS] = {};
+      for ( size_t k = 0; k < depth; ++k ) {
+        for ( size_t r = 0; r < ROWS; ++r ) {
+          for ( size_t c = 0; c < COLUMNS; ++c ) {
+            tile[r][c] += packedLhs[r] * packedRhs[c];
+          }
+        }
+        packedLhs += ROWS;
+        packedRhs += COLUMNS;
+      }
+      for ( size_t r = 0; r < rows; ++r ) {
+        for ( size_t c = 0; c < columns; ++c ) {
+          product[r * stride + c] += tile[r][c];
+        }
+      }
+    }
+
+    ///
+    /// \brief Stores the dot product of each of the count rows with vector in products, see \link avx::InternalBatchDotProduct( )\endlink
+    ///
+    template<typename T>
+    void InternalBatchDotProduct(size_t size,
+                                 size_t count,
+                                 T* products,
+                                 const T* rows,
+                                 size_t stride,
+                                 const T* vector)
+    {
+      for ( size_t r = 0; r < count; ++r ) {
+        const T* row = rows + r * stride;
+        T product = 0;
+        for ( size_t i = 0; i < size; ++i ) {
+          product += row[i] * vector[i];
+        }
+        products[r] = product;
+      }
+    }
+
+    ///
+    /// \brief Adds scalars[r] times each of the count rows to dst, see \link avx::InternalBatchMulAdd( )\endlink
+    ///
+    template<typename T>
+    void InternalBatchMulAdd(size_t size,
+                             size_t count,
+                             T* dst,
+                             const T* rows,
+                             size_t stride,
+                             const T* scalars)
+    {
+      for ( size_t r = 0; r < count; ++r ) {
+        const T* row = rows + r * stride;
+        for ( size_t i = 0; i < size; ++i ) {
+          dst[i] += scalars[r] * row[i];
+        }
+      }
+    }
+
+    ///
+    /// \brief Stores the dot product of every query with every vector in scores, see \link avx::InternalDotProductTile( )\endlink
+    ///
+    template<typename T>
+    void InternalDotProductTile(size_t size,
+                                size_t queryCount,
+                                size_t vectorCount,
+                                T* scores,
+                                size_t scoreStride,
+                                const T* queries,
+                                size_t queryStride,
+                                const T* vectors,
+                                size_t vectorStride)
+    {
+      for ( size_t q = 0; q < queryCount; ++q ) {
+        InternalBatchDotProduct(size, vectorCount, scores + q * scoreStride, vectors, vectorStride, queries + q * queryStride);
+      }
+    }
+
+    ///
+    /// \brief Stores the indices of the elements of src smaller than threshold in indices, see \link avx::InternalSelectBelow( )\endlink
+    ///
+    template<typename T>
+    void InternalSelectBelow(size_t size,
+                             T threshold,
+                             size_t* count,
+                             uint32_t* indices,
+                             const T* src)
+    {
+      size_t selected = 0;
+      for ( size_t i = 0; i < size; ++i ) {
+        if ( src[i] < threshold ) {
+          indices[selected++] = (uint32_t)i;
+        }
+      }
+      *count = selected;
+    }
+  }
+}
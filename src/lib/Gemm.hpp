@@ -0,0 +1,281 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "ArchBinding.hpp"
+#include "Parallel.hpp"
+#include "SimdAllocator.hpp"
+#include "ThreadPool.hpp"
+
+// Products with fewer multiply-adds than this run on the calling thread only, about 128 x 128 x 128
+#define GEMM_PARALLEL_THRESHOLD (1 << 21)
+
+// Cache sizes assumed when ProcessorCaps cannot detect them
+#define GEMM_DEFAULT_L1_BYTES (32 << 10)
+#define GEMM_DEFAULT_L2_BYTES (256 << 10)
+#define GEMM_DEFAULT_L3_BYTES (8 << 20)
+
+// The packed panels are aligned to a cache line so the kernels can use aligned loads
+#define GEMM_PACK_ALIGNMENT 64
+
+// The transposed matrix-vector product accumulates into this many elements of the result at a time, which stay in L1
+#define GEMV_COLUMN_TILE 2048
+
+namespace khyber
+{
+  ///
+  /// \brief Cache blocking of a matrix product, in elements. depth columns of the left operand and rows of the right operand are
+  /// multiplied at a time; a rows x depth block of the left operand is packed to stay in L2, a depth x columns panel of the right
+  /// operand to stay in the last-level cache, and a depth x GemmColumns slice of that panel stays in L1 while the kernel sweeps the
+  /// rows of the block. \link Gemm( )\endlink rounds rows up to a multiple of the kernel's GemmRows and columns up to a multiple of
+  /// its GemmColumns, and treats a 0 as 1.
+  ///
+  struct GemmBlocking
+  {
+    size_t depth;
+    size_t rows;
+    size_t columns;
+  };
+
+  ///
+  /// \brief Sizes the blocks of a product for binding's register tile from the caches of \link ProcessorCaps::Host( )\endlink: the
+  /// L1 slice of the right operand, the L2 block of the left one and the last-level panel of the right one each take half their cache.
+  ///
+  template<typename T>
+  GemmBlocking DefaultGemmBlocking(const ArchBinding<T>& binding)
+  {
+    const ProcessorCaps& caps = ProcessorCaps::Host();
+    size_t l1 = caps.L1DataCacheBytes() > 0 ? caps.L1DataCacheBytes() : GEMM_DEFAULT_L1_BYTES;
+    size_t l2 = caps.L2CacheBytes() > 0 ? caps.L2CacheBytes() : GEMM_DEFAULT_L2_BYTES;
+    size_t l3 = caps.LastLevelCacheBytes() > l2 ? caps.LastLevelCacheBytes() : std::max<size_t>(GEMM_DEFAULT_L3_BYTES, 4 * l2);
+
+    GemmBlocking blocking;
+    blocking.depth = std::min<size_t>(std::max<size_t>(l1 / 2 / (binding.GemmColumns * sizeof(T)) / 8 * 8, 16), 1024);
+    blocking.rows = std::max<size_t>(l2 / 2 / (blocking.depth * sizeof(T)) / binding.GemmRows, 1) * binding.GemmRows;
+    blocking.columns = std::max<size_t>(l3 / 2 / (blocking.depth * sizeof(T)) / binding.GemmColumns, 1) * binding.GemmColumns;
+    return blocking;
+  }
+
+  ///
+  /// \brief Returns blocking with every size at least 1, rows a multiple of tileRows and columns a multiple of tileColumns, the
+  /// granularity at which the blocks are packed
+  ///
+  inline GemmBlocking NormalizeGemmBlocking(const GemmBlocking& blocking, size_t tileRows, size_t tileColumns)
+  {
+    GemmBlocking normalized;
+    normalized.depth = std::max<size_t>(blocking.depth, 1);
+    normalized.rows = std::max<size_t>((blocking.rows + tileRows - 1) / tileRows, 1) * tileRows;
+    normalized.columns = std::max<size_t>((blocking.columns + tileColumns - 1) / tileColumns, 1) * tileColumns;
+    return normalized;
+  }
+
+  ///
+  /// \brief Copies a rows x depth block of a row-major matrix into panels of tileRows rows, each stored column after column
+  /// and zero padded to tileRows, the order in which the kernel reads them
+  ///
+  template<typename T>
+  void PackGemmLhs(size_t rows, size_t depth, const T* lhs, size_t stride, size_t tileRows, T* packed)
+  {
+    for ( size_t row = 0; row < rows; row += tileRows ) {
+      size_t panelRows = std::min(tileRows, rows - row);
+      const T* panel = lhs + row * stride;
+      for ( size_t k = 0; k < depth; ++k ) {
+        size_t r = 0;
+        for ( ; r < panelRows; ++r ) {
+          packed[r] = panel[r * stride + k];
+        }
+        for ( ; r < tileRows; ++r ) {
+          packed[r] = T();
+        }
+        packed += tileRows;
+      }
+    }
+  }
+
+  ///
+  /// \brief Copies a depth x columns panel of a row-major matrix into slices of tileColumns columns, each stored row after row
+  /// and zero padded to tileColumns, the order in which the kernel reads them
+  ///
+  template<typename T>
+  void PackGemmRhs(size_t depth, size_t columns, const T* rhs, size_t stride, size_t tileColumns, T* packed)
+  {
+    for ( size_t column = 0; column < columns; column += tileColumns ) {
+      size_t sliceColumns = std::min(tileColumns, columns - column);
+      const T* slice = rhs + column;
+      for ( size_t k = 0; k < depth; ++k ) {
+        std::copy(slice + k * stride, slice + k * stride + sliceColumns, packed);
+        std::fill(packed + sliceColumns, packed + tileColumns, T());
+        packed += tileColumns;
+      }
+    }
+  }
+
+  ///
+  /// \brief Computes the row-major product = lhs * rhs, of rows x depth and depth x columns matrices, with binding's kernel.
+  /// \details The operands are multiplied one cache block at a time, see \link GemmBlocking\endlink: each depth x columns panel
+  /// of rhs is packed once and shared, then the rows of lhs are split across the \link ThreadPool\endlink (and the columns of the
+  /// panel as well when there are fewer row tiles than threads), each thread packing its own blocks of lhs. Products of fewer than
+  /// GEMM_PARALLEL_THRESHOLD multiply-adds run on the calling thread. product must not overlap the operands.
+  ///
+  template<typename T>
+  void Gemm(const ArchBinding<T>& binding,
+            const GemmBlocking& requested,
+            size_t rows,
+            size_t columns,
+            size_t depth,
+            const T* lhs,
+            size_t lhsStride,
+            const T* rhs,
+            size_t rhsStride,
+            T* product,
+            size_t productStride)
+  {
+    typedef std::vector<T, SimdAllocator<T, GEMM_PACK_ALIGNMENT> > PackedBuffer;
+    const size_t tileRows = binding.GemmRows;
+    const size_t tileColumns = binding.GemmColumns;
+    const GemmBlocking blocking = NormalizeGemmBlocking(requested, tileRows, tileColumns);
+
+    for ( size_t row = 0; row < rows; ++row ) {
+      std::fill(product + row * productStride, product + row * productStride + columns, T());
+    }
+    if ( rows == 0 || columns == 0 || depth == 0 ) {
+      return;
+    }
+
+    // Threads split the row tiles first, the column tiles of each panel when there are too few row tiles
+    ThreadPool& pool = ThreadPool::Instance();
+    size_t threads = pool.GetThreadCount();
+    if ( ThreadPool::InParallelRegion() || (double)rows * columns * depth < GEMM_PARALLEL_THRESHOLD ) {
+      threads = 1;
+    }
+    size_t rowTiles = (rows + tileRows - 1) / tileRows;
+    size_t rowChunks = std::min(threads, rowTiles);
+    size_t rowChunkSize = (rowTiles + rowChunks - 1) / rowChunks * tileRows;
+    rowChunks = (rows + rowChunkSize - 1) / rowChunkSize;
+    size_t columnChunks = std::max<size_t>(threads / rowChunks, 1);
+
+    PackedBuffer packedRhs;
+    for ( size_t column = 0; column < columns; column += blocking.columns ) {
+      size_t panelColumns = std::min(blocking.columns, columns - column);
+      size_t panelTiles = (panelColumns + tileColumns - 1) / tileColumns;
+      size_t panelChunks = std::min(columnChunks, panelTiles);
+      size_t panelChunkTiles = (panelTiles + panelChunks - 1) / panelChunks;
+      panelChunks = (panelTiles + panelChunkTiles - 1) / panelChunkTiles;
+
+      for ( size_t k = 0; k < depth; k += blocking.depth ) {
+        size_t panelDepth = std::min(blocking.depth, depth - k);
+        packedRhs.resize(panelTiles * tileColumns * panelDepth);
+        PackGemmRhs(panelDepth, panelColumns, rhs + k * rhsStride + column, rhsStride, tileColumns, packedRhs.data());
+
+        auto multiply = [&](size_t task) {
+          size_t rowBegin = (task / panelChunks) * rowChunkSize;
+          size_t rowEnd = std::min(rows, rowBegin + rowChunkSize);
+          size_t tileBegin = (task % panelChunks) * panelChunkTiles;
+          size_t tileEnd = std::min(panelTiles, tileBegin + panelChunkTiles);
+          PackedBuffer packedLhs((std::min(blocking.rows, rowEnd - rowBegin) + tileRows - 1) / tileRows * tileRows * panelDepth);
+
+          for ( size_t blockRow = rowBegin; blockRow < rowEnd; blockRow += blocking.rows ) {
+            size_t blockRows = std::min(blocking.rows, rowEnd - blockRow);
+            PackGemmLhs(blockRows, panelDepth, lhs + blockRow * lhsStride + k, lhsStride, tileRows, packedLhs.data());
+
+            // The slice of packedRhs stays in L1 while the kernel sweeps the row tiles of the block
+            for ( size_t tile = tileBegin; tile < tileEnd; ++tile ) {
+              size_t tileColumn = tile * tileColumns;
+              const T* rhsSlice = packedRhs.data() + tileColumn * panelDepth;
+              for ( size_t tileRow = 0; tileRow < blockRows; tileRow += tileRows ) {
+                binding.GemmKernel(panelDepth,
+                                   packedLhs.data() + tileRow * panelDepth,
+                                   rhsSlice,
+                                   product + (blockRow + tileRow) * productStride + column + tileColumn,
+                                   productStride,
+                                   std::min(tileRows, blockRows - tileRow),
+                                   std::min(tileColumns, panelColumns - tileColumn));
+              }
+            }
+          }
+        };
+
+        size_t tasks = rowChunks * panelChunks;
+        if ( tasks <= 1 ) {
+          multiply(0);
+        } else {
+          pool.Run(tasks, multiply);
+        }
+      }
+    }
+  }
+
+  ///
+  /// \brief Computes product = matrix * vector, for a row-major rows x columns matrix, with binding's batched dot product kernel.
+  /// The matrix is read once; the rows are split across the \link ThreadPool\endlink when it has at least the parallel threshold
+  /// of elements.
+  ///
+  template<typename T>
+  void Gemv(const ArchBinding<T>& binding,
+            size_t rows,
+            size_t columns,
+            const T* matrix,
+            size_t stride,
+            const T* vector,
+            T* product)
+  {
+    ChunkLayout layout = PartitionForPool(rows, 4, rows * columns);
+    auto multiply = [&](size_t chunk) {
+      size_t row = chunk * layout.chunkSize;
+      binding.BatchDotProduct(columns, std::min(layout.chunkSize, rows - row), product + row, matrix + row * stride, stride, vector);
+    };
+    if ( layout.chunkCount <= 1 ) {
+      if ( rows > 0 ) {
+        multiply(0);
+      }
+    } else {
+      ThreadPool::Instance().Run(layout.chunkCount, multiply);
+    }
+  }
+
+  ///
+  /// \brief Computes product = transpose(matrix) * vector, for a row-major rows x columns matrix, with binding's batched multiply-add
+  /// kernel: product is the sum of the rows scaled by the elements of vector. product is accumulated GEMV_COLUMN_TILE columns at a
+  /// time so it stays in L1 while all the rows go by, and the columns are split across the \link ThreadPool\endlink when the matrix
+  /// has at least the parallel threshold of elements.
+  ///
+  template<typename T>
+  void TransposedGemv(const ArchBinding<T>& binding,
+                      size_t rows,
+                      size_t columns,
+                      const T* matrix,
+                      size_t stride,
+                      const T* vector,
+                      T* product)
+  {
+    std::fill(product, product + columns, T());
+    ChunkLayout layout = PartitionForPool(columns, PARALLEL_CHUNK_ALIGNMENT / sizeof(T), rows * columns);
+    auto multiply = [&](size_t chunk) {
+      size_t end = std::min(columns, (chunk + 1) * layout.chunkSize);
+      for ( size_t column = chunk * layout.chunkSize; column < end; column += GEMV_COLUMN_TILE ) {
+        binding.BatchMulAdd(std::min<size_t>(GEMV_COLUMN_TILE, end - column), rows, product + column, matrix + column, stride, vector);
+      }
+    };
+    if ( layout.chunkCount <= 1 ) {
+      if ( columns > 0 ) {
+        multiply(0);
+      }
+    } else {
+      ThreadPool::Instance().Run(layout.chunkCount, multiply);
+    }
+  }
+}
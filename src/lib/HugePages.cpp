@@ -0,0 +1,105 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <sys/mman.h>
+#include "HugePages.hpp"
+
+namespace khyber
+{
+  static std::atomic<int> s_defaultMode(SmallPages);
+  static std::atomic<uint64_t> s_explicitAllocations(0);
+  static std::atomic<uint64_t> s_transparentAllocations(0);
+  static std::atomic<uint64_t> s_explicitFallbacks(0);
+
+  static size_t RoundToHugePages(size_t bytes)
+  {
+    return (bytes + HUGE_PAGE_BYTES - 1) & ~(size_t)(HUGE_PAGE_BYTES - 1);
+  }
+
+  ///
+  /// \brief Maps one huge page more than needed and unmaps the unaligned head and the tail, as mmap only aligns to 4KB
+  ///
+  static void* MapAligned(size_t bytes)
+  {
+    size_t mappedBytes = bytes + HUGE_PAGE_BYTES;
+    void* mapped = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if ( mapped == MAP_FAILED ) {
+      return nullptr;
+    }
+    uintptr_t start = (uintptr_t)mapped;
+    uintptr_t aligned = (start + HUGE_PAGE_BYTES - 1) & ~(uintptr_t)(HUGE_PAGE_BYTES - 1);
+    if ( aligned > start ) {
+      munmap(mapped, aligned - start);
+    }
+    size_t tail = start + mappedBytes - (aligned + bytes);
+    if ( tail > 0 ) {
+      munmap((void*)(aligned + bytes), tail);
+    }
+    return (void*)aligned;
+  }
+
+  void* HugePages::Allocate(size_t bytes, PageMode mode)
+  {
+    bytes = RoundToHugePages(bytes);
+    if ( mode == SmallPages ) {
+      void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      return block != MAP_FAILED ? block : nullptr;
+    }
+    if ( mode == ExplicitHugePages ) {
+      void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if ( block != MAP_FAILED ) {
+        ++s_explicitAllocations;
+        return block;
+      }
+      ++s_explicitFallbacks;
+    }
+
+    void* block = MapAligned(bytes);
+    if ( block == nullptr ) {
+      return nullptr;
+    }
+
+    // Ignored when transparent huge pages are disabled, the block then simply has regular pages
+    madvise(block, bytes, MADV_HUGEPAGE);
+    ++s_transparentAllocations;
+    return block;
+  }
+
+  void HugePages::Release(void* block, size_t bytes)
+  {
+    if ( block != nullptr ) {
+      munmap(block, RoundToHugePages(bytes));
+    }
+  }
+
+  PageMode HugePages::GetDefaultMode()
+  {
+    return (PageMode)s_defaultMode.load(std::memory_order_relaxed);
+  }
+
+  void HugePages::SetDefaultMode(PageMode mode)
+  {
+    s_defaultMode.store(mode, std::memory_order_relaxed);
+  }
+
+  HugePageStatistics HugePages::Statistics()
+  {
+    HugePageStatistics statistics;
+    statistics.explicitAllocations = s_explicitAllocations.load();
+    statistics.transparentAllocations = s_transparentAllocations.load();
+    statistics.explicitFallbacks = s_explicitFallbacks.load();
+    return statistics;
+  }
+}
@@ -0,0 +1,82 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Size of an x86-64 large page; allocations smaller than one page are never backed by huge pages
+#define HUGE_PAGE_BYTES (2 << 20)
+
+namespace khyber
+{
+  ///
+  /// \brief Which pages back the buffers of at least HUGE_PAGE_BYTES
+  ///
+  enum PageMode
+  {
+    SmallPages,           // the regular 4KB pages, from the pool or the system allocator
+    TransparentHugePages, // 2MB aligned anonymous memory, advised with MADV_HUGEPAGE
+    ExplicitHugePages     // MAP_HUGETLB from the reserved pool of the kernel, falling back to TransparentHugePages when it is empty
+  };
+
+  ///
+  /// \brief Process-wide counters of the huge page allocations, see \link HugePages::Statistics( )\endlink
+  ///
+  struct HugePageStatistics
+  {
+    uint64_t explicitAllocations;    // blocks mapped with MAP_HUGETLB
+    uint64_t transparentAllocations; // blocks advised with MADV_HUGEPAGE, fallbacks included
+    uint64_t explicitFallbacks;      // ExplicitHugePages requests the kernel could not serve from its reserved pool
+  };
+
+  ///
+  /// \brief Allocates buffers backed by 2MB pages, so the large arrays take one TLB entry per 2MB instead of per 4KB.
+  /// \details The blocks are mapped directly, rounded up to whole huge pages, and unmapped when released: they bypass the
+  /// \link BufferPool\endlink. Explicit huge pages must be reserved beforehand, e.g., through /proc/sys/vm/nr_hugepages;
+  /// transparent huge pages need /sys/kernel/mm/transparent_hugepage/enabled to be "always" or "madvise", otherwise the
+  /// advice is ignored and the block is backed by regular pages.
+  ///
+  class HugePages
+  {
+  public:
+    ///
+    /// \brief Maps bytes, rounded up to a multiple of HUGE_PAGE_BYTES and aligned to it, according to mode. SmallPages maps
+    /// fresh regular pages, aligned to 4KB only, for the buffers that must not have been touched, see \link Numa::Place( )\endlink.
+    /// \return the block, or nullptr if the system is out of memory
+    ///
+    static void* Allocate(size_t bytes, PageMode mode);
+
+    ///
+    /// \brief Unmaps a block returned by \link Allocate( )\endlink for the same bytes
+    ///
+    static void Release(void* block, size_t bytes);
+
+    ///
+    /// \brief Returns the page mode that new arrays, and the arrays returned by the operations, are allocated with
+    ///
+    static PageMode GetDefaultMode();
+
+    ///
+    /// \brief Sets the page mode of the arrays created from now on, existing arrays keep theirs
+    ///
+    static void SetDefaultMode(PageMode mode);
+
+    ///
+    /// \brief Returns the counters of the whole process
+    ///
+    static HugePageStatistics Statistics();
+  };
+}
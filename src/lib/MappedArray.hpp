@@ -0,0 +1,110 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include "ArrayFile.hpp"
+#include "ArrayView.hpp"
+
+namespace khyber
+{
+  ///
+  /// \brief An array file mapped into memory, see \link Array<T>::MapFile( )\endlink
+  /// \details MappedArray<E> is an \link ArrayView<E>\endlink that owns the mapping it refers to and releases it when destroyed, so it
+  /// has the same operations and is used in the same places as an array. MappedArray<const T> maps the file read-only;
+  /// MappedArray<T> maps it copy-on-write, its in-place operations modify private copies of the touched pages and never the file.
+  /// The payload is aligned to ARRAY_FILE_ALIGNMENT bytes. A mapped array can be moved but not copied, views taken from it must not
+  /// outlive it.
+  ///
+  template<typename E>
+  class MappedArray : public ArrayView<E>
+  {
+  public:
+    typedef typename std::remove_const<E>::type T;
+
+    ///
+    /// \brief Maps the array file at path, see \link MapArrayFile( )\endlink for the exceptions thrown
+    /// \param path the file written by \link ArrayOperations::Save( )\endlink
+    /// \param verifyChecksum whether to read the whole payload and check it against the checksum in the header
+    ///
+    MappedArray(const std::string& path, bool verifyChecksum)
+      : _mapping(MapArrayFile(path, ArrayFileElement<T>::type, sizeof(T), !std::is_const<E>::value, verifyChecksum))
+    {
+      ArrayView<E>::operator =(ArrayView<E>((E*)_mapping.payload, _mapping.length));
+    }
+
+    ///
+    /// \brief Move constructor, rhs is left empty
+    ///
+    MappedArray(MappedArray<E>&& rhs) : ArrayView<E>(rhs), _mapping(rhs._mapping)
+    {
+      rhs.Release();
+    }
+
+    ///
+    /// \brief Move assignment operator, unmaps the file 'this' referred to and leaves rhs empty
+    ///
+    MappedArray<E>& operator = (MappedArray<E>&& rhs)
+    {
+      if ( this != &rhs ) {
+        UnmapArrayFile(_mapping);
+        ArrayView<E>::operator =(rhs);
+        _mapping = rhs._mapping;
+        rhs.Release();
+      }
+      return *this;
+    }
+
+    MappedArray(const MappedArray<E>&) = delete;
+    MappedArray<E>& operator = (const MappedArray<E>&) = delete;
+
+    ~MappedArray()
+    {
+      UnmapArrayFile(_mapping);
+    }
+
+    ///
+    /// \brief Evaluate an element-wise expression into the mapped memory, see \link ArrayView<E>::operator =( )\endlink
+    /// \return 'this'
+    ///
+    template<typename X>
+    MappedArray<E>& operator = (const Expression<X>& expression)
+    {
+      ArrayView<E>::operator =(expression);
+      return *this;
+    }
+
+  private:
+    void Release()
+    {
+      ArrayView<E>::operator =(ArrayView<E>());
+      _mapping = ArrayFileMapping();
+    }
+
+    ArrayFileMapping _mapping;
+  };
+
+  // Mapped arrays are expression operands like views
+  template<typename E>
+  struct OperandTraits<MappedArray<E>, void> : public OperandTraits<ArrayView<E>, void>
+  {
+  };
+
+  typedef MappedArray<const float> MappedSinglePrecisionArray;
+  typedef MappedArray<const double> MappedDoublePrecisionArray;
+  typedef MappedArray<const uint32_t> MappedUInt32Array;
+  typedef MappedArray<const int32_t> MappedInt32Array;
+}
@@ -0,0 +1,247 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "Array.hpp"
+#include "Gemm.hpp"
+#include "SimdContainer.hpp"
+
+namespace khyber
+{
+  ///
+  /// \brief Dense row-major matrix of floating point elements with a cache-blocked matrix product
+  /// \details The elements are stored in one aligned \link SimdContainer\endlink, row after row without padding, so the allocation
+  /// options of \link Array<T>\endlink apply and each row can be handed to the array operations as an \link ArrayView<E>\endlink
+  /// through \link Row( )\endlink, or all the elements at once through \link Elements( )\endlink. Mul( ) runs the \link Gemm( )\endlink
+  /// kernel of the process-wide \link ArchBinding<T>\endlink, multithreaded for large products, and MulVec( ) and TransposedMulVec( )
+  /// the matrix-vector kernels. T is float or double; only the single-precision products have SIMD kernels.
+  ///
+  template<typename T>
+  class Matrix : protected SimdContainer<T>
+  {
+    static_assert(std::is_floating_point<T>::value, "Matrix is only defined for floating point element types");
+
+  public:
+    using SimdContainer<T>::data;
+    using SimdContainer<T>::size;
+    using SimdContainer<T>::empty;
+    using SimdContainer<T>::GetPageMode;
+    using SimdContainer<T>::GetPlacement;
+
+    ///
+    /// \brief Construct an empty matrix
+    ///
+    Matrix() : SimdContainer<T>(0), _rows(0), _columns(0)
+    {
+    }
+
+    ///
+    /// \brief Construct a rows x columns matrix of zeroes
+    ///
+    Matrix(size_t rows, size_t columns) : SimdContainer<T>(rows * columns), _rows(rows), _columns(columns)
+    {
+    }
+
+    ///
+    /// \brief Construct a rows x columns matrix of zeroes backed by the given kind of pages, see \link PageMode\endlink
+    ///
+    Matrix(size_t rows, size_t columns, PageMode pages, NumaPlacement placement = Numa::GetDefaultPlacement())
+      : SimdContainer<T>(rows * columns, pages, placement), _rows(rows), _columns(columns)
+    {
+    }
+
+    Matrix(const Matrix<T>& rhs) : SimdContainer<T>((const SimdContainer<T>&) rhs), _rows(rhs._rows), _columns(rhs._columns)
+    {
+    }
+
+    Matrix(Matrix<T>&& rhs) : SimdContainer<T>((SimdContainer<T>&&) rhs), _rows(rhs._rows), _columns(rhs._columns)
+    {
+      rhs._rows = rhs._columns = 0;
+    }
+
+    Matrix<T>& operator = (const Matrix<T>& rhs)
+    {
+      this->_buffer.assign(rhs._buffer.begin(), rhs._buffer.end());
+      _rows = rhs._rows;
+      _columns = rhs._columns;
+      return *this;
+    }
+
+    Matrix<T>& operator = (Matrix<T>&& rhs)
+    {
+      SimdContainer<T>::operator =(std::move(rhs));
+      _rows = rhs._rows;
+      _columns = rhs._columns;
+      rhs._rows = rhs._columns = 0;
+      return *this;
+    }
+
+    ///
+    /// \brief Creates a rows x columns matrix without initializing its elements, see \link Array<T>::Uninitialized( )\endlink
+    ///
+    static Matrix<T> Uninitialized(size_t rows, size_t columns)
+    {
+      Matrix<T> result;
+      result.resize_uninitialized(rows * columns);
+      result._rows = rows;
+      result._columns = columns;
+      return result;
+    }
+
+    size_t rows() const
+    {
+      return _rows;
+    }
+
+    size_t columns() const
+    {
+      return _columns;
+    }
+
+    ///
+    /// \brief Changes the shape of the matrix to rows x columns, the elements are kept in row-major order and the new ones are zero
+    ///
+    void resize(size_t rows, size_t columns)
+    {
+      SimdContainer<T>::resize(rows * columns);
+      _rows = rows;
+      _columns = columns;
+    }
+
+    T& operator () (size_t row, size_t column)
+    {
+      return this->_buffer[row * _columns + column];
+    }
+
+    const T& operator () (size_t row, size_t column) const
+    {
+      return this->_buffer[row * _columns + column];
+    }
+
+    ///
+    /// \brief Returns a view of the elements of one row, it is invalidated when the matrix is resized or destroyed
+    ///
+    ArrayView<T> Row(size_t row)
+    {
+      return ArrayView<T>(data() + row * _columns, _columns);
+    }
+
+    ArrayView<const T> Row(size_t row) const
+    {
+      return ArrayView<const T>(data() + row * _columns, _columns);
+    }
+
+    ///
+    /// \brief Returns a view of all the elements in row-major order, for the element-wise operations of \link ArrayOperations\endlink
+    ///
+    ArrayView<T> Elements()
+    {
+      return ArrayView<T>(data(), size());
+    }
+
+    ArrayView<const T> Elements() const
+    {
+      return ArrayView<const T>(data(), size());
+    }
+
+    ///
+    /// \brief Multiply 'this' by rhs into a new matrix and return it
+    /// \param rhs a matrix with as many rows as 'this' has columns
+    /// \return move-returned rows( ) x rhs.columns( ) Matrix<T>
+    ///
+    Matrix<T> Mul(const Matrix<T>& rhs) const
+    {
+      Matrix<T> product = Uninitialized(_rows, rhs._columns);
+      product.Mul(*this, rhs);
+      return product;
+    }
+
+    ///
+    /// \brief Multiply lhs by rhs into 'this', which is reshaped to lhs.rows( ) x rhs.columns( ) and must be neither of them.
+    /// Throws std::invalid_argument if lhs.columns( ) differs from rhs.rows( ).
+    /// \return 'this'
+    ///
+    Matrix<T>& Mul(const Matrix<T>& lhs, const Matrix<T>& rhs)
+    {
+      const ArchBinding<T>& binding = ArchBinding<T>::Active();
+      return Mul(lhs, rhs, DefaultGemmBlocking(binding));
+    }
+
+    ///
+    /// \brief Multiply lhs by rhs into 'this' with the given cache blocking instead of the one sized from the detected caches
+    /// \return 'this'
+    ///
+    Matrix<T>& Mul(const Matrix<T>& lhs, const Matrix<T>& rhs, const GemmBlocking& blocking)
+    {
+      if ( lhs._columns != rhs._rows ) {
+        throw std::invalid_argument("Matrix::Mul: the left operand has " + std::to_string(lhs._columns) + " columns, the right one " +
+                                    std::to_string(rhs._rows) + " rows");
+      }
+      if ( this == &lhs || this == &rhs ) {
+        throw std::invalid_argument("Matrix::Mul: the product cannot be one of the operands");
+      }
+
+      this->resize_uninitialized(lhs._rows * rhs._columns);
+      _rows = lhs._rows;
+      _columns = rhs._columns;
+      Gemm(ArchBinding<T>::Active(), blocking, _rows, _columns, lhs._columns,
+           lhs.data(), lhs._columns, rhs.data(), rhs._columns, data(), _columns);
+      return *this;
+    }
+
+    ///
+    /// \brief Multiply 'this' by the column vector vector, i.e., compute the dot product of every row with vector, in one pass over
+    /// the matrix that shares each load of vector between several rows. Throws std::invalid_argument if vector does not have
+    /// columns( ) elements.
+    /// \return move-returned Array<T> of rows( ) elements
+    ///
+    Array<T> MulVec(ArrayView<const T> vector) const
+    {
+      if ( vector.size() != _columns ) {
+        throw std::invalid_argument("Matrix::MulVec: the matrix has " + std::to_string(_columns) + " columns, the vector " +
+                                    std::to_string(vector.size()) + " elements");
+      }
+      Array<T> product = Array<T>::Uninitialized(_rows);
+      Gemv(ArchBinding<T>::Active(), _rows, _columns, data(), _columns, vector.data(), product.data());
+      return product;
+    }
+
+    ///
+    /// \brief Multiply the transpose of 'this' by the column vector vector, i.e., sum the rows scaled by the elements of vector,
+    /// without transposing the matrix. Throws std::invalid_argument if vector does not have rows( ) elements.
+    /// \return move-returned Array<T> of columns( ) elements
+    ///
+    Array<T> TransposedMulVec(ArrayView<const T> vector) const
+    {
+      if ( vector.size() != _rows ) {
+        throw std::invalid_argument("Matrix::TransposedMulVec: the matrix has " + std::to_string(_rows) + " rows, the vector " +
+                                    std::to_string(vector.size()) + " elements");
+      }
+      Array<T> product = Array<T>::Uninitialized(_columns);
+      TransposedGemv(ArchBinding<T>::Active(), _rows, _columns, data(), _columns, vector.data(), product.data());
+      return product;
+    }
+
+  private:
+    size_t _rows;
+    size_t _columns;
+  };
+
+  typedef Matrix<float> SinglePrecisionMatrix;
+  typedef Matrix<double> DoublePrecisionMatrix;
+}
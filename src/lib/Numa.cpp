@@ -0,0 +1,158 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "HugePages.hpp"
+#include "Numa.hpp"
+#include "Parallel.hpp"
+
+// Node masks passed to mbind cover this many nodes
+#define NUMA_MAX_NODES 1024
+
+// mbind works on whole pages
+#define NUMA_PAGE_BYTES 4096
+
+namespace khyber
+{
+  static std::atomic<int> s_defaultPlacement(DefaultPlacement);
+
+  ///
+  /// \brief Parses a sysfs list such as "0-1,4" into the ids it contains
+  ///
+  static std::vector<int> ParseNodeList(const std::string& list)
+  {
+    std::vector<int> nodes;
+    size_t position = 0;
+    while ( position < list.size() ) {
+      size_t end = list.find(',', position);
+      if ( end == std::string::npos ) {
+        end = list.size();
+      }
+      std::string range = list.substr(position, end - position);
+      size_t dash = range.find('-');
+      try {
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for ( int node = first; node <= last && node < NUMA_MAX_NODES; ++node ) {
+          nodes.push_back(node);
+        }
+      } catch ( const std::exception& ) {
+        return std::vector<int>();
+      }
+      position = end + 1;
+    }
+    return nodes;
+  }
+
+  static std::vector<int> ReadNodes()
+  {
+    std::ifstream file("/sys/devices/system/node/online");
+    std::string list;
+    std::vector<int> nodes;
+    if ( std::getline(file, list) ) {
+      nodes = ParseNodeList(list);
+    }
+    if ( nodes.empty() ) {
+      nodes.push_back(0);
+    }
+    return nodes;
+  }
+
+  ///
+  /// \brief Sets the policy of the pages in [address, address + bytes), which must start on a page boundary
+  ///
+  static void Bind(char* address, size_t bytes, int mode, const std::vector<int>& nodes)
+  {
+    unsigned long mask[NUMA_MAX_NODES / (8 * sizeof(unsigned long))] = { 0 };
+    const size_t bitsPerWord = 8 * sizeof(unsigned long);
+    for ( size_t i = 0; i < nodes.size(); ++i ) {
+      mask[nodes[i] / bitsPerWord] |= 1UL << (nodes[i] % bitsPerWord);
+    }
+
+    // The policy is only a hint for performance, the pages are usable whether or not the kernel accepts it
+    syscall(SYS_mbind, address, bytes, mode, mask, (unsigned long)NUMA_MAX_NODES + 1, 0);
+  }
+
+  const std::vector<int>& Numa::Nodes()
+  {
+    static const std::vector<int> nodes = ReadNodes();
+    return nodes;
+  }
+
+  size_t Numa::NodeCount()
+  {
+    return Nodes().size();
+  }
+
+  int Numa::CurrentNode()
+  {
+    unsigned cpu = 0, node = 0;
+    if ( syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 ) {
+      return Nodes()[0];
+    }
+    return (int)node;
+  }
+
+  bool Numa::Applies(size_t bytes, NumaPlacement placement)
+  {
+    return placement != DefaultPlacement && bytes >= HUGE_PAGE_BYTES && NodeCount() > 1;
+  }
+
+  void Numa::Place(void* block, size_t bytes, size_t elementBytes, NumaPlacement placement)
+  {
+    if ( block == nullptr || !Applies(bytes, placement) ) {
+      return;
+    }
+
+    char* address = (char*)block;
+    const std::vector<int>& nodes = Nodes();
+    if ( placement == InterleavedPlacement ) {
+      Bind(address, bytes, MPOL_INTERLEAVE, nodes);
+      return;
+    }
+
+    ChunkLayout layout = placement == PartitionedPlacement ?
+      PartitionForPool(bytes / elementBytes, std::max<size_t>(PARALLEL_CHUNK_ALIGNMENT / elementBytes, 1)) : ChunkLayout { 0, 1 };
+    if ( layout.chunkCount <= 1 ) {
+      Bind(address, bytes, MPOL_PREFERRED, std::vector<int>(1, CurrentNode()));
+      return;
+    }
+
+    // Chunk i goes to node i * nodes / chunks, a page straddling two chunks goes with the first
+    size_t chunkBytes = layout.chunkSize * elementBytes;
+    for ( size_t chunk = 0; chunk < layout.chunkCount; ++chunk ) {
+      size_t begin = (chunk * chunkBytes + NUMA_PAGE_BYTES - 1) / NUMA_PAGE_BYTES * NUMA_PAGE_BYTES;
+      size_t end = std::min(bytes, (chunk + 1) * chunkBytes);
+      end = chunk + 1 == layout.chunkCount ? bytes : (end + NUMA_PAGE_BYTES - 1) / NUMA_PAGE_BYTES * NUMA_PAGE_BYTES;
+      if ( begin < end ) {
+        Bind(address + begin, end - begin, MPOL_PREFERRED, std::vector<int>(1, nodes[chunk * nodes.size() / layout.chunkCount]));
+      }
+    }
+  }
+
+  NumaPlacement Numa::GetDefaultPlacement()
+  {
+    return (NumaPlacement)s_defaultPlacement.load(std::memory_order_relaxed);
+  }
+
+  void Numa::SetDefaultPlacement(NumaPlacement placement)
+  {
+    s_defaultPlacement.store(placement, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,79 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace khyber
+{
+  ///
+  /// \brief Which NUMA nodes the pages of a buffer are placed on
+  ///
+  enum NumaPlacement
+  {
+    DefaultPlacement,     // the kernel's policy, usually the node of the thread that first touches each page
+    InterleavedPlacement, // page by page, round robin over all the nodes
+    LocalPlacement,       // the node of the thread allocating the buffer
+    PartitionedPlacement  // the chunks ParallelFor( ) splits the array into, in order, spread evenly over the nodes
+  };
+
+  ///
+  /// \brief Places the pages of large buffers on the NUMA nodes of a multi-socket machine, see \link NumaPlacement\endlink.
+  /// \details A placement other than DefaultPlacement is applied to buffers of at least HUGE_PAGE_BYTES, which are then mapped
+  /// directly by \link HugePages\endlink so no page has been touched, and so placed, before the policy is set. On a machine
+  /// with a single node every placement is DefaultPlacement. The policies are set with the mbind system call, libnuma is not
+  /// needed.
+  ///
+  class Numa
+  {
+  public:
+    ///
+    /// \brief Returns the ids of the online nodes, read once from /sys/devices/system/node/online
+    ///
+    static const std::vector<int>& Nodes();
+
+    ///
+    /// \brief Returns the number of online nodes, 1 if it cannot be determined
+    ///
+    static size_t NodeCount();
+
+    ///
+    /// \brief Returns the node of the CPU the calling thread runs on
+    ///
+    static int CurrentNode();
+
+    ///
+    /// \brief Checks if a buffer of bytes is placed according to placement, rather than by the kernel's default policy
+    ///
+    static bool Applies(size_t bytes, NumaPlacement placement);
+
+    ///
+    /// \brief Sets the policy of the untouched pages of block according to placement, chunked like an array of elementBytes
+    /// wide elements. Does nothing unless \link Applies( )\endlink.
+    ///
+    static void Place(void* block, size_t bytes, size_t elementBytes, NumaPlacement placement);
+
+    ///
+    /// \brief Returns the placement that new arrays, and the arrays returned by the operations, are allocated with
+    ///
+    static NumaPlacement GetDefaultPlacement();
+
+    ///
+    /// \brief Sets the placement of the arrays created from now on, existing arrays keep theirs
+    ///
+    static void SetDefaultPlacement(NumaPlacement placement);
+  };
+}
@@ -0,0 +1,349 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <xmmintrin.h>
+#include "ArchBinding.hpp"
+#include "ThreadPool.hpp"
+
+// Chunks handed to the threads are whole cache lines long, so the threads never write to the same line of an aligned buffer
+#define PARALLEL_CHUNK_ALIGNMENT 64
+
+// Outputs of at least this many bytes are written with non-temporal stores when the size of the last-level cache is unknown
+#define DEFAULT_STREAMING_THRESHOLD (8 << 20)
+
+// Element-wise operations writing with non-temporal stores compute this many bytes at a time into an L1-resident tile
+#define STREAMING_TILE_BYTES 4096
+
+// Compensated reductions are computed over fixed blocks of this many elements, whatever the number of threads
+#define COMPENSATED_BLOCK_SIZE 4096
+
+namespace khyber
+{
+  ///
+  /// \brief Split of [0, size) into chunkCount chunks of chunkSize elements, the last one can be shorter
+  ///
+  struct ChunkLayout
+  {
+    size_t chunkSize;
+    size_t chunkCount;
+  };
+
+  ///
+  /// \brief Splits size items into one chunk per thread of the \link ThreadPool\endlink, each a multiple of granule items, for a job
+  /// reading elements elements in all, e.g., the rows of a matrix. Returns a single chunk when elements is below the parallel threshold,
+  /// the pool has one thread or the caller is already running in the pool.
+  ///
+  inline ChunkLayout PartitionForPool(size_t size, size_t granule, size_t elements)
+  {
+    ThreadPool& pool = ThreadPool::Instance();
+    size_t threads = pool.GetThreadCount();
+    if ( elements < pool.GetParallelThreshold() || threads < 2 || ThreadPool::InParallelRegion() ) {
+      return ChunkLayout { size, size > 0 ? (size_t)1 : (size_t)0 };
+    }
+
+    size_t chunkSize = (size + threads - 1) / threads;
+    chunkSize = (chunkSize + granule - 1) / granule * granule;
+    return ChunkLayout { chunkSize, (size + chunkSize - 1) / chunkSize };
+  }
+
+  ///
+  /// \brief Splits size elements into one chunk per thread of the \link ThreadPool\endlink, each a multiple of granule elements. Returns
+  /// a single chunk when size is below the parallel threshold, the pool has one thread or the caller is already running in the pool.
+  ///
+  inline ChunkLayout PartitionForPool(size_t size, size_t granule)
+  {
+    return PartitionForPool(size, granule, size);
+  }
+
+  ///
+  /// \brief Calls body(offset, count) over consecutive chunks covering [0, size), in parallel when size is large enough
+  /// \param size the number of elements to process
+  /// \param granule every chunk but the last one is a multiple of this many elements
+  /// \param body the function processing one chunk
+  ///
+  template<typename F>
+  void ParallelFor(size_t size, size_t granule, F body)
+  {
+    ChunkLayout layout = PartitionForPool(size, granule);
+    if ( layout.chunkCount <= 1 ) {
+      body(0, size);
+      return;
+    }
+
+    ThreadPool::Instance().Run(layout.chunkCount, [&](size_t chunk) {
+      size_t offset = chunk * layout.chunkSize;
+      body(offset, std::min(layout.chunkSize, size - offset));
+    });
+  }
+
+  typedef void (*StreamingCopyKernel)(size_t bytes, void* dst, const void* src);
+
+  inline size_t DefaultStreamingThreshold()
+  {
+    size_t cacheBytes = ProcessorCaps::Host().LastLevelCacheBytes();
+    return cacheBytes > 0 ? cacheBytes : (size_t)DEFAULT_STREAMING_THRESHOLD;
+  }
+
+  inline size_t& StreamingThresholdSlot()
+  {
+    static size_t threshold = DefaultStreamingThreshold();
+    return threshold;
+  }
+
+  ///
+  /// \brief Returns the size, in bytes, from which the output of an element-wise operation is written with non-temporal stores
+  ///
+  inline size_t GetStreamingThreshold()
+  {
+    return StreamingThresholdSlot();
+  }
+
+  ///
+  /// \brief Sets the size, in bytes, from which the output of an element-wise operation is written with non-temporal stores. The default is
+  /// the size of the last-level cache, above which the output would only evict the inputs and other useful data before it is read again.
+  /// 0 restores the default and SIZE_MAX disables non-temporal stores. Must not be called while an operation is running.
+  ///
+  inline void SetStreamingThreshold(size_t bytes)
+  {
+    StreamingThresholdSlot() = bytes > 0 ? bytes : DefaultStreamingThreshold();
+  }
+
+  ///
+  /// \brief Returns the streaming copy kernel of the active \link ArchBinding<T>\endlink if an output of size elements is to be written
+  /// with non-temporal stores, null otherwise
+  ///
+  template<typename T>
+  inline StreamingCopyKernel StreamingCopyFor(size_t size)
+  {
+    return size >= GetStreamingThreshold() / sizeof(T) ? ArchBinding<T>::Active().StreamingCopy : 0;
+  }
+
+  ///
+  /// \brief Writes count elements of dst, starting at offset, by calling compute(offset, n, out) on consecutive pieces of them.
+  /// \details Without streamingCopy compute writes straight into dst. Otherwise it writes into an L1-resident tile, which is then copied
+  /// to dst with non-temporal stores, and the stores are fenced before returning so the result is visible to the thread that waits for it.
+  ///
+  template<typename T, typename F>
+  void MapThroughTile(StreamingCopyKernel streamingCopy, size_t offset, size_t count, T* dst, F compute)
+  {
+    if ( streamingCopy == 0 ) {
+      compute(offset, count, dst + offset);
+      return;
+    }
+
+    const size_t tileSize = STREAMING_TILE_BYTES / sizeof(T);
+    alignas(32) T tile[tileSize];
+    for ( size_t i = offset; i < offset + count; i += tileSize ) {
+      size_t n = std::min(tileSize, offset + count - i);
+      compute(i, n, tile);
+      streamingCopy(n * sizeof(T), dst + i, tile);
+    }
+    _mm_sfence();
+  }
+
+  ///
+  /// \brief Runs an element-wise kernel of an \link ArchBinding<T>\endlink, e.g., Add, over size elements. Outputs of at least
+  /// \link GetStreamingThreshold( )\endlink bytes are written with non-temporal stores.
+  ///
+  template<typename T, typename... Src>
+  void ParallelMap(void (*kernel)(size_t, T*, const Src*...),
+                   size_t size,
+                   T* dst,
+                   const Src*... src)
+  {
+    StreamingCopyKernel streamingCopy = StreamingCopyFor<T>(size);
+    ParallelFor(size, PARALLEL_CHUNK_ALIGNMENT / sizeof(T), [&](size_t offset, size_t count) {
+      MapThroughTile(streamingCopy, offset, count, dst, [&](size_t i, size_t n, T* out) {
+        kernel(n, out, (src + i)...);
+      });
+    });
+  }
+
+  ///
+  /// \brief Runs an element-wise kernel taking a scalar operand, e.g., ScalarMul or ShiftLeft, over size elements. Outputs of at least
+  /// \link GetStreamingThreshold( )\endlink bytes are written with non-temporal stores.
+  ///
+  template<typename S, typename T>
+  void ParallelScalarMap(void (*kernel)(size_t, S, T*, const T*),
+                         size_t size,
+                         S scalar,
+                         T* dst,
+                         const T* src)
+  {
+    StreamingCopyKernel streamingCopy = StreamingCopyFor<T>(size);
+    ParallelFor(size, PARALLEL_CHUNK_ALIGNMENT / sizeof(T), [&](size_t offset, size_t count) {
+      MapThroughTile(streamingCopy, offset, count, dst, [&](size_t i, size_t n, T* out) {
+        kernel(n, scalar, out, src + i);
+      });
+    });
+  }
+
+  ///
+  /// \brief Runs a reduction kernel, e.g., Summation, over size elements. Each chunk is reduced by the kernel on its own thread and
+  /// the partial results are folded, in chunk order, with combine. The result can therefore differ from the single-threaded one in the
+  /// last bits for floating point types.
+  ///
+  template<typename R, typename C, typename T, typename... Src>
+  void ParallelReduce(void (*kernel)(size_t, R*, const T*, const Src*...),
+                      C combine,
+                      size_t size,
+                      R* result,
+                      const T* src,
+                      const Src*... others)
+  {
+    ChunkLayout layout = PartitionForPool(size, PARALLEL_CHUNK_ALIGNMENT / sizeof(T));
+    if ( layout.chunkCount <= 1 ) {
+      kernel(size, result, src, others...);
+      return;
+    }
+
+    std::vector<R> partials(layout.chunkCount);
+    ThreadPool::Instance().Run(layout.chunkCount, [&](size_t chunk) {
+      size_t offset = chunk * layout.chunkSize;
+      kernel(std::min(layout.chunkSize, size - offset), &partials[chunk], src + offset, (others + offset)...);
+    });
+
+    *result = partials[0];
+    for ( size_t i = 1; i < partials.size(); ++i ) {
+      *result = combine(*result, partials[i]);
+    }
+  }
+
+  ///
+  /// \brief Neumaier's compensated addition of x to sum, the rounding error of the addition is accumulated in compensation
+  ///
+  template<typename T>
+  inline void CompensatedAdd(T& sum, T& compensation, T x)
+  {
+    T t = sum + x;
+    if ( std::abs(sum) >= std::abs(x) ) {
+      compensation += (sum - t) + x;
+    } else {
+      compensation += (x - t) + sum;
+    }
+    sum = t;
+  }
+
+  ///
+  /// \brief Runs a compensated reduction kernel, e.g., CompensatedSummation, over size elements and returns the result. The array is cut
+  /// into blocks of COMPENSATED_BLOCK_SIZE elements, each block is reduced by the kernel into COMPENSATED_LANES running sums and
+  /// compensations, which are folded with \link CompensatedAdd( )\endlink in lane order, then the blocks are folded in block order.
+  /// Neither the shape of this computation nor its order depend on the kernel or the number of threads, so the result is bitwise
+  /// identical on every instruction set and thread count.
+  ///
+  template<typename T, typename... Src>
+  T ParallelCompensatedReduce(void (*kernel)(size_t, T*, const T*, const Src*...),
+                              size_t size,
+                              const T* src,
+                              const Src*... others)
+  {
+    size_t blockCount = (size + COMPENSATED_BLOCK_SIZE - 1) / COMPENSATED_BLOCK_SIZE;
+    std::vector<T> partials(2 * blockCount);
+    ParallelFor(size, COMPENSATED_BLOCK_SIZE, [&](size_t offset, size_t count) {
+      T lanes[2 * COMPENSATED_LANES];
+      for ( size_t block = offset; block < offset + count; block += COMPENSATED_BLOCK_SIZE ) {
+        kernel(std::min((size_t)COMPENSATED_BLOCK_SIZE, offset + count - block), lanes, src + block, (others + block)...);
+        T* partial = &partials[2 * (block / COMPENSATED_BLOCK_SIZE)];
+        partial[0] = partial[1] = 0;
+        for ( size_t lane = 0; lane < COMPENSATED_LANES; ++lane ) {
+          CompensatedAdd(partial[0], partial[1], lanes[lane]);
+        }
+        for ( size_t lane = 0; lane < COMPENSATED_LANES; ++lane ) {
+          partial[1] += lanes[COMPENSATED_LANES + lane];
+        }
+      }
+    });
+
+    T sum = 0;
+    T compensation = 0;
+    for ( size_t block = 0; block < blockCount; ++block ) {
+      CompensatedAdd(sum, compensation, partials[2 * block]);
+      compensation += partials[2 * block + 1];
+    }
+    return sum + compensation;
+  }
+
+  ///
+  /// \brief Runs an index reduction kernel, e.g., ArgMinimum, over size elements and returns the index it finds in src. The indices found in
+  /// the chunks are folded in chunk order, the one of a later chunk only replaces the current one when replace(src[later], src[current])
+  /// holds, so a strict comparison keeps the first index on ties.
+  ///
+  template<typename T, typename C>
+  size_t ParallelArgReduce(void (*kernel)(size_t, size_t*, const T*),
+                           C replace,
+                           size_t size,
+                           const T* src)
+  {
+    size_t index = 0;
+    ChunkLayout layout = PartitionForPool(size, PARALLEL_CHUNK_ALIGNMENT / sizeof(T));
+    if ( layout.chunkCount <= 1 ) {
+      kernel(size, &index, src);
+      return index;
+    }
+
+    std::vector<size_t> partials(layout.chunkCount);
+    ThreadPool::Instance().Run(layout.chunkCount, [&](size_t chunk) {
+      size_t offset = chunk * layout.chunkSize;
+      kernel(std::min(layout.chunkSize, size - offset), &partials[chunk], src + offset);
+      partials[chunk] += offset;
+    });
+
+    index = partials[0];
+    for ( size_t i = 1; i < partials.size(); ++i ) {
+      if ( replace(src[partials[i]], src[index]) ) {
+        index = partials[i];
+      }
+    }
+    return index;
+  }
+
+  ///
+  /// \brief Runs a prefix sum kernel, e.g., PrefixSum, over size elements in two passes when size is large enough: every thread first
+  /// sums its chunk with summation, the totals are scanned serially into the carry of each chunk, then every thread scans its chunk
+  /// starting from that carry. dst can be the same address as src.
+  ///
+  template<typename T>
+  void ParallelScan(void (*scan)(size_t, T, T*, const T*),
+                    void (*summation)(size_t, T*, const T*),
+                    size_t size,
+                    T* dst,
+                    const T* src)
+  {
+    ChunkLayout layout = PartitionForPool(size, PARALLEL_CHUNK_ALIGNMENT / sizeof(T));
+    if ( layout.chunkCount <= 1 ) {
+      scan(size, 0, dst, src);
+      return;
+    }
+
+    std::vector<T> carries(layout.chunkCount);
+    ThreadPool::Instance().Run(layout.chunkCount - 1, [&](size_t chunk) {
+      summation(layout.chunkSize, &carries[chunk + 1], src + chunk * layout.chunkSize);
+    });
+
+    carries[0] = 0;
+    for ( size_t i = 1; i < carries.size(); ++i ) {
+      carries[i] += carries[i - 1];
+    }
+
+    ThreadPool::Instance().Run(layout.chunkCount, [&](size_t chunk) {
+      size_t offset = chunk * layout.chunkSize;
+      scan(std::min(layout.chunkSize, size - offset), carries[chunk], dst + offset, src + offset);
+    });
+  }
+}
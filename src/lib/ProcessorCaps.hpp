@@ -14,10 +14,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <string>
 #include <sstream>
+#include <system_error>
+#include <thread>
+#include <vector>
 #include <cstdint>
+#include <sched.h>
   
 #define cpuid(func, eax, ebx, ecx, edx) \
 __asm__ __volatile__ ("cpuid":          \
@@ -70,24 +77,72 @@ __asm__ __volatile__ ("cpuid":          \
 #define BM_HTT     BM_09
 #define BM_AVX512F BM_10
 
+// Upper bound on the number of cache descriptors kept by ProcessorCaps, current processors report at most five
+#define MAX_CACHE_DESCRIPTORS 8
+
 #define capset(flag, reg, input_mask, output_mask) flag |= ((reg & BM_##input_mask) ? BM_##output_mask : BM_NO)
 
 namespace khyber
 {
+  ///
+  /// \brief Kind of data held by a cache, as reported by CPUID
+  ///
+  enum CacheType { DataCache = 1, InstructionCache = 2, UnifiedCache = 3 };
+
+  ///
+  /// \brief Where \link ProcessorCaps\endlink found the description of the caches
+  ///
+  enum CacheSource { NoCacheSource, CpuidLeaf4, CpuidLeaf8000001D, Sysfs };
+
+  ///
+  /// \brief Geometry of one cache of the processor, see \link ProcessorCaps::Cache( )\endlink
+  ///
+  struct CacheInfo
+  {
+    uint32_t level;          /// 1 for L1, 2 for L2 etc.
+    CacheType type;          /// data, instruction or unified
+    std::size_t bytes;       /// total capacity, in bytes
+    std::size_t lineBytes;   /// line size, in bytes
+    uint32_t ways;           /// associativity, 0 if unknown
+    uint32_t sets;           /// number of sets, 0 if unknown
+    uint32_t sharingThreads; /// (maximum) number of logical processors sharing this cache
+  };
+
+  ///
+  /// \brief Where \link ProcessorCaps\endlink found the core and thread topology
+  ///
+  enum TopologySource { NoTopologySource, CpuidLeafB, CpuidLeaf1F, SysfsTopology };
+
+  ///
+  /// \brief Placement of one logical CPU, i.e., hardware thread, see \link ProcessorCaps::GetLogicalCpu( )\endlink
+  ///
+  struct LogicalCpu
+  {
+    uint32_t id;      /// number of the CPU in the operating system, as used by sched_setaffinity( )
+    uint32_t package; /// index of its package (socket), from 0
+    uint32_t core;    /// index of its physical core, from 0 and unique across packages
+    uint32_t thread;  /// index of the CPU among the SMT siblings of its core, from 0
+  };
+
   ///
   /// \brief The ProcessorCaps class provides an easy way to query IA64 processor capabilities.
   /// \details This class uses the CPUID instruction to get information about the processor and its capabilities, which are then
   /// exposed in the form of Is<Capability>() member functions. Information such as whether or not the processor
   /// provides, and if so, up to which version, AVX and AVX2, the FMA instruction and cache line levels and sizes etc.,
-  /// are all provided.
+  /// are all provided. The size, associativity and sharing of every cache level of a core are enumerated once, from the
+  /// deterministic cache parameters of CPUID or, when the processor or the hypervisor does not report them, from Linux sysfs.
   ///
   class ProcessorCaps
   {
   public:
     ProcessorCaps()
-      : HighestFunction(0),
+      : L1CachelineBytes(0),
+        L2CachelineBytes(0),
+        HighestFunction(0),
         HighestExtFunction(0),
-        _flags(0)
+        _flags(0),
+        _cacheCount(0),
+        _cacheSource(NoCacheSource)
     {
       uint32_t eax;
       uint32_t ebx;
@@ -102,14 +157,38 @@ namespace khyber
       brandPtr[2] = ecx;
       _brand[12] = '\0';
 
+      ecx = 0;
       cpuid(0x80000000, eax, ebx, ecx, edx);
+      uint32_t highestExtFunction = eax;
       HighestExtFunction = eax & 0x000000FF;
-      if ( HighestFunction >= 6 ) {
-        // Now we query the caches
-        eax = 4;
+      if ( highestExtFunction >= 0x80000006 ) {
+        // Only the L2 line size, in case the caches cannot be enumerated below
         ecx = 0;
         cpuid(0x80000006, eax, ebx, ecx, edx);
-	L2CachelineBytes = ecx & LSB_8;
+        L2CachelineBytes = ecx & LSB_8;
+      }
+
+      // Intel describes its caches in leaf 4, AMD in leaf 0x8000001D when it has the topology extensions, and Linux exports either in sysfs
+      bool topologyExtensions = false;
+      if ( highestExtFunction >= 0x80000001 ) {
+        ecx = 0;
+        cpuid(0x80000001, eax, ebx, ecx, edx);
+        topologyExtensions = ecx & BM_22;
+      }
+      if ( HighestFunction >= 4 && EnumerateCaches(4) ) {
+        _cacheSource = CpuidLeaf4;
+      } else if ( topologyExtensions && highestExtFunction >= 0x8000001D && EnumerateCaches(0x8000001D) ) {
+        _cacheSource = CpuidLeaf8000001D;
+      } else if ( ReadSysfsCaches() ) {
+        _cacheSource = Sysfs;
+      }
+      SortCaches();
+      for ( size_t i = 0; i < _cacheCount; ++i ) {
+        if ( _caches[i].level == 1 && _caches[i].type != InstructionCache ) {
+          L1CachelineBytes = _caches[i].lineBytes;
+        } else if ( _caches[i].level == 2 ) {
+          L2CachelineBytes = _caches[i].lineBytes;
+        }
       }
       
       if ( HighestFunction >= 1 ) {
@@ -120,7 +199,7 @@ namespace khyber
         capset(_flags, edx, 25, SSE);
         capset(_flags, edx, 26, SSE2);
         capset(_flags, edx, 28, HTT);
-        capset(_flags, edx, 00, SSE3);
+        capset(_flags, ecx, 00, SSE3);
         capset(_flags, ecx, 19, SSE4_1);
         capset(_flags, ecx, 20, SSE4_2);
         capset(_flags, ecx, 28, AVX);
@@ -135,6 +214,25 @@ namespace khyber
       }
     }
     
+    ///
+    /// \brief Returns the capabilities of the processor this process is running on. The CPUID instruction is executed only once,
+    /// on the first call, and the result is shared by all callers.
+    ///
+    static const ProcessorCaps& Host()
+    {
+      static const ProcessorCaps host;
+      return host;
+    }
+
+    ///
+    /// \brief <em>Not for end-use</em>, clears the given BM_* capability flags, e.g., to exercise the AVX code path on an AVX2 processor
+    /// \param mask bitwise OR of the BM_* flags to clear
+    ///
+    inline void ClearFlags(uint64_t mask)
+    {
+      _flags &= ~mask;
+    }
+
     inline const char* BrandString() const
     {
       return _brand;
@@ -228,6 +326,147 @@ namespace khyber
       return _flags & BM_FMA;
     }
     
+    ///
+    /// \brief Returns the number of caches described by \link Cache( )\endlink, 0 if they could not be enumerated
+    ///
+    inline size_t CacheCount() const
+    {
+      return _cacheCount;
+    }
+
+    ///
+    /// \brief Returns the description of the cache at index, which must be less than \link CacheCount( )\endlink. The caches of a core
+    /// are listed by increasing level, the data cache before the instruction cache of the same level, so the order does not depend on
+    /// the order CPUID or sysfs reports them in.
+    ///
+    inline const CacheInfo& Cache(size_t index) const
+    {
+      return _caches[index];
+    }
+
+    ///
+    /// \brief Returns where the cache descriptions come from: CPUID leaf 4 (Intel), leaf 0x8000001D (AMD) or Linux sysfs
+    ///
+    inline CacheSource GetCacheSource() const
+    {
+      return _cacheSource;
+    }
+
+    ///
+    /// \brief Returns the capacity, in bytes, of the level 1 data cache, 0 if unknown
+    ///
+    inline std::size_t L1DataCacheBytes() const
+    {
+      return CacheBytes(1);
+    }
+
+    ///
+    /// \brief Returns the capacity, in bytes, of the level 2 cache, 0 if unknown or absent
+    ///
+    inline std::size_t L2CacheBytes() const
+    {
+      return CacheBytes(2);
+    }
+
+    ///
+    /// \brief Returns the capacity, in bytes, of the level 3 cache, 0 if unknown or absent
+    ///
+    inline std::size_t L3CacheBytes() const
+    {
+      return CacheBytes(3);
+    }
+
+    ///
+    /// \brief Returns the capacity, in bytes, of the highest level data or unified cache, 0 if unknown. It is usually shared by several
+    /// cores, see \link CacheInfo::sharingThreads\endlink.
+    ///
+    inline std::size_t LastLevelCacheBytes() const
+    {
+      for ( size_t i = _cacheCount; i > 0; --i ) {
+        if ( _caches[i - 1].type != InstructionCache ) {
+          return _caches[i - 1].bytes;
+        }
+      }
+      return 0;
+    }
+
+    ///
+    /// \brief Returns the number of logical CPUs this process is allowed to run on, as reported by sched_getaffinity( )
+    ///
+    inline size_t LogicalCpuCount() const
+    {
+      return Topology().cpus.size();
+    }
+
+    ///
+    /// \brief Returns the number of physical cores among the logical CPUs of this process
+    ///
+    inline size_t PhysicalCoreCount() const
+    {
+      return Topology().coreCount;
+    }
+
+    ///
+    /// \brief Returns the number of packages (sockets) among the logical CPUs of this process
+    ///
+    inline size_t PackageCount() const
+    {
+      return Topology().packageCount;
+    }
+
+    ///
+    /// \brief Returns the placement of the logical CPU at index, which must be less than \link LogicalCpuCount( )\endlink. The CPUs are
+    /// listed by increasing operating system number.
+    ///
+    inline const LogicalCpu& GetLogicalCpu(size_t index) const
+    {
+      return Topology().cpus[index];
+    }
+
+    ///
+    /// \brief Returns where the topology comes from: Linux sysfs, or the x2APIC IDs of CPUID leaf 0x1F or 0xB when sysfs does not
+    /// describe it
+    ///
+    inline TopologySource GetTopologySource() const
+    {
+      return Topology().source;
+    }
+
+    ///
+    /// \brief Returns the operating system numbers of the logical CPUs sharing the physical core of cpu, cpu included
+    ///
+    inline std::vector<uint32_t> SmtSiblings(uint32_t cpu) const
+    {
+      const std::vector<LogicalCpu>& cpus = Topology().cpus;
+      std::vector<uint32_t> siblings;
+      for ( const LogicalCpu& logical : cpus ) {
+        if ( logical.id == cpu ) {
+          for ( const LogicalCpu& sibling : cpus ) {
+            if ( sibling.core == logical.core ) {
+              siblings.push_back(sibling.id);
+            }
+          }
+          break;
+        }
+      }
+      return siblings;
+    }
+
+    ///
+    /// \brief Returns the operating system number of the first logical CPU of every physical core, by increasing core index. Threads pinned
+    /// to these CPUs never share a core, see \link ThreadPool::PinToPhysicalCores( )\endlink.
+    ///
+    inline std::vector<uint32_t> OneCpuPerPhysicalCore() const
+    {
+      std::vector<uint32_t> cpus;
+      for ( const LogicalCpu& logical : Topology().cpus ) {
+        if ( logical.thread == 0 ) {
+          cpus.push_back(logical.id);
+        }
+      }
+      return cpus;
+    }
+
     ///
     /// \brief Returns an std::string with formatted capability description
     ///
@@ -247,6 +486,14 @@ namespace khyber
       capsStream << "AVX512F\t" << (IsAvx512F() ? "yes" : "no") << std::endl;
       capsStream << "FMA\t" << (IsFma() ? "yes" : "no") << std::endl;
       capsStream << "L2 line\t" << L2CachelineBytes << " bytes" << std::endl;
+      for ( size_t i = 0; i < _cacheCount; ++i ) {
+        const CacheInfo& cache = _caches[i];
+        capsStream << "L" << cache.level << (cache.type == DataCache ? "d" : (cache.type == InstructionCache ? "i" : "")) << "\t"
+                   << cache.bytes / 1024 << " KB, " << cache.ways << "-way, " << cache.lineBytes << " byte lines, shared by "
+                   << cache.sharingThreads << " threads" << std::endl;
+      }
+      capsStream << "CPUs\t" << PackageCount() << " packages, " << PhysicalCoreCount() << " cores, " << LogicalCpuCount()
+                 << " logical CPUs" << std::endl;
       
       return capsStream.str();
     }
@@ -264,5 +511,281 @@ namespace khyber
     // -------------------------------------------------------------------------------
     uint64_t _flags;
     char _brand[16];
+    CacheInfo _caches[MAX_CACHE_DESCRIPTORS];
+    size_t _cacheCount;
+    CacheSource _cacheSource;
+
+    // The logical CPUs of the process and their placement, a property of the host shared by every ProcessorCaps
+    struct CpuTopology
+    {
+      std::vector<LogicalCpu> cpus;
+      size_t coreCount;
+      size_t packageCount;
+      TopologySource source;
+    };
+
+    std::size_t CacheBytes(uint32_t level) const
+    {
+      for ( size_t i = 0; i < _cacheCount; ++i ) {
+        if ( _caches[i].level == level && _caches[i].type != InstructionCache ) {
+          return _caches[i].bytes;
+        }
+      }
+      return 0;
+    }
+
+    // Leaves 4 and 0x8000001D share the same layout, one subleaf per cache until a null type
+    bool EnumerateCaches(uint32_t leaf)
+    {
+      uint32_t eax;
+      uint32_t ebx;
+      uint32_t ecx;
+      uint32_t edx;
+      for ( uint32_t index = 0; _cacheCount < MAX_CACHE_DESCRIPTORS; ++index ) {
+        ecx = index;
+        cpuid(leaf, eax, ebx, ecx, edx);
+        uint32_t type = eax & 0x1F;
+        if ( type == 0 ) {
+          break;
+        }
+        if ( type > UnifiedCache ) {
+          continue;
+        }
+        CacheInfo& cache = _caches[_cacheCount++];
+        cache.level = (eax >> 5) & 0x7;
+        cache.type = (CacheType)type;
+        cache.lineBytes = (ebx & 0xFFF) + 1;
+        cache.ways = ((ebx >> 22) & 0x3FF) + 1;
+        cache.sets = ecx + 1;
+        cache.bytes = cache.lineBytes * (((ebx >> 12) & 0x3FF) + 1) * cache.ways * cache.sets;
+        cache.sharingThreads = ((eax >> 14) & 0xFFF) + 1;
+      }
+      return _cacheCount > 0;
+    }
+
+    static bool ReadSysfsValue(const std::string& directory, const char* name, std::string& value)
+    {
+      std::ifstream file((directory + name).c_str());
+      return (bool)std::getline(file, value);
+    }
+
+    static size_t ParseSysfsNumber(const std::string& value)
+    {
+      std::istringstream stream(value);
+      size_t number = 0;
+      char unit = 0;
+      stream >> number >> unit;
+      return unit == 'K' ? number << 10 : (unit == 'M' ? number << 20 : number);
+    }
+
+    // Counts the CPUs of a list such as "0-3,8-11"
+    static uint32_t ParseSysfsCpuCount(const std::string& value)
+    {
+      std::istringstream stream(value);
+      uint32_t count = 0;
+      std::string range;
+      while ( std::getline(stream, range, ',') ) {
+        size_t dash = range.find('-');
+        count += dash == std::string::npos ? 1 : ParseSysfsNumber(range.substr(dash + 1)) - ParseSysfsNumber(range) + 1;
+      }
+      return count;
+    }
+
+    bool ReadSysfsCaches()
+    {
+      for ( size_t index = 0; _cacheCount < MAX_CACHE_DESCRIPTORS; ++index ) {
+        std::ostringstream directory;
+        directory << "/sys/devices/system/cpu/cpu0/cache/index" << index << "/";
+        std::string level;
+        std::string type;
+        std::string size;
+        if ( !ReadSysfsValue(directory.str(), "level", level) || !ReadSysfsValue(directory.str(), "type", type) ||
+             !ReadSysfsValue(directory.str(), "size", size) ) {
+          break;
+        }
+        std::string lineSize;
+        std::string ways;
+        std::string sets;
+        std::string sharedCpus;
+        ReadSysfsValue(directory.str(), "coherency_line_size", lineSize);
+        ReadSysfsValue(directory.str(), "ways_of_associativity", ways);
+        ReadSysfsValue(directory.str(), "number_of_sets", sets);
+        ReadSysfsValue(directory.str(), "shared_cpu_list", sharedCpus);
+
+        CacheInfo& cache = _caches[_cacheCount++];
+        cache.level = ParseSysfsNumber(level);
+        cache.type = type == "Data" ? DataCache : (type == "Instruction" ? InstructionCache : UnifiedCache);
+        cache.bytes = ParseSysfsNumber(size);
+        cache.lineBytes = ParseSysfsNumber(lineSize);
+        cache.ways = ParseSysfsNumber(ways);
+        cache.sets = ParseSysfsNumber(sets);
+        cache.sharingThreads = std::max<uint32_t>(ParseSysfsCpuCount(sharedCpus), 1);
+      }
+      return _cacheCount > 0;
+    }
+
+    void SortCaches()
+    {
+      std::stable_sort(_caches, _caches + _cacheCount, [](const CacheInfo& a, const CacheInfo& b) {
+        return a.level < b.level || (a.level == b.level && a.type < b.type);
+      });
+    }
+
+    // Returns true if the extended topology leaf describes at least the SMT level
+    static bool HasTopologyLevels(uint32_t leaf)
+    {
+      uint32_t eax;
+      uint32_t ebx;
+      uint32_t ecx = 0;
+      uint32_t edx;
+      cpuid(leaf, eax, ebx, ecx, edx);
+      return ebx != 0;
+    }
+
+    // The x2APIC ID of a CPU is its package, core and SMT numbers packed into bit fields, whose widths leaf 0xB or 0x1F reports level
+    // by level. Every CPU is visited by pinning the calling thread to it in turn, as CPUID only describes the CPU it runs on, so this
+    // only runs on a helper thread of its own, see ReadCpuidTopologyOnHelper( ).
+    static bool ReadCpuidTopology(uint32_t leaf, const cpu_set_t& allowed, std::vector<uint32_t>& cpuIds,
+                                  std::vector<uint64_t>& coreKeys, std::vector<uint64_t>& packageKeys)
+    {
+      cpuIds.clear();
+      coreKeys.clear();
+      packageKeys.clear();
+      uint32_t eax;
+      uint32_t ebx;
+      uint32_t ecx;
+      uint32_t edx;
+      uint32_t smtShift = 0;
+      uint32_t packageShift = 0;
+      for ( uint32_t level = 0; level < 8; ++level ) {
+        ecx = level;
+        cpuid(leaf, eax, ebx, ecx, edx);
+        uint32_t levelType = (ecx >> 8) & LSB_8;
+        if ( levelType == 0 ) {
+          break;
+        }
+        if ( levelType == 1 ) {
+          smtShift = eax & 0x1F;
+        }
+        packageShift = eax & 0x1F;
+      }
+
+      for ( uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu ) {
+        if ( !CPU_ISSET(cpu, &allowed) ) {
+          continue;
+        }
+        cpu_set_t single;
+        CPU_ZERO(&single);
+        CPU_SET(cpu, &single);
+        if ( sched_setaffinity(0, sizeof(single), &single) != 0 ) {
+          return false;
+        }
+        ecx = 0;
+        cpuid(leaf, eax, ebx, ecx, edx);
+        cpuIds.push_back(cpu);
+        coreKeys.push_back(edx >> smtShift);
+        packageKeys.push_back(edx >> packageShift);
+      }
+      return !cpuIds.empty();
+    }
+
+    // Runs ReadCpuidTopology( ) on a short-lived thread, so the affinity of the calling thread is never touched
+    static bool ReadCpuidTopologyOnHelper(uint32_t leaf, const cpu_set_t& allowed, std::vector<uint32_t>& cpuIds,
+                                          std::vector<uint64_t>& coreKeys, std::vector<uint64_t>& packageKeys)
+    {
+      bool read = false;
+      try {
+        std::thread helper([&] { read = ReadCpuidTopology(leaf, allowed, cpuIds, coreKeys, packageKeys); });
+        helper.join();
+      } catch ( const std::system_error& ) {
+        return false;
+      }
+      return read;
+    }
+
+    // A core is identified by the lowest CPU of its SMT siblings, as core_id is only unique within a die and a package can have several
+    static bool ReadSysfsTopology(const cpu_set_t& allowed, std::vector<uint32_t>& cpuIds,
+                                  std::vector<uint64_t>& coreKeys, std::vector<uint64_t>& packageKeys)
+    {
+      cpuIds.clear();
+      coreKeys.clear();
+      packageKeys.clear();
+      for ( uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu ) {
+        if ( !CPU_ISSET(cpu, &allowed) ) {
+          continue;
+        }
+        std::ostringstream directory;
+        directory << "/sys/devices/system/cpu/cpu" << cpu << "/topology/";
+        std::string siblings;
+        std::string packageId;
+        if ( !(ReadSysfsValue(directory.str(), "core_cpus_list", siblings) ||
+               ReadSysfsValue(directory.str(), "thread_siblings_list", siblings)) ||
+             !ReadSysfsValue(directory.str(), "physical_package_id", packageId) ) {
+          return false;
+        }
+        cpuIds.push_back(cpu);
+        packageKeys.push_back(ParseSysfsNumber(packageId));
+        // The list is in ascending order, e.g., "4,36" or "4-5", so it starts with the lowest sibling
+        coreKeys.push_back(ParseSysfsNumber(siblings));
+      }
+      return !cpuIds.empty();
+    }
+
+    // Reads the topology of the CPUs the calling thread may run on from sysfs, or from CPUID when sysfs does not describe it
+    static CpuTopology EnumerateTopology()
+    {
+      CpuTopology topology;
+      topology.coreCount = 0;
+      topology.packageCount = 0;
+      topology.source = NoTopologySource;
+      cpu_set_t allowed;
+      if ( sched_getaffinity(0, sizeof(allowed), &allowed) != 0 ) {
+        return topology;
+      }
+
+      uint32_t highestFunction;
+      uint32_t ebx;
+      uint32_t ecx = 0;
+      uint32_t edx;
+      cpuid(0, highestFunction, ebx, ecx, edx);
+
+      std::vector<uint32_t> cpuIds;
+      std::vector<uint64_t> coreKeys;
+      std::vector<uint64_t> packageKeys;
+      if ( ReadSysfsTopology(allowed, cpuIds, coreKeys, packageKeys) ) {
+        topology.source = SysfsTopology;
+      } else if ( highestFunction >= 0x1F && HasTopologyLevels(0x1F) &&
+                  ReadCpuidTopologyOnHelper(0x1F, allowed, cpuIds, coreKeys, packageKeys) ) {
+        topology.source = CpuidLeaf1F;
+      } else if ( highestFunction >= 0xB && HasTopologyLevels(0xB) &&
+                  ReadCpuidTopologyOnHelper(0xB, allowed, cpuIds, coreKeys, packageKeys) ) {
+        topology.source = CpuidLeafB;
+      } else {
+        return topology;
+      }
+
+      // Cores and packages are numbered densely in order of their first CPU
+      std::map<uint64_t, uint32_t> cores;
+      std::map<uint64_t, uint32_t> packages;
+      std::map<uint64_t, uint32_t> threads;
+      for ( size_t i = 0; i < cpuIds.size(); ++i ) {
+        LogicalCpu logical;
+        logical.id = cpuIds[i];
+        logical.package = packages.insert(std::make_pair(packageKeys[i], (uint32_t)packages.size())).first->second;
+        logical.core = cores.insert(std::make_pair(coreKeys[i], (uint32_t)cores.size())).first->second;
+        logical.thread = threads[coreKeys[i]]++;
+        topology.cpus.push_back(logical);
+      }
+      topology.coreCount = cores.size();
+      topology.packageCount = packages.size();
+      return topology;
+    }
+
+    // The topology is enumerated once per process, the first time it is asked for, e.g., to pin the workers of the ThreadPool
+    static const CpuTopology& Topology()
+    {
+      static const CpuTopology topology = EnumerateTopology();
+      return topology;
+    }
   };
 }
@@ -15,17 +15,62 @@
 #pragma once
 
 #include <stdlib.h>
+#include <type_traits>
+#include <utility>
 #include <xmmintrin.h>
 #include <boost/cstdint.hpp>
+#include "BufferPool.hpp"
+#include "HugePages.hpp"
+#include "Numa.hpp"
 
 const size_t DEFAULT_ALIGNMENT = 32;
 
 namespace khyber
 {
+  ///
+  /// \brief Allocation policy that takes every block from the system allocator
+  ///
+  struct SystemBlocks
+  {
+    static void* Allocate(size_t bytes, size_t alignment)
+    {
+      return _mm_malloc(bytes, alignment);
+    }
+
+    static void Release(void* block, size_t, size_t)
+    {
+      _mm_free(block);
+    }
+  };
+
+  ///
+  /// \brief Allocation policy that reuses the blocks cached by the calling thread, see \link BufferPool\endlink
+  ///
+  struct PooledBlocks
+  {
+    static void* Allocate(size_t bytes, size_t alignment)
+    {
+      return BufferPool::Allocate(bytes, alignment);
+    }
+
+    static void Release(void* block, size_t bytes, size_t alignment)
+    {
+      BufferPool::Release(block, bytes, alignment);
+    }
+  };
+
   ///
   /// \brief Aligned memory allocator for working with SIMD (SSE, AVX) instructions
+  /// \details Policy supplies the memory, the default PooledBlocks lets the temporaries returned by every operation reuse
+  /// the buffers of earlier ones instead of reaching the system allocator each time. Blocks of at least HUGE_PAGE_BYTES
+  /// are taken from \link HugePages\endlink instead when the allocator's page mode or NUMA placement asks for it. The
+  /// page mode and the placement are the allocator's only state, they default to \link HugePages::GetDefaultMode( )\endlink
+  /// and \link Numa::GetDefaultPlacement( )\endlink and move with the buffer.
+  ///
+  /// construct( ) without arguments default-initializes, so resizing a vector leaves the new arithmetic elements
+  /// uninitialized; \link SimdContainer\endlink zeroes them itself, in parallel, so each chunk is first touched by a worker.
   ///
-  template<typename T, size_t alignment>
+  template<typename T, size_t alignment, typename Policy = PooledBlocks>
   struct SimdAllocator
   {
     typedef std::size_t size_type;
@@ -35,49 +80,90 @@ namespace khyber
     typedef T& reference;
     typedef const T& const_reference;
     typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
 
     template<typename U>
     struct rebind {
-      typedef SimdAllocator<U, alignment> other;
+      typedef SimdAllocator<U, alignment, Policy> other;
     };
 
-    SimdAllocator() throw() {}
+    SimdAllocator() throw() : pages(HugePages::GetDefaultMode()), placement(Numa::GetDefaultPlacement()) {}
 
-    SimdAllocator(const SimdAllocator&) throw() {}
+    explicit SimdAllocator(PageMode pages, NumaPlacement placement = Numa::GetDefaultPlacement()) throw()
+      : pages(pages), placement(placement) {}
+
+    SimdAllocator(const SimdAllocator& rhs) throw() : pages(rhs.pages), placement(rhs.placement) {}
 
     template<typename U>
-    SimdAllocator(const SimdAllocator<U, alignment>&) throw() {}
+    SimdAllocator(const SimdAllocator<U, alignment, Policy>& rhs) throw() : pages(rhs.pages), placement(rhs.placement) {}
 
     template<typename U>
-    SimdAllocator& operator = (const SimdAllocator<U, alignment>&)
+    SimdAllocator& operator = (const SimdAllocator<U, alignment, Policy>& rhs)
     {
+      pages = rhs.pages;
+      placement = rhs.placement;
       return *this;
     }
 
-    SimdAllocator<T, alignment>& operator = (const SimdAllocator&)
+    SimdAllocator<T, alignment, Policy>& operator = (const SimdAllocator& rhs)
     {
+      pages = rhs.pages;
+      placement = rhs.placement;
       return *this;
     }
 
     T* allocate(size_t n)
     {
-      return (T*)_mm_malloc(n * sizeof(T), alignment);
+      if ( UsesMappedPages(n) ) {
+        T* block = (T*)HugePages::Allocate(n * sizeof(T), pages);
+        Numa::Place(block, n * sizeof(T), sizeof(T), placement);
+        return block;
+      }
+      return (T*)Policy::Allocate(n * sizeof(T), alignment);
     }
 
     void deallocate(T* p, size_t n)
     {
-      _mm_free(p);
+      if ( UsesMappedPages(n) ) {
+        HugePages::Release(p, n * sizeof(T));
+      } else {
+        Policy::Release(p, n * sizeof(T), alignment);
+      }
+    }
+
+    template<typename U>
+    void construct(U* p)
+    {
+      ::new((void*)p) U;
+    }
+
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args)
+    {
+      ::new((void*)p) U(std::forward<Args>(args)...);
     }
+
+    ///
+    /// \brief Checks if n elements are mapped directly, for huge pages or for a NUMA placement, rather than taken from Policy
+    ///
+    bool UsesMappedPages(size_t n) const
+    {
+      return n * sizeof(T) >= HUGE_PAGE_BYTES && (pages != SmallPages || Numa::Applies(n * sizeof(T), placement));
+    }
+
+    PageMode pages;
+    NumaPlacement placement;
   };
 
-  template<typename T, typename U, size_t alignment>
-  inline bool operator == (const SimdAllocator<T, alignment>&, const SimdAllocator<U, alignment>&)
+  template<typename T, typename U, size_t alignment, typename Policy>
+  inline bool operator == (const SimdAllocator<T, alignment, Policy>& lhs, const SimdAllocator<U, alignment, Policy>& rhs)
   {
-    return true;
+    return lhs.pages == rhs.pages && lhs.placement == rhs.placement;
   }
 
-  template<typename T, typename U, size_t alignment>
-  inline bool operator != (const SimdAllocator<T, alignment>& lhs, const SimdAllocator<U, alignment>& rhs)
+  template<typename T, typename U, size_t alignment, typename Policy>
+  inline bool operator != (const SimdAllocator<T, alignment, Policy>& lhs, const SimdAllocator<U, alignment, Policy>& rhs)
   {
     return !(lhs == rhs);
   }
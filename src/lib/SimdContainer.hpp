@@ -15,36 +15,48 @@
 #pragma once
 
 #include <stdlib.h>
+#include <algorithm>
 #include <vector>
-#include "ProcessorCaps.hpp"
+#include "Parallel.hpp"
 #include "SimdAllocator.hpp"
+#include "Types.hpp"
 
 #define DEFAULT_CONTAINER_SIZE 512
 
 namespace khyber
 {
   ///
-  /// \brief The base class for all SIMD data structures, encapsulates an aligned std::vector<T> alongwith processor information.
+  /// \brief The base class for all SIMD data structures, encapsulates an aligned std::vector<T>.
   ///
   /// Most of the API for this class, as well as the \link Array<T>\endlink conforms to the std::vector<T> type. However, that results in a small bit
-  /// of inconsistencies in the API naming convention. For example, the type is CamelCased, as is the method \link OverrideProcessorCaps( )\endlink, but
+  /// of inconsistencies in the API naming convention. For example, the type is CamelCased, as are the compute methods of \link Array<T>\endlink such as Add( ), but
   /// the rest of the API is GNU style, e.g., \link resize( )\endlink, \link size( )\endlink and \link push_back( )\endlink.
   ///
+  /// New elements are zeroed like in std::vector<T>, but by the threads of the \link ThreadPool\endlink when there are enough of
+  /// them, each zeroing the chunk a \link ParallelFor( )\endlink over the array would give it, so that under the kernel's
+  /// first-touch policy the pages of a large array are spread over the NUMA nodes the pool runs on. See also \link NumaPlacement\endlink.
+  ///
   template<typename T>
   class SimdContainer
   {
   public:
     ///
-    /// \brief vector_type the underlying buffer's type, i.e., std::vector<T, ...>
+    /// \brief vector_type the underlying buffer's type, i.e., std::vector<T, ...>. Its allocator default-initializes, so
+    /// vector_type(n) and resize(n) on it leave the elements uninitialized.
     ///
     typedef std::vector<T, SimdAllocator<T, DEFAULT_ALIGNMENT> > vector_type;
+
+    ///
+    /// \brief allocator_type the allocator of the underlying buffer
+    ///
+    typedef typename vector_type::allocator_type allocator_type;
     
     ///
     /// \brief Construct a container of default size
     ///
     SimdContainer()
     {
-      _buffer.resize(DEFAULT_CONTAINER_SIZE);
+      resize(DEFAULT_CONTAINER_SIZE);
     }
 
     ///
@@ -53,7 +65,29 @@ namespace khyber
     ///
     SimdContainer(size_t capacity)
     {
-      _buffer.resize(capacity);
+      resize(capacity);
+    }
+
+    ///
+    /// \brief Construct a container of specified size whose buffer is backed by the given kind of pages, see \link PageMode\endlink
+    /// \param capacity the initial capacity of the container
+    /// \param pages the pages of this container's buffer, whatever its size becomes
+    /// \param placement the NUMA nodes of this container's buffer
+    ///
+    SimdContainer(size_t capacity, PageMode pages, NumaPlacement placement = Numa::GetDefaultPlacement())
+      : _buffer(allocator_type(pages, placement))
+    {
+      resize(capacity);
+    }
+
+    ///
+    /// \brief Construct a container of specified size whose buffer is placed on the given NUMA nodes, see \link NumaPlacement\endlink
+    /// \param capacity the initial capacity of the container
+    /// \param placement the NUMA nodes of this container's buffer, whatever its size becomes
+    ///
+    SimdContainer(size_t capacity, NumaPlacement placement) : _buffer(allocator_type(HugePages::GetDefaultMode(), placement))
+    {
+      resize(capacity);
     }
     
     ///
@@ -118,6 +152,18 @@ namespace khyber
     /// \param n new container size, expressed in number of elements
     ///
     void resize(size_t n)
+    {
+      size_t initialized = _buffer.size();
+      _buffer.resize(n);
+      Zero(initialized);
+    }
+
+    ///
+    /// \brief Resizes the container so that it contains n elements, leaving the new elements uninitialized. For buffers that are
+    /// about to be overwritten in full, it saves the write traffic of zeroing them first.
+    /// \param n new container size, expressed in number of elements
+    ///
+    void resize_uninitialized(size_t n)
     {
       _buffer.resize(n);
     }
@@ -192,6 +238,24 @@ namespace khyber
     {
       return _buffer.capacity();
     }
+
+    ///
+    /// \brief Query the kind of pages backing the underlying memory buffer once it is at least HUGE_PAGE_BYTES
+    /// \return the page mode of the buffer's allocator
+    ///
+    PageMode GetPageMode() const
+    {
+      return _buffer.get_allocator().pages;
+    }
+
+    ///
+    /// \brief Query the NUMA placement of the underlying memory buffer once it is at least HUGE_PAGE_BYTES
+    /// \return the placement of the buffer's allocator
+    ///
+    NumaPlacement GetPlacement() const
+    {
+      return _buffer.get_allocator().placement;
+    }
     
     ///
     /// \brief Return the mutable pointer to the start of the underlying memory buffer, use with extreme care
@@ -220,22 +284,21 @@ namespace khyber
       _buffer.swap(buffer);
     }
 
+  protected:
+    vector_type _buffer;
+
     ///
-    /// \brief <em>Not for end-use</em>, overrides the ProcessorCaps (capabilities) object associated to this SimdContainer<T>.
-    ///
-    /// Do \e not use this method as an end-user developer, it is only provided for diagnostic capabilities to be used by Khyber developers. The override
-    /// allows for testing of implementations other than the most efficient for the current architecture, e.g., allow execution of serial computation
-    /// methods on an AVX or AVX2 processor.
-    ///
-    /// \param procCaps the ProcessorCaps to override with for this SimdContainer<T>
+    /// \brief Zeroes the elements from offset to the end, in parallel chunks
     ///
-    void OverrideProcessorCaps(ProcessorCaps procCaps)
+    void Zero(size_t offset)
     {
-      _procCaps = procCaps;
+      if ( offset >= _buffer.size() ) {
+        return;
+      }
+      T* start = _buffer.data() + offset;
+      ParallelFor(_buffer.size() - offset, std::max<size_t>(PARALLEL_CHUNK_ALIGNMENT / sizeof(T), 1), [=](size_t begin, size_t count) {
+        std::fill(start + begin, start + begin + count, T());
+      });
     }
-
-  protected:
-    ProcessorCaps _procCaps;
-    vector_type _buffer;
   };
 }
@@ -0,0 +1,456 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Types.hpp"
+
+namespace khyber
+{
+  ///
+  /// \brief Low-level functions for vector operations using the SSE4.1 instruction set.
+  ///
+  /// This namespace provides C-style functions for computation using the SSE4.1 instruction set. These functions are used internally by
+  /// \link Array<T>\endlink to carry out the actual computations when the \link ProcessorCaps\endlink indicates that the SSE2 and SSE4.1 instruction
+  /// sets are present. While it is possible to use these functions for end-use, it is strongly suggested to use the \link Array<T>\endlink
+  /// class instead; the functions in this namespace are not processor aware, if you use them on a processor without SSE4.1 support, it will
+  /// cause a fault, i.e., hardware exception. Additionally, the \link Array<T>\endlink provides growable buffers as well as interface
+  /// compatibility between it and the std::vector<T> type.
+  ///
+  namespace sse
+  {
+    ///
+    /// \brief InternalAdd add the two single-precision floating point arrays augend and addend into sum
+    /// \param size the number of elements in all three array parameters
+    /// \param sum
+    /// \param augend
+    /// \param addend
+    ///
+    void InternalAdd(size_t size,
+                     float* sum,
+                     const float* augend,
+                     const float* addend);
+
+    ///
+    /// \brief Add a scalar to every element of a single-precision array
+    /// \param size the number of elements in the array sum and src
+    /// \param addend the scalar value to add to each element of the src array
+    /// \param sum the resulting array, can be the same address as src
+    /// \param src the array to add to
+    ///
+    void InternalScalarAdd(size_t size,
+                           float addend,
+                           float* sum,
+                           const float* src);
+
+    ///
+    /// \brief InternalSub subtract the single-precision array subtrahend from minuend and store the result in difference
+    /// \param size the number of elements in all three array parameters
+    /// \param difference
+    /// \param minuend
+    /// \param subtrahend
+    ///
+    void InternalSub(size_t size,
+                     float* difference,
+                     const float* minuend,
+                     const float* subtrahend);
+
+    ///
+    /// \brief InternalMul multiply the single-precision arrays multiplicand and multiplier and store the result in product. This can be considered
+    /// the classical cross product of two vectors
+    /// \param size the number of elements in all three array parameters
+    /// \param product
+    /// \param multiplicand
+    /// \param multiplier
+    ///
+    void InternalMul(size_t size,
+                     float* product,
+                     const float* multiplier,
+                     const float* multiplicand);
+
+    ///
+    /// \brief Multiply a single-precision array by a scalar
+    /// \param size the number of elements in the array product and src
+    /// \param multiplier the scalar value by which to multiply the src array
+    /// \param product the resulting array, can be the same address as src
+    /// \param src the array to multiply
+    ///
+    void InternalScalarMul(size_t size,
+                           float multiplier,
+                           float* product,
+                           const float* src);
+
+    ///
+    /// \brief InternalDiv divide the single-precision array dividend by divisor and store the results in quotient
+    /// \param size the number of elements in all three array parameters
+    /// \param quotient
+    /// \param dividend
+    /// \param divisor
+    ///
+    void InternalDiv(size_t size,
+                     float* quotient,
+                     const float* dividend,
+                     const float* divisor);
+
+    ///
+    /// \brief Divide a single-precision array by a scalar
+    /// \param size the number of elements in the array quotient and src
+    /// \param divisor the scalar value by which to divide the src array
+    /// \param quotient the output array, can be the same address as src
+    /// \param src the array to divide
+    ///
+    void InternalScalarDiv(size_t size,
+                           float divisor,
+                           float* quotient,
+                           const float* src);
+
+    ///
+    /// \brief InternalSqrt compute the square root of every element in the single-precision array src and store the results in dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalSqrt(size_t size,
+                      float* dst,
+                      const float* src);
+
+    ///
+    /// \brief InternalSquare compute the square of every element in the array src and store it in the array dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalSquare(size_t size,
+                        float* dst,
+                        const float* src);
+
+    ///
+    /// \brief Compute the cube of every element in the array src and store it in the array dst.
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalCube(size_t size,
+                      float* dst,
+                      const float* src);
+
+    ///
+    /// \brief Compute the sum of all elements in the single-precision array src, the output is a scalar. Note this is not the prefix sum,
+    /// the src array remains unchanged.
+    /// \param size the number of elements in both array parameters
+    /// \param sum
+    /// \param src
+    ///
+    void InternalSummation(size_t size,
+                           float* sum,
+                           const float* src);
+
+    ///
+    /// \brief InternalCompensatedSummation spread the single-precision array src over COMPENSATED_LANES running sums, element i going to lane i % COMPENSATED_LANES,
+    /// and add each element with Neumaier's compensated addition. The result is bitwise identical to that of the other instruction sets.
+    /// \param size the number of elements in the array parameter
+    /// \param lanes the COMPENSATED_LANES sums followed by their COMPENSATED_LANES compensations, see \link ParallelCompensatedReduce( )\endlink
+    /// \param src the array to sum
+    ///
+    void InternalCompensatedSummation(size_t size,
+                                      float* lanes,
+                                      const float* src);
+
+    ///
+    /// \brief InternalCompensatedDotProduct like InternalCompensatedSummation, over the products multiplier[i] * multiplicand[i] of the single-precision arrays
+    /// \param size the number of elements in both array parameters
+    /// \param lanes the COMPENSATED_LANES sums followed by their COMPENSATED_LANES compensations
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalCompensatedDotProduct(size_t size,
+                                       float* lanes,
+                                       const float* multiplier,
+                                       const float* multiplicand);
+
+    ///
+    /// \brief InternalPrefixSum compute the inclusive prefix sum of src into dst, i.e., dst[i] = carry + src[0] + ... + src[i], for single-precision arrays
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalPrefixSum(size_t size,
+                           float carry,
+                           float* dst,
+                           const float* src);
+
+    ///
+    /// \brief InternalExclusivePrefixSum compute the exclusive prefix sum of src into dst, i.e., dst[0] = carry and dst[i] = carry + src[0] + ... + src[i - 1], for single-precision arrays
+    /// \param size the number of elements in the array parameters
+    /// \param carry the running total to start from, e.g., the sum of all the elements preceding src
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src the array to scan
+    ///
+    void InternalExclusivePrefixSum(size_t size,
+                                    float carry,
+                                    float* dst,
+                                    const float* src);
+
+    ///
+    /// \brief InternalDotProduct compute the dot product of the single-precision arrays multiplicand and multiplier, store in product
+    /// \param size the number of elements in both array parameters
+    /// \param product pointer to a scalar single-precision float into which the dot product will be output
+    /// \param multiplier
+    /// \param multiplicand
+    ///
+    void InternalDotProduct(size_t size,
+                            float* product,
+                            const float* multiplier,
+                            const float* multiplicand);
+
+    ///
+    /// \brief Change the sign of every element in src and store the result in dst
+    /// \param size the number of elements in both array parameters
+    /// \param dst
+    /// \param src
+    ///
+    void InternalNegate(size_t size,
+                        float* dst,
+                        const float* src);
+
+    ///
+    /// \brief Compute the linear (geometric) distance between the two vectors, store in distance
+    /// \param size the number of elements in both array parameters
+    /// \param distance pointer to a scalar single-precision floating point into which the distance will be output
+    /// \param v1 array representing 1st point in size()-dimensional space
+    /// \param v2 array representing 2nd point in size()-dimensional space
+    ///
+    void InternalDistance(size_t size,
+                          float* distance,
+                          const float* v1,
+                          const float* v2);
+
+    ///
+    /// \brief Compute the reciprocal of every element in the src array by exact division and store it in the dst array
+    /// \param size the number of elements in both array parameters
+    /// \param dst destination array
+    /// \param src source array
+    ///
+    void InternalReciprocate(size_t size,
+                             float* dst,
+                             const float* src);
+
+    ///
+    /// \brief InternalMinimum find the smallest element of the single-precision array src, or NaN if src contains any NaN
+    /// \param size the number of elements in the array parameter
+    /// \param minimum pointer to the scalar into which the minimum is output, the largest finite value if size is 0
+    /// \param src the array to search
+    ///
+    void InternalMinimum(size_t size,
+                         float* minimum,
+                         const float* src);
+
+    ///
+    /// \brief InternalMaximum find the largest element of the single-precision array src, or NaN if src contains any NaN
+    /// \param size the number of elements in the array parameter
+    /// \param maximum pointer to the scalar into which the maximum is output, the lowest finite value if size is 0
+    /// \param src the array to search
+    ///
+    void InternalMaximum(size_t size,
+                         float* maximum,
+                         const float* src);
+
+    ///
+    /// \brief InternalMinMaximum find both the smallest and the largest element of the single-precision array src in a single pass, see InternalMinimum and InternalMaximum
+    /// \param size the number of elements in the array parameter
+    /// \param extrema pointer to the pair into which the minimum and maximum are output
+    /// \param src the array to search
+    ///
+    void InternalMinMaximum(size_t size,
+                            Extrema<float>* extrema,
+                            const float* src);
+
+    ///
+    /// \brief InternalArgMinimum find the index of the first smallest element of the single-precision array src, or of its first NaN if it contains any
+    /// \param size the number of elements in the array parameter
+    /// \param index pointer to the scalar into which the index is output, 0 if size is 0
+    /// \param src the array to search
+    ///
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const float* src);
+
+    ///
+    /// \brief InternalArgMaximum find the index of the first largest element of the single-precision array src, or of its first NaN if it contains any
+    /// \param size the number of elements in the array parameter
+    /// \param index pointer to the scalar into which the index is output, 0 if size is 0
+    /// \param src the array to search
+    ///
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const float* src);
+
+    ///
+    /// \brief InternalExp compute e^x of every element in the single-precision array src and store it in dst. The error is at most 1 ulp, results
+    /// overflow to infinity above 88.72 and are denormal below -87.33 where they lose precision gradually.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalExp(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalLog compute the natural logarithm of every element in the single-precision array src and store it in dst. The error is at most 1 ulp,
+    /// log(0) is -infinity and the logarithm of a negative number is NaN.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalLog(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalLog2 compute the base-2 logarithm of every element in the single-precision array src and store it in dst. The error is at most 1.5 ulp,
+    /// the special values are those of \link InternalLog( )\endlink.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalLog2(size_t size,
+                      float* dst,
+                      const float* src);
+
+    ///
+    /// \brief InternalSin compute the sine of every element in the single-precision array src and store it in dst. The error is at most 1.6 ulp over [-pi, pi],
+    /// beyond that the absolute error stays below 2^-23 up to |x| = 8192 and grows slowly for larger arguments.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalSin(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalCos compute the cosine of every element in the single-precision array src and store it in dst, with the same error bounds as
+    /// \link InternalSin( )\endlink
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalCos(size_t size,
+                     float* dst,
+                     const float* src);
+
+    ///
+    /// \brief InternalTanh compute the hyperbolic tangent of every element in the single-precision array src and store it in dst. The error is at most 1.4 ulp.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalTanh(size_t size,
+                      float* dst,
+                      const float* src);
+
+    ///
+    /// \brief InternalSigmoid compute the logistic function 1 / (1 + e^-x) of every element in the single-precision array src and store it in dst.
+    /// The error is at most 2.5 ulp.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalSigmoid(size_t size,
+                         float* dst,
+                         const float* src);
+
+    ///
+    /// \brief InternalPow raise every element of the single-precision array base to the power of the matching element of exponent and store it in dst.
+    /// It is computed as 2^(exponent * log2(base)), so the error grows with the magnitude of the result's binary exponent: about 1 + 1.2 * |exponent * log2(base)| ulp,
+    /// e.g. 7 ulp for results between 2^-5 and 2^5. The special values are those of std::pow.
+    /// \param size the number of elements in all three array parameters
+    /// \param dst the resulting array, can be the same address as base or exponent
+    /// \param base
+    /// \param exponent
+    ///
+    void InternalPow(size_t size,
+                     float* dst,
+                     const float* base,
+                     const float* exponent);
+
+    ///
+    /// \brief InternalApproximateReciprocate compute the reciprocal of every element in the single-precision array src with rcpps and store it in dst.
+    /// The relative error is at most 1.5*2^-12. Inputs whose reciprocal leaves the normal range, denormals included, give +/-infinity or 0.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalApproximateReciprocate(size_t size,
+                                        float* dst,
+                                        const float* src);
+
+    ///
+    /// \brief InternalRefinedReciprocate compute the reciprocal of every element in the single-precision array src with rcpps followed by one
+    /// Newton-Raphson step and store it in dst. The relative error is at most 1.7*2^-23, the special values are those of \link InternalApproximateReciprocate( )\endlink.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalRefinedReciprocate(size_t size,
+                                    float* dst,
+                                    const float* src);
+
+    ///
+    /// \brief InternalRsqrt compute the reciprocal square root 1 / sqrt(x) of every element in the single-precision array src by exact square root
+    /// and division and store it in dst. The relative error is at most 0.75*2^-23.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalRsqrt(size_t size,
+                       float* dst,
+                       const float* src);
+
+    ///
+    /// \brief InternalApproximateRsqrt compute the reciprocal square root of every element in the single-precision array src with rsqrtps and store it in dst.
+    /// The relative error is at most 1.5*2^-12. Denormal inputs give +infinity.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalApproximateRsqrt(size_t size,
+                                  float* dst,
+                                  const float* src);
+
+    ///
+    /// \brief InternalRefinedRsqrt compute the reciprocal square root of every element in the single-precision array src with rsqrtps followed by one
+    /// Newton-Raphson step and store it in dst. The relative error is at most 2.3*2^-23, the special values are those of \link InternalApproximateRsqrt( )\endlink.
+    /// \param size the number of elements in both array parameters
+    /// \param dst the resulting array, can be the same address as src
+    /// \param src
+    ///
+    void InternalRefinedRsqrt(size_t size,
+                              float* dst,
+                              const float* src);
+
+    ///
+    /// \brief InternalStreamingCopy copy bytes bytes from src to dst with non-temporal stores, which write around the caches instead of
+    /// evicting their contents. The stores are weakly ordered: the caller must issue an sfence before another thread reads dst.
+    /// \param bytes the number of bytes to copy
+    /// \param dst the destination, any alignment, the bytes before its first 16 byte boundary are stored normally
+    /// \param src the source, any alignment, must not overlap dst
+    ///
+    void InternalStreamingCopy(size_t bytes,
+                               void* dst,
+                               const void* src);
+  }
+}
@@ -0,0 +1,228 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pthread.h>
+#include <sched.h>
+#include <utility>
+#include "ProcessorCaps.hpp"
+#include "ThreadPool.hpp"
+
+namespace khyber
+{
+  static thread_local bool t_inParallelRegion = false;
+
+  ///
+  /// \brief Marks the calling thread as running a job for its lifetime, whether the job returns or throws
+  ///
+  class ParallelRegionGuard
+  {
+  public:
+    ParallelRegionGuard()
+    {
+      t_inParallelRegion = true;
+    }
+
+    ~ParallelRegionGuard()
+    {
+      t_inParallelRegion = false;
+    }
+  };
+
+  static size_t DefaultThreadCount()
+  {
+    size_t hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 0 ? hardwareThreads : 1;
+  }
+
+  ThreadPool& ThreadPool::Instance()
+  {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  ThreadPool::ThreadPool()
+    : _threadCount(DefaultThreadCount()),
+      _parallelThreshold(DEFAULT_PARALLEL_THRESHOLD),
+      _task(nullptr),
+      _taskCount(0),
+      _generation(0),
+      _activeWorkers(0),
+      _error(nullptr),
+      _stop(false),
+      _nextTask(0)
+  {
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    StopWorkers();
+  }
+
+  void ThreadPool::SetThreadCount(size_t threadCount)
+  {
+    std::lock_guard<std::mutex> submission(_submitMutex);
+    StopWorkers();
+    _threadCount = threadCount > 0 ? threadCount : DefaultThreadCount();
+  }
+
+  void ThreadPool::SetAffinity(const std::vector<uint32_t>& cpus)
+  {
+    std::lock_guard<std::mutex> submission(_submitMutex);
+    StopWorkers();
+    _affinity = cpus;
+  }
+
+  void ThreadPool::PinToPhysicalCores()
+  {
+    std::vector<uint32_t> cpus = ProcessorCaps::Host().OneCpuPerPhysicalCore();
+    if ( cpus.empty() ) {
+      return;
+    }
+    SetThreadCount(cpus.size());
+    SetAffinity(cpus);
+  }
+
+  bool ThreadPool::PinCurrentThread(uint32_t cpu)
+  {
+    cpu_set_t single;
+    CPU_ZERO(&single);
+    CPU_SET(cpu, &single);
+    return pthread_setaffinity_np(pthread_self(), sizeof(single), &single) == 0;
+  }
+
+  bool ThreadPool::InParallelRegion()
+  {
+    return t_inParallelRegion;
+  }
+
+  void ThreadPool::Run(size_t taskCount, const std::function<void(size_t)>& task)
+  {
+    if ( taskCount == 0 ) {
+      return;
+    }
+
+    // A job submitted from inside a task would wait for the pool forever
+    if ( t_inParallelRegion ) {
+      for ( size_t i = 0; i < taskCount; ++i ) {
+        task(i);
+      }
+      return;
+    }
+
+    std::lock_guard<std::mutex> submission(_submitMutex);
+    if ( _workers.size() + 1 < _threadCount ) {
+      StartWorkers();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _task = &task;
+      _taskCount = taskCount;
+      _nextTask = 0;
+      _error = nullptr;
+      ++_generation;
+    }
+    _wake.notify_all();
+
+    // The calling thread works on the job too, then waits for the workers still running the tasks they claimed. task must
+    // outlive every worker that uses it, so the wait happens whatever the tasks did.
+    {
+      ParallelRegionGuard region;
+      RunTasks(task, taskCount);
+    }
+
+    std::exception_ptr error;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _task = nullptr;
+      _done.wait(lock, [this] { return _activeWorkers == 0; });
+      std::swap(error, _error);
+    }
+    if ( error ) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  void ThreadPool::RunTasks(const std::function<void(size_t)>& task, size_t taskCount)
+  {
+    try {
+      for ( size_t i = _nextTask++; i < taskCount; i = _nextTask++ ) {
+        task(i);
+      }
+    } catch ( ... ) {
+      // Keep the first exception for Run( ) and let the other threads skip the tasks nobody has claimed yet
+      _nextTask = taskCount;
+      std::lock_guard<std::mutex> lock(_mutex);
+      if ( !_error ) {
+        _error = std::current_exception();
+      }
+    }
+  }
+
+  void ThreadPool::WorkerLoop(size_t index)
+  {
+    if ( !_affinity.empty() ) {
+      PinCurrentThread(_affinity[index % _affinity.size()]);
+    }
+    t_inParallelRegion = true;
+    uint64_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(_mutex);
+    for ( ;; ) {
+      _wake.wait(lock, [&] { return _stop || _generation != seenGeneration; });
+      if ( _stop ) {
+        return;
+      }
+
+      // A worker that wakes up after the submitter has finished the job finds no task and goes back to sleep
+      seenGeneration = _generation;
+      if ( _task == nullptr ) {
+        continue;
+      }
+
+      const std::function<void(size_t)>* task = _task;
+      size_t taskCount = _taskCount;
+      ++_activeWorkers;
+      lock.unlock();
+      RunTasks(*task, taskCount);
+      lock.lock();
+      if ( --_activeWorkers == 0 ) {
+        _done.notify_all();
+      }
+    }
+  }
+
+  void ThreadPool::StartWorkers()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = false;
+    }
+    while ( _workers.size() + 1 < _threadCount ) {
+      _workers.emplace_back(&ThreadPool::WorkerLoop, this, _workers.size() + 1);
+    }
+  }
+
+  void ThreadPool::StopWorkers()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+    for ( auto& worker : _workers ) {
+      worker.join();
+    }
+    _workers.clear();
+  }
+}
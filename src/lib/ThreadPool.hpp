@@ -0,0 +1,139 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Arrays with fewer elements than this run on the calling thread only
+#define DEFAULT_PARALLEL_THRESHOLD (1 << 18)
+
+namespace khyber
+{
+  ///
+  /// \brief Process-wide pool of worker threads used to split large \link Array<T>\endlink operations across cores.
+  /// \details The pool is created on first use with one thread per hardware thread, the thread calling \link Run( )\endlink
+  /// counts as one of them and executes tasks as well. Only one job runs at a time; a job submitted from inside a task,
+  /// or while another thread's job is running, waits for the pool. Operations on arrays shorter than the parallel threshold
+  /// never reach the pool, see \link ParallelFor( )\endlink.
+  ///
+  class ThreadPool
+  {
+  public:
+    ///
+    /// \brief Returns the pool shared by the whole process
+    ///
+    static ThreadPool& Instance();
+
+    ~ThreadPool();
+
+    ///
+    /// \brief Returns the number of threads that execute a job, including the calling thread
+    ///
+    size_t GetThreadCount() const
+    {
+      return _threadCount;
+    }
+
+    ///
+    /// \brief Sets the number of threads that execute a job, including the calling thread. 1 disables multithreading, 0 restores the
+    /// default of one thread per hardware thread. Must not be called while a job is running.
+    ///
+    void SetThreadCount(size_t threadCount);
+
+    ///
+    /// \brief Pins the worker threads to the given logical CPUs, worker i to cpus[i % cpus.size( )] for i from 1, the calling thread of
+    /// a job being thread 0. The calling thread itself is not pinned, cpus[0] is left for it. An empty list unpins the workers. Must not
+    /// be called while a job is running.
+    ///
+    void SetAffinity(const std::vector<uint32_t>& cpus);
+
+    ///
+    /// \brief Runs one thread per physical core, with the workers pinned to the cores other than the first, so no two threads of a job
+    /// share a core through SMT. Memory-bound kernels scale better this way than with one thread per logical CPU. See
+    /// \link ProcessorCaps::OneCpuPerPhysicalCore( )\endlink. Must not be called while a job is running.
+    ///
+    void PinToPhysicalCores();
+
+    ///
+    /// \brief Pins the calling thread to the logical CPU cpu
+    /// \return false if the operating system refused, e.g., because cpu is outside the affinity mask of the process
+    ///
+    static bool PinCurrentThread(uint32_t cpu);
+
+    ///
+    /// \brief Returns the minimum number of elements for an operation to be split across the pool
+    ///
+    size_t GetParallelThreshold() const
+    {
+      return _parallelThreshold;
+    }
+
+    ///
+    /// \brief Sets the minimum number of elements for an operation to be split across the pool, default DEFAULT_PARALLEL_THRESHOLD
+    ///
+    void SetParallelThreshold(size_t elements)
+    {
+      _parallelThreshold = elements;
+    }
+
+    ///
+    /// \brief Calls task(i) for every i in [0, taskCount) on the threads of the pool and returns once all of them have completed.
+    /// If a task throws, the tasks not yet started are skipped and the first exception is rethrown once every thread is done.
+    /// \param taskCount the number of tasks in the job
+    /// \param task the function to execute, it must be safe to call concurrently for different indices
+    ///
+    void Run(size_t taskCount, const std::function<void(size_t)>& task);
+
+    ///
+    /// \brief Returns true on a thread that is currently executing a task of a job, nested jobs are run serially on such threads
+    ///
+    static bool InParallelRegion();
+
+  private:
+    ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator = (const ThreadPool&) = delete;
+
+    void StartWorkers();
+    void StopWorkers();
+    void WorkerLoop(size_t index);
+    void RunTasks(const std::function<void(size_t)>& task, size_t taskCount);
+
+    size_t _threadCount;
+    std::atomic<size_t> _parallelThreshold;
+    std::vector<std::thread> _workers;
+    std::vector<uint32_t> _affinity;
+
+    std::mutex _submitMutex;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    const std::function<void(size_t)>* _task;
+    size_t _taskCount;
+    uint64_t _generation;
+    size_t _activeWorkers;
+    std::exception_ptr _error;
+    bool _stop;
+    std::atomic<size_t> _nextTask;
+  };
+}
@@ -0,0 +1,71 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Number of independent running sums the compensated kernels, e.g., avx::InternalCompensatedSummation( ), spread an array over.
+// Element i always goes to lane i % COMPENSATED_LANES whatever the register width, which keeps their results identical.
+#define COMPENSATED_LANES 16
+
+namespace khyber
+{
+  typedef float sp_t;      /// single-precision floating point
+  typedef double dp_t;     /// double-precision floating point
+  typedef uint32_t ui32_t; /// unsigned 32-bit integer
+  typedef int32_t i32_t;   /// signed 32-bit integer
+
+  ///
+  /// \brief Accuracy requested from the operations that can trade it for throughput, e.g., \link Array<T>::Reciprocate( )\endlink
+  /// * Approximate: the hardware estimate alone, a relative error of at most 1.5*2^-12 for single-precision;
+  /// * Refined: the estimate followed by one Newton-Raphson step, a relative error of about 2^-22;
+  /// * Exact: IEEE division and square root, correctly rounded apart from the double rounding of 1 / sqrt(x).
+  ///
+  /// Double-precision and integral arrays, and processors without SSE4.1, have no hardware estimate and always compute exactly.
+  ///
+  enum PrecisionMode { Approximate, Refined, Exact };
+
+  ///
+  /// \brief Maps an element type to the type its wide reductions, e.g., \link Array<T>::WideSummation( )\endlink, accumulate in
+  ///
+  template<typename T>
+  struct WideType
+  {
+    typedef T type;
+  };
+
+  template<>
+  struct WideType<uint32_t>
+  {
+    typedef uint64_t type;
+  };
+
+  template<>
+  struct WideType<int32_t>
+  {
+    typedef int64_t type;
+  };
+
+  ///
+  /// \brief The smallest and the largest element of an array, as found in a single pass by \link Array<T>::MinMax( )\endlink
+  ///
+  template<typename T>
+  struct Extrema
+  {
+    T minimum;
+    T maximum;
+  };
+}
@@ -0,0 +1,222 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "Parallel.hpp"
+#include "VectorIndex.hpp"
+
+namespace khyber
+{
+  // A candidate neighbor ordered by key, the smaller the nearer, then by id. Keys are distances or negated similarities, so
+  // every metric selects the smallest ones.
+  typedef std::pair<float, size_t> Candidate;
+
+  // The k nearest candidates seen so far, as a max-heap whose front is the one to evict next
+  typedef std::vector<Candidate> CandidateHeap;
+
+  VectorIndex::VectorIndex(size_t dimension, VectorMetric metric)
+    : _dimension(dimension), _metric(metric), _count(0), _vectors(0), _weights(0)
+  {
+    if ( dimension == 0 ) {
+      throw std::invalid_argument("VectorIndex: the dimension must be at least 1");
+    }
+    const size_t granule = VECTOR_INDEX_ALIGNMENT / sizeof(float);
+    _stride = (dimension + granule - 1) / granule * granule;
+  }
+
+  void VectorIndex::reserve(size_t count)
+  {
+    _vectors.reserve(count * _stride);
+    _weights.reserve(count);
+  }
+
+  void VectorIndex::Append(const float* vector)
+  {
+    // vector may be a stored one, e.g., from Vector( ), which growing the storage moves
+    std::less<const float*> before;
+    const float* stored = _vectors.data();
+    bool inside = !before(vector, stored) && before(vector, stored + _vectors.size());
+    size_t offset = vector - stored;
+    _vectors.resize((_count + 1) * _stride);
+    if ( inside ) {
+      vector = _vectors.data() + offset;
+    }
+    float* copy = _vectors.data() + _count * _stride;
+    std::copy(vector, vector + _dimension, copy);
+
+    float squaredNorm = 0;
+    ArchBinding<float>::Active().DotProduct(_dimension, &squaredNorm, copy, copy);
+    float weight = 0;
+    if ( _metric == L2Distance ) {
+      weight = squaredNorm;
+    } else if ( _metric == CosineSimilarity ) {
+      weight = squaredNorm > 0 ? -1 / std::sqrt(squaredNorm) : 0;
+    }
+    _weights.resize(_count + 1);
+    _weights[_count] = weight;
+    ++_count;
+  }
+
+  size_t VectorIndex::Add(ArrayView<const float> vector)
+  {
+    if ( vector.size() != _dimension ) {
+      throw std::invalid_argument("VectorIndex::Add: the index has dimension " + std::to_string(_dimension) + ", the vector " +
+                                  std::to_string(vector.size()) + " elements");
+    }
+    Append(vector.data());
+    return _count - 1;
+  }
+
+  size_t VectorIndex::Add(const Matrix<float>& vectors)
+  {
+    if ( vectors.columns() != _dimension ) {
+      throw std::invalid_argument("VectorIndex::Add: the index has dimension " + std::to_string(_dimension) + ", the vectors " +
+                                  std::to_string(vectors.columns()) + " columns");
+    }
+    size_t first = _count;
+    reserve(_count + vectors.rows());
+    for ( size_t row = 0; row < vectors.rows(); ++row ) {
+      Append(vectors.data() + row * _dimension);
+    }
+    return first;
+  }
+
+  std::vector<Neighbor> VectorIndex::Search(ArrayView<const float> query, size_t k) const
+  {
+    if ( query.size() != _dimension ) {
+      throw std::invalid_argument("VectorIndex::Search: the index has dimension " + std::to_string(_dimension) + ", the query " +
+                                  std::to_string(query.size()) + " elements");
+    }
+    return SearchBatch(query.data(), 1, k)[0];
+  }
+
+  std::vector<std::vector<Neighbor> > VectorIndex::Search(const Matrix<float>& queries, size_t k) const
+  {
+    if ( queries.columns() != _dimension ) {
+      throw std::invalid_argument("VectorIndex::Search: the index has dimension " + std::to_string(_dimension) + ", the queries " +
+                                  std::to_string(queries.columns()) + " columns");
+    }
+    return SearchBatch(queries.data(), queries.rows(), k);
+  }
+
+  ///
+  /// \brief Offers the candidates of row, the keys of the vectors from first on, whose indices are in selected, to heap
+  ///
+  static void Offer(CandidateHeap& heap, size_t k, const float* row, size_t first, const uint32_t* selected, size_t count)
+  {
+    for ( size_t i = 0; i < count; ++i ) {
+      Candidate candidate(row[selected[i]], first + selected[i]);
+      if ( heap.size() < k ) {
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end());
+      } else if ( candidate < heap.front() ) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = candidate;
+        std::push_heap(heap.begin(), heap.end());
+      }
+    }
+  }
+
+  std::vector<std::vector<Neighbor> > VectorIndex::SearchBatch(const float* queries, size_t queryCount, size_t k) const
+  {
+    const ArchBinding<float>& binding = ArchBinding<float>::Active();
+    std::vector<std::vector<Neighbor> > results(queryCount);
+    k = std::min(k, _count);
+    if ( k == 0 || queryCount == 0 ) {
+      return results;
+    }
+
+    // The queries are padded like the stored vectors, and normalized for the cosine similarity
+    Matrix<float> padded(queryCount, _stride);
+    std::vector<float> squaredNorms(queryCount);
+    for ( size_t q = 0; q < queryCount; ++q ) {
+      const float* query = queries + q * _dimension;
+      float* copy = padded.data() + q * _stride;
+      std::copy(query, query + _dimension, copy);
+      binding.DotProduct(_dimension, &squaredNorms[q], query, query);
+      if ( _metric == CosineSimilarity && squaredNorms[q] > 0 ) {
+        binding.ScalarMul(_dimension, 1 / std::sqrt(squaredNorms[q]), copy, copy);
+      }
+    }
+
+    // Each chunk of the database keeps its own heap per query, they are merged at the end
+    ChunkLayout layout = PartitionForPool(_count, VECTOR_INDEX_BLOCK, queryCount * _count * _stride);
+    std::vector<CandidateHeap> heaps(layout.chunkCount * queryCount);
+    auto search = [&](size_t chunk) {
+      std::vector<float, SimdAllocator<float, POOL_BLOCK_ALIGNMENT> > keys(VECTOR_INDEX_QUERY_BLOCK * VECTOR_INDEX_BLOCK);
+      std::vector<uint32_t> selected(VECTOR_INDEX_BLOCK);
+      size_t end = std::min(_count, (chunk + 1) * layout.chunkSize);
+
+      for ( size_t block = chunk * layout.chunkSize; block < end; block += VECTOR_INDEX_BLOCK ) {
+        size_t blockSize = std::min<size_t>(VECTOR_INDEX_BLOCK, end - block);
+        const float* weights = _weights.data() + block;
+        for ( size_t queryBlock = 0; queryBlock < queryCount; queryBlock += VECTOR_INDEX_QUERY_BLOCK ) {
+          size_t queryBlockSize = std::min<size_t>(VECTOR_INDEX_QUERY_BLOCK, queryCount - queryBlock);
+          binding.DotProductTile(_stride, queryBlockSize, blockSize, keys.data(), VECTOR_INDEX_BLOCK,
+                                 padded.data() + queryBlock * _stride, _stride, _vectors.data() + block * _stride, _stride);
+
+          for ( size_t q = 0; q < queryBlockSize; ++q ) {
+            float* row = keys.data() + q * VECTOR_INDEX_BLOCK;
+            if ( _metric == L2Distance ) {
+              // |v|^2 - 2 q.v, |q|^2 is the same for every vector and only added to the results
+              binding.ScalarMul(blockSize, -2.0f, row, row);
+              binding.Add(blockSize, row, row, weights);
+            } else if ( _metric == InnerProduct ) {
+              binding.Negate(blockSize, row, row);
+            } else {
+              binding.Mul(blockSize, row, row, weights);
+            }
+
+            CandidateHeap& heap = heaps[chunk * queryCount + queryBlock + q];
+            float threshold = heap.size() < k ? std::numeric_limits<float>::infinity() : heap.front().first;
+            size_t count = 0;
+            binding.SelectBelow(blockSize, threshold, &count, selected.data(), row);
+            Offer(heap, k, row, block, selected.data(), count);
+          }
+        }
+      }
+    };
+
+    if ( layout.chunkCount <= 1 ) {
+      search(0);
+    } else {
+      ThreadPool::Instance().Run(layout.chunkCount, search);
+    }
+
+    for ( size_t q = 0; q < queryCount; ++q ) {
+      CandidateHeap candidates;
+      for ( size_t chunk = 0; chunk < layout.chunkCount; ++chunk ) {
+        const CandidateHeap& heap = heaps[chunk * queryCount + q];
+        candidates.insert(candidates.end(), heap.begin(), heap.end());
+      }
+      size_t found = std::min(k, candidates.size());
+      std::partial_sort(candidates.begin(), candidates.begin() + found, candidates.end());
+
+      std::vector<Neighbor>& neighbors = results[q];
+      neighbors.resize(found);
+      for ( size_t i = 0; i < found; ++i ) {
+        float key = candidates[i].first;
+        neighbors[i].id = candidates[i].second;
+        neighbors[i].score = _metric == L2Distance ? std::sqrt(std::max(key + squaredNorms[q], 0.0f)) : -key;
+      }
+    }
+    return results;
+  }
+}
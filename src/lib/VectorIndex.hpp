@@ -0,0 +1,146 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include "Array.hpp"
+#include "Matrix.hpp"
+
+// Every stored vector starts on a multiple of this many bytes, the vectors are zero padded up to it
+#define VECTOR_INDEX_ALIGNMENT 32
+
+// Vectors scored at a time by one thread, 128KB of 128-dimensional vectors, which stay in L2 while the queries of a batch go by
+#define VECTOR_INDEX_BLOCK 256
+
+// Queries scored at a time against a block of vectors, their scores take 32KB
+#define VECTOR_INDEX_QUERY_BLOCK 32
+
+namespace khyber
+{
+  ///
+  /// \brief How a \link VectorIndex\endlink compares a query with the stored vectors
+  ///
+  enum VectorMetric
+  {
+    L2Distance,      // Euclidean distance, the smallest first
+    InnerProduct,    // dot product, the largest first
+    CosineSimilarity // dot product of the normalized vectors, the largest first
+  };
+
+  ///
+  /// \brief One result of a \link VectorIndex::Search( )\endlink: the id of a stored vector and its distance or similarity to the query
+  ///
+  struct Neighbor
+  {
+    size_t id;
+    float score;
+  };
+
+  ///
+  /// \brief Exact k-nearest-neighbor search over a collection of single-precision vectors of one dimension.
+  /// \details The vectors are stored one after the other in a single aligned block, each padded to VECTOR_INDEX_ALIGNMENT, and
+  /// their ids are their positions in it. A search scores the queries against every stored vector: blocks of vectors are multiplied
+  /// by blocks of queries in the DotProductTile kernel of the process-wide \link ArchBinding<float>\endlink, the dot products are
+  /// turned into distances with the element-wise kernels, and the SelectBelow kernel drops, eight at a time, the ones that cannot
+  /// beat the k-th best so far, so only the few that can go into each query's heap. L2 distances are computed as
+  /// |q|^2 + |v|^2 - 2 q.v from the norms of the stored vectors. The database is split across the \link ThreadPool\endlink.
+  /// Adding vectors must not overlap a search; any number of searches can run at once.
+  ///
+  class VectorIndex
+  {
+  public:
+    ///
+    /// \brief Construct an empty index of vectors of dimension elements, compared by metric.
+    /// Throws std::invalid_argument if dimension is 0.
+    ///
+    explicit VectorIndex(size_t dimension, VectorMetric metric = L2Distance);
+
+    size_t dimension() const
+    {
+      return _dimension;
+    }
+
+    VectorMetric metric() const
+    {
+      return _metric;
+    }
+
+    ///
+    /// \brief Returns the number of stored vectors
+    ///
+    size_t size() const
+    {
+      return _count;
+    }
+
+    bool empty() const
+    {
+      return _count == 0;
+    }
+
+    ///
+    /// \brief Reserves room for count vectors, so adding up to that many does not move the stored ones
+    ///
+    void reserve(size_t count);
+
+    ///
+    /// \brief Stores a copy of vector, which can be a view of a stored one. Throws std::invalid_argument if it does not have
+    /// dimension( ) elements.
+    /// \return the id of the vector, the number of vectors stored before it
+    ///
+    size_t Add(ArrayView<const float> vector);
+
+    ///
+    /// \brief Stores a copy of every row of vectors. Throws std::invalid_argument if it does not have dimension( ) columns.
+    /// \return the id of the first row, the others follow in order
+    ///
+    size_t Add(const Matrix<float>& vectors);
+
+    ///
+    /// \brief Returns a view of the stored vector with the given id, it is invalidated when vectors are added
+    ///
+    ArrayView<const float> Vector(size_t id) const
+    {
+      return ArrayView<const float>(_vectors.data() + id * _stride, _dimension);
+    }
+
+    ///
+    /// \brief Finds the k stored vectors nearest to query. Throws std::invalid_argument if it does not have dimension( ) elements.
+    /// \return min(k, size( )) neighbors, the nearest first, ties going to the lower id. The score is the Euclidean distance, the
+    /// dot product or the cosine similarity according to metric( ). Vectors whose score is NaN are never returned.
+    ///
+    std::vector<Neighbor> Search(ArrayView<const float> query, size_t k) const;
+
+    ///
+    /// \brief Finds the k stored vectors nearest to each row of queries, see the single query Search( ). Scoring many queries at
+    /// once reads the stored vectors once per block of queries instead of once per query. Throws std::invalid_argument if queries
+    /// does not have dimension( ) columns.
+    /// \return one list of neighbors per row of queries
+    ///
+    std::vector<std::vector<Neighbor> > Search(const Matrix<float>& queries, size_t k) const;
+
+  private:
+    size_t _dimension;
+    size_t _stride;
+    VectorMetric _metric;
+    size_t _count;
+    Array<float> _vectors;
+    // |v|^2 for the L2 distance, -1/|v| for the cosine similarity, unused for the inner product
+    Array<float> _weights;
+
+    void Append(const float* vector);
+    std::vector<std::vector<Neighbor> > SearchBatch(const float* queries, size_t queryCount, size_t k) const;
+  };
+}
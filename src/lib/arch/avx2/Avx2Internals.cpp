@@ -13,21 +13,35 @@
 // limitations under the License.
 
 #include <immintrin.h>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 #include "Avx2Internals.hpp"
 
 namespace khyber
 {
   namespace avx2
   {
+    // Reduces the 8 lanes of v to a single float: the upper 128 bits are folded onto the lower ones, then
+    // the remaining 4 lanes are folded twice within the XMM register.
+    static inline float HorizontalSum(__m256 v)
+    {
+      __m128 xmm = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+      xmm = _mm_add_ps(xmm, _mm_movehl_ps(xmm, xmm));
+      xmm = _mm_add_ss(xmm, _mm_movehdup_ps(xmm));
+      return _mm_cvtss_f32(xmm);
+    }
+
     void InternalAdd(size_t size,
                      float* sum,
-                     float* augend,
+                     const float* augend,
                      const float* addend)
     {
-      __m256* pSum = (__m256*)sum;
-      __m256* pAugend = (__m256*)augend;
-      __m256* pAddend = (__m256*)addend;
+      __m256_u* pSum = (__m256_u*)sum;
+      const __m256_u* pAugend = (const __m256_u*)augend;
+      const __m256_u* pAddend = (const __m256_u*)addend;
 
       size_t i;
       for ( i = 0; i < (size >> 3); ++i ) {
@@ -40,13 +54,422 @@ namespace khyber
       }
     }
 
+    void InternalScalarAdd(size_t size,
+                           float addend,
+                           float* sum,
+                           const float* src)
+    {
+      __m256_u* pSum = (__m256_u*)sum;
+      const __m256_u* pSrc = (const __m256_u*)src;
+      __m256 ymmAddend = _mm256_set1_ps(addend);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pSum[i] = _mm256_add_ps(pSrc[i], ymmAddend);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        sum[i] = src[i] + addend;
+      }
+    }
+
+    void InternalSub(size_t size,
+                     float* difference,
+                     const float* minuend,
+                     const float* subtrahend)
+    {
+      __m256_u* pDifference = (__m256_u*)difference;
+      const __m256_u* pMinuend = (const __m256_u*)minuend;
+      const __m256_u* pSubtrahend = (const __m256_u*)subtrahend;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDifference[i] = _mm256_sub_ps(pMinuend[i], pSubtrahend[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        difference[i] = minuend[i] - subtrahend[i];
+      }
+    }
+
+    void InternalMul(size_t size,
+                     float* product,
+                     const float* multiplier,
+                     const float* multiplicand)
+    {
+      __m256_u* pProduct = (__m256_u*)product;
+      const __m256_u* pMultiplier = (const __m256_u*)multiplier;
+      const __m256_u* pMultiplicand = (const __m256_u*)multiplicand;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pProduct[i] = _mm256_mul_ps(pMultiplier[i], pMultiplicand[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        product[i] = multiplier[i] * multiplicand[i];
+      }
+    }
+
+    void InternalScalarMul(size_t size,
+                           float multiplier,
+                           float* product,
+                           const float* src)
+    {
+      __m256_u* pProduct = (__m256_u*)product;
+      const __m256_u* pSrc = (const __m256_u*)src;
+      __m256 ymmMultiplier = _mm256_set1_ps(multiplier);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pProduct[i] = _mm256_mul_ps(pSrc[i], ymmMultiplier);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        product[i] = src[i] * multiplier;
+      }
+    }
+
+    void InternalDiv(size_t size,
+                     float* quotient,
+                     const float* dividend,
+                     const float* divisor)
+    {
+      __m256_u* pQuotient = (__m256_u*)quotient;
+      const __m256_u* pDividend = (const __m256_u*)dividend;
+      const __m256_u* pDivisor = (const __m256_u*)divisor;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pQuotient[i] = _mm256_div_ps(pDividend[i], pDivisor[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        quotient[i] = dividend[i] / divisor[i];
+      }
+    }
+
+    void InternalScalarDiv(size_t size,
+                           float divisor,
+                           float* quotient,
+                           const float* src)
+    {
+      __m256_u* pQuotient = (__m256_u*)quotient;
+      const __m256_u* pSrc = (const __m256_u*)src;
+      __m256 ymmDivisor = _mm256_set1_ps(divisor);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pQuotient[i] = _mm256_div_ps(pSrc[i], ymmDivisor);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        quotient[i] = src[i] / divisor;
+      }
+    }
+
+    void InternalSqrt(size_t size,
+                      float* dst,
+                      const float* src)
+    {
+      __m256_u* pDst = (__m256_u*)dst;
+      const __m256_u* pSrc = (const __m256_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_sqrt_ps(pSrc[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = sqrt(src[i]);
+      }
+    }
+
+    void InternalSquare(size_t size,
+                        float* dst,
+                        const float* src)
+    {
+      __m256_u* pDst = (__m256_u*)dst;
+      const __m256_u* pSrc = (const __m256_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_mul_ps(pSrc[i], pSrc[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = src[i] * src[i];
+      }
+    }
+
+    void InternalCube(size_t size,
+                      float* dst,
+                      const float* src)
+    {
+      __m256_u* pDst = (__m256_u*)dst;
+      const __m256_u* pSrc = (const __m256_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_mul_ps(_mm256_mul_ps(pSrc[i], pSrc[i]), pSrc[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = src[i] * src[i] * src[i];
+      }
+    }
+
+    void InternalSummation(size_t size,
+                           float* sum,
+                           const float* src)
+    {
+      const __m256_u* pSrc = (const __m256_u*)src;
+      __m256 accumulator = _mm256_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        accumulator = _mm256_add_ps(accumulator, pSrc[i]);
+      }
+
+      *sum = HorizontalSum(accumulator);
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *sum += src[i];
+      }
+    }
+
+    // Neumaier's compensated addition of x to every lane of sum, the same steps as fallback::InternalCompensatedSummation( ) takes
+    // for each lane. Nothing may be fused into an FMA here, the results have to match the other instruction sets bit for bit.
+    static inline void CompensatedAdd(__m256& sum, __m256& compensation, __m256 x)
+    {
+      __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+      __m256 t = _mm256_add_ps(sum, x);
+      __m256 sumIsLarger = _mm256_cmp_ps(_mm256_and_ps(sum, absMask), _mm256_and_ps(x, absMask), _CMP_GE_OQ);
+      __m256 larger = _mm256_blendv_ps(x, sum, sumIsLarger);
+      __m256 smaller = _mm256_blendv_ps(sum, x, sumIsLarger);
+      compensation = _mm256_add_ps(compensation, _mm256_add_ps(_mm256_sub_ps(larger, t), smaller));
+      sum = t;
+    }
+
+    void InternalCompensatedSummation(size_t size,
+                                      float* lanes,
+                                      const float* src)
+    {
+      const size_t registers = COMPENSATED_LANES / 8;
+      __m256 sum[registers];
+      __m256 compensation[registers];
+      for ( size_t r = 0; r < registers; ++r ) {
+        sum[r] = _mm256_setzero_ps();
+        compensation[r] = _mm256_setzero_ps();
+      }
+
+      size_t i;
+      for ( i = 0; i + COMPENSATED_LANES <= size; i += COMPENSATED_LANES ) {
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], ((const __m256_u*)(src + i))[r]);
+        }
+      }
+
+      // The last partial group is padded with zeros, like the fallback kernel does
+      if ( i < size ) {
+        alignas(32) float tail[COMPENSATED_LANES] = { 0 };
+        std::copy(src + i, src + size, tail);
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], ((__m256_u*)tail)[r]);
+        }
+      }
+
+      for ( size_t r = 0; r < registers; ++r ) {
+        _mm256_storeu_ps(lanes + r * 8, sum[r]);
+        _mm256_storeu_ps(lanes + COMPENSATED_LANES + r * 8, compensation[r]);
+      }
+    }
+
+    void InternalCompensatedDotProduct(size_t size,
+                                       float* lanes,
+                                       const float* multiplier,
+                                       const float* multiplicand)
+    {
+      const size_t registers = COMPENSATED_LANES / 8;
+      __m256 sum[registers];
+      __m256 compensation[registers];
+      for ( size_t r = 0; r < registers; ++r ) {
+        sum[r] = _mm256_setzero_ps();
+        compensation[r] = _mm256_setzero_ps();
+      }
+
+      size_t i;
+      for ( i = 0; i + COMPENSATED_LANES <= size; i += COMPENSATED_LANES ) {
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], _mm256_mul_ps(((const __m256_u*)(multiplier + i))[r], ((const __m256_u*)(multiplicand + i))[r]));
+        }
+      }
+
+      // The last partial group is padded with zeros, like the fallback kernel does
+      if ( i < size ) {
+        alignas(32) float tailMultiplier[COMPENSATED_LANES] = { 0 };
+        alignas(32) float tailMultiplicand[COMPENSATED_LANES] = { 0 };
+        std::copy(multiplier + i, multiplier + size, tailMultiplier);
+        std::copy(multiplicand + i, multiplicand + size, tailMultiplicand);
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], _mm256_mul_ps(((__m256_u*)tailMultiplier)[r], ((__m256_u*)tailMultiplicand)[r]));
+        }
+      }
+
+      for ( size_t r = 0; r < registers; ++r ) {
+        _mm256_storeu_ps(lanes + r * 8, sum[r]);
+        _mm256_storeu_ps(lanes + COMPENSATED_LANES + r * 8, compensation[r]);
+      }
+    }
+
+    // Log-step inclusive scan of the 8 lanes of v: two byte-shift-and-add steps inside each 128-bit half, then
+    // the total of the low half is added to every lane of the high half.
+    static inline __m256i ScanRegister(__m256i v)
+    {
+      v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+      v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+      __m256i lowTotal = _mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+      return _mm256_add_epi32(v, _mm256_permute2x128_si256(lowTotal, lowTotal, 0x08));
+    }
+
+    static inline __m256 ScanRegister(__m256 v)
+    {
+      v = _mm256_add_ps(v, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(v), 4)));
+      v = _mm256_add_ps(v, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(v), 8)));
+      __m256 lowTotal = _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3));
+      return _mm256_add_ps(v, _mm256_permute2f128_ps(lowTotal, lowTotal, 0x08));
+    }
+
+    void InternalPrefixSum(size_t size,
+                           float carry,
+                           float* dst,
+                           const float* src)
+    {
+      __m256_u* pDst = (__m256_u*)dst;
+      const __m256_u* pSrc = (const __m256_u*)src;
+      __m256 ymmCarry = _mm256_set1_ps(carry);
+      __m256i lastLane = _mm256_set1_epi32(7);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_add_ps(ScanRegister(pSrc[i]), ymmCarry);
+        ymmCarry = _mm256_permutevar8x32_ps(pDst[i], lastLane);
+      }
+
+      carry = _mm256_cvtss_f32(ymmCarry);
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        carry += src[i];
+        dst[i] = carry;
+      }
+    }
+
+    void InternalExclusivePrefixSum(size_t size,
+                                    float carry,
+                                    float* dst,
+                                    const float* src)
+    {
+      __m256_u* pDst = (__m256_u*)dst;
+      const __m256_u* pSrc = (const __m256_u*)src;
+      __m256 ymmCarry = _mm256_set1_ps(carry);
+      __m256i lastLane = _mm256_set1_epi32(7);
+      __m256i rotateUp = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        __m256 inclusive = _mm256_add_ps(ScanRegister(pSrc[i]), ymmCarry);
+        pDst[i] = _mm256_blend_ps(_mm256_permutevar8x32_ps(inclusive, rotateUp), ymmCarry, 0x01);
+        ymmCarry = _mm256_permutevar8x32_ps(inclusive, lastLane);
+      }
+
+      carry = _mm256_cvtss_f32(ymmCarry);
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        float value = src[i];
+        dst[i] = carry;
+        carry += value;
+      }
+    }
+
+    void InternalDotProduct(size_t size,
+                            float* product,
+                            const float* multiplier,
+                            const float* multiplicand)
+    {
+      const __m256_u* pMultiplier = (const __m256_u*)multiplier;
+      const __m256_u* pMultiplicand = (const __m256_u*)multiplicand;
+      __m256 accumulator0 = _mm256_setzero_ps();
+      __m256 accumulator1 = _mm256_setzero_ps();
+      __m256 accumulator2 = _mm256_setzero_ps();
+      __m256 accumulator3 = _mm256_setzero_ps();
+
+      // Four independent accumulators keep the adds out of each other's latency chain
+      size_t i;
+      for ( i = 0; i + 4 <= (size >> 3); i += 4 ) {
+        accumulator0 = _mm256_add_ps(accumulator0, _mm256_mul_ps(pMultiplier[i], pMultiplicand[i]));
+        accumulator1 = _mm256_add_ps(accumulator1, _mm256_mul_ps(pMultiplier[i + 1], pMultiplicand[i + 1]));
+        accumulator2 = _mm256_add_ps(accumulator2, _mm256_mul_ps(pMultiplier[i + 2], pMultiplicand[i + 2]));
+        accumulator3 = _mm256_add_ps(accumulator3, _mm256_mul_ps(pMultiplier[i + 3], pMultiplicand[i + 3]));
+      }
+      for ( ; i < (size >> 3); ++i ) {
+        accumulator0 = _mm256_add_ps(accumulator0, _mm256_mul_ps(pMultiplier[i], pMultiplicand[i]));
+      }
+      __m256 accumulator = _mm256_add_ps(_mm256_add_ps(accumulator0, accumulator1), _mm256_add_ps(accumulator2, accumulator3));
+
+      *product = HorizontalSum(accumulator);
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *product += (multiplier[i] * multiplicand[i]);
+      }
+    }
+
+    void InternalDotProductFma(size_t size,
+                               float* product,
+                               const float* multiplier,
+                               const float* multiplicand)
+    {
+      const __m256_u* pMultiplier = (const __m256_u*)multiplier;
+      const __m256_u* pMultiplicand = (const __m256_u*)multiplicand;
+      __m256 accumulator0 = _mm256_setzero_ps();
+      __m256 accumulator1 = _mm256_setzero_ps();
+      __m256 accumulator2 = _mm256_setzero_ps();
+      __m256 accumulator3 = _mm256_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i + 4 <= (size >> 3); i += 4 ) {
+        accumulator0 = _mm256_fmadd_ps(pMultiplier[i], pMultiplicand[i], accumulator0);
+        accumulator1 = _mm256_fmadd_ps(pMultiplier[i + 1], pMultiplicand[i + 1], accumulator1);
+        accumulator2 = _mm256_fmadd_ps(pMultiplier[i + 2], pMultiplicand[i + 2], accumulator2);
+        accumulator3 = _mm256_fmadd_ps(pMultiplier[i + 3], pMultiplicand[i + 3], accumulator3);
+      }
+      for ( ; i < (size >> 3); ++i ) {
+        accumulator0 = _mm256_fmadd_ps(pMultiplier[i], pMultiplicand[i], accumulator0);
+      }
+      __m256 accumulator = _mm256_add_ps(_mm256_add_ps(accumulator0, accumulator1), _mm256_add_ps(accumulator2, accumulator3));
+
+      *product = HorizontalSum(accumulator);
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *product = fmaf(multiplier[i], multiplicand[i], *product);
+      }
+    }
+
     void InternalNegate(size_t size,
-                        float *dst,
-                        float *src)
+                        float* dst,
+                        const float* src)
     {
-      __m256i* pDst = (__m256i*)dst;
-      __m256i* pSrc = (__m256i*)src;
-      __m256i mask = _mm256_set_epi32(0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000);
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i mask = _mm256_set1_epi32(0x80000000);
 
       size_t i;
       for ( i = 0; i < (size >> 3); ++i ) {
@@ -58,5 +481,2235 @@ namespace khyber
         dst[i] = -src[i];
       }
     }
+
+    void InternalDistance(size_t size,
+                          float* distance,
+                          const float* v1,
+                          const float* v2)
+    {
+      const __m256_u* pV1 = (const __m256_u*)v1;
+      const __m256_u* pV2 = (const __m256_u*)v2;
+      __m256 scratch;
+      __m256 accumulator0 = _mm256_setzero_ps();
+      __m256 accumulator1 = _mm256_setzero_ps();
+      __m256 accumulator2 = _mm256_setzero_ps();
+      __m256 accumulator3 = _mm256_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i + 4 <= (size >> 3); i += 4 ) {
+        scratch = _mm256_sub_ps(pV1[i], pV2[i]);
+        accumulator0 = _mm256_add_ps(accumulator0, _mm256_mul_ps(scratch, scratch));
+        scratch = _mm256_sub_ps(pV1[i + 1], pV2[i + 1]);
+        accumulator1 = _mm256_add_ps(accumulator1, _mm256_mul_ps(scratch, scratch));
+        scratch = _mm256_sub_ps(pV1[i + 2], pV2[i + 2]);
+        accumulator2 = _mm256_add_ps(accumulator2, _mm256_mul_ps(scratch, scratch));
+        scratch = _mm256_sub_ps(pV1[i + 3], pV2[i + 3]);
+        accumulator3 = _mm256_add_ps(accumulator3, _mm256_mul_ps(scratch, scratch));
+      }
+      for ( ; i < (size >> 3); ++i ) {
+        scratch = _mm256_sub_ps(pV1[i], pV2[i]);
+        accumulator0 = _mm256_add_ps(accumulator0, _mm256_mul_ps(scratch, scratch));
+      }
+      __m256 accumulator = _mm256_add_ps(_mm256_add_ps(accumulator0, accumulator1), _mm256_add_ps(accumulator2, accumulator3));
+
+      *distance = HorizontalSum(accumulator);
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *distance += ((v1[i] - v2[i]) * (v1[i] - v2[i]));
+      }
+      *distance = sqrt(*distance);
+    }
+
+    void InternalDistanceFma(size_t size,
+                             float* distance,
+                             const float* v1,
+                             const float* v2)
+    {
+      const __m256_u* pV1 = (const __m256_u*)v1;
+      const __m256_u* pV2 = (const __m256_u*)v2;
+      __m256 scratch;
+      __m256 accumulator0 = _mm256_setzero_ps();
+      __m256 accumulator1 = _mm256_setzero_ps();
+      __m256 accumulator2 = _mm256_setzero_ps();
+      __m256 accumulator3 = _mm256_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i + 4 <= (size >> 3); i += 4 ) {
+        scratch = _mm256_sub_ps(pV1[i], pV2[i]);
+        accumulator0 = _mm256_fmadd_ps(scratch, scratch, accumulator0);
+        scratch = _mm256_sub_ps(pV1[i + 1], pV2[i + 1]);
+        accumulator1 = _mm256_fmadd_ps(scratch, scratch, accumulator1);
+        scratch = _mm256_sub_ps(pV1[i + 2], pV2[i + 2]);
+        accumulator2 = _mm256_fmadd_ps(scratch, scratch, accumulator2);
+        scratch = _mm256_sub_ps(pV1[i + 3], pV2[i + 3]);
+        accumulator3 = _mm256_fmadd_ps(scratch, scratch, accumulator3);
+      }
+      for ( ; i < (size >> 3); ++i ) {
+        scratch = _mm256_sub_ps(pV1[i], pV2[i]);
+        accumulator0 = _mm256_fmadd_ps(scratch, scratch, accumulator0);
+      }
+      __m256 accumulator = _mm256_add_ps(_mm256_add_ps(accumulator0, accumulator1), _mm256_add_ps(accumulator2, accumulator3));
+
+      *distance = HorizontalSum(accumulator);
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *distance = fmaf(v1[i] - v2[i], v1[i] - v2[i], *distance);
+      }
+      *distance = sqrt(*distance);
+    }
+
+    void InternalReciprocate(size_t size,
+                             float* dst,
+                             const float* src)
+    {
+      __m256_u* pDst = (__m256_u*)dst;
+      const __m256_u* pSrc = (const __m256_u*)src;
+      __m256 one = _mm256_set1_ps(1.0f);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_div_ps(one, pSrc[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = 1.0f / src[i];
+      }
+    }
+
+    void InternalMinimum(size_t size,
+                         float* minimum,
+                         const float* src)
+    {
+      // minps returns its second operand if either one is NaN, so the accumulator skips NaN elements, which are tracked separately
+      const __m256_u* pSrc = (const __m256_u*)src;
+      __m256 accumulator = _mm256_set1_ps(std::numeric_limits<float>::max());
+      __m256 nans = _mm256_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        accumulator = _mm256_min_ps(pSrc[i], accumulator);
+        nans = _mm256_or_ps(nans, _mm256_cmp_ps(pSrc[i], pSrc[i], _CMP_UNORD_Q));
+      }
+
+      float* tmp = (float*)&accumulator;
+      *minimum = _mm256_movemask_ps(nans) ? std::numeric_limits<float>::quiet_NaN() : tmp[0];
+      for ( size_t lane = 1; lane < 8; ++lane ) {
+        *minimum = tmp[lane] < *minimum ? tmp[lane] : *minimum;
+      }
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *minimum = src[i] < *minimum || src[i] != src[i] ? src[i] : *minimum;
+      }
+    }
+
+    void InternalMaximum(size_t size,
+                         float* maximum,
+                         const float* src)
+    {
+      const __m256_u* pSrc = (const __m256_u*)src;
+      __m256 accumulator = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+      __m256 nans = _mm256_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        accumulator = _mm256_max_ps(pSrc[i], accumulator);
+        nans = _mm256_or_ps(nans, _mm256_cmp_ps(pSrc[i], pSrc[i], _CMP_UNORD_Q));
+      }
+
+      float* tmp = (float*)&accumulator;
+      *maximum = _mm256_movemask_ps(nans) ? std::numeric_limits<float>::quiet_NaN() : tmp[0];
+      for ( size_t lane = 1; lane < 8; ++lane ) {
+        *maximum = tmp[lane] > *maximum ? tmp[lane] : *maximum;
+      }
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *maximum = src[i] > *maximum || src[i] != src[i] ? src[i] : *maximum;
+      }
+    }
+
+    void InternalMinMaximum(size_t size,
+                            Extrema<float>* extrema,
+                            const float* src)
+    {
+      const __m256_u* pSrc = (const __m256_u*)src;
+      __m256 minimum = _mm256_set1_ps(std::numeric_limits<float>::max());
+      __m256 maximum = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+      __m256 nans = _mm256_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        minimum = _mm256_min_ps(pSrc[i], minimum);
+        maximum = _mm256_max_ps(pSrc[i], maximum);
+        nans = _mm256_or_ps(nans, _mm256_cmp_ps(pSrc[i], pSrc[i], _CMP_UNORD_Q));
+      }
+
+      float* minima = (float*)&minimum;
+      float* maxima = (float*)&maximum;
+      if ( _mm256_movemask_ps(nans) ) {
+        extrema->minimum = extrema->maximum = std::numeric_limits<float>::quiet_NaN();
+      } else {
+        extrema->minimum = minima[0];
+        extrema->maximum = maxima[0];
+        for ( size_t lane = 1; lane < 8; ++lane ) {
+          extrema->minimum = minima[lane] < extrema->minimum ? minima[lane] : extrema->minimum;
+          extrema->maximum = maxima[lane] > extrema->maximum ? maxima[lane] : extrema->maximum;
+        }
+      }
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        extrema->minimum = src[i] < extrema->minimum || src[i] != src[i] ? src[i] : extrema->minimum;
+        extrema->maximum = src[i] > extrema->maximum || src[i] != src[i] ? src[i] : extrema->maximum;
+      }
+    }
+
+    // Index of the first smallest (Largest == false) or largest element of src, or of its first NaN. Every lane keeps its
+    // own extremum along with the number of the register it was loaded from, replacing them only on a strictly better value
+    // so that each lane holds its first occurrence. The lanes are then merged, the lower index winning ties.
+    template<bool Largest>
+    static size_t ArgExtremum(size_t size,
+                              const float* src)
+    {
+      const __m256_u* pSrc = (const __m256_u*)src;
+      size_t index = 0;
+      size_t i = 0;
+      if ( size >= 8 ) {
+        __m256 best = pSrc[0];
+        __m256 bestRegister = _mm256_setzero_ps();
+        __m256 nans = _mm256_cmp_ps(best, best, _CMP_UNORD_Q);
+        for ( i = 1; i < (size >> 3); ++i ) {
+          __m256 better = Largest ? _mm256_cmp_ps(pSrc[i], best, _CMP_GT_OQ) : _mm256_cmp_ps(pSrc[i], best, _CMP_LT_OQ);
+          best = _mm256_blendv_ps(best, pSrc[i], better);
+          // The register numbers are kept as 32-bit integers, which covers up to 2^32 registers per call
+          bestRegister = _mm256_blendv_ps(bestRegister, _mm256_castsi256_ps(_mm256_set1_epi32((int32_t)i)), better);
+          nans = _mm256_or_ps(nans, _mm256_cmp_ps(pSrc[i], pSrc[i], _CMP_UNORD_Q));
+        }
+
+        if ( _mm256_movemask_ps(nans) ) {
+          // Rescan from the start, the scalar loop below stops at the first NaN
+          i = 0;
+        } else {
+          uint32_t* registers = (uint32_t*)&bestRegister;
+          index = (size_t)registers[0] << 3;
+          for ( size_t lane = 1; lane < 8; ++lane ) {
+            size_t candidate = ((size_t)registers[lane] << 3) + lane;
+            if ( (Largest ? src[candidate] > src[index] : src[candidate] < src[index]) ||
+                 (src[candidate] == src[index] && candidate < index) ) {
+              index = candidate;
+            }
+          }
+          i <<= 3;
+        }
+      }
+
+      for ( ; i < size; ++i ) {
+        if ( src[i] != src[i] ) {
+          return i;
+        }
+        index = (Largest ? src[i] > src[index] : src[i] < src[index]) ? i : index;
+      }
+      return index;
+    }
+
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const float* src)
+    {
+      *index = ArgExtremum<false>(size, src);
+    }
+
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const float* src)
+    {
+      *index = ArgExtremum<true>(size, src);
+    }
+
+    ///////////////////////// Transcendental functions ////////////////////////
+
+    // The single-precision transcendental functions follow the Cephes library: the argument is reduced to a small interval
+    // around 0 and a minimax polynomial is evaluated over it. They match those of the AVX package, the exponent field is only
+    // read and written with the 256-bit integer instructions instead of conversions.
+
+    static inline __m256 Abs(__m256 x)
+    {
+      return _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+    }
+
+    static inline __m256 SignBit(__m256 x)
+    {
+      return _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000)));
+    }
+
+    // Returns 2^n for the integral n in [-126, 127] by writing n + 127 into the exponent field
+    static inline __m256 PowerOf2(__m256 n)
+    {
+      __m256i biased = _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+      return _mm256_castsi256_ps(_mm256_slli_epi32(biased, 23));
+    }
+
+    // Returns p * 2^n for the integral n in [-151, 129]. The scaling is done in two halves so that neither factor leaves the normal
+    // range, the result then overflows to infinity or underflows gradually to the denormals in the final multiplication.
+    static inline __m256 ScaleByPowerOf2(__m256 p, __m256 n)
+    {
+      __m256 half = _mm256_floor_ps(_mm256_mul_ps(n, _mm256_set1_ps(0.5f)));
+      return _mm256_mul_ps(_mm256_mul_ps(p, PowerOf2(half)), PowerOf2(_mm256_sub_ps(n, half)));
+    }
+
+    // e^r for r in [-ln(2)/2, ln(2)/2]
+    static inline __m256 ExpPolynomial(__m256 r)
+    {
+      __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+      p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(1.3981999507e-3f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(8.3334519073e-3f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(4.1665795894e-2f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(1.6666665459e-1f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(5.0000001201e-1f));
+      p = _mm256_mul_ps(p, _mm256_mul_ps(r, r));
+      return _mm256_add_ps(_mm256_add_ps(p, r), _mm256_set1_ps(1.0f));
+    }
+
+    static inline __m256 Exp(__m256 x)
+    {
+      // e^x overflows above 88.73 and underflows below -103.98, the clamp keeps n in range. NaN is the second operand
+      // of min/max so it is passed through.
+      x = _mm256_min_ps(_mm256_set1_ps(89.0f), x);
+      x = _mm256_max_ps(_mm256_set1_ps(-104.0f), x);
+
+      // x = n * ln(2) + r, ln(2) is split in two so that n * 0.693359375 is exact
+      __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f)));
+      r = _mm256_sub_ps(r, _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f)));
+      return ScaleByPowerOf2(ExpPolynomial(r), n);
+    }
+
+    static inline __m256 Exp2(__m256 x)
+    {
+      x = _mm256_min_ps(_mm256_set1_ps(129.0f), x);
+      x = _mm256_max_ps(_mm256_set1_ps(-151.0f), x);
+
+      __m256 n = _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      __m256 r = _mm256_mul_ps(_mm256_sub_ps(x, n), _mm256_set1_ps(0.693147180559945309f));
+      return ScaleByPowerOf2(ExpPolynomial(r), n);
+    }
+
+    // Splits x > 0 into m * 2^e with m in [sqrt(1/2), sqrt(2)), returns m - 1 and the exponent e
+    static inline __m256 LogReduce(__m256 x, __m256& e)
+    {
+      // Denormals are scaled by 2^24 into the normal range first
+      __m256 denormal = _mm256_cmp_ps(x, _mm256_set1_ps(std::numeric_limits<float>::min()), _CMP_LT_OQ);
+      x = _mm256_blendv_ps(x, _mm256_mul_ps(x, _mm256_set1_ps(16777216.0f)), denormal);
+
+      __m256i field = _mm256_srli_epi32(_mm256_castps_si256(x), 23);
+      e = _mm256_cvtepi32_ps(_mm256_sub_epi32(field, _mm256_set1_epi32(126)));
+      e = _mm256_sub_ps(e, _mm256_and_ps(denormal, _mm256_set1_ps(24.0f)));
+
+      // m in [0.5, 1), doubled when below sqrt(1/2)
+      __m256 m = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff)));
+      m = _mm256_or_ps(m, _mm256_set1_ps(0.5f));
+      __m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+      e = _mm256_sub_ps(e, _mm256_and_ps(small, _mm256_set1_ps(1.0f)));
+      m = _mm256_add_ps(m, _mm256_and_ps(small, m));
+      return _mm256_sub_ps(m, _mm256_set1_ps(1.0f));
+    }
+
+    // log(1 + f) - f for f in [sqrt(1/2) - 1, sqrt(2) - 1)
+    static inline __m256 LogPolynomial(__m256 f)
+    {
+      __m256 z = _mm256_mul_ps(f, f);
+      __m256 p = _mm256_set1_ps(7.0376836292e-2f);
+      p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(-1.1514610310e-1f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(1.1676998740e-1f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(-1.2420140846e-1f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(1.4249322787e-1f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(-1.6668057665e-1f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(2.0000714765e-1f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(-2.4999993993e-1f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(3.3333331174e-1f));
+      p = _mm256_mul_ps(_mm256_mul_ps(p, f), z);
+      return _mm256_sub_ps(p, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+    }
+
+    // log(0) is -infinity, log(+infinity) and log(NaN) are themselves and the logarithm of a negative number is NaN
+    static inline __m256 LogSpecialCases(__m256 result, __m256 x)
+    {
+      __m256 passThrough = _mm256_or_ps(_mm256_cmp_ps(x, x, _CMP_UNORD_Q),
+                                        _mm256_cmp_ps(x, _mm256_set1_ps(std::numeric_limits<float>::infinity()), _CMP_EQ_OQ));
+      result = _mm256_blendv_ps(result, x, passThrough);
+      result = _mm256_blendv_ps(result, _mm256_set1_ps(-std::numeric_limits<float>::infinity()),
+                                _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ));
+      return _mm256_blendv_ps(result, _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN()),
+                              _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+    }
+
+    static inline __m256 Log(__m256 x)
+    {
+      __m256 e;
+      __m256 f = LogReduce(x, e);
+      __m256 y = _mm256_add_ps(LogPolynomial(f), _mm256_mul_ps(e, _mm256_set1_ps(-2.12194440e-4f)));
+      __m256 result = _mm256_add_ps(_mm256_add_ps(f, y), _mm256_mul_ps(e, _mm256_set1_ps(0.693359375f)));
+      return LogSpecialCases(result, x);
+    }
+
+    static inline __m256 Log2(__m256 x)
+    {
+      __m256 e;
+      __m256 f = LogReduce(x, e);
+      __m256 y = LogPolynomial(f);
+
+      // log2(x) = e + (f + y) * log2(e), log2(e) - 1 is applied separately to keep its rounding error off the leading terms
+      const __m256 log2eMinus1 = _mm256_set1_ps(0.44269504088896340736f);
+      __m256 result = _mm256_add_ps(_mm256_mul_ps(y, log2eMinus1), _mm256_mul_ps(f, log2eMinus1));
+      result = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(result, y), f), e);
+      return LogSpecialCases(result, x);
+    }
+
+    // Reduces |x| to z in [-pi/4, pi/4] and the even octant q in {0, 2, 4, 6} such that |x| = j * pi/4 + z and q = j mod 8.
+    // pi/4 is split in three parts, j * pi/4 is exact up to |x| = 8192.
+    static inline __m256 TrigReduce(__m256 ax, __m256& q)
+    {
+      __m256 j = _mm256_floor_ps(_mm256_mul_ps(ax, _mm256_set1_ps(1.27323954473516f)));
+      j = _mm256_floor_ps(_mm256_mul_ps(_mm256_add_ps(j, _mm256_set1_ps(1.0f)), _mm256_set1_ps(0.5f)));
+      j = _mm256_add_ps(j, j);
+      q = _mm256_sub_ps(j, _mm256_mul_ps(_mm256_floor_ps(_mm256_mul_ps(j, _mm256_set1_ps(0.125f))), _mm256_set1_ps(8.0f)));
+
+      __m256 z = _mm256_sub_ps(ax, _mm256_mul_ps(j, _mm256_set1_ps(0.78515625f)));
+      z = _mm256_sub_ps(z, _mm256_mul_ps(j, _mm256_set1_ps(2.4187564849853515625e-4f)));
+      return _mm256_sub_ps(z, _mm256_mul_ps(j, _mm256_set1_ps(3.77489497744594108e-8f)));
+    }
+
+    // sin(z) for z in [-pi/4, pi/4]
+    static inline __m256 SinPolynomial(__m256 z)
+    {
+      __m256 zz = _mm256_mul_ps(z, z);
+      __m256 p = _mm256_set1_ps(-1.9515295891e-4f);
+      p = _mm256_add_ps(_mm256_mul_ps(p, zz), _mm256_set1_ps(8.3321608736e-3f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, zz), _mm256_set1_ps(-1.6666654611e-1f));
+      return _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(p, zz), z), z);
+    }
+
+    // cos(z) for z in [-pi/4, pi/4]
+    static inline __m256 CosPolynomial(__m256 z)
+    {
+      __m256 zz = _mm256_mul_ps(z, z);
+      __m256 p = _mm256_set1_ps(2.443315711809948e-5f);
+      p = _mm256_add_ps(_mm256_mul_ps(p, zz), _mm256_set1_ps(-1.388731625493765e-3f));
+      p = _mm256_add_ps(_mm256_mul_ps(p, zz), _mm256_set1_ps(4.166664568298827e-2f));
+      p = _mm256_mul_ps(_mm256_mul_ps(p, zz), zz);
+      return _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(zz, _mm256_set1_ps(0.5f))), p);
+    }
+
+    static inline __m256 Sin(__m256 x)
+    {
+      __m256 q;
+      __m256 z = TrigReduce(Abs(x), q);
+
+      // sin(j * pi/4 + z) is sin(z), cos(z), -sin(z), -cos(z) for q = 0, 2, 4, 6, and sin is odd
+      __m256 useCos = _mm256_or_ps(_mm256_cmp_ps(q, _mm256_set1_ps(2.0f), _CMP_EQ_OQ), _mm256_cmp_ps(q, _mm256_set1_ps(6.0f), _CMP_EQ_OQ));
+      __m256 negate = _mm256_cmp_ps(q, _mm256_set1_ps(4.0f), _CMP_GE_OQ);
+      __m256 result = _mm256_blendv_ps(SinPolynomial(z), CosPolynomial(z), useCos);
+      __m256 sign = _mm256_xor_ps(SignBit(x), SignBit(negate));
+      return _mm256_xor_ps(result, sign);
+    }
+
+    static inline __m256 Cos(__m256 x)
+    {
+      __m256 q;
+      __m256 z = TrigReduce(Abs(x), q);
+
+      // cos(j * pi/4 + z) is cos(z), -sin(z), -cos(z), sin(z) for q = 0, 2, 4, 6, and cos is even
+      __m256 useSin = _mm256_or_ps(_mm256_cmp_ps(q, _mm256_set1_ps(2.0f), _CMP_EQ_OQ), _mm256_cmp_ps(q, _mm256_set1_ps(6.0f), _CMP_EQ_OQ));
+      __m256 negate = _mm256_or_ps(_mm256_cmp_ps(q, _mm256_set1_ps(2.0f), _CMP_EQ_OQ), _mm256_cmp_ps(q, _mm256_set1_ps(4.0f), _CMP_EQ_OQ));
+      __m256 result = _mm256_blendv_ps(CosPolynomial(z), SinPolynomial(z), useSin);
+      return _mm256_xor_ps(result, SignBit(negate));
+    }
+
+    static inline __m256 Tanh(__m256 x)
+    {
+      __m256 ax = Abs(x);
+
+      // 1 - 2 / (e^(2|x|) + 1) cancels badly near 0, an odd polynomial is used below 0.625 instead
+      __m256 large = _mm256_add_ps(Exp(_mm256_add_ps(ax, ax)), _mm256_set1_ps(1.0f));
+      large = _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_div_ps(_mm256_set1_ps(2.0f), large));
+
+      __m256 z = _mm256_mul_ps(x, x);
+      __m256 small = _mm256_set1_ps(-5.70498872745e-3f);
+      small = _mm256_add_ps(_mm256_mul_ps(small, z), _mm256_set1_ps(2.06390887954e-2f));
+      small = _mm256_add_ps(_mm256_mul_ps(small, z), _mm256_set1_ps(-5.37397155531e-2f));
+      small = _mm256_add_ps(_mm256_mul_ps(small, z), _mm256_set1_ps(1.33314422036e-1f));
+      small = _mm256_add_ps(_mm256_mul_ps(small, z), _mm256_set1_ps(-3.33332819422e-1f));
+      small = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(small, z), ax), ax);
+
+      __m256 result = _mm256_blendv_ps(large, small, _mm256_cmp_ps(ax, _mm256_set1_ps(0.625f), _CMP_LT_OQ));
+      return _mm256_or_ps(result, SignBit(x));
+    }
+
+    static inline __m256 Sigmoid(__m256 x)
+    {
+      // 1 / (1 + e^-x) for positive x and e^x / (1 + e^x) for negative x, so that e^-|x| never overflows and the tiny results
+      // of large negative x keep their precision
+      __m256 t = Exp(_mm256_or_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000))));
+      __m256 one = _mm256_set1_ps(1.0f);
+      return _mm256_div_ps(_mm256_blendv_ps(one, t, _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ)), _mm256_add_ps(one, t));
+    }
+
+    static inline __m256 Pow(__m256 x, __m256 y)
+    {
+      __m256 result = Exp2(_mm256_mul_ps(y, Log2(Abs(x))));
+
+      // A finite negative base has a real power only for integral exponents, it is negative for the odd ones. Exponents beyond 2^24 are
+      // all even.
+      __m256 integral = _mm256_cmp_ps(_mm256_floor_ps(y), y, _CMP_EQ_OQ);
+      __m256 halfY = _mm256_mul_ps(y, _mm256_set1_ps(0.5f));
+      __m256 odd = _mm256_andnot_ps(_mm256_cmp_ps(_mm256_floor_ps(halfY), halfY, _CMP_EQ_OQ), integral);
+      result = _mm256_xor_ps(result, _mm256_and_ps(SignBit(x), odd));
+      __m256 negativeFinite = _mm256_and_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ),
+                                            _mm256_cmp_ps(x, _mm256_set1_ps(-std::numeric_limits<float>::infinity()), _CMP_GT_OQ));
+      result = _mm256_blendv_ps(result, _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN()), _mm256_andnot_ps(integral, negativeFinite));
+
+      // As for std::pow, x^0 and 1^y are 1 even when the other operand is NaN, and so is (-1)^(+/-infinity)
+      __m256 one = _mm256_set1_ps(1.0f);
+      __m256 isOne = _mm256_or_ps(_mm256_cmp_ps(y, _mm256_setzero_ps(), _CMP_EQ_OQ), _mm256_cmp_ps(x, one, _CMP_EQ_OQ));
+      isOne = _mm256_or_ps(isOne, _mm256_and_ps(_mm256_cmp_ps(x, _mm256_set1_ps(-1.0f), _CMP_EQ_OQ),
+                                                _mm256_cmp_ps(Abs(y), _mm256_set1_ps(std::numeric_limits<float>::infinity()), _CMP_EQ_OQ)));
+      return _mm256_blendv_ps(result, one, isOne);
+    }
+
+    // Applies the register function to every element, the tail is padded into a full register so that it is computed exactly like
+    // the rest of the array
+    template<__m256 (*Function)(__m256)>
+    static void MapRegister(size_t size,
+                            float* dst,
+                            const float* src)
+    {
+      __m256_u* pDst = (__m256_u*)dst;
+      const __m256_u* pSrc = (const __m256_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = Function(pSrc[i]);
+      }
+
+      i <<= 3;
+      if ( i < size ) {
+        alignas(32) float buffer[8] = { 0 };
+        std::copy(src + i, src + size, buffer);
+        *(__m256_u*)buffer = Function(*(__m256_u*)buffer);
+        std::copy(buffer, buffer + (size - i), dst + i);
+      }
+    }
+
+    void InternalExp(size_t size,
+                     float* dst,
+                     const float* src)
+    {
+      MapRegister<Exp>(size, dst, src);
+    }
+
+    void InternalLog(size_t size,
+                     float* dst,
+                     const float* src)
+    {
+      MapRegister<Log>(size, dst, src);
+    }
+
+    void InternalLog2(size_t size,
+                      float* dst,
+                      const float* src)
+    {
+      MapRegister<Log2>(size, dst, src);
+    }
+
+    void InternalSin(size_t size,
+                     float* dst,
+                     const float* src)
+    {
+      MapRegister<Sin>(size, dst, src);
+    }
+
+    void InternalCos(size_t size,
+                     float* dst,
+                     const float* src)
+    {
+      MapRegister<Cos>(size, dst, src);
+    }
+
+    void InternalTanh(size_t size,
+                      float* dst,
+                      const float* src)
+    {
+      MapRegister<Tanh>(size, dst, src);
+    }
+
+    void InternalSigmoid(size_t size,
+                         float* dst,
+                         const float* src)
+    {
+      MapRegister<Sigmoid>(size, dst, src);
+    }
+
+    void InternalPow(size_t size,
+                     float* dst,
+                     const float* base,
+                     const float* exponent)
+    {
+      __m256_u* pDst = (__m256_u*)dst;
+      const __m256_u* pBase = (const __m256_u*)base;
+      const __m256_u* pExponent = (const __m256_u*)exponent;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = Pow(pBase[i], pExponent[i]);
+      }
+
+      i <<= 3;
+      if ( i < size ) {
+        alignas(32) float baseBuffer[8] = { 0 };
+        alignas(32) float exponentBuffer[8] = { 0 };
+        std::copy(base + i, base + size, baseBuffer);
+        std::copy(exponent + i, exponent + size, exponentBuffer);
+        *(__m256_u*)baseBuffer = Pow(*(__m256_u*)baseBuffer, *(__m256_u*)exponentBuffer);
+        std::copy(baseBuffer, baseBuffer + (size - i), dst + i);
+      }
+    }
+
+    ////////////////////// Reciprocals and square roots ///////////////////////
+
+    // rcpps and rsqrtps return 0 or infinity for inputs whose result leaves the normal range, denormal inputs included. The
+    // Newton-Raphson step would turn those into NaN or flip their sign, so they keep the approximation, which is already the limit.
+    static inline __m256 KeepLimits(__m256 refined, __m256 approximation)
+    {
+      __m256 limit = _mm256_or_ps(_mm256_cmp_ps(approximation, _mm256_setzero_ps(), _CMP_EQ_OQ),
+                                  _mm256_cmp_ps(Abs(approximation), _mm256_set1_ps(std::numeric_limits<float>::infinity()), _CMP_EQ_OQ));
+      return _mm256_blendv_ps(refined, approximation, limit);
+    }
+
+    static inline __m256 ApproximateReciprocal(__m256 x)
+    {
+      return _mm256_rcp_ps(x);
+    }
+
+    // One Newton-Raphson step r * (2 - x * r) doubles the 12 correct bits of rcpps
+    static inline __m256 RefinedReciprocal(__m256 x)
+    {
+      __m256 r = _mm256_rcp_ps(x);
+      return KeepLimits(_mm256_mul_ps(r, _mm256_sub_ps(_mm256_set1_ps(2.0f), _mm256_mul_ps(x, r))), r);
+    }
+
+    static inline __m256 Rsqrt(__m256 x)
+    {
+      return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(x));
+    }
+
+    static inline __m256 ApproximateRsqrt(__m256 x)
+    {
+      return _mm256_rsqrt_ps(x);
+    }
+
+    // One Newton-Raphson step r * (3 - x * r^2) / 2 doubles the 12 correct bits of rsqrtps
+    static inline __m256 RefinedRsqrt(__m256 x)
+    {
+      __m256 r = _mm256_rsqrt_ps(x);
+      __m256 refined = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), r), _mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(_mm256_mul_ps(x, r), r)));
+      return KeepLimits(refined, r);
+    }
+
+    void InternalApproximateReciprocate(size_t size,
+                                        float* dst,
+                                        const float* src)
+    {
+      MapRegister<ApproximateReciprocal>(size, dst, src);
+    }
+
+    void InternalRefinedReciprocate(size_t size,
+                                    float* dst,
+                                    const float* src)
+    {
+      MapRegister<RefinedReciprocal>(size, dst, src);
+    }
+
+    void InternalRsqrt(size_t size,
+                       float* dst,
+                       const float* src)
+    {
+      MapRegister<Rsqrt>(size, dst, src);
+    }
+
+    void InternalApproximateRsqrt(size_t size,
+                                  float* dst,
+                                  const float* src)
+    {
+      MapRegister<ApproximateRsqrt>(size, dst, src);
+    }
+
+    void InternalRefinedRsqrt(size_t size,
+                              float* dst,
+                              const float* src)
+    {
+      MapRegister<RefinedRsqrt>(size, dst, src);
+    }
+
+    ///////////////////////////// Double-precision ////////////////////////////
+
+    // Reduces the 4 lanes of v to a single double: the upper 128 bits are folded onto the lower ones, then the
+    // remaining 2 lanes are added.
+    static inline double HorizontalSum(__m256d v)
+    {
+      __m128d xmm = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+      xmm = _mm_add_sd(xmm, _mm_unpackhi_pd(xmm, xmm));
+      return _mm_cvtsd_f64(xmm);
+    }
+
+    void InternalAdd(size_t size,
+                     double* sum,
+                     const double* augend,
+                     const double* addend)
+    {
+      __m256d_u* pSum = (__m256d_u*)sum;
+      const __m256d_u* pAugend = (const __m256d_u*)augend;
+      const __m256d_u* pAddend = (const __m256d_u*)addend;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pSum[i] = _mm256_add_pd(pAugend[i], pAddend[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        sum[i] = augend[i] + addend[i];
+      }
+    }
+
+    void InternalScalarAdd(size_t size,
+                           double addend,
+                           double* sum,
+                           const double* src)
+    {
+      __m256d_u* pSum = (__m256d_u*)sum;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d ymmAddend = _mm256_set1_pd(addend);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pSum[i] = _mm256_add_pd(pSrc[i], ymmAddend);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        sum[i] = src[i] + addend;
+      }
+    }
+
+    void InternalSub(size_t size,
+                     double* difference,
+                     const double* minuend,
+                     const double* subtrahend)
+    {
+      __m256d_u* pDifference = (__m256d_u*)difference;
+      const __m256d_u* pMinuend = (const __m256d_u*)minuend;
+      const __m256d_u* pSubtrahend = (const __m256d_u*)subtrahend;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDifference[i] = _mm256_sub_pd(pMinuend[i], pSubtrahend[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        difference[i] = minuend[i] - subtrahend[i];
+      }
+    }
+
+    void InternalMul(size_t size,
+                     double* product,
+                     const double* multiplier,
+                     const double* multiplicand)
+    {
+      __m256d_u* pProduct = (__m256d_u*)product;
+      const __m256d_u* pMultiplier = (const __m256d_u*)multiplier;
+      const __m256d_u* pMultiplicand = (const __m256d_u*)multiplicand;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pProduct[i] = _mm256_mul_pd(pMultiplier[i], pMultiplicand[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        product[i] = multiplier[i] * multiplicand[i];
+      }
+    }
+
+    void InternalScalarMul(size_t size,
+                           double multiplier,
+                           double* product,
+                           const double* src)
+    {
+      __m256d_u* pProduct = (__m256d_u*)product;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d ymmMultiplier = _mm256_set1_pd(multiplier);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pProduct[i] = _mm256_mul_pd(pSrc[i], ymmMultiplier);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        product[i] = src[i] * multiplier;
+      }
+    }
+
+    void InternalDiv(size_t size,
+                     double* quotient,
+                     const double* dividend,
+                     const double* divisor)
+    {
+      __m256d_u* pQuotient = (__m256d_u*)quotient;
+      const __m256d_u* pDividend = (const __m256d_u*)dividend;
+      const __m256d_u* pDivisor = (const __m256d_u*)divisor;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pQuotient[i] = _mm256_div_pd(pDividend[i], pDivisor[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        quotient[i] = dividend[i] / divisor[i];
+      }
+    }
+
+    void InternalScalarDiv(size_t size,
+                           double divisor,
+                           double* quotient,
+                           const double* src)
+    {
+      __m256d_u* pQuotient = (__m256d_u*)quotient;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d ymmDivisor = _mm256_set1_pd(divisor);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pQuotient[i] = _mm256_div_pd(pSrc[i], ymmDivisor);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        quotient[i] = src[i] / divisor;
+      }
+    }
+
+    void InternalSqrt(size_t size,
+                      double* dst,
+                      const double* src)
+    {
+      __m256d_u* pDst = (__m256d_u*)dst;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm256_sqrt_pd(pSrc[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = sqrt(src[i]);
+      }
+    }
+
+    void InternalSquare(size_t size,
+                        double* dst,
+                        const double* src)
+    {
+      __m256d_u* pDst = (__m256d_u*)dst;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm256_mul_pd(pSrc[i], pSrc[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = src[i] * src[i];
+      }
+    }
+
+    void InternalCube(size_t size,
+                      double* dst,
+                      const double* src)
+    {
+      __m256d_u* pDst = (__m256d_u*)dst;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm256_mul_pd(_mm256_mul_pd(pSrc[i], pSrc[i]), pSrc[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = src[i] * src[i] * src[i];
+      }
+    }
+
+    void InternalSummation(size_t size,
+                           double* sum,
+                           const double* src)
+    {
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d accumulator = _mm256_setzero_pd();
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        accumulator = _mm256_add_pd(accumulator, pSrc[i]);
+      }
+
+      *sum = HorizontalSum(accumulator);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *sum += src[i];
+      }
+    }
+
+    // See CompensatedAdd(__m256&, __m256&, __m256)
+    static inline void CompensatedAdd(__m256d& sum, __m256d& compensation, __m256d x)
+    {
+      __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+      __m256d t = _mm256_add_pd(sum, x);
+      __m256d sumIsLarger = _mm256_cmp_pd(_mm256_and_pd(sum, absMask), _mm256_and_pd(x, absMask), _CMP_GE_OQ);
+      __m256d larger = _mm256_blendv_pd(x, sum, sumIsLarger);
+      __m256d smaller = _mm256_blendv_pd(sum, x, sumIsLarger);
+      compensation = _mm256_add_pd(compensation, _mm256_add_pd(_mm256_sub_pd(larger, t), smaller));
+      sum = t;
+    }
+
+    void InternalCompensatedSummation(size_t size,
+                                      double* lanes,
+                                      const double* src)
+    {
+      const size_t registers = COMPENSATED_LANES / 4;
+      __m256d sum[registers];
+      __m256d compensation[registers];
+      for ( size_t r = 0; r < registers; ++r ) {
+        sum[r] = _mm256_setzero_pd();
+        compensation[r] = _mm256_setzero_pd();
+      }
+
+      size_t i;
+      for ( i = 0; i + COMPENSATED_LANES <= size; i += COMPENSATED_LANES ) {
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], ((const __m256d_u*)(src + i))[r]);
+        }
+      }
+
+      // The last partial group is padded with zeros, like the fallback kernel does
+      if ( i < size ) {
+        alignas(32) double tail[COMPENSATED_LANES] = { 0 };
+        std::copy(src + i, src + size, tail);
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], ((__m256d_u*)tail)[r]);
+        }
+      }
+
+      for ( size_t r = 0; r < registers; ++r ) {
+        _mm256_storeu_pd(lanes + r * 4, sum[r]);
+        _mm256_storeu_pd(lanes + COMPENSATED_LANES + r * 4, compensation[r]);
+      }
+    }
+
+    void InternalCompensatedDotProduct(size_t size,
+                                       double* lanes,
+                                       const double* multiplier,
+                                       const double* multiplicand)
+    {
+      const size_t registers = COMPENSATED_LANES / 4;
+      __m256d sum[registers];
+      __m256d compensation[registers];
+      for ( size_t r = 0; r < registers; ++r ) {
+        sum[r] = _mm256_setzero_pd();
+        compensation[r] = _mm256_setzero_pd();
+      }
+
+      size_t i;
+      for ( i = 0; i + COMPENSATED_LANES <= size; i += COMPENSATED_LANES ) {
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], _mm256_mul_pd(((const __m256d_u*)(multiplier + i))[r], ((const __m256d_u*)(multiplicand + i))[r]));
+        }
+      }
+
+      // The last partial group is padded with zeros, like the fallback kernel does
+      if ( i < size ) {
+        alignas(32) double tailMultiplier[COMPENSATED_LANES] = { 0 };
+        alignas(32) double tailMultiplicand[COMPENSATED_LANES] = { 0 };
+        std::copy(multiplier + i, multiplier + size, tailMultiplier);
+        std::copy(multiplicand + i, multiplicand + size, tailMultiplicand);
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], _mm256_mul_pd(((__m256d_u*)tailMultiplier)[r], ((__m256d_u*)tailMultiplicand)[r]));
+        }
+      }
+
+      for ( size_t r = 0; r < registers; ++r ) {
+        _mm256_storeu_pd(lanes + r * 4, sum[r]);
+        _mm256_storeu_pd(lanes + COMPENSATED_LANES + r * 4, compensation[r]);
+      }
+    }
+
+    // Log-step inclusive scan of the 4 lanes of v
+    static inline __m256d ScanRegister(__m256d v)
+    {
+      v = _mm256_add_pd(v, _mm256_castsi256_pd(_mm256_slli_si256(_mm256_castpd_si256(v), 8)));
+      return _mm256_add_pd(v, _mm256_permute4x64_pd(_mm256_blend_pd(v, _mm256_setzero_pd(), 0xD), _MM_SHUFFLE(1, 1, 3, 3)));
+    }
+
+    void InternalPrefixSum(size_t size,
+                           double carry,
+                           double* dst,
+                           const double* src)
+    {
+      __m256d_u* pDst = (__m256d_u*)dst;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d ymmCarry = _mm256_set1_pd(carry);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm256_add_pd(ScanRegister(pSrc[i]), ymmCarry);
+        ymmCarry = _mm256_permute4x64_pd(pDst[i], _MM_SHUFFLE(3, 3, 3, 3));
+      }
+
+      carry = _mm256_cvtsd_f64(ymmCarry);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        carry += src[i];
+        dst[i] = carry;
+      }
+    }
+
+    void InternalExclusivePrefixSum(size_t size,
+                                    double carry,
+                                    double* dst,
+                                    const double* src)
+    {
+      __m256d_u* pDst = (__m256d_u*)dst;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d ymmCarry = _mm256_set1_pd(carry);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        __m256d inclusive = _mm256_add_pd(ScanRegister(pSrc[i]), ymmCarry);
+        pDst[i] = _mm256_blend_pd(_mm256_permute4x64_pd(inclusive, _MM_SHUFFLE(2, 1, 0, 3)), ymmCarry, 0x1);
+        ymmCarry = _mm256_permute4x64_pd(inclusive, _MM_SHUFFLE(3, 3, 3, 3));
+      }
+
+      carry = _mm256_cvtsd_f64(ymmCarry);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        double value = src[i];
+        dst[i] = carry;
+        carry += value;
+      }
+    }
+
+    void InternalDotProduct(size_t size,
+                            double* product,
+                            const double* multiplier,
+                            const double* multiplicand)
+    {
+      const __m256d_u* pMultiplier = (const __m256d_u*)multiplier;
+      const __m256d_u* pMultiplicand = (const __m256d_u*)multiplicand;
+      __m256d accumulator0 = _mm256_setzero_pd();
+      __m256d accumulator1 = _mm256_setzero_pd();
+      __m256d accumulator2 = _mm256_setzero_pd();
+      __m256d accumulator3 = _mm256_setzero_pd();
+
+      size_t i;
+      for ( i = 0; i + 4 <= (size >> 2); i += 4 ) {
+        accumulator0 = _mm256_add_pd(accumulator0, _mm256_mul_pd(pMultiplier[i], pMultiplicand[i]));
+        accumulator1 = _mm256_add_pd(accumulator1, _mm256_mul_pd(pMultiplier[i + 1], pMultiplicand[i + 1]));
+        accumulator2 = _mm256_add_pd(accumulator2, _mm256_mul_pd(pMultiplier[i + 2], pMultiplicand[i + 2]));
+        accumulator3 = _mm256_add_pd(accumulator3, _mm256_mul_pd(pMultiplier[i + 3], pMultiplicand[i + 3]));
+      }
+      for ( ; i < (size >> 2); ++i ) {
+        accumulator0 = _mm256_add_pd(accumulator0, _mm256_mul_pd(pMultiplier[i], pMultiplicand[i]));
+      }
+      __m256d accumulator = _mm256_add_pd(_mm256_add_pd(accumulator0, accumulator1), _mm256_add_pd(accumulator2, accumulator3));
+
+      *product = HorizontalSum(accumulator);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *product += (multiplier[i] * multiplicand[i]);
+      }
+    }
+
+    void InternalDotProductFma(size_t size,
+                               double* product,
+                               const double* multiplier,
+                               const double* multiplicand)
+    {
+      const __m256d_u* pMultiplier = (const __m256d_u*)multiplier;
+      const __m256d_u* pMultiplicand = (const __m256d_u*)multiplicand;
+      __m256d accumulator0 = _mm256_setzero_pd();
+      __m256d accumulator1 = _mm256_setzero_pd();
+      __m256d accumulator2 = _mm256_setzero_pd();
+      __m256d accumulator3 = _mm256_setzero_pd();
+
+      size_t i;
+      for ( i = 0; i + 4 <= (size >> 2); i += 4 ) {
+        accumulator0 = _mm256_fmadd_pd(pMultiplier[i], pMultiplicand[i], accumulator0);
+        accumulator1 = _mm256_fmadd_pd(pMultiplier[i + 1], pMultiplicand[i + 1], accumulator1);
+        accumulator2 = _mm256_fmadd_pd(pMultiplier[i + 2], pMultiplicand[i + 2], accumulator2);
+        accumulator3 = _mm256_fmadd_pd(pMultiplier[i + 3], pMultiplicand[i + 3], accumulator3);
+      }
+      for ( ; i < (size >> 2); ++i ) {
+        accumulator0 = _mm256_fmadd_pd(pMultiplier[i], pMultiplicand[i], accumulator0);
+      }
+      __m256d accumulator = _mm256_add_pd(_mm256_add_pd(accumulator0, accumulator1), _mm256_add_pd(accumulator2, accumulator3));
+
+      *product = HorizontalSum(accumulator);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *product = fma(multiplier[i], multiplicand[i], *product);
+      }
+    }
+
+    void InternalNegate(size_t size,
+                        double* dst,
+                        const double* src)
+    {
+      __m256d_u* pDst = (__m256d_u*)dst;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d mask = _mm256_set1_pd(-0.0);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm256_xor_pd(pSrc[i], mask);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = -src[i];
+      }
+    }
+
+    void InternalDistance(size_t size,
+                          double* distance,
+                          const double* v1,
+                          const double* v2)
+    {
+      const __m256d_u* pV1 = (const __m256d_u*)v1;
+      const __m256d_u* pV2 = (const __m256d_u*)v2;
+      __m256d scratch;
+      __m256d accumulator0 = _mm256_setzero_pd();
+      __m256d accumulator1 = _mm256_setzero_pd();
+      __m256d accumulator2 = _mm256_setzero_pd();
+      __m256d accumulator3 = _mm256_setzero_pd();
+
+      size_t i;
+      for ( i = 0; i + 4 <= (size >> 2); i += 4 ) {
+        scratch = _mm256_sub_pd(pV1[i], pV2[i]);
+        accumulator0 = _mm256_add_pd(accumulator0, _mm256_mul_pd(scratch, scratch));
+        scratch = _mm256_sub_pd(pV1[i + 1], pV2[i + 1]);
+        accumulator1 = _mm256_add_pd(accumulator1, _mm256_mul_pd(scratch, scratch));
+        scratch = _mm256_sub_pd(pV1[i + 2], pV2[i + 2]);
+        accumulator2 = _mm256_add_pd(accumulator2, _mm256_mul_pd(scratch, scratch));
+        scratch = _mm256_sub_pd(pV1[i + 3], pV2[i + 3]);
+        accumulator3 = _mm256_add_pd(accumulator3, _mm256_mul_pd(scratch, scratch));
+      }
+      for ( ; i < (size >> 2); ++i ) {
+        scratch = _mm256_sub_pd(pV1[i], pV2[i]);
+        accumulator0 = _mm256_add_pd(accumulator0, _mm256_mul_pd(scratch, scratch));
+      }
+      __m256d accumulator = _mm256_add_pd(_mm256_add_pd(accumulator0, accumulator1), _mm256_add_pd(accumulator2, accumulator3));
+
+      *distance = HorizontalSum(accumulator);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *distance += ((v1[i] - v2[i]) * (v1[i] - v2[i]));
+      }
+      *distance = sqrt(*distance);
+    }
+
+    void InternalDistanceFma(size_t size,
+                             double* distance,
+                             const double* v1,
+                             const double* v2)
+    {
+      const __m256d_u* pV1 = (const __m256d_u*)v1;
+      const __m256d_u* pV2 = (const __m256d_u*)v2;
+      __m256d scratch;
+      __m256d accumulator0 = _mm256_setzero_pd();
+      __m256d accumulator1 = _mm256_setzero_pd();
+      __m256d accumulator2 = _mm256_setzero_pd();
+      __m256d accumulator3 = _mm256_setzero_pd();
+
+      size_t i;
+      for ( i = 0; i + 4 <= (size >> 2); i += 4 ) {
+        scratch = _mm256_sub_pd(pV1[i], pV2[i]);
+        accumulator0 = _mm256_fmadd_pd(scratch, scratch, accumulator0);
+        scratch = _mm256_sub_pd(pV1[i + 1], pV2[i + 1]);
+        accumulator1 = _mm256_fmadd_pd(scratch, scratch, accumulator1);
+        scratch = _mm256_sub_pd(pV1[i + 2], pV2[i + 2]);
+        accumulator2 = _mm256_fmadd_pd(scratch, scratch, accumulator2);
+        scratch = _mm256_sub_pd(pV1[i + 3], pV2[i + 3]);
+        accumulator3 = _mm256_fmadd_pd(scratch, scratch, accumulator3);
+      }
+      for ( ; i < (size >> 2); ++i ) {
+        scratch = _mm256_sub_pd(pV1[i], pV2[i]);
+        accumulator0 = _mm256_fmadd_pd(scratch, scratch, accumulator0);
+      }
+      __m256d accumulator = _mm256_add_pd(_mm256_add_pd(accumulator0, accumulator1), _mm256_add_pd(accumulator2, accumulator3));
+
+      *distance = HorizontalSum(accumulator);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *distance = fma(v1[i] - v2[i], v1[i] - v2[i], *distance);
+      }
+      *distance = sqrt(*distance);
+    }
+
+    void InternalReciprocate(size_t size,
+                             double* dst,
+                             const double* src)
+    {
+      // There is no approximate reciprocal for double-precision before AVX-512, the division is exact
+      __m256d_u* pDst = (__m256d_u*)dst;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d one = _mm256_set1_pd(1.0);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm256_div_pd(one, pSrc[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = 1.0 / src[i];
+      }
+    }
+
+    void InternalRsqrt(size_t size,
+                       double* dst,
+                       const double* src)
+    {
+      __m256d_u* pDst = (__m256d_u*)dst;
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d one = _mm256_set1_pd(1.0);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm256_div_pd(one, _mm256_sqrt_pd(pSrc[i]));
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = 1.0 / std::sqrt(src[i]);
+      }
+    }
+
+    void InternalMinimum(size_t size,
+                         double* minimum,
+                         const double* src)
+    {
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d accumulator = _mm256_set1_pd(std::numeric_limits<double>::max());
+      __m256d nans = _mm256_setzero_pd();
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        accumulator = _mm256_min_pd(pSrc[i], accumulator);
+        nans = _mm256_or_pd(nans, _mm256_cmp_pd(pSrc[i], pSrc[i], _CMP_UNORD_Q));
+      }
+
+      double* tmp = (double*)&accumulator;
+      *minimum = _mm256_movemask_pd(nans) ? std::numeric_limits<double>::quiet_NaN() : tmp[0];
+      for ( size_t lane = 1; lane < 4; ++lane ) {
+        *minimum = tmp[lane] < *minimum ? tmp[lane] : *minimum;
+      }
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *minimum = src[i] < *minimum || src[i] != src[i] ? src[i] : *minimum;
+      }
+    }
+
+    void InternalMaximum(size_t size,
+                         double* maximum,
+                         const double* src)
+    {
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d accumulator = _mm256_set1_pd(std::numeric_limits<double>::lowest());
+      __m256d nans = _mm256_setzero_pd();
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        accumulator = _mm256_max_pd(pSrc[i], accumulator);
+        nans = _mm256_or_pd(nans, _mm256_cmp_pd(pSrc[i], pSrc[i], _CMP_UNORD_Q));
+      }
+
+      double* tmp = (double*)&accumulator;
+      *maximum = _mm256_movemask_pd(nans) ? std::numeric_limits<double>::quiet_NaN() : tmp[0];
+      for ( size_t lane = 1; lane < 4; ++lane ) {
+        *maximum = tmp[lane] > *maximum ? tmp[lane] : *maximum;
+      }
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *maximum = src[i] > *maximum || src[i] != src[i] ? src[i] : *maximum;
+      }
+    }
+
+    void InternalMinMaximum(size_t size,
+                            Extrema<double>* extrema,
+                            const double* src)
+    {
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      __m256d minimum = _mm256_set1_pd(std::numeric_limits<double>::max());
+      __m256d maximum = _mm256_set1_pd(std::numeric_limits<double>::lowest());
+      __m256d nans = _mm256_setzero_pd();
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        minimum = _mm256_min_pd(pSrc[i], minimum);
+        maximum = _mm256_max_pd(pSrc[i], maximum);
+        nans = _mm256_or_pd(nans, _mm256_cmp_pd(pSrc[i], pSrc[i], _CMP_UNORD_Q));
+      }
+
+      double* minima = (double*)&minimum;
+      double* maxima = (double*)&maximum;
+      if ( _mm256_movemask_pd(nans) ) {
+        extrema->minimum = extrema->maximum = std::numeric_limits<double>::quiet_NaN();
+      } else {
+        extrema->minimum = minima[0];
+        extrema->maximum = maxima[0];
+        for ( size_t lane = 1; lane < 4; ++lane ) {
+          extrema->minimum = minima[lane] < extrema->minimum ? minima[lane] : extrema->minimum;
+          extrema->maximum = maxima[lane] > extrema->maximum ? maxima[lane] : extrema->maximum;
+        }
+      }
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        extrema->minimum = src[i] < extrema->minimum || src[i] != src[i] ? src[i] : extrema->minimum;
+        extrema->maximum = src[i] > extrema->maximum || src[i] != src[i] ? src[i] : extrema->maximum;
+      }
+    }
+
+    // See ArgExtremum(size_t, const float*)
+    template<bool Largest>
+    static size_t ArgExtremum(size_t size,
+                              const double* src)
+    {
+      const __m256d_u* pSrc = (const __m256d_u*)src;
+      size_t index = 0;
+      size_t i = 0;
+      if ( size >= 4 ) {
+        __m256d best = pSrc[0];
+        __m256d bestRegister = _mm256_setzero_pd();
+        __m256d nans = _mm256_cmp_pd(best, best, _CMP_UNORD_Q);
+        for ( i = 1; i < (size >> 2); ++i ) {
+          __m256d better = Largest ? _mm256_cmp_pd(pSrc[i], best, _CMP_GT_OQ) : _mm256_cmp_pd(pSrc[i], best, _CMP_LT_OQ);
+          best = _mm256_blendv_pd(best, pSrc[i], better);
+          bestRegister = _mm256_blendv_pd(bestRegister, _mm256_castsi256_pd(_mm256_set1_epi64x((int64_t)i)), better);
+          nans = _mm256_or_pd(nans, _mm256_cmp_pd(pSrc[i], pSrc[i], _CMP_UNORD_Q));
+        }
+
+        if ( _mm256_movemask_pd(nans) ) {
+          // Rescan from the start, the scalar loop below stops at the first NaN
+          i = 0;
+        } else {
+          uint64_t* registers = (uint64_t*)&bestRegister;
+          index = (size_t)registers[0] << 2;
+          for ( size_t lane = 1; lane < 4; ++lane ) {
+            size_t candidate = ((size_t)registers[lane] << 2) + lane;
+            if ( (Largest ? src[candidate] > src[index] : src[candidate] < src[index]) ||
+                 (src[candidate] == src[index] && candidate < index) ) {
+              index = candidate;
+            }
+          }
+          i <<= 2;
+        }
+      }
+
+      for ( ; i < size; ++i ) {
+        if ( src[i] != src[i] ) {
+          return i;
+        }
+        index = (Largest ? src[i] > src[index] : src[i] < src[index]) ? i : index;
+      }
+      return index;
+    }
+
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const double* src)
+    {
+      *index = ArgExtremum<false>(size, src);
+    }
+
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const double* src)
+    {
+      *index = ArgExtremum<true>(size, src);
+    }
+
+    ///////////////////////////// 32-bit integers /////////////////////////////
+
+    // The kernels whose result does not depend on the signedness, e.g., add, mullo or the bitwise operations,
+    // are implemented for uint32_t only; the int32_t overloads forward to them so that the scalar tails wrap
+    // around instead of overflowing.
+
+    void InternalAdd(size_t size,
+                     uint32_t* sum,
+                     const uint32_t* augend,
+                     const uint32_t* addend)
+    {
+      __m256i_u* pSum = (__m256i_u*)sum;
+      const __m256i_u* pAugend = (const __m256i_u*)augend;
+      const __m256i_u* pAddend = (const __m256i_u*)addend;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pSum[i] = _mm256_add_epi32(pAugend[i], pAddend[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        sum[i] = augend[i] + addend[i];
+      }
+    }
+
+    void InternalScalarAdd(size_t size,
+                           uint32_t addend,
+                           uint32_t* sum,
+                           const uint32_t* src)
+    {
+      __m256i_u* pSum = (__m256i_u*)sum;
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i ymmAddend = _mm256_set1_epi32(addend);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pSum[i] = _mm256_add_epi32(pSrc[i], ymmAddend);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        sum[i] = src[i] + addend;
+      }
+    }
+
+    void InternalSub(size_t size,
+                     uint32_t* difference,
+                     const uint32_t* minuend,
+                     const uint32_t* subtrahend)
+    {
+      __m256i_u* pDifference = (__m256i_u*)difference;
+      const __m256i_u* pMinuend = (const __m256i_u*)minuend;
+      const __m256i_u* pSubtrahend = (const __m256i_u*)subtrahend;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDifference[i] = _mm256_sub_epi32(pMinuend[i], pSubtrahend[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        difference[i] = minuend[i] - subtrahend[i];
+      }
+    }
+
+    void InternalMul(size_t size,
+                     uint32_t* product,
+                     const uint32_t* multiplier,
+                     const uint32_t* multiplicand)
+    {
+      __m256i_u* pProduct = (__m256i_u*)product;
+      const __m256i_u* pMultiplier = (const __m256i_u*)multiplier;
+      const __m256i_u* pMultiplicand = (const __m256i_u*)multiplicand;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pProduct[i] = _mm256_mullo_epi32(pMultiplier[i], pMultiplicand[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        product[i] = multiplier[i] * multiplicand[i];
+      }
+    }
+
+    void InternalScalarMul(size_t size,
+                           uint32_t multiplier,
+                           uint32_t* product,
+                           const uint32_t* src)
+    {
+      __m256i_u* pProduct = (__m256i_u*)product;
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i ymmMultiplier = _mm256_set1_epi32(multiplier);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pProduct[i] = _mm256_mullo_epi32(pSrc[i], ymmMultiplier);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        product[i] = src[i] * multiplier;
+      }
+    }
+
+    void InternalSquare(size_t size,
+                        uint32_t* dst,
+                        const uint32_t* src)
+    {
+      InternalMul(size, dst, src, src);
+    }
+
+    void InternalCube(size_t size,
+                      uint32_t* dst,
+                      const uint32_t* src)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_mullo_epi32(_mm256_mullo_epi32(pSrc[i], pSrc[i]), pSrc[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = src[i] * src[i] * src[i];
+      }
+    }
+
+    void InternalNegate(size_t size,
+                        uint32_t* dst,
+                        const uint32_t* src)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i zero = _mm256_setzero_si256();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_sub_epi32(zero, pSrc[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = 0u - src[i];
+      }
+    }
+
+    void InternalMin(size_t size,
+                     uint32_t* dst,
+                     const uint32_t* lhs,
+                     const uint32_t* rhs)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pLhs = (const __m256i_u*)lhs;
+      const __m256i_u* pRhs = (const __m256i_u*)rhs;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_min_epu32(pLhs[i], pRhs[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = lhs[i] < rhs[i] ? lhs[i] : rhs[i];
+      }
+    }
+
+    void InternalMax(size_t size,
+                     uint32_t* dst,
+                     const uint32_t* lhs,
+                     const uint32_t* rhs)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pLhs = (const __m256i_u*)lhs;
+      const __m256i_u* pRhs = (const __m256i_u*)rhs;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_max_epu32(pLhs[i], pRhs[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = lhs[i] > rhs[i] ? lhs[i] : rhs[i];
+      }
+    }
+
+    void InternalAnd(size_t size,
+                     uint32_t* dst,
+                     const uint32_t* lhs,
+                     const uint32_t* rhs)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pLhs = (const __m256i_u*)lhs;
+      const __m256i_u* pRhs = (const __m256i_u*)rhs;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_and_si256(pLhs[i], pRhs[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = lhs[i] & rhs[i];
+      }
+    }
+
+    void InternalOr(size_t size,
+                    uint32_t* dst,
+                    const uint32_t* lhs,
+                    const uint32_t* rhs)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pLhs = (const __m256i_u*)lhs;
+      const __m256i_u* pRhs = (const __m256i_u*)rhs;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_or_si256(pLhs[i], pRhs[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = lhs[i] | rhs[i];
+      }
+    }
+
+    void InternalXor(size_t size,
+                     uint32_t* dst,
+                     const uint32_t* lhs,
+                     const uint32_t* rhs)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pLhs = (const __m256i_u*)lhs;
+      const __m256i_u* pRhs = (const __m256i_u*)rhs;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_xor_si256(pLhs[i], pRhs[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = lhs[i] ^ rhs[i];
+      }
+    }
+
+    void InternalAndNot(size_t size,
+                        uint32_t* dst,
+                        const uint32_t* lhs,
+                        const uint32_t* rhs)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pLhs = (const __m256i_u*)lhs;
+      const __m256i_u* pRhs = (const __m256i_u*)rhs;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        // vpandn complements its first operand
+        pDst[i] = _mm256_andnot_si256(pRhs[i], pLhs[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = lhs[i] & ~rhs[i];
+      }
+    }
+
+    void InternalShiftLeft(size_t size,
+                           uint32_t count,
+                           uint32_t* dst,
+                           const uint32_t* src)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m128i xmmCount = _mm_cvtsi32_si128(count);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_sll_epi32(pSrc[i], xmmCount);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = count < 32 ? src[i] << count : 0;
+      }
+    }
+
+    void InternalShiftRight(size_t size,
+                            uint32_t count,
+                            uint32_t* dst,
+                            const uint32_t* src)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m128i xmmCount = _mm_cvtsi32_si128(count);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_srl_epi32(pSrc[i], xmmCount);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = count < 32 ? src[i] >> count : 0;
+      }
+    }
+
+    void InternalSummation(size_t size,
+                           uint32_t* sum,
+                           const uint32_t* src)
+    {
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i accumulator = _mm256_setzero_si256();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        accumulator = _mm256_add_epi32(accumulator, pSrc[i]);
+      }
+
+      uint32_t* tmp = (uint32_t*)&accumulator;
+      *sum = tmp[0] + tmp[1] + tmp[2] + tmp[3] + tmp[4] + tmp[5] + tmp[6] + tmp[7];
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *sum += src[i];
+      }
+    }
+
+    void InternalPrefixSum(size_t size,
+                           uint32_t carry,
+                           uint32_t* dst,
+                           const uint32_t* src)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i ymmCarry = _mm256_set1_epi32(carry);
+      __m256i lastLane = _mm256_set1_epi32(7);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_add_epi32(ScanRegister(pSrc[i]), ymmCarry);
+        ymmCarry = _mm256_permutevar8x32_epi32(pDst[i], lastLane);
+      }
+
+      carry = (uint32_t)_mm256_cvtsi256_si32(ymmCarry);
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        carry += src[i];
+        dst[i] = carry;
+      }
+    }
+
+    void InternalExclusivePrefixSum(size_t size,
+                                    uint32_t carry,
+                                    uint32_t* dst,
+                                    const uint32_t* src)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i ymmCarry = _mm256_set1_epi32(carry);
+      __m256i lastLane = _mm256_set1_epi32(7);
+      __m256i rotateUp = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        __m256i inclusive = _mm256_add_epi32(ScanRegister(pSrc[i]), ymmCarry);
+        pDst[i] = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(inclusive, rotateUp), ymmCarry, 0x01);
+        ymmCarry = _mm256_permutevar8x32_epi32(inclusive, lastLane);
+      }
+
+      carry = (uint32_t)_mm256_cvtsi256_si32(ymmCarry);
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        uint32_t value = src[i];
+        dst[i] = carry;
+        carry += value;
+      }
+    }
+
+    void InternalDotProduct(size_t size,
+                            uint32_t* product,
+                            const uint32_t* multiplier,
+                            const uint32_t* multiplicand)
+    {
+      const __m256i_u* pMultiplier = (const __m256i_u*)multiplier;
+      const __m256i_u* pMultiplicand = (const __m256i_u*)multiplicand;
+      __m256i accumulator = _mm256_setzero_si256();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        accumulator = _mm256_add_epi32(accumulator, _mm256_mullo_epi32(pMultiplier[i], pMultiplicand[i]));
+      }
+
+      uint32_t* tmp = (uint32_t*)&accumulator;
+      *product = tmp[0] + tmp[1] + tmp[2] + tmp[3] + tmp[4] + tmp[5] + tmp[6] + tmp[7];
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *product += multiplier[i] * multiplicand[i];
+      }
+    }
+
+    void InternalWideSummation(size_t size,
+                               uint64_t* sum,
+                               const uint32_t* src)
+    {
+      // Each 32-bit lane is zero-extended into one of two 64-bit accumulators, the even lanes go in the
+      // first and the odd lanes in the second one, so no partial sum can overflow before 2^32 elements.
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i evenMask = _mm256_set1_epi64x(0x00000000FFFFFFFFULL);
+      __m256i evenAccumulator = _mm256_setzero_si256();
+      __m256i oddAccumulator = _mm256_setzero_si256();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        evenAccumulator = _mm256_add_epi64(evenAccumulator, _mm256_and_si256(pSrc[i], evenMask));
+        oddAccumulator = _mm256_add_epi64(oddAccumulator, _mm256_srli_epi64(pSrc[i], 32));
+      }
+
+      evenAccumulator = _mm256_add_epi64(evenAccumulator, oddAccumulator);
+      uint64_t* tmp = (uint64_t*)&evenAccumulator;
+      *sum = tmp[0] + tmp[1] + tmp[2] + tmp[3];
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *sum += src[i];
+      }
+    }
+
+    void InternalMinimum(size_t size,
+                         uint32_t* minimum,
+                         const uint32_t* src)
+    {
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i accumulator = _mm256_set1_epi32(0xFFFFFFFF);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        accumulator = _mm256_min_epu32(accumulator, pSrc[i]);
+      }
+
+      uint32_t* tmp = (uint32_t*)&accumulator;
+      *minimum = tmp[0];
+      for ( size_t lane = 1; lane < 8; ++lane ) {
+        *minimum = tmp[lane] < *minimum ? tmp[lane] : *minimum;
+      }
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *minimum = src[i] < *minimum ? src[i] : *minimum;
+      }
+    }
+
+    void InternalMaximum(size_t size,
+                         uint32_t* maximum,
+                         const uint32_t* src)
+    {
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i accumulator = _mm256_setzero_si256();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        accumulator = _mm256_max_epu32(accumulator, pSrc[i]);
+      }
+
+      uint32_t* tmp = (uint32_t*)&accumulator;
+      *maximum = tmp[0];
+      for ( size_t lane = 1; lane < 8; ++lane ) {
+        *maximum = tmp[lane] > *maximum ? tmp[lane] : *maximum;
+      }
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *maximum = src[i] > *maximum ? src[i] : *maximum;
+      }
+    }
+
+    void InternalMinMaximum(size_t size,
+                            Extrema<uint32_t>* extrema,
+                            const uint32_t* src)
+    {
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i minimum = _mm256_set1_epi32(0xFFFFFFFF);
+      __m256i maximum = _mm256_setzero_si256();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        minimum = _mm256_min_epu32(minimum, pSrc[i]);
+        maximum = _mm256_max_epu32(maximum, pSrc[i]);
+      }
+
+      uint32_t* minima = (uint32_t*)&minimum;
+      uint32_t* maxima = (uint32_t*)&maximum;
+      extrema->minimum = minima[0];
+      extrema->maximum = maxima[0];
+      for ( size_t lane = 1; lane < 8; ++lane ) {
+        extrema->minimum = minima[lane] < extrema->minimum ? minima[lane] : extrema->minimum;
+        extrema->maximum = maxima[lane] > extrema->maximum ? maxima[lane] : extrema->maximum;
+      }
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        extrema->minimum = src[i] < extrema->minimum ? src[i] : extrema->minimum;
+        extrema->maximum = src[i] > extrema->maximum ? src[i] : extrema->maximum;
+      }
+    }
+
+    // Index of the first smallest (Largest == false) or largest element of src, like ArgExtremum(size_t, const float*). There is
+    // no unsigned 32-bit compare, unsigned lanes are compared as signed ones after flipping their sign bit.
+    template<bool Largest, typename T>
+    static size_t ArgExtremum(size_t size,
+                              const T* src)
+    {
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i bias = _mm256_set1_epi32(std::is_signed<T>::value ? 0 : INT32_MIN);
+      size_t index = 0;
+      size_t i = 0;
+      if ( size >= 8 ) {
+        __m256i best = _mm256_xor_si256(pSrc[0], bias);
+        __m256i bestRegister = _mm256_setzero_si256();
+        for ( i = 1; i < (size >> 3); ++i ) {
+          __m256i value = _mm256_xor_si256(pSrc[i], bias);
+          __m256i better = Largest ? _mm256_cmpgt_epi32(value, best) : _mm256_cmpgt_epi32(best, value);
+          best = _mm256_blendv_epi8(best, value, better);
+          bestRegister = _mm256_blendv_epi8(bestRegister, _mm256_set1_epi32((int32_t)i), better);
+        }
+
+        uint32_t* registers = (uint32_t*)&bestRegister;
+        index = (size_t)registers[0] << 3;
+        for ( size_t lane = 1; lane < 8; ++lane ) {
+          size_t candidate = ((size_t)registers[lane] << 3) + lane;
+          if ( (Largest ? src[candidate] > src[index] : src[candidate] < src[index]) ||
+               (src[candidate] == src[index] && candidate < index) ) {
+            index = candidate;
+          }
+        }
+        i <<= 3;
+      }
+
+      for ( ; i < size; ++i ) {
+        index = (Largest ? src[i] > src[index] : src[i] < src[index]) ? i : index;
+      }
+      return index;
+    }
+
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const uint32_t* src)
+    {
+      *index = ArgExtremum<false>(size, src);
+    }
+
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const uint32_t* src)
+    {
+      *index = ArgExtremum<true>(size, src);
+    }
+
+    void InternalAdd(size_t size,
+                     int32_t* sum,
+                     const int32_t* augend,
+                     const int32_t* addend)
+    {
+      InternalAdd(size, (uint32_t*)sum, (const uint32_t*)augend, (const uint32_t*)addend);
+    }
+
+    void InternalScalarAdd(size_t size,
+                           int32_t addend,
+                           int32_t* sum,
+                           const int32_t* src)
+    {
+      InternalScalarAdd(size, (uint32_t)addend, (uint32_t*)sum, (const uint32_t*)src);
+    }
+
+    void InternalSub(size_t size,
+                     int32_t* difference,
+                     const int32_t* minuend,
+                     const int32_t* subtrahend)
+    {
+      InternalSub(size, (uint32_t*)difference, (const uint32_t*)minuend, (const uint32_t*)subtrahend);
+    }
+
+    void InternalMul(size_t size,
+                     int32_t* product,
+                     const int32_t* multiplier,
+                     const int32_t* multiplicand)
+    {
+      InternalMul(size, (uint32_t*)product, (const uint32_t*)multiplier, (const uint32_t*)multiplicand);
+    }
+
+    void InternalScalarMul(size_t size,
+                           int32_t multiplier,
+                           int32_t* product,
+                           const int32_t* src)
+    {
+      InternalScalarMul(size, (uint32_t)multiplier, (uint32_t*)product, (const uint32_t*)src);
+    }
+
+    void InternalSquare(size_t size,
+                        int32_t* dst,
+                        const int32_t* src)
+    {
+      InternalSquare(size, (uint32_t*)dst, (const uint32_t*)src);
+    }
+
+    void InternalCube(size_t size,
+                      int32_t* dst,
+                      const int32_t* src)
+    {
+      InternalCube(size, (uint32_t*)dst, (const uint32_t*)src);
+    }
+
+    void InternalNegate(size_t size,
+                        int32_t* dst,
+                        const int32_t* src)
+    {
+      InternalNegate(size, (uint32_t*)dst, (const uint32_t*)src);
+    }
+
+    void InternalMin(size_t size,
+                     int32_t* dst,
+                     const int32_t* lhs,
+                     const int32_t* rhs)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pLhs = (const __m256i_u*)lhs;
+      const __m256i_u* pRhs = (const __m256i_u*)rhs;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_min_epi32(pLhs[i], pRhs[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = lhs[i] < rhs[i] ? lhs[i] : rhs[i];
+      }
+    }
+
+    void InternalMax(size_t size,
+                     int32_t* dst,
+                     const int32_t* lhs,
+                     const int32_t* rhs)
+    {
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pLhs = (const __m256i_u*)lhs;
+      const __m256i_u* pRhs = (const __m256i_u*)rhs;
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_max_epi32(pLhs[i], pRhs[i]);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = lhs[i] > rhs[i] ? lhs[i] : rhs[i];
+      }
+    }
+
+    void InternalAnd(size_t size,
+                     int32_t* dst,
+                     const int32_t* lhs,
+                     const int32_t* rhs)
+    {
+      InternalAnd(size, (uint32_t*)dst, (const uint32_t*)lhs, (const uint32_t*)rhs);
+    }
+
+    void InternalOr(size_t size,
+                    int32_t* dst,
+                    const int32_t* lhs,
+                    const int32_t* rhs)
+    {
+      InternalOr(size, (uint32_t*)dst, (const uint32_t*)lhs, (const uint32_t*)rhs);
+    }
+
+    void InternalXor(size_t size,
+                     int32_t* dst,
+                     const int32_t* lhs,
+                     const int32_t* rhs)
+    {
+      InternalXor(size, (uint32_t*)dst, (const uint32_t*)lhs, (const uint32_t*)rhs);
+    }
+
+    void InternalAndNot(size_t size,
+                        int32_t* dst,
+                        const int32_t* lhs,
+                        const int32_t* rhs)
+    {
+      InternalAndNot(size, (uint32_t*)dst, (const uint32_t*)lhs, (const uint32_t*)rhs);
+    }
+
+    void InternalShiftLeft(size_t size,
+                           uint32_t count,
+                           int32_t* dst,
+                           const int32_t* src)
+    {
+      InternalShiftLeft(size, count, (uint32_t*)dst, (const uint32_t*)src);
+    }
+
+    void InternalShiftRight(size_t size,
+                            uint32_t count,
+                            int32_t* dst,
+                            const int32_t* src)
+    {
+      // Arithmetic shift, the sign bit is replicated; counts above 31 leave only the sign
+      __m256i_u* pDst = (__m256i_u*)dst;
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m128i xmmCount = _mm_cvtsi32_si128(count);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        pDst[i] = _mm256_sra_epi32(pSrc[i], xmmCount);
+      }
+
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        dst[i] = src[i] >> (count < 32 ? count : 31);
+      }
+    }
+
+    void InternalSummation(size_t size,
+                           int32_t* sum,
+                           const int32_t* src)
+    {
+      InternalSummation(size, (uint32_t*)sum, (const uint32_t*)src);
+    }
+
+    void InternalPrefixSum(size_t size,
+                           int32_t carry,
+                           int32_t* dst,
+                           const int32_t* src)
+    {
+      InternalPrefixSum(size, (uint32_t)carry, (uint32_t*)dst, (const uint32_t*)src);
+    }
+
+    void InternalExclusivePrefixSum(size_t size,
+                                    int32_t carry,
+                                    int32_t* dst,
+                                    const int32_t* src)
+    {
+      InternalExclusivePrefixSum(size, (uint32_t)carry, (uint32_t*)dst, (const uint32_t*)src);
+    }
+
+    void InternalDotProduct(size_t size,
+                            int32_t* product,
+                            const int32_t* multiplier,
+                            const int32_t* multiplicand)
+    {
+      InternalDotProduct(size, (uint32_t*)product, (const uint32_t*)multiplier, (const uint32_t*)multiplicand);
+    }
+
+    void InternalWideSummation(size_t size,
+                               int64_t* sum,
+                               const int32_t* src)
+    {
+      // Each half of the register is sign-extended into 64-bit lanes before being accumulated
+      const __m128i_u* pSrc = (const __m128i_u*)src;
+      __m256i accumulator = _mm256_setzero_si256();
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        accumulator = _mm256_add_epi64(accumulator, _mm256_cvtepi32_epi64(pSrc[2 * i]));
+        accumulator = _mm256_add_epi64(accumulator, _mm256_cvtepi32_epi64(pSrc[2 * i + 1]));
+      }
+
+      int64_t* tmp = (int64_t*)&accumulator;
+      *sum = tmp[0] + tmp[1] + tmp[2] + tmp[3];
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *sum += src[i];
+      }
+    }
+
+    void InternalMinimum(size_t size,
+                         int32_t* minimum,
+                         const int32_t* src)
+    {
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i accumulator = _mm256_set1_epi32(INT32_MAX);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        accumulator = _mm256_min_epi32(accumulator, pSrc[i]);
+      }
+
+      int32_t* tmp = (int32_t*)&accumulator;
+      *minimum = tmp[0];
+      for ( size_t lane = 1; lane < 8; ++lane ) {
+        *minimum = tmp[lane] < *minimum ? tmp[lane] : *minimum;
+      }
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *minimum = src[i] < *minimum ? src[i] : *minimum;
+      }
+    }
+
+    void InternalMaximum(size_t size,
+                         int32_t* maximum,
+                         const int32_t* src)
+    {
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i accumulator = _mm256_set1_epi32(INT32_MIN);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        accumulator = _mm256_max_epi32(accumulator, pSrc[i]);
+      }
+
+      int32_t* tmp = (int32_t*)&accumulator;
+      *maximum = tmp[0];
+      for ( size_t lane = 1; lane < 8; ++lane ) {
+        *maximum = tmp[lane] > *maximum ? tmp[lane] : *maximum;
+      }
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        *maximum = src[i] > *maximum ? src[i] : *maximum;
+      }
+    }
+
+    void InternalMinMaximum(size_t size,
+                            Extrema<int32_t>* extrema,
+                            const int32_t* src)
+    {
+      const __m256i_u* pSrc = (const __m256i_u*)src;
+      __m256i minimum = _mm256_set1_epi32(INT32_MAX);
+      __m256i maximum = _mm256_set1_epi32(INT32_MIN);
+
+      size_t i;
+      for ( i = 0; i < (size >> 3); ++i ) {
+        minimum = _mm256_min_epi32(minimum, pSrc[i]);
+        maximum = _mm256_max_epi32(maximum, pSrc[i]);
+      }
+
+      int32_t* minima = (int32_t*)&minimum;
+      int32_t* maxima = (int32_t*)&maximum;
+      extrema->minimum = minima[0];
+      extrema->maximum = maxima[0];
+      for ( size_t lane = 1; lane < 8; ++lane ) {
+        extrema->minimum = minima[lane] < extrema->minimum ? minima[lane] : extrema->minimum;
+        extrema->maximum = maxima[lane] > extrema->maximum ? maxima[lane] : extrema->maximum;
+      }
+      i <<= 3;
+      for ( ; i < size; ++i ) {
+        extrema->minimum = src[i] < extrema->minimum ? src[i] : extrema->minimum;
+        extrema->maximum = src[i] > extrema->maximum ? src[i] : extrema->maximum;
+      }
+    }
+
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const int32_t* src)
+    {
+      *index = ArgExtremum<false>(size, src);
+    }
+
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const int32_t* src)
+    {
+      *index = ArgExtremum<true>(size, src);
+    }
   }
 }
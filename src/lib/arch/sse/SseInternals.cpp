@@ -0,0 +1,1096 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "SseInternals.hpp"
+
+namespace khyber
+{
+  namespace sse
+  {
+    // Reduces the 4 lanes of v to a single float by folding the upper half onto the lower one twice
+    static inline float HorizontalSum(__m128 v)
+    {
+      v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+      v = _mm_add_ss(v, _mm_movehdup_ps(v));
+      return _mm_cvtss_f32(v);
+    }
+
+    void InternalAdd(size_t size,
+                     float* sum,
+                     const float* augend,
+                     const float* addend)
+    {
+      __m128_u* pSum = (__m128_u*)sum;
+      const __m128_u* pAugend = (const __m128_u*)augend;
+      const __m128_u* pAddend = (const __m128_u*)addend;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pSum[i] = _mm_add_ps(pAugend[i], pAddend[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        sum[i] = augend[i] + addend[i];
+      }
+    }
+
+    void InternalScalarAdd(size_t size,
+                           float addend,
+                           float* sum,
+                           const float* src)
+    {
+      __m128_u* pSum = (__m128_u*)sum;
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 xmmAddend = _mm_set1_ps(addend);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pSum[i] = _mm_add_ps(pSrc[i], xmmAddend);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        sum[i] = src[i] + addend;
+      }
+    }
+
+    void InternalSub(size_t size,
+                     float* difference,
+                     const float* minuend,
+                     const float* subtrahend)
+    {
+      __m128_u* pDifference = (__m128_u*)difference;
+      const __m128_u* pMinuend = (const __m128_u*)minuend;
+      const __m128_u* pSubtrahend = (const __m128_u*)subtrahend;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDifference[i] = _mm_sub_ps(pMinuend[i], pSubtrahend[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        difference[i] = minuend[i] - subtrahend[i];
+      }
+    }
+
+    void InternalMul(size_t size,
+                     float* product,
+                     const float* multiplier,
+                     const float* multiplicand)
+    {
+      __m128_u* pProduct = (__m128_u*)product;
+      const __m128_u* pMultiplier = (const __m128_u*)multiplier;
+      const __m128_u* pMultiplicand = (const __m128_u*)multiplicand;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pProduct[i] = _mm_mul_ps(pMultiplier[i], pMultiplicand[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        product[i] = multiplier[i] * multiplicand[i];
+      }
+    }
+
+    void InternalScalarMul(size_t size,
+                           float multiplier,
+                           float* product,
+                           const float* src)
+    {
+      __m128_u* pProduct = (__m128_u*)product;
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 xmmMultiplier = _mm_set1_ps(multiplier);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pProduct[i] = _mm_mul_ps(pSrc[i], xmmMultiplier);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        product[i] = src[i] * multiplier;
+      }
+    }
+
+    void InternalDiv(size_t size,
+                     float* quotient,
+                     const float* dividend,
+                     const float* divisor)
+    {
+      __m128_u* pQuotient = (__m128_u*)quotient;
+      const __m128_u* pDividend = (const __m128_u*)dividend;
+      const __m128_u* pDivisor = (const __m128_u*)divisor;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pQuotient[i] = _mm_div_ps(pDividend[i], pDivisor[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        quotient[i] = dividend[i] / divisor[i];
+      }
+    }
+
+    void InternalScalarDiv(size_t size,
+                           float divisor,
+                           float* quotient,
+                           const float* src)
+    {
+      __m128_u* pQuotient = (__m128_u*)quotient;
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 xmmDivisor = _mm_set1_ps(divisor);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pQuotient[i] = _mm_div_ps(pSrc[i], xmmDivisor);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        quotient[i] = src[i] / divisor;
+      }
+    }
+
+    void InternalSqrt(size_t size,
+                      float* dst,
+                      const float* src)
+    {
+      __m128_u* pDst = (__m128_u*)dst;
+      const __m128_u* pSrc = (const __m128_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm_sqrt_ps(pSrc[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = sqrt(src[i]);
+      }
+    }
+
+    void InternalSquare(size_t size,
+                        float* dst,
+                        const float* src)
+    {
+      __m128_u* pDst = (__m128_u*)dst;
+      const __m128_u* pSrc = (const __m128_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm_mul_ps(pSrc[i], pSrc[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = src[i] * src[i];
+      }
+    }
+
+    void InternalCube(size_t size,
+                      float* dst,
+                      const float* src)
+    {
+      __m128_u* pDst = (__m128_u*)dst;
+      const __m128_u* pSrc = (const __m128_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm_mul_ps(_mm_mul_ps(pSrc[i], pSrc[i]), pSrc[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = src[i] * src[i] * src[i];
+      }
+    }
+
+    void InternalSummation(size_t size,
+                           float* sum,
+                           const float* src)
+    {
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 accumulator = _mm_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        accumulator = _mm_add_ps(accumulator, pSrc[i]);
+      }
+
+      *sum = HorizontalSum(accumulator);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *sum += src[i];
+      }
+    }
+
+    // Neumaier's compensated addition of x to every lane of sum, the same steps as fallback::InternalCompensatedSummation( ) takes
+    // for each lane. Nothing may be fused into an FMA here, the results have to match the other instruction sets bit for bit.
+    static inline void CompensatedAdd(__m128& sum, __m128& compensation, __m128 x)
+    {
+      __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+      __m128 t = _mm_add_ps(sum, x);
+      __m128 sumIsLarger = _mm_cmpge_ps(_mm_and_ps(sum, absMask), _mm_and_ps(x, absMask));
+      __m128 larger = _mm_blendv_ps(x, sum, sumIsLarger);
+      __m128 smaller = _mm_blendv_ps(sum, x, sumIsLarger);
+      compensation = _mm_add_ps(compensation, _mm_add_ps(_mm_sub_ps(larger, t), smaller));
+      sum = t;
+    }
+
+    void InternalCompensatedSummation(size_t size,
+                                      float* lanes,
+                                      const float* src)
+    {
+      const size_t registers = COMPENSATED_LANES / 4;
+      __m128 sum[registers];
+      __m128 compensation[registers];
+      for ( size_t r = 0; r < registers; ++r ) {
+        sum[r] = _mm_setzero_ps();
+        compensation[r] = _mm_setzero_ps();
+      }
+
+      size_t i;
+      for ( i = 0; i + COMPENSATED_LANES <= size; i += COMPENSATED_LANES ) {
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], ((const __m128_u*)(src + i))[r]);
+        }
+      }
+
+      // The last partial group is padded with zeros, like the fallback kernel does
+      if ( i < size ) {
+        alignas(16) float tail[COMPENSATED_LANES] = { 0 };
+        std::copy(src + i, src + size, tail);
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], ((__m128_u*)tail)[r]);
+        }
+      }
+
+      for ( size_t r = 0; r < registers; ++r ) {
+        _mm_storeu_ps(lanes + r * 4, sum[r]);
+        _mm_storeu_ps(lanes + COMPENSATED_LANES + r * 4, compensation[r]);
+      }
+    }
+
+    void InternalCompensatedDotProduct(size_t size,
+                                       float* lanes,
+                                       const float* multiplier,
+                                       const float* multiplicand)
+    {
+      const size_t registers = COMPENSATED_LANES / 4;
+      __m128 sum[registers];
+      __m128 compensation[registers];
+      for ( size_t r = 0; r < registers; ++r ) {
+        sum[r] = _mm_setzero_ps();
+        compensation[r] = _mm_setzero_ps();
+      }
+
+      size_t i;
+      for ( i = 0; i + COMPENSATED_LANES <= size; i += COMPENSATED_LANES ) {
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], _mm_mul_ps(((const __m128_u*)(multiplier + i))[r], ((const __m128_u*)(multiplicand + i))[r]));
+        }
+      }
+
+      // The last partial group is padded with zeros, like the fallback kernel does
+      if ( i < size ) {
+        alignas(16) float tailMultiplier[COMPENSATED_LANES] = { 0 };
+        alignas(16) float tailMultiplicand[COMPENSATED_LANES] = { 0 };
+        std::copy(multiplier + i, multiplier + size, tailMultiplier);
+        std::copy(multiplicand + i, multiplicand + size, tailMultiplicand);
+        for ( size_t r = 0; r < registers; ++r ) {
+          CompensatedAdd(sum[r], compensation[r], _mm_mul_ps(((__m128_u*)tailMultiplier)[r], ((__m128_u*)tailMultiplicand)[r]));
+        }
+      }
+
+      for ( size_t r = 0; r < registers; ++r ) {
+        _mm_storeu_ps(lanes + r * 4, sum[r]);
+        _mm_storeu_ps(lanes + COMPENSATED_LANES + r * 4, compensation[r]);
+      }
+    }
+
+    // Log-step inclusive scan of the 4 lanes of v
+    static inline __m128 ScanRegister(__m128 v)
+    {
+      v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+      return _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+    }
+
+    void InternalPrefixSum(size_t size,
+                           float carry,
+                           float* dst,
+                           const float* src)
+    {
+      __m128_u* pDst = (__m128_u*)dst;
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 xmmCarry = _mm_set1_ps(carry);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm_add_ps(ScanRegister(pSrc[i]), xmmCarry);
+        xmmCarry = _mm_shuffle_ps(pDst[i], pDst[i], _MM_SHUFFLE(3, 3, 3, 3));
+      }
+
+      carry = _mm_cvtss_f32(xmmCarry);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        carry += src[i];
+        dst[i] = carry;
+      }
+    }
+
+    void InternalExclusivePrefixSum(size_t size,
+                                    float carry,
+                                    float* dst,
+                                    const float* src)
+    {
+      __m128_u* pDst = (__m128_u*)dst;
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 xmmCarry = _mm_set1_ps(carry);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        __m128 inclusive = _mm_add_ps(ScanRegister(pSrc[i]), xmmCarry);
+        pDst[i] = _mm_move_ss(_mm_shuffle_ps(inclusive, inclusive, _MM_SHUFFLE(2, 1, 0, 3)), xmmCarry);
+        xmmCarry = _mm_shuffle_ps(inclusive, inclusive, _MM_SHUFFLE(3, 3, 3, 3));
+      }
+
+      carry = _mm_cvtss_f32(xmmCarry);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        float value = src[i];
+        dst[i] = carry;
+        carry += value;
+      }
+    }
+
+    void InternalDotProduct(size_t size,
+                            float* product,
+                            const float* multiplier,
+                            const float* multiplicand)
+    {
+      const __m128_u* pMultiplier = (const __m128_u*)multiplier;
+      const __m128_u* pMultiplicand = (const __m128_u*)multiplicand;
+      __m128 accumulator0 = _mm_setzero_ps();
+      __m128 accumulator1 = _mm_setzero_ps();
+      __m128 accumulator2 = _mm_setzero_ps();
+      __m128 accumulator3 = _mm_setzero_ps();
+
+      // Four independent accumulators keep the adds out of each other's latency chain
+      size_t i;
+      for ( i = 0; i + 4 <= (size >> 2); i += 4 ) {
+        accumulator0 = _mm_add_ps(accumulator0, _mm_mul_ps(pMultiplier[i], pMultiplicand[i]));
+        accumulator1 = _mm_add_ps(accumulator1, _mm_mul_ps(pMultiplier[i + 1], pMultiplicand[i + 1]));
+        accumulator2 = _mm_add_ps(accumulator2, _mm_mul_ps(pMultiplier[i + 2], pMultiplicand[i + 2]));
+        accumulator3 = _mm_add_ps(accumulator3, _mm_mul_ps(pMultiplier[i + 3], pMultiplicand[i + 3]));
+      }
+      for ( ; i < (size >> 2); ++i ) {
+        accumulator0 = _mm_add_ps(accumulator0, _mm_mul_ps(pMultiplier[i], pMultiplicand[i]));
+      }
+      __m128 accumulator = _mm_add_ps(_mm_add_ps(accumulator0, accumulator1), _mm_add_ps(accumulator2, accumulator3));
+
+      *product = HorizontalSum(accumulator);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *product += (multiplier[i] * multiplicand[i]);
+      }
+    }
+
+    void InternalNegate(size_t size,
+                        float* dst,
+                        const float* src)
+    {
+      __m128_u* pDst = (__m128_u*)dst;
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 mask = _mm_set1_ps(-0.0f);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm_xor_ps(pSrc[i], mask);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = -src[i];
+      }
+    }
+
+    void InternalDistance(size_t size,
+                          float* distance,
+                          const float* v1,
+                          const float* v2)
+    {
+      const __m128_u* pV1 = (const __m128_u*)v1;
+      const __m128_u* pV2 = (const __m128_u*)v2;
+      __m128 scratch;
+      __m128 accumulator0 = _mm_setzero_ps();
+      __m128 accumulator1 = _mm_setzero_ps();
+      __m128 accumulator2 = _mm_setzero_ps();
+      __m128 accumulator3 = _mm_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i + 4 <= (size >> 2); i += 4 ) {
+        scratch = _mm_sub_ps(pV1[i], pV2[i]);
+        accumulator0 = _mm_add_ps(accumulator0, _mm_mul_ps(scratch, scratch));
+        scratch = _mm_sub_ps(pV1[i + 1], pV2[i + 1]);
+        accumulator1 = _mm_add_ps(accumulator1, _mm_mul_ps(scratch, scratch));
+        scratch = _mm_sub_ps(pV1[i + 2], pV2[i + 2]);
+        accumulator2 = _mm_add_ps(accumulator2, _mm_mul_ps(scratch, scratch));
+        scratch = _mm_sub_ps(pV1[i + 3], pV2[i + 3]);
+        accumulator3 = _mm_add_ps(accumulator3, _mm_mul_ps(scratch, scratch));
+      }
+      for ( ; i < (size >> 2); ++i ) {
+        scratch = _mm_sub_ps(pV1[i], pV2[i]);
+        accumulator0 = _mm_add_ps(accumulator0, _mm_mul_ps(scratch, scratch));
+      }
+      __m128 accumulator = _mm_add_ps(_mm_add_ps(accumulator0, accumulator1), _mm_add_ps(accumulator2, accumulator3));
+
+      *distance = HorizontalSum(accumulator);
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *distance += ((v1[i] - v2[i]) * (v1[i] - v2[i]));
+      }
+      *distance = sqrt(*distance);
+    }
+
+    void InternalReciprocate(size_t size,
+                             float* dst,
+                             const float* src)
+    {
+      __m128_u* pDst = (__m128_u*)dst;
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 one = _mm_set1_ps(1.0f);
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = _mm_div_ps(one, pSrc[i]);
+      }
+
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        dst[i] = 1.0f / src[i];
+      }
+    }
+
+    void InternalMinimum(size_t size,
+                         float* minimum,
+                         const float* src)
+    {
+      // minps returns its second operand if either one is NaN, so the accumulator skips NaN elements, which are tracked separately
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 accumulator = _mm_set1_ps(std::numeric_limits<float>::max());
+      __m128 nans = _mm_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        accumulator = _mm_min_ps(pSrc[i], accumulator);
+        nans = _mm_or_ps(nans, _mm_cmpunord_ps(pSrc[i], pSrc[i]));
+      }
+
+      float* tmp = (float*)&accumulator;
+      *minimum = _mm_movemask_ps(nans) ? std::numeric_limits<float>::quiet_NaN() : tmp[0];
+      for ( size_t lane = 1; lane < 4; ++lane ) {
+        *minimum = tmp[lane] < *minimum ? tmp[lane] : *minimum;
+      }
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *minimum = src[i] < *minimum || src[i] != src[i] ? src[i] : *minimum;
+      }
+    }
+
+    void InternalMaximum(size_t size,
+                         float* maximum,
+                         const float* src)
+    {
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 accumulator = _mm_set1_ps(std::numeric_limits<float>::lowest());
+      __m128 nans = _mm_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        accumulator = _mm_max_ps(pSrc[i], accumulator);
+        nans = _mm_or_ps(nans, _mm_cmpunord_ps(pSrc[i], pSrc[i]));
+      }
+
+      float* tmp = (float*)&accumulator;
+      *maximum = _mm_movemask_ps(nans) ? std::numeric_limits<float>::quiet_NaN() : tmp[0];
+      for ( size_t lane = 1; lane < 4; ++lane ) {
+        *maximum = tmp[lane] > *maximum ? tmp[lane] : *maximum;
+      }
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        *maximum = src[i] > *maximum || src[i] != src[i] ? src[i] : *maximum;
+      }
+    }
+
+    void InternalMinMaximum(size_t size,
+                            Extrema<float>* extrema,
+                            const float* src)
+    {
+      const __m128_u* pSrc = (const __m128_u*)src;
+      __m128 minimum = _mm_set1_ps(std::numeric_limits<float>::max());
+      __m128 maximum = _mm_set1_ps(std::numeric_limits<float>::lowest());
+      __m128 nans = _mm_setzero_ps();
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        minimum = _mm_min_ps(pSrc[i], minimum);
+        maximum = _mm_max_ps(pSrc[i], maximum);
+        nans = _mm_or_ps(nans, _mm_cmpunord_ps(pSrc[i], pSrc[i]));
+      }
+
+      float* minima = (float*)&minimum;
+      float* maxima = (float*)&maximum;
+      if ( _mm_movemask_ps(nans) ) {
+        extrema->minimum = extrema->maximum = std::numeric_limits<float>::quiet_NaN();
+      } else {
+        extrema->minimum = minima[0];
+        extrema->maximum = maxima[0];
+        for ( size_t lane = 1; lane < 4; ++lane ) {
+          extrema->minimum = minima[lane] < extrema->minimum ? minima[lane] : extrema->minimum;
+          extrema->maximum = maxima[lane] > extrema->maximum ? maxima[lane] : extrema->maximum;
+        }
+      }
+      i <<= 2;
+      for ( ; i < size; ++i ) {
+        extrema->minimum = src[i] < extrema->minimum || src[i] != src[i] ? src[i] : extrema->minimum;
+        extrema->maximum = src[i] > extrema->maximum || src[i] != src[i] ? src[i] : extrema->maximum;
+      }
+    }
+
+    // Index of the first smallest (Largest == false) or largest element of src, or of its first NaN. Every lane keeps its
+    // own extremum along with the number of the register it was loaded from, replacing them only on a strictly better value
+    // so that each lane holds its first occurrence. The lanes are then merged, the lower index winning ties.
+    template<bool Largest>
+    static size_t ArgExtremum(size_t size,
+                              const float* src)
+    {
+      const __m128_u* pSrc = (const __m128_u*)src;
+      size_t index = 0;
+      size_t i = 0;
+      if ( size >= 4 ) {
+        __m128 best = pSrc[0];
+        __m128 bestRegister = _mm_setzero_ps();
+        __m128 nans = _mm_cmpunord_ps(best, best);
+        for ( i = 1; i < (size >> 2); ++i ) {
+          __m128 better = Largest ? _mm_cmpgt_ps(pSrc[i], best) : _mm_cmplt_ps(pSrc[i], best);
+          best = _mm_blendv_ps(best, pSrc[i], better);
+          // The register numbers are kept as 32-bit integers, which covers up to 2^32 registers per call
+          bestRegister = _mm_blendv_ps(bestRegister, _mm_castsi128_ps(_mm_set1_epi32((int32_t)i)), better);
+          nans = _mm_or_ps(nans, _mm_cmpunord_ps(pSrc[i], pSrc[i]));
+        }
+
+        if ( _mm_movemask_ps(nans) ) {
+          // Rescan from the start, the scalar loop below stops at the first NaN
+          i = 0;
+        } else {
+          uint32_t* registers = (uint32_t*)&bestRegister;
+          index = (size_t)registers[0] << 2;
+          for ( size_t lane = 1; lane < 4; ++lane ) {
+            size_t candidate = ((size_t)registers[lane] << 2) + lane;
+            if ( (Largest ? src[candidate] > src[index] : src[candidate] < src[index]) ||
+                 (src[candidate] == src[index] && candidate < index) ) {
+              index = candidate;
+            }
+          }
+          i <<= 2;
+        }
+      }
+
+      for ( ; i < size; ++i ) {
+        if ( src[i] != src[i] ) {
+          return i;
+        }
+        index = (Largest ? src[i] > src[index] : src[i] < src[index]) ? i : index;
+      }
+      return index;
+    }
+
+    void InternalArgMinimum(size_t size,
+                            size_t* index,
+                            const float* src)
+    {
+      *index = ArgExtremum<false>(size, src);
+    }
+
+    void InternalArgMaximum(size_t size,
+                            size_t* index,
+                            const float* src)
+    {
+      *index = ArgExtremum<true>(size, src);
+    }
+
+    ///////////////////////// Transcendental functions ////////////////////////
+
+    // The transcendental functions follow the Cephes library: the argument is reduced to a small interval around 0 and a
+    // minimax polynomial is evaluated over it. They are the same as those of the AVX package on 4 lanes, so both round alike.
+
+    static inline __m128 Abs(__m128 x)
+    {
+      return _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+    }
+
+    static inline __m128 SignBit(__m128 x)
+    {
+      return _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x80000000)));
+    }
+
+    // Returns 2^n for the integral n in [-126, 127]: (n + 127) * 2^23 is below 2^31 and converts to the bit pattern of 2^n
+    static inline __m128 PowerOf2(__m128 n)
+    {
+      __m128 bits = _mm_mul_ps(_mm_add_ps(n, _mm_set1_ps(127.0f)), _mm_set1_ps(8388608.0f));
+      return _mm_castsi128_ps(_mm_cvtps_epi32(bits));
+    }
+
+    // Returns p * 2^n for the integral n in [-151, 129]. The scaling is done in two halves so that neither factor leaves the normal
+    // range, the result then overflows to infinity or underflows gradually to the denormals in the final multiplication.
+    static inline __m128 ScaleByPowerOf2(__m128 p, __m128 n)
+    {
+      __m128 half = _mm_floor_ps(_mm_mul_ps(n, _mm_set1_ps(0.5f)));
+      return _mm_mul_ps(_mm_mul_ps(p, PowerOf2(half)), PowerOf2(_mm_sub_ps(n, half)));
+    }
+
+    // e^r for r in [-ln(2)/2, ln(2)/2]
+    static inline __m128 ExpPolynomial(__m128 r)
+    {
+      __m128 p = _mm_set1_ps(1.9875691500e-4f);
+      p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.3981999507e-3f));
+      p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(8.3334519073e-3f));
+      p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(4.1665795894e-2f));
+      p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.6666665459e-1f));
+      p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.0000001201e-1f));
+      p = _mm_mul_ps(p, _mm_mul_ps(r, r));
+      return _mm_add_ps(_mm_add_ps(p, r), _mm_set1_ps(1.0f));
+    }
+
+    static inline __m128 Exp(__m128 x)
+    {
+      // e^x overflows above 88.73 and underflows below -103.98, the clamp keeps n in range. NaN is the second operand
+      // of min/max so it is passed through.
+      x = _mm_min_ps(_mm_set1_ps(89.0f), x);
+      x = _mm_max_ps(_mm_set1_ps(-104.0f), x);
+
+      // x = n * ln(2) + r, ln(2) is split in two so that n * 0.693359375 is exact
+      __m128 n = _mm_round_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      __m128 r = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(0.693359375f)));
+      r = _mm_sub_ps(r, _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+      return ScaleByPowerOf2(ExpPolynomial(r), n);
+    }
+
+    static inline __m128 Exp2(__m128 x)
+    {
+      x = _mm_min_ps(_mm_set1_ps(129.0f), x);
+      x = _mm_max_ps(_mm_set1_ps(-151.0f), x);
+
+      __m128 n = _mm_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      __m128 r = _mm_mul_ps(_mm_sub_ps(x, n), _mm_set1_ps(0.693147180559945309f));
+      return ScaleByPowerOf2(ExpPolynomial(r), n);
+    }
+
+    // Splits x > 0 into m * 2^e with m in [sqrt(1/2), sqrt(2)), returns m - 1 and the exponent e
+    static inline __m128 LogReduce(__m128 x, __m128& e)
+    {
+      // Denormals are scaled by 2^24 into the normal range first
+      __m128 denormal = _mm_cmplt_ps(x, _mm_set1_ps(std::numeric_limits<float>::min()));
+      x = _mm_blendv_ps(x, _mm_mul_ps(x, _mm_set1_ps(16777216.0f)), denormal);
+
+      // The exponent field read as an integer is exactly representable as a float, it is converted and scaled down by 2^23
+      __m128 field = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7f800000)));
+      e = _mm_mul_ps(_mm_cvtepi32_ps(_mm_castps_si128(field)), _mm_set1_ps(1.0f / 8388608.0f));
+      e = _mm_sub_ps(e, _mm_set1_ps(126.0f));
+      e = _mm_sub_ps(e, _mm_and_ps(denormal, _mm_set1_ps(24.0f)));
+
+      // m in [0.5, 1), doubled when below sqrt(1/2)
+      __m128 m = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x007fffff)));
+      m = _mm_or_ps(m, _mm_set1_ps(0.5f));
+      __m128 small = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+      e = _mm_sub_ps(e, _mm_and_ps(small, _mm_set1_ps(1.0f)));
+      m = _mm_add_ps(m, _mm_and_ps(small, m));
+      return _mm_sub_ps(m, _mm_set1_ps(1.0f));
+    }
+
+    // log(1 + f) - f for f in [sqrt(1/2) - 1, sqrt(2) - 1)
+    static inline __m128 LogPolynomial(__m128 f)
+    {
+      __m128 z = _mm_mul_ps(f, f);
+      __m128 p = _mm_set1_ps(7.0376836292e-2f);
+      p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(-1.1514610310e-1f));
+      p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.1676998740e-1f));
+      p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(-1.2420140846e-1f));
+      p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.4249322787e-1f));
+      p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(-1.6668057665e-1f));
+      p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(2.0000714765e-1f));
+      p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(-2.4999993993e-1f));
+      p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(3.3333331174e-1f));
+      p = _mm_mul_ps(_mm_mul_ps(p, f), z);
+      return _mm_sub_ps(p, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    }
+
+    // log(0) is -infinity, log(+infinity) and log(NaN) are themselves and the logarithm of a negative number is NaN
+    static inline __m128 LogSpecialCases(__m128 result, __m128 x)
+    {
+      __m128 passThrough = _mm_or_ps(_mm_cmpunord_ps(x, x),
+                                     _mm_cmpeq_ps(x, _mm_set1_ps(std::numeric_limits<float>::infinity())));
+      result = _mm_blendv_ps(result, x, passThrough);
+      result = _mm_blendv_ps(result, _mm_set1_ps(-std::numeric_limits<float>::infinity()),
+                             _mm_cmpeq_ps(x, _mm_setzero_ps()));
+      return _mm_blendv_ps(result, _mm_set1_ps(std::numeric_limits<float>::quiet_NaN()),
+                           _mm_cmplt_ps(x, _mm_setzero_ps()));
+    }
+
+    static inline __m128 Log(__m128 x)
+    {
+      __m128 e;
+      __m128 f = LogReduce(x, e);
+      __m128 y = _mm_add_ps(LogPolynomial(f), _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+      __m128 result = _mm_add_ps(_mm_add_ps(f, y), _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+      return LogSpecialCases(result, x);
+    }
+
+    static inline __m128 Log2(__m128 x)
+    {
+      __m128 e;
+      __m128 f = LogReduce(x, e);
+      __m128 y = LogPolynomial(f);
+
+      // log2(x) = e + (f + y) * log2(e), log2(e) - 1 is applied separately to keep its rounding error off the leading terms
+      const __m128 log2eMinus1 = _mm_set1_ps(0.44269504088896340736f);
+      __m128 result = _mm_add_ps(_mm_mul_ps(y, log2eMinus1), _mm_mul_ps(f, log2eMinus1));
+      result = _mm_add_ps(_mm_add_ps(_mm_add_ps(result, y), f), e);
+      return LogSpecialCases(result, x);
+    }
+
+    // Reduces |x| to z in [-pi/4, pi/4] and the even octant q in {0, 2, 4, 6} such that |x| = j * pi/4 + z and q = j mod 8.
+    // pi/4 is split in three parts, j * pi/4 is exact up to |x| = 8192.
+    static inline __m128 TrigReduce(__m128 ax, __m128& q)
+    {
+      __m128 j = _mm_floor_ps(_mm_mul_ps(ax, _mm_set1_ps(1.27323954473516f)));
+      j = _mm_floor_ps(_mm_mul_ps(_mm_add_ps(j, _mm_set1_ps(1.0f)), _mm_set1_ps(0.5f)));
+      j = _mm_add_ps(j, j);
+      q = _mm_sub_ps(j, _mm_mul_ps(_mm_floor_ps(_mm_mul_ps(j, _mm_set1_ps(0.125f))), _mm_set1_ps(8.0f)));
+
+      __m128 z = _mm_sub_ps(ax, _mm_mul_ps(j, _mm_set1_ps(0.78515625f)));
+      z = _mm_sub_ps(z, _mm_mul_ps(j, _mm_set1_ps(2.4187564849853515625e-4f)));
+      return _mm_sub_ps(z, _mm_mul_ps(j, _mm_set1_ps(3.77489497744594108e-8f)));
+    }
+
+    // sin(z) for z in [-pi/4, pi/4]
+    static inline __m128 SinPolynomial(__m128 z)
+    {
+      __m128 zz = _mm_mul_ps(z, z);
+      __m128 p = _mm_set1_ps(-1.9515295891e-4f);
+      p = _mm_add_ps(_mm_mul_ps(p, zz), _mm_set1_ps(8.3321608736e-3f));
+      p = _mm_add_ps(_mm_mul_ps(p, zz), _mm_set1_ps(-1.6666654611e-1f));
+      return _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, zz), z), z);
+    }
+
+    // cos(z) for z in [-pi/4, pi/4]
+    static inline __m128 CosPolynomial(__m128 z)
+    {
+      __m128 zz = _mm_mul_ps(z, z);
+      __m128 p = _mm_set1_ps(2.443315711809948e-5f);
+      p = _mm_add_ps(_mm_mul_ps(p, zz), _mm_set1_ps(-1.388731625493765e-3f));
+      p = _mm_add_ps(_mm_mul_ps(p, zz), _mm_set1_ps(4.166664568298827e-2f));
+      p = _mm_mul_ps(_mm_mul_ps(p, zz), zz);
+      return _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(zz, _mm_set1_ps(0.5f))), p);
+    }
+
+    static inline __m128 Sin(__m128 x)
+    {
+      __m128 q;
+      __m128 z = TrigReduce(Abs(x), q);
+
+      // sin(j * pi/4 + z) is sin(z), cos(z), -sin(z), -cos(z) for q = 0, 2, 4, 6, and sin is odd
+      __m128 useCos = _mm_or_ps(_mm_cmpeq_ps(q, _mm_set1_ps(2.0f)), _mm_cmpeq_ps(q, _mm_set1_ps(6.0f)));
+      __m128 negate = _mm_cmpge_ps(q, _mm_set1_ps(4.0f));
+      __m128 result = _mm_blendv_ps(SinPolynomial(z), CosPolynomial(z), useCos);
+      __m128 sign = _mm_xor_ps(SignBit(x), SignBit(negate));
+      return _mm_xor_ps(result, sign);
+    }
+
+    static inline __m128 Cos(__m128 x)
+    {
+      __m128 q;
+      __m128 z = TrigReduce(Abs(x), q);
+
+      // cos(j * pi/4 + z) is cos(z), -sin(z), -cos(z), sin(z) for q = 0, 2, 4, 6, and cos is even
+      __m128 useSin = _mm_or_ps(_mm_cmpeq_ps(q, _mm_set1_ps(2.0f)), _mm_cmpeq_ps(q, _mm_set1_ps(6.0f)));
+      __m128 negate = _mm_or_ps(_mm_cmpeq_ps(q, _mm_set1_ps(2.0f)), _mm_cmpeq_ps(q, _mm_set1_ps(4.0f)));
+      __m128 result = _mm_blendv_ps(CosPolynomial(z), SinPolynomial(z), useSin);
+      return _mm_xor_ps(result, SignBit(negate));
+    }
+
+    static inline __m128 Tanh(__m128 x)
+    {
+      __m128 ax = Abs(x);
+
+      // 1 - 2 / (e^(2|x|) + 1) cancels badly near 0, an odd polynomial is used below 0.625 instead
+      __m128 large = _mm_add_ps(Exp(_mm_add_ps(ax, ax)), _mm_set1_ps(1.0f));
+      large = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_div_ps(_mm_set1_ps(2.0f), large));
+
+      __m128 z = _mm_mul_ps(x, x);
+      __m128 small = _mm_set1_ps(-5.70498872745e-3f);
+      small = _mm_add_ps(_mm_mul_ps(small, z), _mm_set1_ps(2.06390887954e-2f));
+      small = _mm_add_ps(_mm_mul_ps(small, z), _mm_set1_ps(-5.37397155531e-2f));
+      small = _mm_add_ps(_mm_mul_ps(small, z), _mm_set1_ps(1.33314422036e-1f));
+      small = _mm_add_ps(_mm_mul_ps(small, z), _mm_set1_ps(-3.33332819422e-1f));
+      small = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(small, z), ax), ax);
+
+      __m128 result = _mm_blendv_ps(large, small, _mm_cmplt_ps(ax, _mm_set1_ps(0.625f)));
+      return _mm_or_ps(result, SignBit(x));
+    }
+
+    static inline __m128 Sigmoid(__m128 x)
+    {
+      // 1 / (1 + e^-x) for positive x and e^x / (1 + e^x) for negative x, so that e^-|x| never overflows and the tiny results
+      // of large negative x keep their precision
+      __m128 t = Exp(_mm_or_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x80000000))));
+      __m128 one = _mm_set1_ps(1.0f);
+      return _mm_div_ps(_mm_blendv_ps(one, t, _mm_cmplt_ps(x, _mm_setzero_ps())), _mm_add_ps(one, t));
+    }
+
+    static inline __m128 Pow(__m128 x, __m128 y)
+    {
+      __m128 result = Exp2(_mm_mul_ps(y, Log2(Abs(x))));
+
+      // A finite negative base has a real power only for integral exponents, it is negative for the odd ones. Exponents beyond 2^24 are
+      // all even.
+      __m128 integral = _mm_cmpeq_ps(_mm_floor_ps(y), y);
+      __m128 halfY = _mm_mul_ps(y, _mm_set1_ps(0.5f));
+      __m128 odd = _mm_andnot_ps(_mm_cmpeq_ps(_mm_floor_ps(halfY), halfY), integral);
+      result = _mm_xor_ps(result, _mm_and_ps(SignBit(x), odd));
+      __m128 negativeFinite = _mm_and_ps(_mm_cmplt_ps(x, _mm_setzero_ps()),
+                                         _mm_cmpgt_ps(x, _mm_set1_ps(-std::numeric_limits<float>::infinity())));
+      result = _mm_blendv_ps(result, _mm_set1_ps(std::numeric_limits<float>::quiet_NaN()), _mm_andnot_ps(integral, negativeFinite));
+
+      // As for std::pow, x^0 and 1^y are 1 even when the other operand is NaN, and so is (-1)^(+/-infinity)
+      __m128 one = _mm_set1_ps(1.0f);
+      __m128 isOne = _mm_or_ps(_mm_cmpeq_ps(y, _mm_setzero_ps()), _mm_cmpeq_ps(x, one));
+      isOne = _mm_or_ps(isOne, _mm_and_ps(_mm_cmpeq_ps(x, _mm_set1_ps(-1.0f)),
+                                             _mm_cmpeq_ps(Abs(y), _mm_set1_ps(std::numeric_limits<float>::infinity()))));
+      return _mm_blendv_ps(result, one, isOne);
+    }
+
+    // Applies the register function to every element, the tail is padded into a full register so that it is computed exactly like
+    // the rest of the array
+    template<__m128 (*Function)(__m128)>
+    static void MapRegister(size_t size,
+                            float* dst,
+                            const float* src)
+    {
+      __m128_u* pDst = (__m128_u*)dst;
+      const __m128_u* pSrc = (const __m128_u*)src;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = Function(pSrc[i]);
+      }
+
+      i <<= 2;
+      if ( i < size ) {
+        alignas(16) float buffer[4] = { 0 };
+        std::copy(src + i, src + size, buffer);
+        *(__m128_u*)buffer = Function(*(__m128_u*)buffer);
+        std::copy(buffer, buffer + (size - i), dst + i);
+      }
+    }
+
+    void InternalExp(size_t size,
+                     float* dst,
+                     const float* src)
+    {
+      MapRegister<Exp>(size, dst, src);
+    }
+
+    void InternalLog(size_t size,
+                     float* dst,
+                     const float* src)
+    {
+      MapRegister<Log>(size, dst, src);
+    }
+
+    void InternalLog2(size_t size,
+                      float* dst,
+                      const float* src)
+    {
+      MapRegister<Log2>(size, dst, src);
+    }
+
+    void InternalSin(size_t size,
+                     float* dst,
+                     const float* src)
+    {
+      MapRegister<Sin>(size, dst, src);
+    }
+
+    void InternalCos(size_t size,
+                     float* dst,
+                     const float* src)
+    {
+      MapRegister<Cos>(size, dst, src);
+    }
+
+    void InternalTanh(size_t size,
+                      float* dst,
+                      const float* src)
+    {
+      MapRegister<Tanh>(size, dst, src);
+    }
+
+    void InternalSigmoid(size_t size,
+                         float* dst,
+                         const float* src)
+    {
+      MapRegister<Sigmoid>(size, dst, src);
+    }
+
+    void InternalPow(size_t size,
+                     float* dst,
+                     const float* base,
+                     const float* exponent)
+    {
+      __m128_u* pDst = (__m128_u*)dst;
+      const __m128_u* pBase = (const __m128_u*)base;
+      const __m128_u* pExponent = (const __m128_u*)exponent;
+
+      size_t i;
+      for ( i = 0; i < (size >> 2); ++i ) {
+        pDst[i] = Pow(pBase[i], pExponent[i]);
+      }
+
+      i <<= 2;
+      if ( i < size ) {
+        alignas(16) float baseBuffer[4] = { 0 };
+        alignas(16) float exponentBuffer[4] = { 0 };
+        std::copy(base + i, base + size, baseBuffer);
+        std::copy(exponent + i, exponent + size, exponentBuffer);
+        *(__m128_u*)baseBuffer = Pow(*(__m128_u*)baseBuffer, *(__m128_u*)exponentBuffer);
+        std::copy(baseBuffer, baseBuffer + (size - i), dst + i);
+      }
+    }
+
+    ////////////////////// Reciprocals and square roots ///////////////////////
+
+    // rcpps and rsqrtps return 0 or infinity for inputs whose result leaves the normal range, denormal inputs included. The
+    // Newton-Raphson step would turn those into NaN or flip their sign, so they keep the approximation, which is already the limit.
+    static inline __m128 KeepLimits(__m128 refined, __m128 approximation)
+    {
+      __m128 limit = _mm_or_ps(_mm_cmpeq_ps(approximation, _mm_setzero_ps()),
+                               _mm_cmpeq_ps(Abs(approximation), _mm_set1_ps(std::numeric_limits<float>::infinity())));
+      return _mm_blendv_ps(refined, approximation, limit);
+    }
+
+    static inline __m128 ApproximateReciprocal(__m128 x)
+    {
+      return _mm_rcp_ps(x);
+    }
+
+    // One Newton-Raphson step r * (2 - x * r) doubles the 12 correct bits of rcpps
+    static inline __m128 RefinedReciprocal(__m128 x)
+    {
+      __m128 r = _mm_rcp_ps(x);
+      return KeepLimits(_mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(2.0f), _mm_mul_ps(x, r))), r);
+    }
+
+    static inline __m128 Rsqrt(__m128 x)
+    {
+      return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(x));
+    }
+
+    static inline __m128 ApproximateRsqrt(__m128 x)
+    {
+      return _mm_rsqrt_ps(x);
+    }
+
+    // One Newton-Raphson step r * (3 - x * r^2) / 2 doubles the 12 correct bits of rsqrtps
+    static inline __m128 RefinedRsqrt(__m128 x)
+    {
+      __m128 r = _mm_rsqrt_ps(x);
+      __m128 refined = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_mul_ps(x, r), r)));
+      return KeepLimits(refined, r);
+    }
+
+    void InternalApproximateReciprocate(size_t size,
+                                        float* dst,
+                                        const float* src)
+    {
+      MapRegister<ApproximateReciprocal>(size, dst, src);
+    }
+
+    void InternalRefinedReciprocate(size_t size,
+                                    float* dst,
+                                    const float* src)
+    {
+      MapRegister<RefinedReciprocal>(size, dst, src);
+    }
+
+    void InternalRsqrt(size_t size,
+                       float* dst,
+                       const float* src)
+    {
+      MapRegister<Rsqrt>(size, dst, src);
+    }
+
+    void InternalApproximateRsqrt(size_t size,
+                                  float* dst,
+                                  const float* src)
+    {
+      MapRegister<ApproximateRsqrt>(size, dst, src);
+    }
+
+    void InternalRefinedRsqrt(size_t size,
+                              float* dst,
+                              const float* src)
+    {
+      MapRegister<RefinedRsqrt>(size, dst, src);
+    }
+
+    ////////////////////////////// Streaming stores //////////////////////////
+
+    void InternalStreamingCopy(size_t bytes,
+                               void* dst,
+                               const void* src)
+    {
+      // Non-temporal stores need an aligned destination, the bytes up to the first 16 byte boundary are copied normally
+      char* out = (char*)dst;
+      const char* in = (const char*)src;
+      size_t head = std::min(bytes, (size_t)(-(uintptr_t)out & 15));
+      memcpy(out, in, head);
+      size_t i = head;
+      for ( ; i + 64 <= bytes; i += 64 ) {
+        __m128i a = _mm_loadu_si128((const __m128i_u*)(in + i));
+        __m128i b = _mm_loadu_si128((const __m128i_u*)(in + i + 16));
+        __m128i c = _mm_loadu_si128((const __m128i_u*)(in + i + 32));
+        __m128i d = _mm_loadu_si128((const __m128i_u*)(in + i + 48));
+        _mm_stream_si128((__m128i*)(out + i), a);
+        _mm_stream_si128((__m128i*)(out + i + 16), b);
+        _mm_stream_si128((__m128i*)(out + i + 32), c);
+        _mm_stream_si128((__m128i*)(out + i + 48), d);
+      }
+      for ( ; i + 16 <= bytes; i += 16 ) {
+        _mm_stream_si128((__m128i*)(out + i), _mm_loadu_si128((const __m128i_u*)(in + i)));
+      }
+      memcpy(out + i, in + i, bytes - i);
+    }
+  }
+}
@@ -0,0 +1,156 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+#include "Array.hpp"
+
+// Not a multiple of 8 so every loop tail is exercised
+#define TEST_VECTOR_LENGTH 1037
+
+BOOST_AUTO_TEST_SUITE(ArrayFileTestSuite)
+
+using namespace khyber;
+
+static std::string TestFilePath(const char* name)
+{
+  return std::string(P_tmpdir) + "/khyber_" + name + "_" + std::to_string(getpid()) + ".kha";
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayFileRoundTrip)
+{
+  std::string path = TestFilePath("round_trip");
+  SinglePrecisionArray saved(TEST_VECTOR_LENGTH);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    saved[i] = ((float)i - 518) / 32.0f;
+  }
+  saved.Save(path);
+
+  {
+    MappedSinglePrecisionArray mapped = SinglePrecisionArray::MapFile(path);
+    BOOST_CHECK_EQUAL(mapped.size(), TEST_VECTOR_LENGTH);
+    BOOST_CHECK_EQUAL((size_t)mapped.data() % ARRAY_FILE_ALIGNMENT, 0);
+    for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+      BOOST_CHECK_EQUAL(mapped[i], saved[i]);
+    }
+
+    // The mapped array is an operand and an expression terminal like any other
+    BOOST_CHECK_EQUAL(mapped.DotProduct(saved), saved.DotProduct(saved));
+    SinglePrecisionArray sum = saved.Add(mapped);
+    SinglePrecisionArray scaled = mapped * 2.0f;
+    for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+      BOOST_CHECK_EQUAL(sum[i], scaled[i]);
+    }
+
+    // Moving transfers the mapping
+    MappedSinglePrecisionArray moved(std::move(mapped));
+    BOOST_CHECK(mapped.empty());
+    BOOST_CHECK_EQUAL(moved[TEST_VECTOR_LENGTH - 1], saved[TEST_VECTOR_LENGTH - 1]);
+  }
+
+  // Copy-on-write arrays are modified in memory only
+  {
+    Array<float>::MapFileCopyOnWrite(path).TransformScalarMul(3.0f);
+    MappedArray<float> mapped = Array<float>::MapFileCopyOnWrite(path);
+    mapped.Negate(mapped);
+    BOOST_CHECK_EQUAL(mapped[10], -saved[10]);
+  }
+  MappedSinglePrecisionArray reloaded = SinglePrecisionArray::MapFile(path);
+  BOOST_CHECK_EQUAL(reloaded[10], saved[10]);
+
+  // Saving a view writes only its elements
+  reloaded.Slice(5, 7).Save(path);
+  MappedSinglePrecisionArray slice = SinglePrecisionArray::MapFile(path);
+  BOOST_CHECK_EQUAL(slice.size(), 7);
+  BOOST_CHECK_EQUAL(slice[0], saved[5]);
+
+  UInt32Array integers(TEST_VECTOR_LENGTH);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    integers[i] = i * 7;
+  }
+  integers.Save(path);
+  BOOST_CHECK_EQUAL(UInt32Array::MapFile(path).WideSummation(), integers.WideSummation());
+
+  UInt32Array(0).Save(path);
+  BOOST_CHECK(UInt32Array::MapFile(path).empty());
+  remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayFileConcurrentSave)
+{
+  // Threads saving different arrays to one path each write their own temporary file, the survivor is one of them whole
+  std::string path = TestFilePath("concurrent");
+  std::vector<std::thread> savers;
+  for ( size_t t = 0; t < 4; ++t ) {
+    savers.emplace_back([&path, t] {
+      SinglePrecisionArray saved(TEST_VECTOR_LENGTH * (t + 1));
+      for ( size_t i = 0; i < saved.size(); ++i ) {
+        saved[i] = (float)t;
+      }
+      for ( size_t round = 0; round < 20; ++round ) {
+        saved.Save(path);
+      }
+    });
+  }
+  for ( auto& saver : savers ) {
+    saver.join();
+  }
+
+  MappedSinglePrecisionArray mapped = SinglePrecisionArray::MapFile(path);
+  size_t t = mapped.size() / TEST_VECTOR_LENGTH - 1;
+  BOOST_REQUIRE(t < 4);
+  BOOST_CHECK_EQUAL(mapped.size(), TEST_VECTOR_LENGTH * (t + 1));
+  BOOST_CHECK_EQUAL(mapped.Summation(), (float)(t * mapped.size()));
+  remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayFileErrors)
+{
+  std::string path = TestFilePath("errors");
+  BOOST_CHECK_THROW(SinglePrecisionArray::MapFile(path), std::system_error);
+
+  SinglePrecisionArray saved(TEST_VECTOR_LENGTH);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    saved[i] = i;
+  }
+  saved.Save(path);
+  BOOST_CHECK_THROW(DoublePrecisionArray::MapFile(path), std::runtime_error);
+  BOOST_CHECK_THROW(Int32Array::MapFile(path), std::runtime_error);
+
+  // Change the last element: only a verified mapping notices
+  {
+    std::fstream file(path.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(sizeof(ArrayFileHeader) + (TEST_VECTOR_LENGTH - 1) * sizeof(float));
+    float corrupt = saved[TEST_VECTOR_LENGTH - 1] + 1.0f;
+    file.write((const char*)&corrupt, sizeof(corrupt));
+  }
+  BOOST_CHECK_THROW(SinglePrecisionArray::MapFile(path), std::runtime_error);
+  BOOST_CHECK_EQUAL(SinglePrecisionArray::MapFile(path, false).size(), TEST_VECTOR_LENGTH);
+
+  // A truncated file is rejected with or without the checksum
+  BOOST_CHECK_EQUAL(truncate(path.c_str(), sizeof(ArrayFileHeader) + 100), 0);
+  BOOST_CHECK_THROW(SinglePrecisionArray::MapFile(path, false), std::runtime_error);
+  BOOST_CHECK_EQUAL(truncate(path.c_str(), 10), 0);
+  BOOST_CHECK_THROW(SinglePrecisionArray::MapFile(path, false), std::runtime_error);
+  remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
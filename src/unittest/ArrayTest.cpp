@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 #include "Array.hpp"
 
@@ -83,6 +86,407 @@ BOOST_AUTO_TEST_CASE(TestArrayAdd)
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestArrayHoldsOnlyBuffer)
+{
+  BOOST_CHECK_EQUAL(sizeof(khyber::SinglePrecisionArray), sizeof(khyber::SimdContainer<float>::vector_type));
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayUninitialized)
+{
+  khyber::SinglePrecisionArray a = khyber::SinglePrecisionArray::Uninitialized(1000);
+  BOOST_CHECK_EQUAL(a.size(), 1000);
+  for ( size_t i = 0; i < a.size(); ++i ) {
+    a[i] = i;
+  }
+
+  // Growing keeps the existing elements, zeroing still zeroes the new ones
+  a.resize_uninitialized(3000);
+  BOOST_CHECK_EQUAL(a.size(), 3000);
+  BOOST_CHECK_EQUAL(a[999], 999.0f);
+  a.resize(1000);
+  a.resize(2000);
+  BOOST_CHECK_EQUAL(a[1500], 0.0f);
+
+  // Results created uninitialized are written in full, streamed or not
+  khyber::SinglePrecisionArray sum = a.Add(a);
+  khyber::SinglePrecisionArray scaled = a * 2.0f;
+  for ( size_t i = 0; i < a.size(); ++i ) {
+    BOOST_CHECK_EQUAL(sum[i], 2.0f * a[i]);
+    BOOST_CHECK_EQUAL(scaled[i], sum[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayDowngradedBindings)
+{
+  // Run the SSE and then the serial kernels on this processor
+  const uint64_t masks[] = { BM_AVX | BM_AVX2 | BM_FMA,
+                             BM_AVX | BM_AVX2 | BM_FMA | BM_SSE4_1 };
+  for ( auto mask : masks ) {
+    khyber::ProcessorCaps downgradedCaps = khyber::ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    khyber::SinglePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+
+    khyber::SinglePrecisionArray arr0(13);
+    khyber::SinglePrecisionArray arr1(13);
+    for ( size_t i = 0; i < 13; ++i ) {
+      arr0[i] = i + 1;
+      arr1[i] = 2 * i;
+    }
+    khyber::SinglePrecisionArray quotient = arr1.ScalarDiv(2);
+    khyber::SinglePrecisionArray sqrt = arr1.Sqrt();
+    for ( size_t i = 0; i < 13; ++i ) {
+      BOOST_CHECK_EQUAL(quotient[i], i);
+      BOOST_CHECK_CLOSE(sqrt[i], std::sqrt(2.0f * i), 0.001);
+    }
+    BOOST_CHECK_CLOSE(arr0.Distance(arr0.Add(arr0)), std::sqrt(819.0f), 0.001);
+  }
+
+  khyber::SinglePrecisionArray::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayStreamingStores)
+{
+  // Stream every output, 1 byte and more, and compare with the cached stores bit for bit
+  const uint64_t masks[] = { 0,
+                             BM_AVX | BM_AVX2 | BM_FMA,
+                             BM_AVX | BM_AVX2 | BM_FMA | BM_SSE4_1 };
+  const size_t length = 3 * STREAMING_TILE_BYTES / sizeof(float) + 13;
+  khyber::SinglePrecisionArray lhs(length);
+  khyber::SinglePrecisionArray rhs(length);
+  for ( size_t i = 0; i < length; ++i ) {
+    lhs[i] = (i % 97) / 8.0f;
+    rhs[i] = 1.0f + (i % 13);
+  }
+  for ( auto mask : masks ) {
+    khyber::ProcessorCaps downgradedCaps = khyber::ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    khyber::SinglePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+
+    std::vector<khyber::SinglePrecisionArray> results[2];
+    for ( auto& result : results ) {
+      khyber::SetStreamingThreshold(&result == &results[0] ? SIZE_MAX : 1);
+      result.push_back(lhs.Add(rhs));
+      result.push_back(lhs.ScalarMul(3.0f));
+      result.push_back(rhs.Sqrt());
+      result.push_back(sqrt(lhs * rhs + 1.0f));
+      result.push_back(lhs);
+      result.back().Div(lhs, rhs);
+    }
+    for ( size_t f = 0; f < results[0].size(); ++f ) {
+      for ( size_t i = 0; i < length; ++i ) {
+        BOOST_CHECK_EQUAL(results[0][f][i], results[1][f][i]);
+      }
+    }
+  }
+
+  khyber::SetStreamingThreshold(0);
+  BOOST_CHECK_GT(khyber::GetStreamingThreshold(), 0);
+  khyber::SinglePrecisionArray::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+}
+
+BOOST_AUTO_TEST_CASE(TestDoublePrecisionArray)
+{
+  khyber::DoublePrecisionArray arr0(13);
+  khyber::DoublePrecisionArray arr1(13);
+  BOOST_CHECK_EQUAL((uint64_t)arr0.data() % 32, 0);
+  for ( size_t i = 0; i < 13; ++i ) {
+    arr0[i] = i + 1;
+    arr1[i] = 0.1 * i;
+  }
+
+  khyber::DoublePrecisionArray sum = arr0.Add(arr1);
+  khyber::DoublePrecisionArray root = arr0.Sqrt();
+  khyber::DoublePrecisionArray fused = arr0 * 2.0 - arr1;
+  double refProduct = 0;
+  for ( size_t i = 0; i < 13; ++i ) {
+    BOOST_CHECK_EQUAL(sum[i], arr0[i] + arr1[i]);
+    BOOST_CHECK_EQUAL(root[i], std::sqrt(arr0[i]));
+    BOOST_CHECK_EQUAL(fused[i], arr0[i] * 2.0 - arr1[i]);
+    refProduct += arr0[i] * arr1[i];
+  }
+  BOOST_CHECK_CLOSE(arr0.DotProduct(arr1), refProduct, 1e-10);
+  BOOST_CHECK_CLOSE(arr0.Summation(), 91.0, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(TestIntegerArray)
+{
+  // The serial kernels must agree with the AVX2 ones, including the shifts by more than 31 bits
+  for ( auto mask : { (uint64_t)0, (uint64_t)BM_AVX2 } ) {
+    khyber::ProcessorCaps downgradedCaps = khyber::ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    khyber::UInt32Array::OverrideProcessorCaps(downgradedCaps);
+    khyber::Int32Array::OverrideProcessorCaps(downgradedCaps);
+
+    khyber::UInt32Array arr0(13);
+    khyber::UInt32Array arr1(13);
+    khyber::Int32Array arr2(13);
+    for ( size_t i = 0; i < 13; ++i ) {
+      arr0[i] = 0xFFFFFFF0u + i;
+      arr1[i] = 0x0F0F0F0Fu * i;
+      arr2[i] = 6 - (int32_t)i;
+    }
+
+    khyber::UInt32Array bitwise = arr0.Xor(arr1).Or(arr1);
+    khyber::UInt32Array maximum = arr0.Max(arr1);
+    khyber::UInt32Array cleared = arr0.ShiftLeft(32);
+    khyber::UInt32Array fused = arr0 * 3u + arr1;
+    khyber::Int32Array shifted = arr2.ShiftRight(40);
+    for ( size_t i = 0; i < 13; ++i ) {
+      BOOST_CHECK_EQUAL(bitwise[i], arr0[i] | arr1[i]);
+      BOOST_CHECK_EQUAL(maximum[i], std::max(arr0[i], arr1[i]));
+      BOOST_CHECK_EQUAL(cleared[i], 0);
+      BOOST_CHECK_EQUAL(fused[i], arr0[i] * 3u + arr1[i]);
+      BOOST_CHECK_EQUAL(shifted[i], arr2[i] < 0 ? -1 : 0);
+    }
+    BOOST_CHECK_EQUAL(arr0.WideSummation(), 13ull * 0xFFFFFFF0u + 78);
+    BOOST_CHECK_EQUAL(arr0.Summation(), (uint32_t)(13ull * 0xFFFFFFF0u + 78));
+    BOOST_CHECK_EQUAL(arr2.WideSummation(), 0);
+    BOOST_CHECK_EQUAL(arr2.Min(), -6);
+    BOOST_CHECK_EQUAL(arr2.Max(), 6);
+  }
+
+  khyber::UInt32Array::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+  khyber::Int32Array::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayPrefixSum)
+{
+  khyber::SinglePrecisionArray arr0(13);
+  khyber::Int32Array arr1(13);
+  for ( size_t i = 0; i < 13; ++i ) {
+    arr0[i] = i + 1;
+    arr1[i] = (int32_t)i - 6;
+  }
+
+  khyber::SinglePrecisionArray inclusive = arr0.PrefixSum();
+  khyber::Int32Array exclusive = arr1.ExclusivePrefixSum();
+  for ( size_t i = 0; i < 13; ++i ) {
+    BOOST_CHECK_EQUAL(inclusive[i], (i + 1) * (i + 2) / 2);
+    BOOST_CHECK_EQUAL(exclusive[i], (int32_t)(i * (i - 1) / 2) - 6 * (int32_t)i);
+  }
+
+  arr1.TransformPrefixSum();
+  BOOST_CHECK_EQUAL(arr1[12], 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayExtrema)
+{
+  // AVX2, AVX, SSE and then the serial kernels must all return the first index on ties and propagate NaN
+  const uint64_t masks[] = { 0,
+                             BM_AVX2,
+                             BM_AVX | BM_AVX2 | BM_FMA,
+                             BM_AVX | BM_AVX2 | BM_FMA | BM_SSE4_1 };
+  for ( auto mask : masks ) {
+    khyber::ProcessorCaps downgradedCaps = khyber::ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    khyber::SinglePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+    khyber::DoublePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+    khyber::Int32Array::OverrideProcessorCaps(downgradedCaps);
+
+    khyber::SinglePrecisionArray arr0(37);
+    khyber::DoublePrecisionArray arr1(37);
+    khyber::Int32Array arr2(37);
+    for ( size_t i = 0; i < 37; ++i ) {
+      arr0[i] = (i * 7) % 11;
+      arr1[i] = -arr0[i];
+      arr2[i] = (int32_t)arr0[i] - 5;
+    }
+
+    khyber::Extrema<float> extrema = arr0.MinMax();
+    BOOST_CHECK_EQUAL(arr0.Min(), 0);
+    BOOST_CHECK_EQUAL(arr0.Max(), 10);
+    BOOST_CHECK_EQUAL(extrema.minimum, 0);
+    BOOST_CHECK_EQUAL(extrema.maximum, 10);
+    BOOST_CHECK_EQUAL(arr0.ArgMin(), 0);
+    BOOST_CHECK_EQUAL(arr0.ArgMax(), 3);
+    BOOST_CHECK_EQUAL(arr1.ArgMin(), 3);
+    BOOST_CHECK_EQUAL(arr1.ArgMax(), 0);
+    BOOST_CHECK_EQUAL(arr2.ArgMin(), 0);
+    BOOST_CHECK_EQUAL(arr2.ArgMax(), 3);
+    BOOST_CHECK_EQUAL(arr2.MinMax().minimum, -5);
+    BOOST_CHECK_EQUAL(arr2.MinMax().maximum, 5);
+
+    arr0[29] = NAN;
+    arr0[17] = NAN;
+    extrema = arr0.MinMax();
+    BOOST_CHECK(std::isnan(arr0.Min()));
+    BOOST_CHECK(std::isnan(arr0.Max()));
+    BOOST_CHECK(std::isnan(extrema.minimum) && std::isnan(extrema.maximum));
+    BOOST_CHECK_EQUAL(arr0.ArgMin(), 17);
+    BOOST_CHECK_EQUAL(arr0.ArgMax(), 17);
+  }
+
+  khyber::SinglePrecisionArray::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+  khyber::DoublePrecisionArray::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+  khyber::Int32Array::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayCompensatedSummation)
+{
+  // 1 + 2^-24 + ... is lost by a plain float sum, the compensated one has to be exact and identical on every instruction set
+  const uint64_t masks[] = { 0,
+                             BM_AVX2,
+                             BM_AVX | BM_AVX2 | BM_FMA,
+                             BM_AVX | BM_AVX2 | BM_FMA | BM_SSE4_1 };
+  khyber::SinglePrecisionArray arr0(10007);
+  khyber::SinglePrecisionArray arr1(10007);
+  khyber::DoublePrecisionArray arr2(10007);
+  for ( size_t i = 0; i < 10007; ++i ) {
+    arr0[i] = i % 1000 == 0 ? 1.0f : std::ldexp(1.0f, -24);
+    arr1[i] = i % 3 == 0 ? -0.1f : 0.3f;
+    arr2[i] = 1.0 / (i + 1);
+  }
+
+  std::vector<float> sums;
+  std::vector<float> products;
+  std::vector<double> harmonics;
+  for ( auto mask : masks ) {
+    khyber::ProcessorCaps downgradedCaps = khyber::ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    khyber::SinglePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+    khyber::DoublePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+
+    sums.push_back(arr0.CompensatedSummation());
+    products.push_back(arr0.CompensatedDotProduct(arr1));
+    harmonics.push_back(arr2.CompensatedSummation());
+  }
+
+  BOOST_CHECK_EQUAL(sums[0], 11.0f + 9996 * std::ldexp(1.0f, -24));
+  for ( size_t i = 1; i < sums.size(); ++i ) {
+    BOOST_CHECK_EQUAL(sums[i], sums[0]);
+    BOOST_CHECK_EQUAL(products[i], products[0]);
+    BOOST_CHECK_EQUAL(harmonics[i], harmonics[0]);
+  }
+
+  khyber::SinglePrecisionArray::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+  khyber::DoublePrecisionArray::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayTranscendentals)
+{
+  // The SIMD kernels share their algorithm, so they have to round alike, and all of them stay close to the serial std:: functions
+  const uint64_t masks[] = { 0,
+                             BM_AVX2,
+                             BM_AVX | BM_AVX2 | BM_FMA,
+                             BM_AVX | BM_AVX2 | BM_FMA | BM_SSE4_1 };
+  khyber::SinglePrecisionArray arr0(1037);
+  khyber::SinglePrecisionArray arr1(1037);
+  for ( size_t i = 0; i < 1037; ++i ) {
+    arr0[i] = (i + 1) / 128.0f;
+    arr1[i] = ((float)i - 518) / 64.0f;
+  }
+
+  std::vector<khyber::SinglePrecisionArray> results;
+  for ( auto mask : masks ) {
+    khyber::ProcessorCaps downgradedCaps = khyber::ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    khyber::SinglePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+
+    khyber::SinglePrecisionArray sigmoid(1037);
+    sigmoid.Add(arr1, arr1).TransformSigmoid();
+    results.push_back(arr1.Exp());
+    results.push_back(arr0.Log());
+    results.push_back(arr0.Log2());
+    results.push_back(arr1.Sin());
+    results.push_back(arr1.Cos());
+    results.push_back(arr1.Tanh());
+    results.push_back(std::move(sigmoid));
+    results.push_back(arr0.Pow(arr1));
+  }
+
+  for ( size_t i = 0; i < 1037; ++i ) {
+    BOOST_CHECK_CLOSE(results[0][i], std::exp(arr1[i]), 3e-5);
+    BOOST_CHECK_CLOSE(results[1][i], std::log(arr0[i]), 3e-5);
+    BOOST_CHECK_CLOSE(results[2][i], std::log2(arr0[i]), 3e-5);
+    BOOST_CHECK_SMALL(results[3][i] - std::sin(arr1[i]), 2.4e-7f);
+    BOOST_CHECK_SMALL(results[4][i] - std::cos(arr1[i]), 2.4e-7f);
+    BOOST_CHECK_CLOSE(results[5][i], std::tanh(arr1[i]), 3e-5);
+    BOOST_CHECK_CLOSE(results[6][i], 1 / (1 + std::exp(-2 * arr1[i])), 4e-5);
+    BOOST_CHECK_CLOSE(results[7][i], std::pow(arr0[i], arr1[i]), 2e-3);
+  }
+
+  const size_t functions = results.size() / 4;
+  for ( size_t mask = 1; mask < 3; ++mask ) {
+    for ( size_t f = 0; f < functions; ++f ) {
+      for ( size_t i = 0; i < 1037; ++i ) {
+        BOOST_CHECK_EQUAL(results[mask * functions + f][i], results[f][i]);
+      }
+    }
+  }
+
+  khyber::SinglePrecisionArray::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayPrecisionModes)
+{
+  const uint64_t masks[] = { 0,
+                             BM_AVX2,
+                             BM_AVX | BM_AVX2 | BM_FMA,
+                             BM_AVX | BM_AVX2 | BM_FMA | BM_SSE4_1 };
+  khyber::SinglePrecisionArray arr(1037);
+  khyber::DoublePrecisionArray doubleArr(1037);
+  for ( size_t i = 0; i < 1037; ++i ) {
+    arr[i] = (i + 1) / 7.0f;
+    doubleArr[i] = (i + 1) / 7.0;
+  }
+
+  for ( auto mask : masks ) {
+    khyber::ProcessorCaps downgradedCaps = khyber::ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    khyber::SinglePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+    khyber::DoublePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+
+    // Exact is the IEEE result on every element, the tail included
+    khyber::SinglePrecisionArray reciprocal = arr.Reciprocate();
+    khyber::SinglePrecisionArray rsqrt = arr.Rsqrt();
+    for ( size_t i = 0; i < 1037; ++i ) {
+      BOOST_CHECK_EQUAL(reciprocal[i], 1.0f / arr[i]);
+      BOOST_CHECK_EQUAL(rsqrt[i], 1.0f / std::sqrt(arr[i]));
+    }
+
+    khyber::SinglePrecisionArray approximate = arr.Reciprocate(khyber::Approximate);
+    khyber::SinglePrecisionArray refined(arr);
+    refined.TransformReciprocate(khyber::Refined);
+    khyber::SinglePrecisionArray approximateRsqrt = arr.Rsqrt(khyber::Approximate);
+    khyber::SinglePrecisionArray refinedRsqrt = arr.Rsqrt(khyber::Refined);
+    for ( size_t i = 0; i < 1037; ++i ) {
+      BOOST_CHECK_CLOSE(approximate[i], 1 / (double)arr[i], 0.037);
+      BOOST_CHECK_CLOSE(refined[i], 1 / (double)arr[i], 4.8e-5);
+      BOOST_CHECK_CLOSE(approximateRsqrt[i], 1 / std::sqrt((double)arr[i]), 0.037);
+      BOOST_CHECK_CLOSE(refinedRsqrt[i], 1 / std::sqrt((double)arr[i]), 4.8e-5);
+    }
+
+    // Double-precision has no estimate, every mode divides exactly
+    khyber::DoublePrecisionArray doubleApproximate = doubleArr.Reciprocate(khyber::Approximate);
+    khyber::DoublePrecisionArray doubleRsqrt = doubleArr.Rsqrt(khyber::Refined);
+    for ( size_t i = 0; i < 1037; ++i ) {
+      BOOST_CHECK_EQUAL(doubleApproximate[i], 1.0 / doubleArr[i]);
+      BOOST_CHECK_EQUAL(doubleRsqrt[i], 1.0 / std::sqrt(doubleArr[i]));
+    }
+
+    for ( auto precision : { khyber::Approximate, khyber::Refined, khyber::Exact } ) {
+      khyber::SinglePrecisionArray normalized = arr.Normalize(precision);
+      BOOST_CHECK_CLOSE(std::sqrt(normalized.DotProduct(normalized)), 1.0f, precision == khyber::Approximate ? 0.04 : 1e-3);
+      BOOST_CHECK_CLOSE(normalized[1036] / normalized[0], 1037.0f, 1e-4);
+    }
+    khyber::DoublePrecisionArray normalized(doubleArr);
+    normalized.TransformNormalize();
+    BOOST_CHECK_CLOSE(normalized.DotProduct(normalized), 1.0, 1e-10);
+
+    khyber::SinglePrecisionArray zeros(13);
+    for ( size_t i = 0; i < 13; ++i ) {
+      zeros[i] = 0.0f;
+    }
+    zeros.TransformNormalize();
+    for ( size_t i = 0; i < 13; ++i ) {
+      BOOST_CHECK_EQUAL(zeros[i], 0.0f);
+    }
+  }
+
+  khyber::SinglePrecisionArray::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+  khyber::DoublePrecisionArray::OverrideProcessorCaps(khyber::ProcessorCaps::Host());
+}
+
 BOOST_AUTO_TEST_CASE(TestArraySqrt)
 {
   khyber::SinglePrecisionArray arr0(512);
@@ -0,0 +1,140 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ArrayView.hpp"
+
+// Not a multiple of 8 so every loop tail is exercised
+#define TEST_VECTOR_LENGTH 1037
+
+BOOST_AUTO_TEST_SUITE(ArrayViewTestSuite)
+
+using namespace khyber;
+
+BOOST_AUTO_TEST_CASE(TestArrayViewUnaligned)
+{
+  // The views start one element into their buffers, so none of them is aligned for any instruction set
+  const uint64_t masks[] = { 0,
+                             BM_AVX2,
+                             BM_AVX | BM_AVX2 | BM_FMA,
+                             BM_AVX | BM_AVX2 | BM_FMA | BM_SSE4_1 };
+  std::vector<float> lhsBuffer(TEST_VECTOR_LENGTH + 1);
+  std::vector<float> rhsBuffer(TEST_VECTOR_LENGTH + 1);
+  SinglePrecisionArray lhs(TEST_VECTOR_LENGTH);
+  SinglePrecisionArray rhs(TEST_VECTOR_LENGTH);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    lhsBuffer[i + 1] = lhs[i] = (i + 1) / 64.0f;
+    rhsBuffer[i + 1] = rhs[i] = ((float)i - 518) / 32.0f;
+  }
+  ConstSinglePrecisionArrayView lhsView(lhsBuffer.data() + 1, TEST_VECTOR_LENGTH);
+  ConstSinglePrecisionArrayView rhsView(rhsBuffer.data() + 1, TEST_VECTOR_LENGTH);
+
+  for ( auto mask : masks ) {
+    ProcessorCaps downgradedCaps = ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    SinglePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+
+    // The kernels are the same whatever the alignment, so the results are bitwise identical to those of arrays
+    std::vector<SinglePrecisionArray> expected;
+    expected.push_back(lhs.Add(rhs));
+    expected.push_back(lhs.Div(rhs));
+    expected.push_back(rhs.Exp());
+    expected.push_back(lhs.Log());
+    expected.push_back(lhs.Reciprocate(Refined));
+    expected.push_back(rhs.PrefixSum());
+    expected.push_back(lhs.Normalize());
+    std::vector<SinglePrecisionArray> actual;
+    actual.push_back(lhsView.Add(rhsView));
+    actual.push_back(lhsView.Div(rhs));
+    actual.push_back(rhsView.Exp());
+    actual.push_back(lhsView.Log());
+    actual.push_back(lhsView.Reciprocate(Refined));
+    actual.push_back(rhsView.PrefixSum());
+    actual.push_back(lhsView.Normalize());
+    for ( size_t f = 0; f < expected.size(); ++f ) {
+      BOOST_CHECK_EQUAL(actual[f].size(), TEST_VECTOR_LENGTH);
+      for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+        BOOST_CHECK_EQUAL(actual[f][i], expected[f][i]);
+      }
+    }
+
+    BOOST_CHECK_EQUAL(lhsView.DotProduct(rhsView), lhs.DotProduct(rhs));
+    BOOST_CHECK_EQUAL(lhs.DotProduct(rhsView), lhs.DotProduct(rhs));
+    BOOST_CHECK_EQUAL(rhsView.Summation(), rhs.Summation());
+    BOOST_CHECK_EQUAL(rhsView.CompensatedSummation(), rhs.CompensatedSummation());
+    BOOST_CHECK_EQUAL(lhsView.Distance(rhsView), lhs.Distance(rhs));
+    BOOST_CHECK_EQUAL(rhsView.Min(), rhs.Min());
+    BOOST_CHECK_EQUAL(rhsView.ArgMax(), rhs.ArgMax());
+  }
+
+  SinglePrecisionArray::OverrideProcessorCaps(ProcessorCaps::Host());
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayViewInPlace)
+{
+  std::vector<float> buffer(TEST_VECTOR_LENGTH + 3, -1.0f);
+  SinglePrecisionArray addend(TEST_VECTOR_LENGTH);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    buffer[i + 3] = i;
+    addend[i] = 2.0f * i;
+  }
+
+  // In-place operations and expressions write through the view, and only inside it
+  SinglePrecisionArrayView view(buffer.data() + 3, TEST_VECTOR_LENGTH);
+  view.Add(view, addend).TransformScalarMul(0.5f);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_EQUAL(buffer[i + 3], 1.5f * i);
+  }
+  view = view * 2.0f - addend;
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_EQUAL(view[i], (float)i);
+  }
+  BOOST_CHECK_EQUAL(buffer[2], -1.0f);
+
+  // A slice covers part of the view, and the expression result can be kept in an Array
+  SinglePrecisionArrayView slice = view.Slice(5, 11);
+  slice.Sqrt(slice);
+  BOOST_CHECK_EQUAL(view[4], 4.0f);
+  BOOST_CHECK_EQUAL(view[9], 3.0f);
+  BOOST_CHECK_EQUAL(view[16], 16.0f);
+  SinglePrecisionArray sum = slice + ConstSinglePrecisionArrayView(slice);
+  BOOST_CHECK_EQUAL(sum.size(), 11);
+  BOOST_CHECK_EQUAL(sum[4], 6.0f);
+
+  // A view of an Array writes to the array's buffer
+  SinglePrecisionArrayView arrayView(addend);
+  arrayView.Negate(arrayView);
+  BOOST_CHECK_EQUAL(addend[10], -20.0f);
+}
+
+BOOST_AUTO_TEST_CASE(TestArrayViewInteger)
+{
+  std::vector<uint32_t> buffer(TEST_VECTOR_LENGTH + 1);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    buffer[i + 1] = i * 3;
+  }
+
+  ConstUInt32ArrayView view(buffer.data() + 1, TEST_VECTOR_LENGTH);
+  UInt32Array shifted = view.ShiftLeft(2);
+  UInt32Array masked = view.And(shifted);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_EQUAL(shifted[i], (uint32_t)(i * 12));
+    BOOST_CHECK_EQUAL(masked[i], (uint32_t)((i * 3) & (i * 12)));
+  }
+  BOOST_CHECK_EQUAL(view.WideSummation(), (uint64_t)3 * TEST_VECTOR_LENGTH * (TEST_VECTOR_LENGTH - 1) / 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cmath>
 #include <boost/test/unit_test.hpp>
 #include "ProcessorCaps.hpp"
@@ -50,4 +51,612 @@ BOOST_AUTO_TEST_CASE(TestAvx2Negate)
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestAvx2Arithmetic)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  alignas(32) sp_t lhs[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t rhs[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t sum[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t difference[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t product[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t quotient[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    lhs[i] = i * 1.5;
+    rhs[i] = i + 1;
+  }
+
+  avx2::InternalAdd(TEST_VECTOR_LENGTH, sum, lhs, rhs);
+  avx2::InternalSub(TEST_VECTOR_LENGTH, difference, lhs, rhs);
+  avx2::InternalMul(TEST_VECTOR_LENGTH, product, lhs, rhs);
+  avx2::InternalDiv(TEST_VECTOR_LENGTH, quotient, lhs, rhs);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( sum[i] != lhs[i] + rhs[i] ||
+         difference[i] != lhs[i] - rhs[i] ||
+         product[i] != lhs[i] * rhs[i] ||
+         quotient[i] != lhs[i] / rhs[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2ScalarArithmetic)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  alignas(32) sp_t src[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t sum[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t product[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t quotient[TEST_VECTOR_LENGTH];
+  sp_t scalar = 3.14159;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = i;
+  }
+
+  avx2::InternalScalarAdd(TEST_VECTOR_LENGTH, scalar, sum, src);
+  avx2::InternalScalarMul(TEST_VECTOR_LENGTH, scalar, product, src);
+  avx2::InternalScalarDiv(TEST_VECTOR_LENGTH, scalar, quotient, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( sum[i] != src[i] + scalar ||
+         product[i] != src[i] * scalar ||
+         quotient[i] != src[i] / scalar ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2Powers)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  alignas(32) sp_t src[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t root[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t sqr[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t cub[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = i * (i % 2 ? 1 : -1);
+  }
+
+  avx2::InternalSquare(TEST_VECTOR_LENGTH, sqr, src);
+  avx2::InternalCube(TEST_VECTOR_LENGTH, cub, src);
+  avx2::InternalSqrt(TEST_VECTOR_LENGTH, root, sqr);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( sqr[i] != src[i] * src[i] ||
+         cub[i] != src[i] * src[i] * src[i] ||
+         root[i] != std::abs(src[i]) ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2Reductions)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  alignas(32) sp_t v1[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t v2[TEST_VECTOR_LENGTH];
+  sp_t refSum = 0;
+  sp_t refProduct = 0;
+  sp_t refDistance = 0;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    v1[i] = (i % 7) * 0.5;
+    v2[i] = (i % 5) * 0.25;
+    refSum += v1[i];
+    refProduct += v1[i] * v2[i];
+    refDistance += (v1[i] - v2[i]) * (v1[i] - v2[i]);
+  }
+  refDistance = std::sqrt(refDistance);
+
+  sp_t result;
+  avx2::InternalSummation(TEST_VECTOR_LENGTH, &result, v1);
+  BOOST_CHECK_CLOSE(result, refSum, EPSILON);
+  avx2::InternalSummation(5, &result, v1);
+  BOOST_CHECK_EQUAL(result, v1[0] + v1[1] + v1[2] + v1[3] + v1[4]);
+  avx2::InternalDotProduct(TEST_VECTOR_LENGTH, &result, v1, v2);
+  BOOST_CHECK_CLOSE(result, refProduct, EPSILON);
+  avx2::InternalDistance(TEST_VECTOR_LENGTH, &result, v1, v2);
+  BOOST_CHECK_CLOSE(result, refDistance, EPSILON);
+
+  if ( !caps.IsFma() ) {
+    return;
+  }
+
+  avx2::InternalDotProductFma(TEST_VECTOR_LENGTH, &result, v1, v2);
+  BOOST_CHECK_CLOSE(result, refProduct, EPSILON);
+  avx2::InternalDistanceFma(TEST_VECTOR_LENGTH, &result, v1, v2);
+  BOOST_CHECK_CLOSE(result, refDistance, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2Reciprocate)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  alignas(32) sp_t reciprocated[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t src[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = i + 1;
+  }
+
+  avx2::InternalReciprocate(TEST_VECTOR_LENGTH, reciprocated, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_EQUAL(reciprocated[i], 1.0f / src[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2ReciprocalPrecision)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  alignas(32) sp_t src[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t dst[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = (i + 1) / 7.0f;
+  }
+
+  // Relative tolerances in percent: 1.5*2^-12 for the estimates and 2^-21 after the Newton-Raphson step
+  avx2::InternalApproximateReciprocate(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / (dp_t)src[i], 0.037);
+  }
+  avx2::InternalRefinedReciprocate(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / (dp_t)src[i], 4.8e-5);
+  }
+  avx2::InternalApproximateRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / std::sqrt((dp_t)src[i]), 0.037);
+  }
+  avx2::InternalRefinedRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / std::sqrt((dp_t)src[i]), 4.8e-5);
+  }
+  avx2::InternalRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_EQUAL(dst[i], 1.0f / std::sqrt(src[i]));
+  }
+
+  // The tail is padded into a full register, the estimates have to match the elements computed in the vector loop
+  alignas(32) sp_t tail[7];
+  avx2::InternalRefinedReciprocate(7, tail, src + 8);
+  avx2::InternalRefinedReciprocate(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < 7; ++i ) {
+    BOOST_CHECK_EQUAL(tail[i], dst[8 + i]);
+  }
+  avx2::InternalApproximateRsqrt(7, tail, src + 8);
+  avx2::InternalApproximateRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < 7; ++i ) {
+    BOOST_CHECK_EQUAL(tail[i], dst[8 + i]);
+  }
+
+  // The Newton-Raphson step keeps the limits of the estimate instead of turning them into NaN
+  alignas(32) sp_t special[8] = { 0.0f, -0.0f, INFINITY, -INFINITY, 1e-40f, -4.0f, 4.0f, 0.25f };
+  avx2::InternalRefinedReciprocate(8, dst, special);
+  BOOST_CHECK(std::isinf(dst[0]) && dst[0] > 0);
+  BOOST_CHECK(std::isinf(dst[1]) && dst[1] < 0);
+  BOOST_CHECK_EQUAL(dst[2], 0.0f);
+  BOOST_CHECK_EQUAL(dst[3], 0.0f);
+  BOOST_CHECK(std::isinf(dst[4]) && dst[4] > 0);
+  BOOST_CHECK_CLOSE(dst[5], -0.25f, 4.8e-5);
+  avx2::InternalRefinedRsqrt(8, dst, special);
+  BOOST_CHECK(std::isinf(dst[0]) && dst[0] > 0);
+  BOOST_CHECK_EQUAL(dst[2], 0.0f);
+  BOOST_CHECK(std::isnan(dst[3]));
+  BOOST_CHECK(std::isinf(dst[4]) && dst[4] > 0);
+  BOOST_CHECK(std::isnan(dst[5]));
+  BOOST_CHECK_CLOSE(dst[7], 2.0f, 4.8e-5);
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2DoublePrecision)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  alignas(32) dp_t lhs[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t rhs[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t sum[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t quotient[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t negated[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t root[TEST_VECTOR_LENGTH];
+  dp_t refProduct = 0;
+  dp_t refDistance = 0;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    lhs[i] = i * 1.5;
+    rhs[i] = i + 1;
+    refProduct += lhs[i] * rhs[i];
+    refDistance += (lhs[i] - rhs[i]) * (lhs[i] - rhs[i]);
+  }
+  refDistance = std::sqrt(refDistance);
+
+  avx2::InternalAdd(TEST_VECTOR_LENGTH, sum, lhs, rhs);
+  avx2::InternalDiv(TEST_VECTOR_LENGTH, quotient, lhs, rhs);
+  avx2::InternalNegate(TEST_VECTOR_LENGTH, negated, lhs);
+  avx2::InternalSqrt(TEST_VECTOR_LENGTH, root, rhs);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( sum[i] != lhs[i] + rhs[i] ||
+         quotient[i] != lhs[i] / rhs[i] ||
+         negated[i] != -lhs[i] ||
+         root[i] != std::sqrt(rhs[i]) ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+
+  dp_t result;
+  avx2::InternalDotProduct(TEST_VECTOR_LENGTH, &result, lhs, rhs);
+  BOOST_CHECK_CLOSE(result, refProduct, 1e-10);
+  avx2::InternalDistance(TEST_VECTOR_LENGTH, &result, lhs, rhs);
+  BOOST_CHECK_CLOSE(result, refDistance, 1e-10);
+
+  if ( !caps.IsFma() ) {
+    return;
+  }
+
+  avx2::InternalDotProductFma(TEST_VECTOR_LENGTH, &result, lhs, rhs);
+  BOOST_CHECK_CLOSE(result, refProduct, 1e-10);
+  avx2::InternalDistanceFma(TEST_VECTOR_LENGTH, &result, lhs, rhs);
+  BOOST_CHECK_CLOSE(result, refDistance, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2UnsignedInteger)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  alignas(32) uint32_t lhs[TEST_VECTOR_LENGTH];
+  alignas(32) uint32_t rhs[TEST_VECTOR_LENGTH];
+  alignas(32) uint32_t sum[TEST_VECTOR_LENGTH];
+  alignas(32) uint32_t product[TEST_VECTOR_LENGTH];
+  alignas(32) uint32_t minimum[TEST_VECTOR_LENGTH];
+  alignas(32) uint32_t masked[TEST_VECTOR_LENGTH];
+  alignas(32) uint32_t shifted[TEST_VECTOR_LENGTH];
+  uint64_t refSum = 0;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    lhs[i] = 0xFFFFFF00u + i;
+    rhs[i] = i * 7919u;
+    refSum += lhs[i];
+  }
+
+  avx2::InternalAdd(TEST_VECTOR_LENGTH, sum, lhs, rhs);
+  avx2::InternalMul(TEST_VECTOR_LENGTH, product, lhs, rhs);
+  avx2::InternalMin(TEST_VECTOR_LENGTH, minimum, lhs, rhs);
+  avx2::InternalAndNot(TEST_VECTOR_LENGTH, masked, lhs, rhs);
+  avx2::InternalShiftRight(TEST_VECTOR_LENGTH, 3, shifted, lhs);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( sum[i] != lhs[i] + rhs[i] ||
+         product[i] != lhs[i] * rhs[i] ||
+         minimum[i] != std::min(lhs[i], rhs[i]) ||
+         masked[i] != (lhs[i] & ~rhs[i]) ||
+         shifted[i] != lhs[i] >> 3 ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+
+  uint64_t wideSum;
+  uint32_t extreme;
+  avx2::InternalWideSummation(TEST_VECTOR_LENGTH, &wideSum, lhs);
+  BOOST_CHECK_EQUAL(wideSum, refSum);
+  avx2::InternalMinimum(TEST_VECTOR_LENGTH, &extreme, rhs);
+  BOOST_CHECK_EQUAL(extreme, 0);
+  avx2::InternalMaximum(TEST_VECTOR_LENGTH, &extreme, lhs);
+  BOOST_CHECK_EQUAL(extreme, 0xFFFFFFFFu);
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2SignedInteger)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  alignas(32) int32_t lhs[TEST_VECTOR_LENGTH];
+  alignas(32) int32_t rhs[TEST_VECTOR_LENGTH];
+  alignas(32) int32_t maximum[TEST_VECTOR_LENGTH];
+  alignas(32) int32_t shifted[TEST_VECTOR_LENGTH];
+  int64_t refSum = 0;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    lhs[i] = (i % 2 ? -1 : 1) * (INT32_MAX - i);
+    rhs[i] = 100 - i;
+    refSum += lhs[i];
+  }
+
+  avx2::InternalMax(TEST_VECTOR_LENGTH, maximum, lhs, rhs);
+  avx2::InternalShiftRight(TEST_VECTOR_LENGTH, 4, shifted, lhs);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( maximum[i] != std::max(lhs[i], rhs[i]) ||
+         shifted[i] != lhs[i] >> 4 ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+
+  int64_t wideSum;
+  int32_t extreme;
+  avx2::InternalWideSummation(TEST_VECTOR_LENGTH, &wideSum, lhs);
+  BOOST_CHECK_EQUAL(wideSum, refSum);
+  avx2::InternalMinimum(TEST_VECTOR_LENGTH, &extreme, lhs);
+  BOOST_CHECK_EQUAL(extreme, -(INT32_MAX - 1));
+  avx2::InternalMaximum(TEST_VECTOR_LENGTH, &extreme, rhs);
+  BOOST_CHECK_EQUAL(extreme, 100);
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2PrefixSum)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  // Small integral values keep every floating point prefix sum exact
+  alignas(32) sp_t spSrc[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t spInclusive[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t spExclusive[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t dpSrc[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t dpInclusive[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t dpExclusive[TEST_VECTOR_LENGTH];
+  alignas(32) uint32_t ui32Src[TEST_VECTOR_LENGTH];
+  alignas(32) uint32_t ui32Inclusive[TEST_VECTOR_LENGTH];
+  alignas(32) uint32_t ui32Exclusive[TEST_VECTOR_LENGTH];
+  alignas(32) int32_t i32Src[TEST_VECTOR_LENGTH];
+  alignas(32) int32_t i32Inclusive[TEST_VECTOR_LENGTH];
+  alignas(32) int32_t i32Exclusive[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    spSrc[i] = i % 7;
+    dpSrc[i] = i % 7;
+    ui32Src[i] = i % 7;
+    i32Src[i] = i % 7;
+  }
+
+  avx2::InternalPrefixSum(TEST_VECTOR_LENGTH, 10, spInclusive, spSrc);
+  avx2::InternalExclusivePrefixSum(TEST_VECTOR_LENGTH, 10, spExclusive, spSrc);
+  sp_t spRunning = 10;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( spExclusive[i] != spRunning ||
+         spInclusive[i] != spRunning + spSrc[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+    spRunning += spSrc[i];
+  }
+
+  avx2::InternalPrefixSum(TEST_VECTOR_LENGTH, 10, dpInclusive, dpSrc);
+  avx2::InternalExclusivePrefixSum(TEST_VECTOR_LENGTH, 10, dpExclusive, dpSrc);
+  dp_t dpRunning = 10;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( dpExclusive[i] != dpRunning ||
+         dpInclusive[i] != dpRunning + dpSrc[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+    dpRunning += dpSrc[i];
+  }
+
+  avx2::InternalPrefixSum(TEST_VECTOR_LENGTH, 10, ui32Inclusive, ui32Src);
+  avx2::InternalExclusivePrefixSum(TEST_VECTOR_LENGTH, 10, ui32Exclusive, ui32Src);
+  uint32_t ui32Running = 10;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( ui32Exclusive[i] != ui32Running ||
+         ui32Inclusive[i] != ui32Running + ui32Src[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+    ui32Running += ui32Src[i];
+  }
+
+  avx2::InternalPrefixSum(TEST_VECTOR_LENGTH, 10, i32Inclusive, i32Src);
+  avx2::InternalExclusivePrefixSum(TEST_VECTOR_LENGTH, 10, i32Exclusive, i32Src);
+  int32_t i32Running = 10;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( i32Exclusive[i] != i32Running ||
+         i32Inclusive[i] != i32Running + i32Src[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+    i32Running += i32Src[i];
+  }
+
+  // In place, dst == src
+  avx2::InternalExclusivePrefixSum(TEST_VECTOR_LENGTH, 10, spSrc, spSrc);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( spSrc[i] != spExclusive[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2Extrema)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  // Every value recurs several times, in different lanes, so the first index has to win the ties
+  alignas(32) sp_t spSrc[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t dpSrc[TEST_VECTOR_LENGTH];
+  alignas(32) uint32_t ui32Src[TEST_VECTOR_LENGTH];
+  alignas(32) int32_t i32Src[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    spSrc[i] = (i * 37 + 50) % 101;
+    dpSrc[i] = (i * 37 + 50) % 101;
+    ui32Src[i] = (i * 37 + 50) % 101 * 0x02000000u;
+    i32Src[i] = (i * 37 + 50) % 101 - 50;
+  }
+
+  sp_t spExtreme;
+  Extrema<sp_t> spExtrema;
+  size_t spIndex;
+  avx2::InternalMinimum(TEST_VECTOR_LENGTH, &spExtreme, spSrc);
+  BOOST_CHECK_EQUAL(spExtreme, *std::min_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  avx2::InternalMaximum(TEST_VECTOR_LENGTH, &spExtreme, spSrc);
+  BOOST_CHECK_EQUAL(spExtreme, *std::max_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  avx2::InternalMinMaximum(TEST_VECTOR_LENGTH, &spExtrema, spSrc);
+  BOOST_CHECK_EQUAL(spExtrema.minimum, *std::min_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  BOOST_CHECK_EQUAL(spExtrema.maximum, *std::max_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  avx2::InternalArgMinimum(TEST_VECTOR_LENGTH, &spIndex, spSrc);
+  BOOST_CHECK_EQUAL(spIndex, std::min_element(spSrc, spSrc + TEST_VECTOR_LENGTH) - spSrc);
+  avx2::InternalArgMaximum(TEST_VECTOR_LENGTH, &spIndex, spSrc);
+  BOOST_CHECK_EQUAL(spIndex, std::max_element(spSrc, spSrc + TEST_VECTOR_LENGTH) - spSrc);
+
+  spSrc[400] = NAN;
+  spSrc[300] = NAN;
+  avx2::InternalMinimum(TEST_VECTOR_LENGTH, &spExtreme, spSrc);
+  BOOST_CHECK(std::isnan(spExtreme));
+  avx2::InternalMinMaximum(TEST_VECTOR_LENGTH, &spExtrema, spSrc);
+  BOOST_CHECK(std::isnan(spExtrema.minimum) && std::isnan(spExtrema.maximum));
+  avx2::InternalArgMaximum(TEST_VECTOR_LENGTH, &spIndex, spSrc);
+  BOOST_CHECK_EQUAL(spIndex, 300);
+
+  dp_t dpExtreme;
+  Extrema<dp_t> dpExtrema;
+  size_t dpIndex;
+  avx2::InternalMinimum(TEST_VECTOR_LENGTH, &dpExtreme, dpSrc);
+  BOOST_CHECK_EQUAL(dpExtreme, *std::min_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH));
+  avx2::InternalMaximum(TEST_VECTOR_LENGTH, &dpExtreme, dpSrc);
+  BOOST_CHECK_EQUAL(dpExtreme, *std::max_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH));
+  avx2::InternalMinMaximum(TEST_VECTOR_LENGTH, &dpExtrema, dpSrc);
+  BOOST_CHECK_EQUAL(dpExtrema.minimum, *std::min_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH));
+  BOOST_CHECK_EQUAL(dpExtrema.maximum, *std::max_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH));
+  avx2::InternalArgMinimum(TEST_VECTOR_LENGTH, &dpIndex, dpSrc);
+  BOOST_CHECK_EQUAL(dpIndex, std::min_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH) - dpSrc);
+  avx2::InternalArgMaximum(TEST_VECTOR_LENGTH, &dpIndex, dpSrc);
+  BOOST_CHECK_EQUAL(dpIndex, std::max_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH) - dpSrc);
+
+  dpSrc[400] = NAN;
+  dpSrc[300] = NAN;
+  avx2::InternalMinimum(TEST_VECTOR_LENGTH, &dpExtreme, dpSrc);
+  BOOST_CHECK(std::isnan(dpExtreme));
+  avx2::InternalMinMaximum(TEST_VECTOR_LENGTH, &dpExtrema, dpSrc);
+  BOOST_CHECK(std::isnan(dpExtrema.minimum) && std::isnan(dpExtrema.maximum));
+  avx2::InternalArgMaximum(TEST_VECTOR_LENGTH, &dpIndex, dpSrc);
+  BOOST_CHECK_EQUAL(dpIndex, 300);
+
+  uint32_t ui32Extreme;
+  Extrema<uint32_t> ui32Extrema;
+  size_t ui32Index;
+  avx2::InternalMinimum(TEST_VECTOR_LENGTH, &ui32Extreme, ui32Src);
+  BOOST_CHECK_EQUAL(ui32Extreme, *std::min_element(ui32Src, ui32Src + TEST_VECTOR_LENGTH));
+  avx2::InternalMaximum(TEST_VECTOR_LENGTH, &ui32Extreme, ui32Src);
+  BOOST_CHECK_EQUAL(ui32Extreme, *std::max_element(ui32Src, ui32Src + TEST_VECTOR_LENGTH));
+  avx2::InternalMinMaximum(TEST_VECTOR_LENGTH, &ui32Extrema, ui32Src);
+  BOOST_CHECK_EQUAL(ui32Extrema.minimum, *std::min_element(ui32Src, ui32Src + TEST_VECTOR_LENGTH));
+  BOOST_CHECK_EQUAL(ui32Extrema.maximum, *std::max_element(ui32Src, ui32Src + TEST_VECTOR_LENGTH));
+  avx2::InternalArgMinimum(TEST_VECTOR_LENGTH, &ui32Index, ui32Src);
+  BOOST_CHECK_EQUAL(ui32Index, std::min_element(ui32Src, ui32Src + TEST_VECTOR_LENGTH) - ui32Src);
+  avx2::InternalArgMaximum(TEST_VECTOR_LENGTH, &ui32Index, ui32Src);
+  BOOST_CHECK_EQUAL(ui32Index, std::max_element(ui32Src, ui32Src + TEST_VECTOR_LENGTH) - ui32Src);
+
+  int32_t i32Extreme;
+  Extrema<int32_t> i32Extrema;
+  size_t i32Index;
+  avx2::InternalMinimum(TEST_VECTOR_LENGTH, &i32Extreme, i32Src);
+  BOOST_CHECK_EQUAL(i32Extreme, *std::min_element(i32Src, i32Src + TEST_VECTOR_LENGTH));
+  avx2::InternalMaximum(TEST_VECTOR_LENGTH, &i32Extreme, i32Src);
+  BOOST_CHECK_EQUAL(i32Extreme, *std::max_element(i32Src, i32Src + TEST_VECTOR_LENGTH));
+  avx2::InternalMinMaximum(TEST_VECTOR_LENGTH, &i32Extrema, i32Src);
+  BOOST_CHECK_EQUAL(i32Extrema.minimum, *std::min_element(i32Src, i32Src + TEST_VECTOR_LENGTH));
+  BOOST_CHECK_EQUAL(i32Extrema.maximum, *std::max_element(i32Src, i32Src + TEST_VECTOR_LENGTH));
+  avx2::InternalArgMinimum(TEST_VECTOR_LENGTH, &i32Index, i32Src);
+  BOOST_CHECK_EQUAL(i32Index, std::min_element(i32Src, i32Src + TEST_VECTOR_LENGTH) - i32Src);
+  avx2::InternalArgMaximum(TEST_VECTOR_LENGTH, &i32Index, i32Src);
+  BOOST_CHECK_EQUAL(i32Index, std::max_element(i32Src, i32Src + TEST_VECTOR_LENGTH) - i32Src);
+}
+
+BOOST_AUTO_TEST_CASE(TestAvx2Transcendentals)
+{
+  if ( !caps.IsAvx2() ) {
+    return;
+  }
+
+  // Relative tolerances in percent: 3e-5 is about 2.5 ulp of a float
+  alignas(32) sp_t src[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t positive[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t exponent[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t dst[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = (i - 257) / 32.0f;
+    positive[i] = (i + 1) / 64.0f;
+    exponent[i] = (i % 13 - 6) / 4.0f;
+  }
+
+  avx2::InternalExp(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::exp((dp_t)src[i]), 3e-5);
+  }
+  avx2::InternalLog(TEST_VECTOR_LENGTH, dst, positive);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::log((dp_t)positive[i]), 3e-5);
+  }
+  avx2::InternalLog2(TEST_VECTOR_LENGTH, dst, positive);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::log2((dp_t)positive[i]), 3e-5);
+  }
+  // The error of sin and cos is bounded in ulp only away from their roots
+  avx2::InternalSin(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_SMALL(dst[i] - std::sin((dp_t)src[i]), 2.4e-7);
+  }
+  avx2::InternalCos(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_SMALL(dst[i] - std::cos((dp_t)src[i]), 2.4e-7);
+  }
+  avx2::InternalTanh(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::tanh((dp_t)src[i]), 3e-5);
+  }
+  avx2::InternalSigmoid(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / (1 + std::exp(-(dp_t)src[i])), 4e-5);
+  }
+  avx2::InternalPow(TEST_VECTOR_LENGTH, dst, positive, exponent);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    dp_t power = std::log2((dp_t)positive[i]) * exponent[i];
+    BOOST_CHECK_CLOSE(dst[i], std::pow((dp_t)positive[i], (dp_t)exponent[i]), (2 + 1.2 * std::abs(power)) * 1.2e-5);
+  }
+
+  // The tail is padded into a full register, it has to match the elements computed in the vector loop
+  alignas(32) sp_t tail[3];
+  avx2::InternalExp(3, tail, src + 8);
+  avx2::InternalExp(TEST_VECTOR_LENGTH, dst, src);
+  BOOST_CHECK_EQUAL(tail[0], dst[8]);
+  BOOST_CHECK_EQUAL(tail[2], dst[10]);
+
+  alignas(32) sp_t special[8] = { 0.0f, -1.0f, INFINITY, -INFINITY, -2.0f, 2.0f, 2.0f, 2.0f };
+  alignas(32) sp_t specialExponent[8] = { -1.0f, 3.0f, 0.0f, 0.5f, 0.5f, 2.0f, 2.0f, 2.0f };
+  avx2::InternalLog(8, dst, special);
+  BOOST_CHECK(std::isinf(dst[0]) && dst[0] < 0);
+  BOOST_CHECK(std::isnan(dst[1]));
+  BOOST_CHECK(std::isinf(dst[2]) && dst[2] > 0);
+  BOOST_CHECK(std::isnan(dst[3]));
+  avx2::InternalExp(8, dst, special);
+  BOOST_CHECK_EQUAL(dst[0], 1.0f);
+  BOOST_CHECK(std::isinf(dst[2]));
+  BOOST_CHECK_EQUAL(dst[3], 0.0f);
+  avx2::InternalTanh(8, dst, special);
+  BOOST_CHECK_EQUAL(dst[2], 1.0f);
+  BOOST_CHECK_EQUAL(dst[3], -1.0f);
+  avx2::InternalPow(8, dst, special, specialExponent);
+  BOOST_CHECK(std::isinf(dst[0]));
+  BOOST_CHECK_EQUAL(dst[1], -1.0f);
+  BOOST_CHECK_EQUAL(dst[2], 1.0f);
+  BOOST_CHECK(std::isinf(dst[3]) && dst[3] > 0);
+  BOOST_CHECK(std::isnan(dst[4]));
+  BOOST_CHECK_EQUAL(dst[5], 4.0f);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cmath>
 #include <boost/test/unit_test.hpp>
 #include "ProcessorCaps.hpp"
@@ -255,6 +256,12 @@ BOOST_AUTO_TEST_CASE(TestAvxArraySum)
                           &sum,
                           src);
   BOOST_CHECK_EQUAL(sum, refVal);
+
+  // Shorter than a register, only the scalar tail runs
+  avx::InternalSummation(5, &sum, src);
+  BOOST_CHECK_EQUAL(sum, 10);
+  avx::InternalSummation(0, &sum, src);
+  BOOST_CHECK_EQUAL(sum, 0);
 }
 
 BOOST_AUTO_TEST_CASE(TestAvxDotProductSinglePrecision)
@@ -356,4 +363,342 @@ BOOST_AUTO_TEST_CASE(TestAvxReciprocate)
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestAvxReciprocalPrecision)
+{
+  if ( !caps.IsAvx() ) {
+    return;
+  }
+
+  alignas(32) sp_t src[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t dst[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = (i + 1) / 7.0f;
+  }
+
+  // Relative tolerances in percent: 1.5*2^-12 for the estimates and 2^-21 after the Newton-Raphson step
+  avx::InternalApproximateReciprocate(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / (dp_t)src[i], 0.037);
+  }
+  avx::InternalRefinedReciprocate(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / (dp_t)src[i], 4.8e-5);
+  }
+  avx::InternalApproximateRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / std::sqrt((dp_t)src[i]), 0.037);
+  }
+  avx::InternalRefinedRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / std::sqrt((dp_t)src[i]), 4.8e-5);
+  }
+  avx::InternalRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_EQUAL(dst[i], 1.0f / std::sqrt(src[i]));
+  }
+
+  // The tail is padded into a full register, the estimates have to match the elements computed in the vector loop
+  alignas(32) sp_t tail[7];
+  avx::InternalRefinedReciprocate(7, tail, src + 8);
+  avx::InternalRefinedReciprocate(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < 7; ++i ) {
+    BOOST_CHECK_EQUAL(tail[i], dst[8 + i]);
+  }
+  avx::InternalApproximateRsqrt(7, tail, src + 8);
+  avx::InternalApproximateRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < 7; ++i ) {
+    BOOST_CHECK_EQUAL(tail[i], dst[8 + i]);
+  }
+
+  // The Newton-Raphson step keeps the limits of the estimate instead of turning them into NaN
+  alignas(32) sp_t special[8] = { 0.0f, -0.0f, INFINITY, -INFINITY, 1e-40f, -4.0f, 4.0f, 0.25f };
+  avx::InternalRefinedReciprocate(8, dst, special);
+  BOOST_CHECK(std::isinf(dst[0]) && dst[0] > 0);
+  BOOST_CHECK(std::isinf(dst[1]) && dst[1] < 0);
+  BOOST_CHECK_EQUAL(dst[2], 0.0f);
+  BOOST_CHECK_EQUAL(dst[3], 0.0f);
+  BOOST_CHECK(std::isinf(dst[4]) && dst[4] > 0);
+  BOOST_CHECK_CLOSE(dst[5], -0.25f, 4.8e-5);
+  avx::InternalRefinedRsqrt(8, dst, special);
+  BOOST_CHECK(std::isinf(dst[0]) && dst[0] > 0);
+  BOOST_CHECK_EQUAL(dst[2], 0.0f);
+  BOOST_CHECK(std::isnan(dst[3]));
+  BOOST_CHECK(std::isinf(dst[4]) && dst[4] > 0);
+  BOOST_CHECK(std::isnan(dst[5]));
+  BOOST_CHECK_CLOSE(dst[7], 2.0f, 4.8e-5);
+}
+
+BOOST_AUTO_TEST_CASE(TestAvxDoublePrecision)
+{
+  if ( !caps.IsAvx() ) {
+    return;
+  }
+
+  alignas(32) dp_t lhs[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t rhs[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t sum[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t quotient[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t negated[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t root[TEST_VECTOR_LENGTH];
+  dp_t refProduct = 0;
+  dp_t refDistance = 0;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    lhs[i] = i * 1.5;
+    rhs[i] = i + 1;
+    refProduct += lhs[i] * rhs[i];
+    refDistance += (lhs[i] - rhs[i]) * (lhs[i] - rhs[i]);
+  }
+  refDistance = std::sqrt(refDistance);
+
+  avx::InternalAdd(TEST_VECTOR_LENGTH, sum, lhs, rhs);
+  avx::InternalDiv(TEST_VECTOR_LENGTH, quotient, lhs, rhs);
+  avx::InternalNegate(TEST_VECTOR_LENGTH, negated, lhs);
+  avx::InternalSqrt(TEST_VECTOR_LENGTH, root, rhs);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( sum[i] != lhs[i] + rhs[i] ||
+         quotient[i] != lhs[i] / rhs[i] ||
+         negated[i] != -lhs[i] ||
+         root[i] != std::sqrt(rhs[i]) ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+
+  dp_t result;
+  avx::InternalDotProduct(TEST_VECTOR_LENGTH, &result, lhs, rhs);
+  BOOST_CHECK_CLOSE(result, refProduct, 1e-10);
+  avx::InternalDistance(TEST_VECTOR_LENGTH, &result, lhs, rhs);
+  BOOST_CHECK_CLOSE(result, refDistance, 1e-10);
+
+  if ( !caps.IsFma() ) {
+    return;
+  }
+
+  avx::InternalDotProductFma(TEST_VECTOR_LENGTH, &result, lhs, rhs);
+  BOOST_CHECK_CLOSE(result, refProduct, 1e-10);
+  avx::InternalDistanceFma(TEST_VECTOR_LENGTH, &result, lhs, rhs);
+  BOOST_CHECK_CLOSE(result, refDistance, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(TestAvxPrefixSum)
+{
+  if ( !caps.IsAvx() ) {
+    return;
+  }
+
+  // Small integral values keep every floating point prefix sum exact
+  alignas(32) sp_t spSrc[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t spInclusive[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t spExclusive[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t dpSrc[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t dpInclusive[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t dpExclusive[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    spSrc[i] = i % 7;
+    dpSrc[i] = i % 7;
+  }
+
+  avx::InternalPrefixSum(TEST_VECTOR_LENGTH, 10, spInclusive, spSrc);
+  avx::InternalExclusivePrefixSum(TEST_VECTOR_LENGTH, 10, spExclusive, spSrc);
+  sp_t spRunning = 10;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( spExclusive[i] != spRunning ||
+         spInclusive[i] != spRunning + spSrc[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+    spRunning += spSrc[i];
+  }
+
+  avx::InternalPrefixSum(TEST_VECTOR_LENGTH, 10, dpInclusive, dpSrc);
+  avx::InternalExclusivePrefixSum(TEST_VECTOR_LENGTH, 10, dpExclusive, dpSrc);
+  dp_t dpRunning = 10;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( dpExclusive[i] != dpRunning ||
+         dpInclusive[i] != dpRunning + dpSrc[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+    dpRunning += dpSrc[i];
+  }
+
+  // In place, dst == src
+  avx::InternalExclusivePrefixSum(TEST_VECTOR_LENGTH, 10, spSrc, spSrc);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( spSrc[i] != spExclusive[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAvxExtrema)
+{
+  if ( !caps.IsAvx() ) {
+    return;
+  }
+
+  // Every value recurs several times, in different lanes, so the first index has to win the ties
+  alignas(32) sp_t spSrc[TEST_VECTOR_LENGTH];
+  alignas(32) dp_t dpSrc[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    spSrc[i] = (i * 37 + 50) % 101;
+    dpSrc[i] = (i * 37 + 50) % 101;
+  }
+
+  sp_t spExtreme;
+  Extrema<sp_t> spExtrema;
+  size_t spIndex;
+  avx::InternalMinimum(TEST_VECTOR_LENGTH, &spExtreme, spSrc);
+  BOOST_CHECK_EQUAL(spExtreme, *std::min_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  avx::InternalMaximum(TEST_VECTOR_LENGTH, &spExtreme, spSrc);
+  BOOST_CHECK_EQUAL(spExtreme, *std::max_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  avx::InternalMinMaximum(TEST_VECTOR_LENGTH, &spExtrema, spSrc);
+  BOOST_CHECK_EQUAL(spExtrema.minimum, *std::min_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  BOOST_CHECK_EQUAL(spExtrema.maximum, *std::max_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  avx::InternalArgMinimum(TEST_VECTOR_LENGTH, &spIndex, spSrc);
+  BOOST_CHECK_EQUAL(spIndex, std::min_element(spSrc, spSrc + TEST_VECTOR_LENGTH) - spSrc);
+  avx::InternalArgMaximum(TEST_VECTOR_LENGTH, &spIndex, spSrc);
+  BOOST_CHECK_EQUAL(spIndex, std::max_element(spSrc, spSrc + TEST_VECTOR_LENGTH) - spSrc);
+
+  spSrc[400] = NAN;
+  spSrc[300] = NAN;
+  avx::InternalMinimum(TEST_VECTOR_LENGTH, &spExtreme, spSrc);
+  BOOST_CHECK(std::isnan(spExtreme));
+  avx::InternalMinMaximum(TEST_VECTOR_LENGTH, &spExtrema, spSrc);
+  BOOST_CHECK(std::isnan(spExtrema.minimum) && std::isnan(spExtrema.maximum));
+  avx::InternalArgMaximum(TEST_VECTOR_LENGTH, &spIndex, spSrc);
+  BOOST_CHECK_EQUAL(spIndex, 300);
+
+  dp_t dpExtreme;
+  Extrema<dp_t> dpExtrema;
+  size_t dpIndex;
+  avx::InternalMinimum(TEST_VECTOR_LENGTH, &dpExtreme, dpSrc);
+  BOOST_CHECK_EQUAL(dpExtreme, *std::min_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH));
+  avx::InternalMaximum(TEST_VECTOR_LENGTH, &dpExtreme, dpSrc);
+  BOOST_CHECK_EQUAL(dpExtreme, *std::max_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH));
+  avx::InternalMinMaximum(TEST_VECTOR_LENGTH, &dpExtrema, dpSrc);
+  BOOST_CHECK_EQUAL(dpExtrema.minimum, *std::min_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH));
+  BOOST_CHECK_EQUAL(dpExtrema.maximum, *std::max_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH));
+  avx::InternalArgMinimum(TEST_VECTOR_LENGTH, &dpIndex, dpSrc);
+  BOOST_CHECK_EQUAL(dpIndex, std::min_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH) - dpSrc);
+  avx::InternalArgMaximum(TEST_VECTOR_LENGTH, &dpIndex, dpSrc);
+  BOOST_CHECK_EQUAL(dpIndex, std::max_element(dpSrc, dpSrc + TEST_VECTOR_LENGTH) - dpSrc);
+
+  dpSrc[400] = NAN;
+  dpSrc[300] = NAN;
+  avx::InternalMinimum(TEST_VECTOR_LENGTH, &dpExtreme, dpSrc);
+  BOOST_CHECK(std::isnan(dpExtreme));
+  avx::InternalMinMaximum(TEST_VECTOR_LENGTH, &dpExtrema, dpSrc);
+  BOOST_CHECK(std::isnan(dpExtrema.minimum) && std::isnan(dpExtrema.maximum));
+  avx::InternalArgMaximum(TEST_VECTOR_LENGTH, &dpIndex, dpSrc);
+  BOOST_CHECK_EQUAL(dpIndex, 300);
+}
+
+BOOST_AUTO_TEST_CASE(TestAvxTranscendentals)
+{
+  if ( !caps.IsAvx() ) {
+    return;
+  }
+
+  // Relative tolerances in percent: 3e-5 is about 2.5 ulp of a float
+  alignas(32) sp_t src[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t positive[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t exponent[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t dst[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = (i - 257) / 32.0f;
+    positive[i] = (i + 1) / 64.0f;
+    exponent[i] = (i % 13 - 6) / 4.0f;
+  }
+
+  avx::InternalExp(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::exp((dp_t)src[i]), 3e-5);
+  }
+  avx::InternalLog(TEST_VECTOR_LENGTH, dst, positive);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::log((dp_t)positive[i]), 3e-5);
+  }
+  avx::InternalLog2(TEST_VECTOR_LENGTH, dst, positive);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::log2((dp_t)positive[i]), 3e-5);
+  }
+  // The error of sin and cos is bounded in ulp only away from their roots
+  avx::InternalSin(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_SMALL(dst[i] - std::sin((dp_t)src[i]), 2.4e-7);
+  }
+  avx::InternalCos(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_SMALL(dst[i] - std::cos((dp_t)src[i]), 2.4e-7);
+  }
+  avx::InternalTanh(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::tanh((dp_t)src[i]), 3e-5);
+  }
+  avx::InternalSigmoid(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / (1 + std::exp(-(dp_t)src[i])), 4e-5);
+  }
+  avx::InternalPow(TEST_VECTOR_LENGTH, dst, positive, exponent);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    dp_t power = std::log2((dp_t)positive[i]) * exponent[i];
+    BOOST_CHECK_CLOSE(dst[i], std::pow((dp_t)positive[i], (dp_t)exponent[i]), (2 + 1.2 * std::abs(power)) * 1.2e-5);
+  }
+
+  // The tail is padded into a full register, it has to match the elements computed in the vector loop
+  alignas(32) sp_t tail[3];
+  avx::InternalExp(3, tail, src + 8);
+  avx::InternalExp(TEST_VECTOR_LENGTH, dst, src);
+  BOOST_CHECK_EQUAL(tail[0], dst[8]);
+  BOOST_CHECK_EQUAL(tail[2], dst[10]);
+
+  alignas(32) sp_t special[8] = { 0.0f, -1.0f, INFINITY, -INFINITY, -2.0f, 2.0f, 2.0f, 2.0f };
+  alignas(32) sp_t specialExponent[8] = { -1.0f, 3.0f, 0.0f, 0.5f, 0.5f, 2.0f, 2.0f, 2.0f };
+  avx::InternalLog(8, dst, special);
+  BOOST_CHECK(std::isinf(dst[0]) && dst[0] < 0);
+  BOOST_CHECK(std::isnan(dst[1]));
+  BOOST_CHECK(std::isinf(dst[2]) && dst[2] > 0);
+  BOOST_CHECK(std::isnan(dst[3]));
+  avx::InternalExp(8, dst, special);
+  BOOST_CHECK_EQUAL(dst[0], 1.0f);
+  BOOST_CHECK(std::isinf(dst[2]));
+  BOOST_CHECK_EQUAL(dst[3], 0.0f);
+  avx::InternalTanh(8, dst, special);
+  BOOST_CHECK_EQUAL(dst[2], 1.0f);
+  BOOST_CHECK_EQUAL(dst[3], -1.0f);
+  avx::InternalPow(8, dst, special, specialExponent);
+  BOOST_CHECK(std::isinf(dst[0]));
+  BOOST_CHECK_EQUAL(dst[1], -1.0f);
+  BOOST_CHECK_EQUAL(dst[2], 1.0f);
+  BOOST_CHECK(std::isinf(dst[3]) && dst[3] > 0);
+  BOOST_CHECK(std::isnan(dst[4]));
+  BOOST_CHECK_EQUAL(dst[5], 4.0f);
+}
+
+BOOST_AUTO_TEST_CASE(TestAvxStreamingCopy)
+{
+  if ( !caps.IsAvx() ) {
+    return;
+  }
+
+  // Every alignment of the destination and lengths that end before, on and after a full unrolled iteration
+  alignas(32) uint8_t src[4 * TEST_VECTOR_LENGTH];
+  alignas(32) uint8_t dst[4 * TEST_VECTOR_LENGTH + 64];
+  for ( size_t i = 0; i < sizeof(src); ++i ) {
+    src[i] = (uint8_t)(i * 7 + 3);
+  }
+  const size_t lengths[] = { 0, 5, 128, 161, 4 * TEST_VECTOR_LENGTH - 1 };
+  for ( size_t misalignment = 0; misalignment < 33; ++misalignment ) {
+    for ( auto bytes : lengths ) {
+      std::fill(dst, dst + sizeof(dst), 0);
+      avx::InternalStreamingCopy(bytes, dst + misalignment, src + 1);
+      BOOST_CHECK(std::equal(src + 1, src + 1 + bytes, dst + misalignment));
+      BOOST_CHECK(std::count(dst, dst + misalignment, 0) == (long)misalignment);
+      BOOST_CHECK(std::count(dst + misalignment + bytes, dst + sizeof(dst), 0) == (long)(sizeof(dst) - misalignment - bytes));
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,157 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <thread>
+#include <malloc.h>
+#include <boost/test/unit_test.hpp>
+#include "Array.hpp"
+#include "BufferPool.hpp"
+
+BOOST_AUTO_TEST_SUITE(BufferPoolTestSuite)
+
+using namespace khyber;
+
+BOOST_AUTO_TEST_CASE(TestBufferPoolReuse)
+{
+  BufferPool::Trim();
+  BufferPool::ResetStatistics();
+
+  // A released block is handed out again for any request of its size class
+  void* first = BufferPool::Allocate(1000, 32);
+  BOOST_REQUIRE(first != nullptr);
+  BOOST_CHECK_EQUAL((size_t)first % POOL_BLOCK_ALIGNMENT, 0);
+  BufferPool::Release(first, 1000, 32);
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().cachedBytes, 1024);
+  void* second = BufferPool::Allocate(1020, 16);
+  BOOST_CHECK_EQUAL(first, second);
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().hits, 1);
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().cachedBytes, 0);
+
+  // The next class up is a different block
+  void* larger = BufferPool::Allocate(1025, 32);
+  BOOST_CHECK(larger != second);
+  BufferPool::Release(second, 1020, 16);
+  BufferPool::Release(larger, 1025, 32);
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().cachedBytes, 1024 + 1280);
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().peakCachedBytes, 1024 + 1280);
+
+  // Blocks too large to pool go back to the system
+  void* huge = BufferPool::Allocate(POOL_MAX_BLOCK_BYTES + 1, 32);
+  BufferPool::Release(huge, POOL_MAX_BLOCK_BYTES + 1, 32);
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().systemReleases, 1);
+
+  // A block released by another thread is cached by that thread
+  void* foreign = BufferPool::Allocate(4096, 32);
+  std::thread([foreign]() {
+    BufferPool::Release(foreign, 4096, 32);
+    BOOST_CHECK_EQUAL(BufferPool::Statistics().cachedBytes, 4096);
+  }).join();
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().cachedBytes, 1024 + 1280);
+
+  BufferPool::Trim();
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().cachedBytes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestBufferPoolCacheLimit)
+{
+  size_t limit = BufferPool::GetCacheLimit();
+  BufferPool::Trim();
+  BufferPool::ResetStatistics();
+
+  BufferPool::SetCacheLimit(3000);
+  void* a = BufferPool::Allocate(2048, 32);
+  void* b = BufferPool::Allocate(2048, 32);
+  BufferPool::Release(a, 2048, 32);
+  BufferPool::Release(b, 2048, 32);
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().cachedBytes, 2048);
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().systemReleases, 1);
+
+  // No limit, no pooling
+  BufferPool::Trim();
+  BufferPool::SetCacheLimit(0);
+  a = BufferPool::Allocate(2048, 32);
+  BufferPool::Release(a, 2048, 32);
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().cachedBytes, 0);
+  BOOST_CHECK_EQUAL(BufferPool::Statistics().hits, 0);
+  BufferPool::SetCacheLimit(limit);
+}
+
+// Allocates a block when its thread exits, after the cache of the thread is gone
+struct LateAllocation
+{
+  void* block;
+
+  LateAllocation() : block(nullptr)
+  {
+  }
+
+  ~LateAllocation()
+  {
+    block = BufferPool::Allocate(1000, 32);
+    t_lateBlock = block;
+  }
+
+  static void* t_lateBlock;
+};
+
+void* LateAllocation::t_lateBlock = nullptr;
+
+BOOST_AUTO_TEST_CASE(TestBufferPoolDestroyedCache)
+{
+  BufferPool::Trim();
+  BufferPool::ResetStatistics();
+
+  // Constructed before the cache of the thread, so destroyed after it
+  std::thread([]() {
+    static thread_local LateAllocation late;
+    late.block = nullptr;
+    BufferPool::Release(BufferPool::Allocate(1000, 32), 1000, 32);
+  }).join();
+  void* block = LateAllocation::t_lateBlock;
+  BOOST_REQUIRE(block != nullptr);
+
+  // The block is still a whole size class, so it can be pooled and handed out for any request of that class
+  BOOST_CHECK_EQUAL((size_t)block % POOL_BLOCK_ALIGNMENT, 0);
+  BOOST_REQUIRE_GE(malloc_usable_size(block), 1024);
+  BufferPool::Release(block, 1000, 32);
+  void* reused = BufferPool::Allocate(1020, 16);
+  BOOST_CHECK_EQUAL(reused, block);
+  memset(reused, 0, 1020);
+  BufferPool::Release(reused, 1020, 16);
+  BufferPool::Trim();
+}
+
+BOOST_AUTO_TEST_CASE(TestBufferPoolArrayTemporaries)
+{
+  SinglePrecisionArray a(10000), b(10000);
+  for ( size_t i = 0; i < a.size(); ++i ) {
+    a[i] = i;
+    b[i] = 2.0f * i;
+  }
+  BufferPool::Trim();
+  BufferPool::ResetStatistics();
+
+  // Only the first temporary reaches the system allocator
+  for ( size_t i = 0; i < 100; ++i ) {
+    SinglePrecisionArray sum = a.Add(b);
+    BOOST_CHECK_EQUAL(sum[i], 3.0f * i);
+  }
+  BufferPoolStatistics statistics = BufferPool::Statistics();
+  BOOST_CHECK_EQUAL(statistics.allocations, 100);
+  BOOST_CHECK_EQUAL(statistics.hits, 99);
+  BOOST_CHECK_EQUAL(statistics.releases, 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
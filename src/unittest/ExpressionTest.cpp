@@ -0,0 +1,88 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <boost/test/unit_test.hpp>
+#include "Array.hpp"
+
+// Longer than two tiles and not a multiple of 8 so every loop tail is exercised
+#define TEST_VECTOR_LENGTH 1037
+
+BOOST_AUTO_TEST_SUITE(ExpressionTestSuite)
+
+using namespace khyber;
+
+BOOST_AUTO_TEST_CASE(TestExpressionFused)
+{
+  SinglePrecisionArray a(TEST_VECTOR_LENGTH);
+  SinglePrecisionArray b(TEST_VECTOR_LENGTH);
+  SinglePrecisionArray c(TEST_VECTOR_LENGTH);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    a[i] = i + 1;
+    b[i] = 0.5f * i;
+    c[i] = 3.0f;
+  }
+
+  SinglePrecisionArray d = sqrt((a + b) * c - 1.0f);
+  BOOST_CHECK_EQUAL(d.size(), TEST_VECTOR_LENGTH);
+  SinglePrecisionArray chained = a.Add(b).Mul(c);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( d[i] != std::sqrt(chained[i] - 1.0f) ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestExpressionScalars)
+{
+  SinglePrecisionArray a(TEST_VECTOR_LENGTH);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    a[i] = i + 1;
+  }
+
+  SinglePrecisionArray d(3);
+  d = 2.0f * a + 1.0f - a / 4.0f;
+  BOOST_CHECK_EQUAL(d.size(), TEST_VECTOR_LENGTH);
+  SinglePrecisionArray e = 10.0f - a;
+  SinglePrecisionArray f = 1.0f / a;
+  SinglePrecisionArray g = -a;
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(d[i], 2.0f * a[i] + 1.0f - a[i] / 4.0f, 0.0001);
+    BOOST_CHECK_EQUAL(e[i], 10.0f - a[i]);
+    BOOST_CHECK_EQUAL(f[i], 1.0f / a[i]);
+    BOOST_CHECK_EQUAL(g[i], -a[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestExpressionAliased)
+{
+  SinglePrecisionArray a(TEST_VECTOR_LENGTH);
+  SinglePrecisionArray b(TEST_VECTOR_LENGTH);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    a[i] = i;
+    b[i] = 2.0f;
+  }
+
+  // a is read by the left subtree after the right one has been computed, it must not be overwritten before that
+  a = (b + b) * a + a;
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( a[i] != 5.0f * i ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <boost/test/unit_test.hpp>
+#include "Array.hpp"
+#include "HugePages.hpp"
+
+// One and a half huge pages of floats, so the last page is partly used
+#define TEST_VECTOR_LENGTH (3 * HUGE_PAGE_BYTES / 8)
+
+BOOST_AUTO_TEST_SUITE(HugePagesTestSuite)
+
+using namespace khyber;
+
+static bool HugePageAligned(const void* p)
+{
+  return (size_t)p % HUGE_PAGE_BYTES == 0;
+}
+
+BOOST_AUTO_TEST_CASE(TestHugePagesArray)
+{
+  HugePageStatistics before = HugePages::Statistics();
+  SinglePrecisionArray a(TEST_VECTOR_LENGTH, TransparentHugePages);
+  SinglePrecisionArray b(TEST_VECTOR_LENGTH, ExplicitHugePages);
+  BOOST_CHECK_EQUAL(a.GetPageMode(), TransparentHugePages);
+  BOOST_CHECK(HugePageAligned(a.data()));
+  BOOST_CHECK(HugePageAligned(b.data()));
+
+  // Without reserved huge pages the explicit request falls back to transparent ones
+  HugePageStatistics after = HugePages::Statistics();
+  BOOST_CHECK_EQUAL(after.transparentAllocations - before.transparentAllocations,
+                    1 + after.explicitFallbacks - before.explicitFallbacks);
+  BOOST_CHECK_EQUAL(after.explicitAllocations - before.explicitAllocations + after.explicitFallbacks - before.explicitFallbacks, 1);
+
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    a[i] = i % 1000;
+    b[i] = 2.0f;
+  }
+  a.Mul(a, b);
+  BOOST_CHECK_EQUAL(a[TEST_VECTOR_LENGTH - 1], 2.0f * ((TEST_VECTOR_LENGTH - 1) % 1000));
+
+  // Growing past the capacity keeps the page mode, moving takes it along
+  a.resize(2 * TEST_VECTOR_LENGTH);
+  BOOST_CHECK(HugePageAligned(a.data()));
+  BOOST_CHECK_EQUAL(a[TEST_VECTOR_LENGTH - 1], 2.0f * ((TEST_VECTOR_LENGTH - 1) % 1000));
+  SinglePrecisionArray moved;
+  moved = std::move(a);
+  BOOST_CHECK_EQUAL(moved.GetPageMode(), TransparentHugePages);
+  BOOST_CHECK(HugePageAligned(moved.data()));
+
+  // Buffers smaller than a huge page keep using regular pages
+  SinglePrecisionArray small(1000, TransparentHugePages);
+  before = HugePages::Statistics();
+  small.resize(2000);
+  BOOST_CHECK_EQUAL(HugePages::Statistics().transparentAllocations, before.transparentAllocations);
+}
+
+BOOST_AUTO_TEST_CASE(TestHugePagesDefaultMode)
+{
+  BOOST_CHECK_EQUAL(HugePages::GetDefaultMode(), SmallPages);
+  SinglePrecisionArray a(TEST_VECTOR_LENGTH, SmallPages), b(TEST_VECTOR_LENGTH, SmallPages);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    a[i] = 1.0f;
+    b[i] = i % 7;
+  }
+
+  // The arrays returned by the operations follow the default mode
+  HugePages::SetDefaultMode(TransparentHugePages);
+  SinglePrecisionArray sum = a.Add(b);
+  HugePages::SetDefaultMode(SmallPages);
+  BOOST_CHECK_EQUAL(sum.GetPageMode(), TransparentHugePages);
+  BOOST_CHECK(HugePageAligned(sum.data()));
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; i += 4093 ) {
+    BOOST_CHECK_EQUAL(sum[i], 1.0f + i % 7);
+  }
+  BOOST_CHECK_EQUAL(a.Add(b).GetPageMode(), SmallPages);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,217 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include "Matrix.hpp"
+
+BOOST_AUTO_TEST_SUITE(MatrixTestSuite)
+
+using namespace khyber;
+
+template<typename T>
+static Matrix<T> MakeMatrix(size_t rows, size_t columns, size_t seed)
+{
+  Matrix<T> matrix(rows, columns);
+  for ( size_t r = 0; r < rows; ++r ) {
+    for ( size_t c = 0; c < columns; ++c ) {
+      matrix(r, c) = (T)((int)((r * 31 + c * 17 + seed) % 23) - 11) / 8;
+    }
+  }
+  return matrix;
+}
+
+///
+/// \brief Checks product against the naive product of lhs and rhs. The elements are multiples of 1/8 below 2, so every partial
+/// sum is exact in single precision for these depths and the results must match exactly whatever the summation order.
+///
+template<typename T>
+static void CheckProduct(const Matrix<T>& lhs, const Matrix<T>& rhs, const Matrix<T>& product)
+{
+  BOOST_REQUIRE_EQUAL(product.rows(), lhs.rows());
+  BOOST_REQUIRE_EQUAL(product.columns(), rhs.columns());
+  size_t mismatches = 0;
+  for ( size_t r = 0; r < lhs.rows(); ++r ) {
+    for ( size_t c = 0; c < rhs.columns(); ++c ) {
+      T expected = 0;
+      for ( size_t k = 0; k < lhs.columns(); ++k ) {
+        expected += lhs(r, k) * rhs(k, c);
+      }
+      mismatches += product(r, c) != expected;
+    }
+  }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestMatrixBasics)
+{
+  SinglePrecisionMatrix m(3, 5);
+  BOOST_CHECK_EQUAL(m.rows(), 3);
+  BOOST_CHECK_EQUAL(m.columns(), 5);
+  BOOST_CHECK_EQUAL(m.size(), 15);
+  m(2, 4) = 7.0f;
+  BOOST_CHECK_EQUAL(m.data()[14], 7.0f);
+  BOOST_CHECK_EQUAL(m.Row(2).Summation(), 7.0f);
+  m.Elements().TransformScalarMul(2.0f);
+  BOOST_CHECK_EQUAL(m(2, 4), 14.0f);
+
+  SinglePrecisionMatrix moved(std::move(m));
+  BOOST_CHECK_EQUAL(moved(2, 4), 14.0f);
+  BOOST_CHECK_EQUAL(m.rows(), 0);
+
+  SinglePrecisionMatrix other(4, 2);
+  BOOST_CHECK_THROW(moved.Mul(other), std::invalid_argument);
+  BOOST_CHECK_THROW(moved.Mul(moved, SinglePrecisionMatrix(5, 5)), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(TestMatrixProduct)
+{
+  const uint64_t masks[] = { 0,
+                             BM_FMA,
+                             BM_AVX2,
+                             BM_AVX | BM_AVX2 | BM_FMA,
+                             BM_AVX | BM_AVX2 | BM_FMA | BM_SSE4_1 };
+  const size_t shapes[][3] = { { 1, 1, 1 }, { 7, 13, 5 }, { 6, 16, 32 }, { 61, 97, 83 }, { 130, 70, 300 } };
+  for ( auto mask : masks ) {
+    ProcessorCaps downgradedCaps = ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    SinglePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+    DoublePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+
+    for ( auto& shape : shapes ) {
+      SinglePrecisionMatrix lhs = MakeMatrix<float>(shape[0], shape[2], 1);
+      SinglePrecisionMatrix rhs = MakeMatrix<float>(shape[2], shape[1], 2);
+      CheckProduct(lhs, rhs, lhs.Mul(rhs));
+
+      // Blocks much smaller than the operands exercise every partial block and tile
+      SinglePrecisionMatrix blocked;
+      blocked.Mul(lhs, rhs, GemmBlocking { 16, 2 * ArchBinding<float>::Active().GemmRows, 3 * ArchBinding<float>::Active().GemmColumns });
+      CheckProduct(lhs, rhs, blocked);
+
+      DoublePrecisionMatrix lhs64 = MakeMatrix<double>(shape[0], shape[2], 3);
+      DoublePrecisionMatrix rhs64 = MakeMatrix<double>(shape[2], shape[1], 4);
+      CheckProduct(lhs64, rhs64, lhs64.Mul(rhs64));
+    }
+  }
+  SinglePrecisionArray::OverrideProcessorCaps(ProcessorCaps::Host());
+  DoublePrecisionArray::OverrideProcessorCaps(ProcessorCaps::Host());
+
+  // Blocks that are not multiples of the register tile are rounded up to it, and empty ones to a single element
+  SinglePrecisionMatrix lhs = MakeMatrix<float>(37, 53, 5);
+  SinglePrecisionMatrix rhs = MakeMatrix<float>(53, 29, 6);
+  const GemmBlocking blockings[] = { { 16, 5, 16 }, { 7, 1, 3 }, { 0, 0, 0 }, { 1, 13, 0 } };
+  for ( auto& blocking : blockings ) {
+    SinglePrecisionMatrix blocked;
+    blocked.Mul(lhs, rhs, blocking);
+    CheckProduct(lhs, rhs, blocked);
+  }
+
+  // An empty inner dimension gives a zero product
+  SinglePrecisionMatrix zero = SinglePrecisionMatrix(4, 0).Mul(SinglePrecisionMatrix(0, 3));
+  BOOST_CHECK_EQUAL(zero.rows(), 4);
+  BOOST_CHECK_EQUAL(zero.Elements().Summation(), 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(TestMatrixParallelProduct)
+{
+  ThreadPool& pool = ThreadPool::Instance();
+  pool.SetThreadCount(4);
+
+  // Tall, square and wide products split over rows, or over the columns of the panels when there are few rows
+  const size_t shapes[][3] = { { 300, 40, 200 }, { 180, 190, 170 }, { 8, 1500, 200 } };
+  for ( auto& shape : shapes ) {
+    SinglePrecisionMatrix lhs = MakeMatrix<float>(shape[0], shape[2], 5);
+    SinglePrecisionMatrix rhs = MakeMatrix<float>(shape[2], shape[1], 6);
+    CheckProduct(lhs, rhs, lhs.Mul(rhs));
+    SinglePrecisionMatrix blocked;
+    blocked.Mul(lhs, rhs, GemmBlocking { 64, 4 * ArchBinding<float>::Active().GemmRows, 5 * ArchBinding<float>::Active().GemmColumns });
+    CheckProduct(lhs, rhs, blocked);
+  }
+  pool.SetThreadCount(0);
+}
+
+///
+/// \brief Checks MulVec and TransposedMulVec of matrix against the naive products, exact for the same reason as CheckProduct( )
+///
+template<typename T>
+static void CheckVectorProducts(const Matrix<T>& matrix)
+{
+  Array<T> vector(matrix.columns());
+  for ( size_t i = 0; i < vector.size(); ++i ) {
+    vector[i] = (T)((int)(i * 7 % 13) - 6) / 8;
+  }
+  Array<T> product = matrix.MulVec(vector);
+  BOOST_REQUIRE_EQUAL(product.size(), matrix.rows());
+  size_t mismatches = 0;
+  for ( size_t r = 0; r < matrix.rows(); ++r ) {
+    T expected = 0;
+    for ( size_t c = 0; c < matrix.columns(); ++c ) {
+      expected += matrix(r, c) * vector[c];
+    }
+    mismatches += product[r] != expected;
+  }
+
+  Array<T> transposedVector(matrix.rows());
+  for ( size_t i = 0; i < transposedVector.size(); ++i ) {
+    transposedVector[i] = (T)((int)(i * 5 % 11) - 5) / 8;
+  }
+  Array<T> transposedProduct = matrix.TransposedMulVec(transposedVector);
+  BOOST_REQUIRE_EQUAL(transposedProduct.size(), matrix.columns());
+  for ( size_t c = 0; c < matrix.columns(); ++c ) {
+    T expected = 0;
+    for ( size_t r = 0; r < matrix.rows(); ++r ) {
+      expected += matrix(r, c) * transposedVector[r];
+    }
+    mismatches += transposedProduct[c] != expected;
+  }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestMatrixVectorProduct)
+{
+  const uint64_t masks[] = { 0, BM_FMA, BM_AVX | BM_AVX2 | BM_FMA | BM_SSE4_1 };
+  // Row counts around the four-row groups, column counts around the 8 and 16 element strides of the kernels
+  const size_t shapes[][2] = { { 1, 1 }, { 3, 7 }, { 4, 8 }, { 5, 16 }, { 9, 25 }, { 63, 130 }, { 200, 3000 } };
+  for ( auto mask : masks ) {
+    ProcessorCaps downgradedCaps = ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    SinglePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+    DoublePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+
+    for ( auto& shape : shapes ) {
+      CheckVectorProducts(MakeMatrix<float>(shape[0], shape[1], 7));
+      CheckVectorProducts(MakeMatrix<double>(shape[0], shape[1], 8));
+    }
+  }
+  SinglePrecisionArray::OverrideProcessorCaps(ProcessorCaps::Host());
+  DoublePrecisionArray::OverrideProcessorCaps(ProcessorCaps::Host());
+
+  SinglePrecisionMatrix matrix(3, 5);
+  BOOST_CHECK_THROW(matrix.MulVec(SinglePrecisionArray(3)), std::invalid_argument);
+  BOOST_CHECK_THROW(matrix.TransposedMulVec(SinglePrecisionArray(5)), std::invalid_argument);
+  BOOST_CHECK_EQUAL(SinglePrecisionMatrix(0, 4).MulVec(SinglePrecisionArray(4)).size(), 0);
+  BOOST_CHECK_EQUAL(SinglePrecisionMatrix(0, 4).TransposedMulVec(SinglePrecisionArray(0)).Summation(), 0.0f);
+
+  // Split across the pool over rows, and over column chunks of several tiles for the transposed product
+  ThreadPool& pool = ThreadPool::Instance();
+  pool.SetThreadCount(4);
+  pool.SetParallelThreshold(1000);
+  CheckVectorProducts(MakeMatrix<float>(37, 9000, 9));
+  CheckVectorProducts(MakeMatrix<float>(501, 40, 10));
+  pool.SetParallelThreshold(DEFAULT_PARALLEL_THRESHOLD);
+  pool.SetThreadCount(0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
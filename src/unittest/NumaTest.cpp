@@ -0,0 +1,81 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include "Array.hpp"
+#include "Numa.hpp"
+
+// Two huge pages of floats, above the parallel threshold of the tests
+#define TEST_VECTOR_LENGTH (HUGE_PAGE_BYTES / 2)
+
+BOOST_AUTO_TEST_SUITE(NumaTestSuite)
+
+using namespace khyber;
+
+BOOST_AUTO_TEST_CASE(TestNumaNodes)
+{
+  const std::vector<int>& nodes = Numa::Nodes();
+  BOOST_REQUIRE_GE(Numa::NodeCount(), 1);
+  BOOST_CHECK(std::find(nodes.begin(), nodes.end(), Numa::CurrentNode()) != nodes.end());
+
+  // Small buffers and the default placement are left to the kernel, and so is everything on a single node
+  BOOST_CHECK(!Numa::Applies(TEST_VECTOR_LENGTH * sizeof(float), DefaultPlacement));
+  BOOST_CHECK(!Numa::Applies(4096, InterleavedPlacement));
+  BOOST_CHECK_EQUAL(Numa::Applies(TEST_VECTOR_LENGTH * sizeof(float), PartitionedPlacement), Numa::NodeCount() > 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestNumaPlacedArrays)
+{
+  ThreadPool& pool = ThreadPool::Instance();
+  pool.SetThreadCount(4);
+  pool.SetParallelThreshold(1024);
+
+  NumaPlacement placements[] = { DefaultPlacement, InterleavedPlacement, LocalPlacement, PartitionedPlacement };
+  for ( NumaPlacement placement : placements ) {
+    SinglePrecisionArray a(TEST_VECTOR_LENGTH, placement);
+    BOOST_CHECK_EQUAL(a.GetPlacement(), placement);
+    BOOST_CHECK_EQUAL(std::count(a.data(), a.data() + a.size(), 0.0f), TEST_VECTOR_LENGTH);
+    for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+      a[i] = i % 100;
+    }
+    SinglePrecisionArray b(TEST_VECTOR_LENGTH, SmallPages, placement);
+    b.Add(a, a);
+    BOOST_CHECK_EQUAL(b[TEST_VECTOR_LENGTH - 1], 2.0f * ((TEST_VECTOR_LENGTH - 1) % 100));
+
+    // Growing zeroes the new elements, whoever touches them
+    a.resize(TEST_VECTOR_LENGTH + 5000);
+    BOOST_CHECK_EQUAL(a[TEST_VECTOR_LENGTH - 1], (TEST_VECTOR_LENGTH - 1) % 100);
+    BOOST_CHECK_EQUAL(std::count(a.data() + TEST_VECTOR_LENGTH, a.data() + a.size(), 0.0f), 5000);
+  }
+
+  // A pooled buffer reused for a new array is zeroed again
+  {
+    SinglePrecisionArray dirty(100000);
+    std::fill(dirty.data(), dirty.data() + dirty.size(), 7.0f);
+  }
+  SinglePrecisionArray clean(100000);
+  BOOST_CHECK_EQUAL(std::count(clean.data(), clean.data() + clean.size(), 0.0f), 100000);
+
+  // The default placement applies to the results of the operations
+  Numa::SetDefaultPlacement(InterleavedPlacement);
+  SinglePrecisionArray sum = clean.Add(clean);
+  Numa::SetDefaultPlacement(DefaultPlacement);
+  BOOST_CHECK_EQUAL(sum.GetPlacement(), InterleavedPlacement);
+
+  pool.SetParallelThreshold(DEFAULT_PARALLEL_THRESHOLD);
+  pool.SetThreadCount(0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
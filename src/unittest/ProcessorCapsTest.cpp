@@ -0,0 +1,110 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <set>
+#include <sched.h>
+#include <boost/test/unit_test.hpp>
+#include "ProcessorCaps.hpp"
+
+extern khyber::ProcessorCaps caps;
+
+BOOST_AUTO_TEST_SUITE(ProcessorCapsTestSuite)
+
+using namespace khyber;
+
+BOOST_AUTO_TEST_CASE(TestProcessorCapsCaches)
+{
+  if ( caps.GetCacheSource() == NoCacheSource ) {
+    BOOST_CHECK_EQUAL(caps.CacheCount(), 0);
+    BOOST_CHECK_EQUAL(caps.LastLevelCacheBytes(), 0);
+    return;
+  }
+
+  // Every x86-64 processor has an L1 data cache and a cache line of at least 32 bytes
+  BOOST_CHECK_GT(caps.CacheCount(), 0);
+  BOOST_CHECK_GT(caps.L1DataCacheBytes(), 0);
+  BOOST_CHECK_GE(caps.L1CachelineBytes, 32);
+  BOOST_CHECK_GE(caps.LastLevelCacheBytes(), caps.L1DataCacheBytes());
+  BOOST_CHECK_GE(caps.LastLevelCacheBytes(), caps.L2CacheBytes());
+
+  for ( size_t i = 0; i < caps.CacheCount(); ++i ) {
+    const CacheInfo& cache = caps.Cache(i);
+    BOOST_CHECK_GE(cache.level, 1);
+    BOOST_CHECK_GT(cache.bytes, 0);
+    BOOST_CHECK_GE(cache.sharingThreads, 1);
+    if ( i > 0 ) {
+      const CacheInfo& previous = caps.Cache(i - 1);
+      BOOST_CHECK(previous.level < cache.level || (previous.level == cache.level && previous.type <= cache.type));
+    }
+
+    // CPUID describes the geometry exactly
+    if ( caps.GetCacheSource() != Sysfs ) {
+      BOOST_CHECK_EQUAL(cache.bytes % (cache.lineBytes * cache.ways * cache.sets), 0);
+    }
+  }
+
+  // The enumeration does not depend on when or how often it runs
+  ProcessorCaps again;
+  BOOST_CHECK_EQUAL(again.CacheCount(), caps.CacheCount());
+  BOOST_CHECK_EQUAL(again.LastLevelCacheBytes(), caps.LastLevelCacheBytes());
+  BOOST_CHECK(caps.GetCapsDescription().find("L1d\t") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(TestProcessorCapsTopology)
+{
+  cpu_set_t allowed;
+  BOOST_REQUIRE_EQUAL(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+  ProcessorCaps enumerated;
+  TopologySource source = enumerated.GetTopologySource();
+
+  // Enumerating the topology never changes the affinity of the calling thread
+  cpu_set_t after;
+  BOOST_REQUIRE_EQUAL(sched_getaffinity(0, sizeof(after), &after), 0);
+  BOOST_CHECK(CPU_EQUAL(&allowed, &after));
+  if ( source == NoTopologySource ) {
+    return;
+  }
+
+  BOOST_CHECK_EQUAL(enumerated.LogicalCpuCount(), (size_t)CPU_COUNT(&allowed));
+  BOOST_CHECK_GE(enumerated.PhysicalCoreCount(), 1);
+  BOOST_CHECK_LE(enumerated.PhysicalCoreCount(), enumerated.LogicalCpuCount());
+  BOOST_CHECK_GE(enumerated.PackageCount(), 1);
+  BOOST_CHECK_LE(enumerated.PackageCount(), enumerated.PhysicalCoreCount());
+
+  std::set<uint32_t> cores;
+  for ( size_t i = 0; i < enumerated.LogicalCpuCount(); ++i ) {
+    const LogicalCpu& logical = enumerated.GetLogicalCpu(i);
+    BOOST_CHECK(CPU_ISSET(logical.id, &allowed));
+    BOOST_CHECK_LT(logical.core, enumerated.PhysicalCoreCount());
+    BOOST_CHECK_LT(logical.package, enumerated.PackageCount());
+    std::vector<uint32_t> siblings = enumerated.SmtSiblings(logical.id);
+    BOOST_CHECK(std::find(siblings.begin(), siblings.end(), logical.id) != siblings.end());
+    BOOST_CHECK_LT(logical.thread, siblings.size());
+    cores.insert(logical.core);
+  }
+  BOOST_CHECK_EQUAL(cores.size(), enumerated.PhysicalCoreCount());
+
+  // One CPU of every core, never two siblings
+  std::vector<uint32_t> perCore = enumerated.OneCpuPerPhysicalCore();
+  BOOST_CHECK_EQUAL(perCore.size(), enumerated.PhysicalCoreCount());
+  for ( size_t i = 0; i < perCore.size(); ++i ) {
+    std::vector<uint32_t> siblings = enumerated.SmtSiblings(perCore[i]);
+    for ( size_t j = i + 1; j < perCore.size(); ++j ) {
+      BOOST_CHECK(std::find(siblings.begin(), siblings.end(), perCore[j]) == siblings.end());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
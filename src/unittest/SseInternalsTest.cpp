@@ -0,0 +1,434 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <boost/test/unit_test.hpp>
+#include "ProcessorCaps.hpp"
+#include "SseInternals.hpp"
+
+#define EPSILON 0.001
+#define TEST_VECTOR_LENGTH 515
+
+extern khyber::ProcessorCaps caps;
+
+BOOST_AUTO_TEST_SUITE(SseInternalsTestSuite)
+
+using namespace khyber;
+
+BOOST_AUTO_TEST_CASE(TestSseNegate)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  alignas(16) sp_t negated[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t src[TEST_VECTOR_LENGTH];
+
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = i / 10;
+  }
+
+  sse::InternalNegate(TEST_VECTOR_LENGTH,
+                       negated,
+                       src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( negated[i] != -src[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSseArithmetic)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  alignas(16) sp_t lhs[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t rhs[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t sum[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t difference[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t product[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t quotient[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    lhs[i] = i * 1.5;
+    rhs[i] = i + 1;
+  }
+
+  sse::InternalAdd(TEST_VECTOR_LENGTH, sum, lhs, rhs);
+  sse::InternalSub(TEST_VECTOR_LENGTH, difference, lhs, rhs);
+  sse::InternalMul(TEST_VECTOR_LENGTH, product, lhs, rhs);
+  sse::InternalDiv(TEST_VECTOR_LENGTH, quotient, lhs, rhs);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( sum[i] != lhs[i] + rhs[i] ||
+         difference[i] != lhs[i] - rhs[i] ||
+         product[i] != lhs[i] * rhs[i] ||
+         quotient[i] != lhs[i] / rhs[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSseScalarArithmetic)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  alignas(16) sp_t src[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t sum[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t product[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t quotient[TEST_VECTOR_LENGTH];
+  sp_t scalar = 3.14159;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = i;
+  }
+
+  sse::InternalScalarAdd(TEST_VECTOR_LENGTH, scalar, sum, src);
+  sse::InternalScalarMul(TEST_VECTOR_LENGTH, scalar, product, src);
+  sse::InternalScalarDiv(TEST_VECTOR_LENGTH, scalar, quotient, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( sum[i] != src[i] + scalar ||
+         product[i] != src[i] * scalar ||
+         quotient[i] != src[i] / scalar ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSsePowers)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  alignas(16) sp_t src[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t root[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t sqr[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t cub[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = i * (i % 2 ? 1 : -1);
+  }
+
+  sse::InternalSquare(TEST_VECTOR_LENGTH, sqr, src);
+  sse::InternalCube(TEST_VECTOR_LENGTH, cub, src);
+  sse::InternalSqrt(TEST_VECTOR_LENGTH, root, sqr);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( sqr[i] != src[i] * src[i] ||
+         cub[i] != src[i] * src[i] * src[i] ||
+         root[i] != std::abs(src[i]) ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSseReductions)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  alignas(16) sp_t v1[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t v2[TEST_VECTOR_LENGTH];
+  sp_t refSum = 0;
+  sp_t refProduct = 0;
+  sp_t refDistance = 0;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    v1[i] = (i % 7) * 0.5;
+    v2[i] = (i % 5) * 0.25;
+    refSum += v1[i];
+    refProduct += v1[i] * v2[i];
+    refDistance += (v1[i] - v2[i]) * (v1[i] - v2[i]);
+  }
+  refDistance = std::sqrt(refDistance);
+
+  sp_t result;
+  sse::InternalSummation(TEST_VECTOR_LENGTH, &result, v1);
+  BOOST_CHECK_CLOSE(result, refSum, EPSILON);
+  sse::InternalSummation(5, &result, v1);
+  BOOST_CHECK_EQUAL(result, v1[0] + v1[1] + v1[2] + v1[3] + v1[4]);
+  sse::InternalDotProduct(TEST_VECTOR_LENGTH, &result, v1, v2);
+  BOOST_CHECK_CLOSE(result, refProduct, EPSILON);
+  sse::InternalDistance(TEST_VECTOR_LENGTH, &result, v1, v2);
+  BOOST_CHECK_CLOSE(result, refDistance, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(TestSseReciprocate)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  alignas(16) sp_t reciprocated[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t src[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = i + 1;
+  }
+
+  sse::InternalReciprocate(TEST_VECTOR_LENGTH, reciprocated, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_EQUAL(reciprocated[i], 1.0f / src[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSseReciprocalPrecision)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  alignas(16) sp_t src[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t dst[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = (i + 1) / 7.0f;
+  }
+
+  // Relative tolerances in percent: 1.5*2^-12 for the estimates and 2^-21 after the Newton-Raphson step
+  sse::InternalApproximateReciprocate(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / (dp_t)src[i], 0.037);
+  }
+  sse::InternalRefinedReciprocate(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / (dp_t)src[i], 4.8e-5);
+  }
+  sse::InternalApproximateRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / std::sqrt((dp_t)src[i]), 0.037);
+  }
+  sse::InternalRefinedRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / std::sqrt((dp_t)src[i]), 4.8e-5);
+  }
+  sse::InternalRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_EQUAL(dst[i], 1.0f / std::sqrt(src[i]));
+  }
+
+  // The tail is padded into a full register, the estimates have to match the elements computed in the vector loop
+  alignas(16) sp_t tail[3];
+  sse::InternalRefinedReciprocate(3, tail, src + 4);
+  sse::InternalRefinedReciprocate(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < 3; ++i ) {
+    BOOST_CHECK_EQUAL(tail[i], dst[4 + i]);
+  }
+  sse::InternalApproximateRsqrt(3, tail, src + 4);
+  sse::InternalApproximateRsqrt(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < 3; ++i ) {
+    BOOST_CHECK_EQUAL(tail[i], dst[4 + i]);
+  }
+
+  // The Newton-Raphson step keeps the limits of the estimate instead of turning them into NaN
+  alignas(16) sp_t special[8] = { 0.0f, -0.0f, INFINITY, -INFINITY, 1e-40f, -4.0f, 4.0f, 0.25f };
+  sse::InternalRefinedReciprocate(8, dst, special);
+  BOOST_CHECK(std::isinf(dst[0]) && dst[0] > 0);
+  BOOST_CHECK(std::isinf(dst[1]) && dst[1] < 0);
+  BOOST_CHECK_EQUAL(dst[2], 0.0f);
+  BOOST_CHECK_EQUAL(dst[3], 0.0f);
+  BOOST_CHECK(std::isinf(dst[4]) && dst[4] > 0);
+  BOOST_CHECK_CLOSE(dst[5], -0.25f, 4.8e-5);
+  sse::InternalRefinedRsqrt(8, dst, special);
+  BOOST_CHECK(std::isinf(dst[0]) && dst[0] > 0);
+  BOOST_CHECK_EQUAL(dst[2], 0.0f);
+  BOOST_CHECK(std::isnan(dst[3]));
+  BOOST_CHECK(std::isinf(dst[4]) && dst[4] > 0);
+  BOOST_CHECK(std::isnan(dst[5]));
+  BOOST_CHECK_CLOSE(dst[7], 2.0f, 4.8e-5);
+}
+
+BOOST_AUTO_TEST_CASE(TestSsePrefixSum)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  // Small integral values keep every floating point prefix sum exact
+  alignas(32) sp_t spSrc[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t spInclusive[TEST_VECTOR_LENGTH];
+  alignas(32) sp_t spExclusive[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    spSrc[i] = i % 7;
+  }
+
+  sse::InternalPrefixSum(TEST_VECTOR_LENGTH, 10, spInclusive, spSrc);
+  sse::InternalExclusivePrefixSum(TEST_VECTOR_LENGTH, 10, spExclusive, spSrc);
+  sp_t spRunning = 10;
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( spExclusive[i] != spRunning ||
+         spInclusive[i] != spRunning + spSrc[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+    spRunning += spSrc[i];
+  }
+
+  // In place, dst == src
+  sse::InternalExclusivePrefixSum(TEST_VECTOR_LENGTH, 10, spSrc, spSrc);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( spSrc[i] != spExclusive[i] ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSseExtrema)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  // Every value recurs several times, in different lanes, so the first index has to win the ties
+  alignas(32) sp_t spSrc[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    spSrc[i] = (i * 37 + 50) % 101;
+  }
+
+  sp_t spExtreme;
+  Extrema<sp_t> spExtrema;
+  size_t spIndex;
+  sse::InternalMinimum(TEST_VECTOR_LENGTH, &spExtreme, spSrc);
+  BOOST_CHECK_EQUAL(spExtreme, *std::min_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  sse::InternalMaximum(TEST_VECTOR_LENGTH, &spExtreme, spSrc);
+  BOOST_CHECK_EQUAL(spExtreme, *std::max_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  sse::InternalMinMaximum(TEST_VECTOR_LENGTH, &spExtrema, spSrc);
+  BOOST_CHECK_EQUAL(spExtrema.minimum, *std::min_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  BOOST_CHECK_EQUAL(spExtrema.maximum, *std::max_element(spSrc, spSrc + TEST_VECTOR_LENGTH));
+  sse::InternalArgMinimum(TEST_VECTOR_LENGTH, &spIndex, spSrc);
+  BOOST_CHECK_EQUAL(spIndex, std::min_element(spSrc, spSrc + TEST_VECTOR_LENGTH) - spSrc);
+  sse::InternalArgMaximum(TEST_VECTOR_LENGTH, &spIndex, spSrc);
+  BOOST_CHECK_EQUAL(spIndex, std::max_element(spSrc, spSrc + TEST_VECTOR_LENGTH) - spSrc);
+
+  spSrc[400] = NAN;
+  spSrc[300] = NAN;
+  sse::InternalMinimum(TEST_VECTOR_LENGTH, &spExtreme, spSrc);
+  BOOST_CHECK(std::isnan(spExtreme));
+  sse::InternalMinMaximum(TEST_VECTOR_LENGTH, &spExtrema, spSrc);
+  BOOST_CHECK(std::isnan(spExtrema.minimum) && std::isnan(spExtrema.maximum));
+  sse::InternalArgMaximum(TEST_VECTOR_LENGTH, &spIndex, spSrc);
+  BOOST_CHECK_EQUAL(spIndex, 300);
+}
+
+BOOST_AUTO_TEST_CASE(TestSseTranscendentals)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  // Relative tolerances in percent: 3e-5 is about 2.5 ulp of a float
+  alignas(16) sp_t src[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t positive[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t exponent[TEST_VECTOR_LENGTH];
+  alignas(16) sp_t dst[TEST_VECTOR_LENGTH];
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    src[i] = (i - 257) / 32.0f;
+    positive[i] = (i + 1) / 64.0f;
+    exponent[i] = (i % 13 - 6) / 4.0f;
+  }
+
+  sse::InternalExp(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::exp((dp_t)src[i]), 3e-5);
+  }
+  sse::InternalLog(TEST_VECTOR_LENGTH, dst, positive);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::log((dp_t)positive[i]), 3e-5);
+  }
+  sse::InternalLog2(TEST_VECTOR_LENGTH, dst, positive);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::log2((dp_t)positive[i]), 3e-5);
+  }
+  // The error of sin and cos is bounded in ulp only away from their roots
+  sse::InternalSin(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_SMALL(dst[i] - std::sin((dp_t)src[i]), 2.4e-7);
+  }
+  sse::InternalCos(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_SMALL(dst[i] - std::cos((dp_t)src[i]), 2.4e-7);
+  }
+  sse::InternalTanh(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], std::tanh((dp_t)src[i]), 3e-5);
+  }
+  sse::InternalSigmoid(TEST_VECTOR_LENGTH, dst, src);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    BOOST_CHECK_CLOSE(dst[i], 1 / (1 + std::exp(-(dp_t)src[i])), 4e-5);
+  }
+  sse::InternalPow(TEST_VECTOR_LENGTH, dst, positive, exponent);
+  for ( auto i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    dp_t power = std::log2((dp_t)positive[i]) * exponent[i];
+    BOOST_CHECK_CLOSE(dst[i], std::pow((dp_t)positive[i], (dp_t)exponent[i]), (2 + 1.2 * std::abs(power)) * 1.2e-5);
+  }
+
+  // The tail is padded into a full register, it has to match the elements computed in the vector loop
+  alignas(16) sp_t tail[3];
+  sse::InternalExp(3, tail, src + 4);
+  sse::InternalExp(TEST_VECTOR_LENGTH, dst, src);
+  BOOST_CHECK_EQUAL(tail[0], dst[4]);
+  BOOST_CHECK_EQUAL(tail[2], dst[6]);
+
+  alignas(16) sp_t special[8] = { 0.0f, -1.0f, INFINITY, -INFINITY, -2.0f, 2.0f, 2.0f, 2.0f };
+  alignas(16) sp_t specialExponent[8] = { -1.0f, 3.0f, 0.0f, 0.5f, 0.5f, 2.0f, 2.0f, 2.0f };
+  sse::InternalLog(8, dst, special);
+  BOOST_CHECK(std::isinf(dst[0]) && dst[0] < 0);
+  BOOST_CHECK(std::isnan(dst[1]));
+  BOOST_CHECK(std::isinf(dst[2]) && dst[2] > 0);
+  BOOST_CHECK(std::isnan(dst[3]));
+  sse::InternalExp(8, dst, special);
+  BOOST_CHECK_EQUAL(dst[0], 1.0f);
+  BOOST_CHECK(std::isinf(dst[2]));
+  BOOST_CHECK_EQUAL(dst[3], 0.0f);
+  sse::InternalTanh(8, dst, special);
+  BOOST_CHECK_EQUAL(dst[2], 1.0f);
+  BOOST_CHECK_EQUAL(dst[3], -1.0f);
+  sse::InternalPow(8, dst, special, specialExponent);
+  BOOST_CHECK(std::isinf(dst[0]));
+  BOOST_CHECK_EQUAL(dst[1], -1.0f);
+  BOOST_CHECK_EQUAL(dst[2], 1.0f);
+  BOOST_CHECK(std::isinf(dst[3]) && dst[3] > 0);
+  BOOST_CHECK(std::isnan(dst[4]));
+  BOOST_CHECK_EQUAL(dst[5], 4.0f);
+}
+
+BOOST_AUTO_TEST_CASE(TestSseStreamingCopy)
+{
+  if ( !caps.IsSse4_1() ) {
+    return;
+  }
+
+  // Every alignment of the destination and lengths that end before, on and after a full unrolled iteration
+  alignas(32) uint8_t src[4 * TEST_VECTOR_LENGTH];
+  alignas(32) uint8_t dst[4 * TEST_VECTOR_LENGTH + 64];
+  for ( size_t i = 0; i < sizeof(src); ++i ) {
+    src[i] = (uint8_t)(i * 7 + 3);
+  }
+  const size_t lengths[] = { 0, 5, 64, 79, 4 * TEST_VECTOR_LENGTH - 1 };
+  for ( size_t misalignment = 0; misalignment < 33; ++misalignment ) {
+    for ( auto bytes : lengths ) {
+      std::fill(dst, dst + sizeof(dst), 0);
+      sse::InternalStreamingCopy(bytes, dst + misalignment, src + 1);
+      BOOST_CHECK(std::equal(src + 1, src + 1 + bytes, dst + misalignment));
+      BOOST_CHECK(std::count(dst, dst + misalignment, 0) == (long)misalignment);
+      BOOST_CHECK(std::count(dst + misalignment + bytes, dst + sizeof(dst), 0) == (long)(sizeof(dst) - misalignment - bytes));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,182 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <boost/test/unit_test.hpp>
+#include "Array.hpp"
+#include "ThreadPool.hpp"
+
+// Above the lowered threshold and not a multiple of the chunk granule
+#define TEST_VECTOR_LENGTH 100003
+
+BOOST_AUTO_TEST_SUITE(ThreadPoolTestSuite)
+
+using namespace khyber;
+
+BOOST_AUTO_TEST_CASE(TestThreadPoolRun)
+{
+  ThreadPool& pool = ThreadPool::Instance();
+  pool.SetThreadCount(4);
+
+  std::vector<int> visits(1000, 0);
+  std::atomic<int> nested(0);
+  pool.Run(visits.size(), [&](size_t i) {
+    ++visits[i];
+    // Jobs submitted from inside a task run serially on the same thread
+    pool.Run(2, [&](size_t) { ++nested; });
+  });
+  for ( size_t i = 0; i < visits.size(); ++i ) {
+    BOOST_CHECK_EQUAL(visits[i], 1);
+  }
+  BOOST_CHECK_EQUAL(nested, 2000);
+  BOOST_CHECK(!ThreadPool::InParallelRegion());
+
+  pool.SetThreadCount(0);
+}
+
+BOOST_AUTO_TEST_CASE(TestThreadPoolExceptions)
+{
+  ThreadPool& pool = ThreadPool::Instance();
+  pool.SetThreadCount(4);
+
+  // A throwing task on any thread, the calling one included, is rethrown by Run( ) once the whole job has stopped
+  for ( size_t thrower = 0; thrower < 64; thrower += 7 ) {
+    std::atomic<int> started(0);
+    BOOST_CHECK_THROW(pool.Run(64, [&](size_t i) {
+      ++started;
+      if ( i == thrower ) {
+        throw std::runtime_error("task failed");
+      }
+    }), std::runtime_error);
+    BOOST_CHECK(started <= 64);
+    BOOST_CHECK(!ThreadPool::InParallelRegion());
+  }
+
+  // The pool is still usable, and the caller is no longer considered inside a job
+  std::vector<int> visits(1000, 0);
+  std::atomic<int> outside(0);
+  pool.Run(visits.size(), [&](size_t i) {
+    ++visits[i];
+    outside += !ThreadPool::InParallelRegion();
+  });
+  BOOST_CHECK_EQUAL(outside, 0);
+  BOOST_CHECK_EQUAL(std::count(visits.begin(), visits.end(), 1), 1000);
+  BOOST_CHECK(!ThreadPool::InParallelRegion());
+
+  pool.SetThreadCount(0);
+}
+
+BOOST_AUTO_TEST_CASE(TestThreadPoolArrayOperations)
+{
+  ThreadPool& pool = ThreadPool::Instance();
+  pool.SetThreadCount(4);
+  pool.SetParallelThreshold(1024);
+
+  SinglePrecisionArray a(TEST_VECTOR_LENGTH);
+  SinglePrecisionArray b(TEST_VECTOR_LENGTH);
+  UInt32Array c(TEST_VECTOR_LENGTH);
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    a[i] = i % 97;
+    b[i] = 1.0f;
+    c[i] = 3 * i;
+  }
+
+  SinglePrecisionArray sum = a.Add(b);
+  SinglePrecisionArray scaled = a.ScalarMul(2.0f);
+  a = a * b + a;
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( sum[i] != i % 97 + 1.0f || scaled[i] != 2.0f * (i % 97) || a[i] != 2.0f * (i % 97) ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+
+  // Integral sums are exact, so the parallel reduction must match the serial one bit for bit
+  BOOST_CHECK_EQUAL(b.Summation(), (float)TEST_VECTOR_LENGTH);
+  BOOST_CHECK_EQUAL(c.WideSummation(), 3ull * TEST_VECTOR_LENGTH * (TEST_VECTOR_LENGTH - 1) / 2);
+  BOOST_CHECK_EQUAL(c.Max(), 3u * (TEST_VECTOR_LENGTH - 1));
+  BOOST_CHECK_CLOSE(b.Distance(b.ScalarMul(2.0f)), std::sqrt((float)TEST_VECTOR_LENGTH), 0.001);
+
+  // The extrema of a recur in every chunk, the first index has to win across the chunks
+  BOOST_CHECK_EQUAL(a.ArgMin(), 0);
+  BOOST_CHECK_EQUAL(a.ArgMax(), 96);
+  BOOST_CHECK_EQUAL(a.MinMax().maximum, 192.0f);
+  BOOST_CHECK_EQUAL(c.ArgMax(), TEST_VECTOR_LENGTH - 1);
+
+  // Two-pass scan, the carries of the chunks come from the first pass
+  UInt32Array offsets = c.ExclusivePrefixSum();
+  c.TransformPrefixSum();
+  for ( size_t i = 0; i < TEST_VECTOR_LENGTH; ++i ) {
+    if ( offsets[i] != (uint32_t)(3ull * i * (i - 1) / 2) || c[i] != (uint32_t)(3ull * i * (i + 1) / 2) ) {
+      BOOST_CHECK_MESSAGE(false, i);
+      break;
+    }
+  }
+
+  // The compensated sums are computed over the same blocks whatever the number of threads
+  float parallelSum = a.CompensatedSummation();
+  float parallelProduct = a.CompensatedDotProduct(b);
+  pool.SetThreadCount(3);
+  BOOST_CHECK_EQUAL(a.CompensatedSummation(), parallelSum);
+  BOOST_CHECK_EQUAL(a.CompensatedDotProduct(b), parallelProduct);
+  pool.SetThreadCount(1);
+  BOOST_CHECK_EQUAL(a.CompensatedSummation(), parallelSum);
+  BOOST_CHECK_EQUAL(a.CompensatedDotProduct(b), parallelProduct);
+
+  pool.SetParallelThreshold(DEFAULT_PARALLEL_THRESHOLD);
+  pool.SetThreadCount(0);
+}
+
+BOOST_AUTO_TEST_CASE(TestThreadPoolPinning)
+{
+  ThreadPool& pool = ThreadPool::Instance();
+  pool.PinToPhysicalCores();
+  std::vector<uint32_t> cores = ProcessorCaps::Host().OneCpuPerPhysicalCore();
+  BOOST_CHECK_EQUAL(pool.GetThreadCount(), std::max<size_t>(cores.size(), 1));
+
+  // Every task run by a worker runs on a single CPU of the list
+  std::thread::id caller = std::this_thread::get_id();
+  std::mutex mutex;
+  std::vector<std::vector<uint32_t> > workerMasks;
+  pool.Run(1000, [&](size_t) {
+    if ( std::this_thread::get_id() == caller ) {
+      return;
+    }
+    cpu_set_t mask;
+    pthread_getaffinity_np(pthread_self(), sizeof(mask), &mask);
+    std::vector<uint32_t> cpus;
+    for ( uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu ) {
+      if ( CPU_ISSET(cpu, &mask) ) {
+        cpus.push_back(cpu);
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    workerMasks.push_back(cpus);
+  });
+  for ( auto& cpus : workerMasks ) {
+    BOOST_CHECK_EQUAL(cpus.size(), 1);
+    BOOST_CHECK(std::find(cores.begin(), cores.end(), cpus[0]) != cores.end());
+  }
+
+  pool.SetAffinity(std::vector<uint32_t>());
+  pool.SetThreadCount(0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
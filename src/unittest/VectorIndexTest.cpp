@@ -0,0 +1,188 @@
+// Copyright 2014 Irfan Hamid
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <boost/test/unit_test.hpp>
+#include "VectorIndex.hpp"
+
+BOOST_AUTO_TEST_SUITE(VectorIndexTestSuite)
+
+using namespace khyber;
+
+///
+/// \brief Small integers, so the dot products and L2 distances are exact in single precision and many of them tie
+///
+static SinglePrecisionMatrix MakeVectors(size_t count, size_t dimension, size_t seed)
+{
+  SinglePrecisionMatrix vectors(count, dimension);
+  for ( size_t r = 0; r < count; ++r ) {
+    for ( size_t c = 0; c < dimension; ++c ) {
+      vectors(r, c) = (float)((int)((r * 37 + c * 11 + seed * 7 + r * c) % 9) - 4);
+    }
+  }
+  return vectors;
+}
+
+///
+/// \brief Computes the score of query against vector in double precision
+///
+static double Score(VectorMetric metric, ArrayView<const float> query, ArrayView<const float> vector)
+{
+  double dot = 0, distance = 0, queryNorm = 0, vectorNorm = 0;
+  for ( size_t i = 0; i < query.size(); ++i ) {
+    dot += (double)query[i] * vector[i];
+    distance += ((double)query[i] - vector[i]) * ((double)query[i] - vector[i]);
+    queryNorm += (double)query[i] * query[i];
+    vectorNorm += (double)vector[i] * vector[i];
+  }
+  if ( metric == L2Distance ) {
+    return std::sqrt(distance);
+  }
+  if ( metric == InnerProduct ) {
+    return dot;
+  }
+  return queryNorm > 0 && vectorNorm > 0 ? dot / std::sqrt(queryNorm * vectorNorm) : 0;
+}
+
+///
+/// \brief Checks neighbors against a brute-force ranking of every stored vector. The L2 and inner product scores are exact, so
+/// the ids must match, ties going to the lower id; the cosine scores are rounded, so only the scores are compared.
+///
+static void CheckNeighbors(const VectorIndex& index, ArrayView<const float> query, size_t k, const std::vector<Neighbor>& neighbors)
+{
+  bool smallestFirst = index.metric() == L2Distance;
+  std::vector<std::pair<double, size_t> > expected;
+  for ( size_t id = 0; id < index.size(); ++id ) {
+    double score = Score(index.metric(), query, index.Vector(id));
+    expected.push_back(std::make_pair(smallestFirst ? score : -score, id));
+  }
+  std::sort(expected.begin(), expected.end());
+
+  BOOST_REQUIRE_EQUAL(neighbors.size(), std::min(k, index.size()));
+  size_t mismatches = 0;
+  for ( size_t i = 0; i < neighbors.size(); ++i ) {
+    double score = smallestFirst ? expected[i].first : -expected[i].first;
+    if ( index.metric() == CosineSimilarity ) {
+      mismatches += std::fabs(neighbors[i].score - score) > 1e-5;
+      mismatches += std::fabs(neighbors[i].score - Score(index.metric(), query, index.Vector(neighbors[i].id))) > 1e-5;
+    } else {
+      mismatches += neighbors[i].id != expected[i].second;
+      mismatches += std::fabs(neighbors[i].score - score) > 1e-3 * std::max(1.0, std::fabs(score));
+    }
+  }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestVectorIndexBasics)
+{
+  BOOST_CHECK_THROW(VectorIndex(0), std::invalid_argument);
+
+  VectorIndex index(3, InnerProduct);
+  BOOST_CHECK(index.empty());
+  BOOST_CHECK(index.Search(SinglePrecisionArray(3), 5).empty());
+
+  SinglePrecisionArray vector(3);
+  vector[0] = 1.0f;
+  vector[1] = 2.0f;
+  vector[2] = 3.0f;
+  BOOST_CHECK_EQUAL(index.Add(vector), 0);
+  BOOST_CHECK_EQUAL(index.Add(MakeVectors(4, 3, 1)), 1);
+  BOOST_CHECK_EQUAL(index.size(), 5);
+  BOOST_CHECK_EQUAL(index.Vector(0)[2], 3.0f);
+  BOOST_CHECK_THROW(index.Add(SinglePrecisionArray(4)), std::invalid_argument);
+  BOOST_CHECK_THROW(index.Add(SinglePrecisionMatrix(2, 2)), std::invalid_argument);
+  BOOST_CHECK_THROW(index.Search(SinglePrecisionArray(2), 1), std::invalid_argument);
+  BOOST_CHECK_THROW(index.Search(SinglePrecisionMatrix(2, 4), 1), std::invalid_argument);
+
+  // The nearest vector by inner product to itself, with every vector returned when k exceeds the size
+  std::vector<Neighbor> neighbors = index.Search(vector, 10);
+  BOOST_CHECK_EQUAL(neighbors.size(), 5);
+  CheckNeighbors(index, vector, 10, neighbors);
+  BOOST_CHECK(index.Search(vector, 0).empty());
+
+  // A stored vector can be added again, even when that moves the storage it is read from
+  VectorIndex copies(3, L2Distance);
+  copies.Add(vector);
+  for ( size_t i = 0; i < 100; ++i ) {
+    BOOST_CHECK_EQUAL(copies.Add(copies.Vector(i)), i + 1);
+  }
+  for ( size_t i = 0; i < copies.size(); ++i ) {
+    BOOST_CHECK(std::equal(vector.data(), vector.data() + 3, copies.Vector(i).begin()));
+  }
+  CheckNeighbors(copies, vector, 3, copies.Search(vector, 3));
+}
+
+BOOST_AUTO_TEST_CASE(TestVectorIndexSearch)
+{
+  const uint64_t masks[] = { 0, BM_FMA, BM_AVX | BM_AVX2 | BM_FMA | BM_SSE4_1 };
+  const VectorMetric metrics[] = { L2Distance, InnerProduct, CosineSimilarity };
+  // Dimensions around the 8 element registers and the padding, and batches around the four-query tiles
+  const size_t dimensions[] = { 1, 7, 16, 33 };
+  const size_t queryCounts[] = { 1, 6 };
+  for ( auto mask : masks ) {
+    ProcessorCaps downgradedCaps = ProcessorCaps::Host();
+    downgradedCaps.ClearFlags(mask);
+    SinglePrecisionArray::OverrideProcessorCaps(downgradedCaps);
+
+    for ( auto metric : metrics ) {
+      for ( auto dimension : dimensions ) {
+        VectorIndex index(dimension, metric);
+        index.Add(MakeVectors(601, dimension, 2));
+        for ( auto queryCount : queryCounts ) {
+          SinglePrecisionMatrix queries = MakeVectors(queryCount, dimension, 3);
+          std::vector<std::vector<Neighbor> > results = index.Search(queries, 10);
+          BOOST_REQUIRE_EQUAL(results.size(), queryCount);
+          for ( size_t q = 0; q < queryCount; ++q ) {
+            CheckNeighbors(index, queries.Row(q), 10, results[q]);
+          }
+        }
+      }
+    }
+  }
+  SinglePrecisionArray::OverrideProcessorCaps(ProcessorCaps::Host());
+}
+
+BOOST_AUTO_TEST_CASE(TestVectorIndexParallelSearch)
+{
+  VectorIndex index(24, L2Distance);
+  index.Add(MakeVectors(3000, 24, 4));
+  SinglePrecisionMatrix queries = MakeVectors(9, 24, 5);
+  std::vector<std::vector<Neighbor> > serial = index.Search(queries, 25);
+
+  // Split over the database, the merged results must be those of the serial search, ties included
+  ThreadPool& pool = ThreadPool::Instance();
+  pool.SetThreadCount(4);
+  pool.SetParallelThreshold(1000);
+  std::vector<std::vector<Neighbor> > parallel = index.Search(queries, 25);
+  std::vector<Neighbor> single = index.Search(queries.Row(7), 25);
+  pool.SetParallelThreshold(DEFAULT_PARALLEL_THRESHOLD);
+  pool.SetThreadCount(0);
+
+  size_t mismatches = 0;
+  for ( size_t q = 0; q < queries.rows(); ++q ) {
+    CheckNeighbors(index, queries.Row(q), 25, parallel[q]);
+    for ( size_t i = 0; i < serial[q].size(); ++i ) {
+      mismatches += parallel[q][i].id != serial[q][i].id || parallel[q][i].score != serial[q][i].score;
+    }
+  }
+  for ( size_t i = 0; i < single.size(); ++i ) {
+    mismatches += single[i].id != serial[7][i].id || single[i].score != serial[7][i].score;
+  }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()